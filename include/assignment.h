@@ -0,0 +1,94 @@
+#ifndef ASSIGNMENT_H
+#define ASSIGNMENT_H
+
+#include <stdbool.h>
+#include "graph.h"
+#include "solve_control.h"
+#include "types.h"
+
+/**
+ * @file assignment.h
+ * @brief 静态交通分配：在起讫点（OD）需求下求用户均衡的路段流量。
+ * @details 使用 Frank-Wolfe 算法：
+ *          1. 按当前流量用 BPR 函数 t = t0 × (1 + α (x/c)^β) 更新每条路段的通行时间；
+ *          2. 在线程池上按起点并行计算最短路径，把所有需求加载到最短路径上（全有全无分配）；
+ *          3. 沿"全有全无流量 - 当前流量"的方向做线搜索（对 Beckmann 目标函数二分求导数零点），更新流量；
+ *          4. 相对间隙 (总出行成本 - 最短路径总成本) / 总出行成本 小于目标值时停止。
+ *          路段是有向的 (起点, 终点, 交通方式) 三元组，与寻路算法使用相同的交通规则和交通事件状态；
+ *          路段表使用与寻路引擎相同的压缩邻接表（见 csr_engine.h），只构建一次，内存占用与可用路段数成正比。
+ */
+
+/**
+ * @brief 交通分配的参数。
+ */
+typedef struct {
+    double time_weight;         ///< 时间权重。
+    double cost_weight;         ///< 花费权重。
+    int max_iterations;         ///< 最大迭代次数。
+    double target_relative_gap; ///< 收敛所需的相对间隙。
+    double bpr_alpha;           ///< BPR 函数的 α。
+    double bpr_beta;            ///< BPR 函数的 β。
+    double capacity[TRANSPORT_MODE_COUNT]; ///< 每种交通方式单条路段的通行能力（人次/小时）。
+} AssignmentOptions;
+
+/**
+ * @brief 一条有流量的路段。
+ */
+typedef struct {
+    int from_node_id;           ///< 路段起点。
+    int to_node_id;             ///< 路段终点。
+    TransportMode mode;         ///< 交通方式。
+    double flow;                ///< 均衡流量（人次/小时）。
+    double free_flow_hours;     ///< 自由流通行时间（小时）。
+    double congested_hours;     ///< 均衡流量下的通行时间（小时）。
+    double saturation;          ///< 饱和度（流量 / 通行能力）。
+} AssignedLink;
+
+/**
+ * @brief 交通分配的结果。
+ */
+typedef struct {
+    int iterations;             ///< 实际迭代次数。
+    double relative_gap;        ///< 最后一次迭代的相对间隙。
+    bool converged;             ///< 是否达到目标相对间隙。
+    double total_demand;        ///< 总需求（人次/小时）。
+    double unassigned_demand;   ///< 起讫点之间不可达而未能分配的需求。
+    double total_travel_hours;  ///< 所有出行的总时间（人·小时）。
+    AssignedLink* links;        ///< 有流量的路段，按流量从大到小排列。
+    int link_count;             ///< 有流量的路段数。
+} AssignmentResult;
+
+/**
+ * @brief 用默认值填充交通分配参数。
+ */
+void assignment_default_options(AssignmentOptions* options);
+
+/**
+ * @brief 从CSV文件加载起讫点需求矩阵。
+ * @details 文件格式为 `origin,destination,trips`（带表头），起讫点可以是节点名称，
+ *          也可以是城市名称（此时使用该城市的第一个地标节点）。同一对起讫点出现多次时需求累加。
+ *
+ * @param network 交通网络。
+ * @param csv_path 文件路径。
+ * @return double* 节点数 × 节点数 的需求矩阵 demand[o * 节点数 + d]，调用者需使用 free() 释放。失败时返回NULL。
+ */
+double* assignment_load_demand_csv(const TrafficNetwork* network, const char* csv_path);
+
+/**
+ * @brief 求解用户均衡交通分配。
+ *
+ * @param network 交通网络。
+ * @param demand 节点数 × 节点数 的需求矩阵（人次/小时）。
+ * @param options 参数，NULL表示使用默认值。
+ * @param control 取消令牌与进度回调，可为NULL。进度阶段名为 "assignment"。
+ * @return AssignmentResult* 结果，调用者需使用 free_assignment_result() 释放。内存不足或被取消时返回NULL。
+ */
+AssignmentResult* solve_traffic_assignment(const TrafficNetwork* network, const double* demand, const AssignmentOptions* options,
+                                           const SolveControl* control);
+
+/**
+ * @brief 释放交通分配的结果。传入NULL时不做任何操作。
+ */
+void free_assignment_result(AssignmentResult* result);
+
+#endif // ASSIGNMENT_H
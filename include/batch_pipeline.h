@@ -0,0 +1,62 @@
+#ifndef BATCH_PIPELINE_H
+#define BATCH_PIPELINE_H
+
+#include <stdbool.h>
+#include "graph.h"
+#include "solve_control.h"
+
+/**
+ * @file batch_pipeline.h
+ * @brief 文件到文件的批量路线规划：读取起终点列表，逐行输出规划结果，输出顺序与输入一致。
+ * @details 处理分为三级流水线，相邻两级之间用有界无锁环形队列（见 spsc_ring.h）连接：
+ *          1. 解析线程：读取输入、拆分字段、按名称查找节点；
+ *          2. N 个寻路线程：共用一个寻路引擎计算路线；
+ *          3. 输出线程（即调用者线程）：把结果格式化后写入输出文件。
+ *          解析线程把第 k 条查询交给第 k mod N 个寻路线程，输出线程按同样的顺序轮流从各寻路线程取结果，
+ *          因此每个队列都只有一个生产者和一个消费者，不需要重排缓冲区即可保持顺序，读文件、查名称和格式化与寻路重叠进行。
+ *
+ *          输入每行一条查询：起点,终点[,时间权重,花费权重[,交通方式]]。起终点可以写名称或节点ID，
+ *          权重默认各0.5，交通方式以分号分隔（例如 high_speed_rail;bus），省略时不限制；空行和以 '#' 开头的行被跳过。
+ *          输出为带表头的CSV：line,from,to,status,distance_km,time_hours,cost_yuan,route，
+ *          status 为 ok、invalid（格式错误）、unknown_node（未找到地标）、no_route（不可达）或 cancelled。
+ */
+
+/**
+ * @brief 批量规划的配置。
+ */
+typedef struct {
+    int worker_count;       ///< 寻路线程数，小于等于0时使用CPU核心数。
+    int queue_capacity;     ///< 每个环形队列的容量，默认256。
+} BatchOptions;
+
+/**
+ * @brief 批量规划的统计结果。
+ */
+typedef struct {
+    long query_count;       ///< 写入输出的查询数。
+    long routed_count;      ///< 其中成功规划的查询数。
+    double elapsed_seconds; ///< 总耗时（秒）。
+} BatchStats;
+
+/**
+ * @brief 用默认值初始化批量规划配置。
+ */
+void batch_options_init(BatchOptions* options);
+
+/**
+ * @brief 对输入文件中的每一条查询规划路线，结果按输入顺序写入输出文件。
+ * @details 进度（按已读取的输入字节数计，阶段标识为 "batch"）在解析线程中报告。
+ *          取消后不再读取新的查询，已经读取的查询照常写出（未算完的标记为 cancelled），函数返回false。
+ *
+ * @param network 交通网络。
+ * @param input_path 输入文件路径。
+ * @param output_path 输出文件路径，已存在时被覆盖。
+ * @param options 配置，可为NULL表示使用默认值。
+ * @param control 取消令牌和进度回调，可为NULL。
+ * @param out_stats 输出统计结果，可为NULL。
+ * @return bool 全部查询都已写出时返回true；文件无法打开、内存不足或被取消时返回false。
+ */
+bool batch_route_file(const TrafficNetwork* network, const char* input_path, const char* output_path, const BatchOptions* options,
+                      const SolveControl* control, BatchStats* out_stats);
+
+#endif // BATCH_PIPELINE_H
@@ -0,0 +1,86 @@
+#ifndef CENTRALITY_H
+#define CENTRALITY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "graph.h"
+#include "solve_control.h"
+#include "types.h"
+
+/**
+ * @file centrality.h
+ * @brief 介数中心性分析：统计每个节点位于多少条起讫点之间的最优路线上。
+ * @details 使用 Brandes 算法：从每个起点做一次 Dijkstra，同时统计到每个节点的最短路径条数，
+ *          再按距离从远到近回传依赖值。路段表使用寻路引擎共享的压缩邻接表，只访问允许的交通方式所在的行，
+ *          开放集按网络的稠密程度选择线性扫描或二叉堆。边权与寻路算法一致（交通规则、交通事件状态、时间/花费权重）。
+ *          起点在线程池上并行处理，每个工作线程累加到自己的介数数组，最后合并。
+ *          可以只统计枢纽（机场和高铁站）之间的起讫点对，也可以随机抽取部分起点做近似估计。
+ *          精确计算的复杂度为 起点数 × 节点数² × 交通方式数。
+ */
+
+/**
+ * @brief 参与统计的起讫点范围。
+ */
+typedef enum {
+    CENTRALITY_ALL_NODES,       ///< 所有节点之间的起讫点对。
+    CENTRALITY_HUB_NODES        ///< 只统计机场和高铁站之间的起讫点对（中间节点不限）。
+} CentralityScope;
+
+/**
+ * @brief 介数中心性的参数。
+ */
+typedef struct {
+    double time_weight;         ///< 时间权重。
+    double cost_weight;         ///< 花费权重。
+    CentralityScope scope;      ///< 起讫点范围。
+    int sample_sources;         ///< 随机抽取的起点数，0 表示使用范围内的全部起点（精确计算）。
+    uint64_t seed;              ///< 抽样的随机种子。
+    TransportModeMask allowed_modes; ///< 允许使用的交通方式，0表示不限制。被排除的交通方式不参与搜索。
+} CentralityOptions;
+
+/**
+ * @brief 介数中心性的结果。
+ */
+typedef struct {
+    int node_count;             ///< 节点数。
+    double* betweenness;        ///< 每个节点的介数：经过该节点（不含作为起讫点）的最优路线条数，
+                                ///< 多条并列最优路线按比例计数。抽样时已按抽样比例放大。
+    double* share;              ///< 每个节点的介数占可能经过它的起讫点对总数的比例 [0, 1]。
+    int endpoint_count;         ///< 范围内的起讫点数。
+    int source_count;           ///< 实际计算的起点数。
+    bool sampled;               ///< 是否为抽样估计。
+} CentralityResult;
+
+/**
+ * @brief 用默认值填充介数中心性参数：只考虑时间、全部节点、全部交通方式、精确计算。
+ */
+void centrality_default_options(CentralityOptions* options);
+
+/**
+ * @brief 计算节点的介数中心性。
+ *
+ * @param network 交通网络。
+ * @param options 参数，NULL表示使用默认值。
+ * @param control 取消令牌与进度回调，可为NULL。进度阶段名为 "centrality"。
+ * @return CentralityResult* 结果，调用者需使用 free_centrality_result() 释放。内存不足或被取消时返回NULL。
+ */
+CentralityResult* compute_betweenness_centrality(const TrafficNetwork* network, const CentralityOptions* options,
+                                                 const SolveControl* control);
+
+/**
+ * @brief 把结果按介数从大到小写入CSV文件。
+ * @details 列为 `node_name,city_name,node_type,betweenness,share`，节点类型与 nodes.csv 中的写法相同。
+ *
+ * @param network 交通网络。
+ * @param result 计算结果。
+ * @param csv_path 输出文件路径，已存在时覆盖。
+ * @return bool 成功返回true。
+ */
+bool centrality_write_csv(const TrafficNetwork* network, const CentralityResult* result, const char* csv_path);
+
+/**
+ * @brief 释放介数中心性的结果。传入NULL时不做任何操作。
+ */
+void free_centrality_result(CentralityResult* result);
+
+#endif // CENTRALITY_H
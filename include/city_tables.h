@@ -0,0 +1,99 @@
+#ifndef CITY_TABLES_H
+#define CITY_TABLES_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "graph.h"
+#include "types.h"
+
+/**
+ * @file city_tables.h
+ * @brief 同城全源最短路径表：为每个城市、每组权重预先计算城内节点两两之间的最优路线，短途的市内路段直接查表。
+ * @details 绝大多数路段是地标与枢纽之间的市内接驳（驾车或公交）。每个城市只有几个节点，
+ *          对每组权重在城内节点上做全源最短路径，表的大小为 权重组数 × Σ(城市节点数²)，各城市在线程池上并行构建。
+ *          表中的路线只经过本城节点，为保证查表结果与全网搜索一致，构建时同时检查一个下界：
+ *          任何离开本城的路线至少要经过一个外城节点 X，其加权成本不低于 每公里成本下界 × (d(起点, X) + d(X, 终点))；
+ *          表中的成本不超过该下界的最小值时，表中路线就是全网最优，查表直接返回，否则由调用者回退到搜索。
+ *          表按固定速度模型、无交通事件的网络构建，网络出现交通事件或增加节点后不再使用。
+ *          寻路函数使用通过 traffic_network_set_city_tables() 交给网络的表，每个网络各自持有自己的表；
+ *          设置或替换表必须在该网络上没有进行中的查询时进行，建好的表本身只读，可以被多个线程同时查询。
+ *          可以与网络一起保存到二进制快照（见 snapshot.h）。
+ */
+
+/**
+ * @brief 一组时间/花费权重。查询的权重与某组权重成比例时（例如 0.3/0.3 与 0.5/0.5）使用同一张表。
+ */
+typedef struct {
+    double time_weight;         ///< 时间权重。
+    double cost_weight;         ///< 花费权重。
+} WeightProfile;
+
+/**
+ * @brief 同城全源最短路径表的句柄（不透明结构体）。
+ */
+typedef struct CityTables CityTables;
+
+/**
+ * @brief 为网络中的每个城市构建全源最短路径表。
+ *
+ * @param network 交通网络。构建时忽略交通事件。
+ * @param profiles 权重组，NULL表示使用默认的三组：只考虑时间、只考虑花费、两者各半。
+ * @param profile_count 权重组数。
+ * @return CityTables* 新建的表，调用者需使用 city_tables_destroy() 释放。参数无效或内存不足时返回NULL。
+ */
+CityTables* city_tables_build(const TrafficNetwork* network, const WeightProfile* profiles, int profile_count);
+
+/**
+ * @brief 查表得到同城两个节点之间的最优路线。
+ * @details 只做 O(路段数) 的查表，不做任何搜索。
+ *
+ * @param tables 同城表，可为NULL。
+ * @param network 交通网络，必须是构建或加载该表时使用的网络。
+ * @param from_node_id 起点。
+ * @param to_node_id 终点。
+ * @param time_weight 时间权重。
+ * @param cost_weight 花费权重。
+ * @return RoutePath* 全网最优路线，调用者需使用 free_route_path() 释放。
+ *                    起终点不同城、权重与所有权重组都不成比例、无法证明表中路线全网最优、
+ *                    网络有交通事件或已增加节点时返回NULL，调用者应回退到搜索。
+ */
+RoutePath* city_tables_find_route(const CityTables* tables, const TrafficNetwork* network, int from_node_id, int to_node_id,
+                                  double time_weight, double cost_weight);
+
+/**
+ * @brief 获取表中的城市总数和可直接查表的同城节点对数（用于显示统计信息）。
+ */
+void city_tables_get_stats(const CityTables* tables, int* city_count, int* exact_pair_count, int* pair_count);
+
+/**
+ * @brief 把表写入已打开的二进制文件的当前位置。
+ * @return bool 成功返回true。
+ */
+bool city_tables_write(const CityTables* tables, FILE* fp);
+
+/**
+ * @brief 从已打开的二进制文件的当前位置读取表，并与网络绑定。
+ * @details 文件中记录了构建时所有节点坐标的指纹，与传入的网络不一致时拒绝加载。
+ *
+ * @return CityTables* 读取的表，调用者需使用 city_tables_destroy() 释放。格式错误或与网络不一致时返回NULL。
+ */
+CityTables* city_tables_read(FILE* fp, const TrafficNetwork* network);
+
+/**
+ * @brief 直接引用内存中（例如映射的快照文件）由 city_tables_write() 写出的表，不复制数组。
+ * @details 内存必须8字节对齐，并且在表销毁之前保持有效、不被修改；映射为只读时多个进程共享同一份物理内存。
+ *
+ * @param data 表的起始地址。
+ * @param size 从起始地址开始可以访问的字节数。
+ * @param network 与表绑定的网络。
+ * @return CityTables* 引用该内存的表，调用者需使用 city_tables_destroy() 释放（不会释放引用的内存）。
+ *                     格式错误、数据不完整或与网络不一致时返回NULL。
+ */
+CityTables* city_tables_map(const void* data, size_t size, const TrafficNetwork* network);
+
+/**
+ * @brief 释放同城表。传入NULL时不做任何操作。
+ */
+void city_tables_destroy(CityTables* tables);
+
+#endif // CITY_TABLES_H
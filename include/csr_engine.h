@@ -0,0 +1,118 @@
+#ifndef CSR_ENGINE_H
+#define CSR_ENGINE_H
+
+#include "routing_engine.h"
+
+/**
+ * @file csr_engine.h
+ * @brief 基于压缩邻接表（CSR）的寻路引擎。
+ * @details 预处理时把隐式完全图中所有可用的路段（含交通事件的减速倍数）一次性展开为压缩邻接表，
+ *          每个起点的路段再按交通方式分段，查询时被排除的交通方式整段跳过，
+ *          松弛一条路段只需两次乘加，不再重复计算距离和交通规则。
+ *          两个引擎共享同一份邻接表，只是开放集的管理方式不同。
+ *          邻接表和开放集也单独提供给交通分配、可靠性分析、介数中心性等需要在全网反复搜索的模块。
+ */
+
+/**
+ * @brief 压缩邻接表：网络中所有可用的路段（交通规则允许且未被封闭，通行时间已乘交通事件的减速倍数）。
+ * @details 起点 u 使用交通方式 m 的路段位于 [row_start[u*M+m], row_start[u*M+m+1])，M 为 TRANSPORT_MODE_COUNT。
+ *          路段编号在 [0, link_count) 内连续，调用者可以用它索引自己的每路段数组。
+ */
+typedef struct {
+    int node_count;
+    int link_count;
+    int* row_start;             ///< 长度为 node_count * M + 1。
+    int* link_to;               ///< 路段终点。
+    double* link_hours;         ///< 通行时间（已乘交通事件的减速倍数）。
+    double* link_yuan;          ///< 花费。
+    double* link_km;            ///< 距离。
+} CsrLinkTable;
+
+/**
+ * @brief 在默认线程池上并行评估所有路段，构建压缩邻接表。
+ * @details 邻接表是网络当前状态的快照，之后的交通事件不会反映到其中。
+ *
+ * @param network 交通网络。
+ * @return CsrLinkTable* 邻接表，调用者需使用 csr_link_table_free() 释放。内存不足时返回NULL。
+ */
+CsrLinkTable* csr_link_table_build(const TrafficNetwork* network);
+
+/**
+ * @brief 释放邻接表。传入NULL时不做任何操作。
+ */
+void csr_link_table_free(CsrLinkTable* table);
+
+/**
+ * @brief 获取路段使用的交通方式（由它在起点所在行中的位置确定）。
+ *
+ * @param table 邻接表。
+ * @param from_node_id 路段起点。
+ * @param link 路段编号，必须属于 from_node_id 的行。
+ */
+TransportMode csr_link_table_get_mode(const CsrLinkTable* table, int from_node_id, int link);
+
+/**
+ * @brief 按与 routing_engine_select() 相同的规则判断开放集是否应使用二叉堆。
+ * @details 平均出度 d 满足 d × log2(节点数) < 节点数 时用二叉堆，否则线性扫描更快。
+ *          出度直接从邻接表统计，不需要抽样。
+ *
+ * @param table 邻接表。
+ * @param allowed_modes 搜索允许的交通方式，0表示全部。
+ */
+bool csr_link_table_prefers_heap(const CsrLinkTable* table, TransportModeMask allowed_modes);
+
+/**
+ * @brief Dijkstra / A* 的开放集：二叉堆或无序数组（线性扫描取最小值）。
+ * @details 排序键由调用者的数组提供（例如 g 或 g + h），键只能减小，修改后需再次调用 csr_open_set_push()。
+ *          一个开放集只能由一个线程使用，可以在多次搜索之间复用。
+ */
+typedef struct {
+    const double* key;          ///< 排序键，下标为节点ID。
+    int* items;                 ///< 二叉堆，或线性扫描时的无序数组。
+    int* position;              ///< 节点在 items 中的下标，-1表示不在开放集中。
+    int count;
+    bool use_heap;
+} CsrOpenSet;
+
+/**
+ * @brief 初始化空的开放集。
+ *
+ * @param set 要初始化的开放集。
+ * @param node_count 节点数。
+ * @param key 排序键数组（长度为 node_count），开放集只读取不修改。
+ * @param use_heap true 使用二叉堆，false 使用线性扫描（见 csr_link_table_prefers_heap()）。
+ * @return bool 内存不足时返回false。
+ */
+bool csr_open_set_init(CsrOpenSet* set, int node_count, const double* key, bool use_heap);
+
+/**
+ * @brief 释放开放集的内存。
+ */
+void csr_open_set_free(CsrOpenSet* set);
+
+/**
+ * @brief 清空开放集，用于开始新的一次搜索。
+ */
+void csr_open_set_clear(CsrOpenSet* set);
+
+/**
+ * @brief 加入节点，或在节点的键减小后调整它的位置。
+ */
+void csr_open_set_push(CsrOpenSet* set, int node);
+
+/**
+ * @brief 取出键最小的节点，开放集为空时返回-1。
+ */
+int csr_open_set_pop(CsrOpenSet* set);
+
+/**
+ * @brief 线性扫描开放集的压缩邻接表引擎（"csr_linear"），适合稠密网络。
+ */
+extern const RoutingEngineVTable csr_linear_engine;
+
+/**
+ * @brief 二叉堆管理开放集的压缩邻接表引擎（"csr_heap"），适合稀疏网络。
+ */
+extern const RoutingEngineVTable csr_heap_engine;
+
+#endif // CSR_ENGINE_H
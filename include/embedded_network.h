@@ -0,0 +1,33 @@
+#ifndef EMBEDDED_NETWORK_H
+#define EMBEDDED_NETWORK_H
+
+#include "types.h"
+
+/**
+ * @file embedded_network.h
+ * @brief 编译时内置的网络数据，用于数据固定的嵌入式设备。
+ * @details `make embedded` 先用 tools/embed_network 把 data/nodes.csv 转换为 `static const` 的节点、城市和名称索引表，
+ *          再以 TRAFFIC_EMBEDDED_NETWORK 编译进程序。traffic_network_create() 遇到同一路径时直接引用这些表，
+ *          不解析文件，也不复制数组；数据位于只读段，多个进程共享同一份物理内存。
+ *          普通构建中没有内置数据。
+ */
+
+/**
+ * @brief 内置的网络数据。
+ */
+typedef struct {
+    const char* source_path;    ///< 生成数据时使用的CSV路径，例如 "data/nodes.csv"。
+    const Node* nodes;          ///< 节点数组，id 等于下标。
+    int node_count;             ///< 节点数。
+    const CityMeta* cities;     ///< 城市数组。
+    int city_count;             ///< 城市数。
+    const int* name_index;      ///< 按名称（strcmp 顺序）排序的节点ID，名称相同时ID小的在前。
+} EmbeddedNetwork;
+
+/**
+ * @brief 获取内置的网络数据。
+ * @return const EmbeddedNetwork* 内置数据；普通构建中返回NULL。
+ */
+const EmbeddedNetwork* embedded_network_get(void);
+
+#endif // EMBEDDED_NETWORK_H
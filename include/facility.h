@@ -0,0 +1,85 @@
+#ifndef FACILITY_H
+#define FACILITY_H
+
+#include "graph.h"
+#include "solve_control.h"
+#include "types.h"
+
+/**
+ * @file facility.h
+ * @brief 枢纽选址：从候选站址中选出 k 个新建机场或高铁站，使需求加权的总出行成本最小。
+ * @details 使用带惰性评估的贪心算法（CELF）：
+ *          1. 先计算当前网络的全源最短路径矩阵 D；
+ *          2. 新建一个枢纽 h 只会增加与 h 相连的路段，经过 h 的最短路径只经过它一次，因此
+ *             D'(s, t) = min(D(s, t), min_u [D(s, u) + w(u, h)] + min_v [w(h, v) + D(v, t)])，
+ *             评估一个候选站址只需 O(节点数 × 起讫点数)，无需重新计算全源最短路径；
+ *          3. 候选站址的收益（总成本的减少量）随已选枢纽增多而不增，上一轮的收益就是本轮收益的上界：
+ *             每轮只重新评估上界最大的若干个候选站址（在线程池上并行），上界最大者的收益已是最新时即选中它；
+ *          4. 选中后把枢纽加入内部的覆盖网络，并按上式更新整个矩阵 D。
+ *          不修改传入的网络。
+ */
+
+/**
+ * @brief 一个候选站址。
+ */
+typedef struct {
+    char city_name[50];         ///< 所属城市。
+    NodeType type;              ///< 节点类型（机场或高铁站）。
+    char name[100];             ///< 站址名称，不能与已有节点重名。
+    double latitude;            ///< 纬度。
+    double longitude;           ///< 经度。
+} HubCandidate;
+
+/**
+ * @brief 枢纽选址的参数。
+ */
+typedef struct {
+    double time_weight;         ///< 时间权重。
+    double cost_weight;         ///< 花费权重。
+    int hub_count;              ///< 要选出的枢纽数 k。
+} FacilityOptions;
+
+/**
+ * @brief 枢纽选址的结果。
+ */
+typedef struct {
+    int* chosen;                ///< 选中的候选站址下标，按选中顺序排列。
+    double* gains;              ///< 每个枢纽带来的总成本减少量。
+    int chosen_count;           ///< 选中的枢纽数（没有正收益的候选站址时可能少于 k）。
+    double initial_objective;   ///< 新建枢纽前的需求加权总成本。
+    double final_objective;     ///< 新建全部选中枢纽后的需求加权总成本。
+    int evaluations;            ///< 评估候选站址的总次数（含第一轮全部评估），远小于 候选数 × k 说明惰性评估省去了大部分计算。
+} FacilityResult;
+
+/**
+ * @brief 从CSV文件加载候选站址。
+ * @details 文件格式与 nodes.csv 相同：`city_name,node_type,node_name,latitude,longitude`（带表头），
+ *          节点类型只能是 airport 或 hsr。
+ *
+ * @param csv_path 文件路径。
+ * @param out_count 输出候选站址数。
+ * @return HubCandidate* 候选站址数组，调用者需使用 free() 释放。失败时返回NULL。
+ */
+HubCandidate* facility_load_candidates_csv(const char* csv_path, int* out_count);
+
+/**
+ * @brief 选出使需求加权总成本最小的 k 个新建枢纽。
+ * @details 不可达的起讫点对按固定的高成本计入目标函数，新枢纽使其可达时同样计为收益。
+ *
+ * @param network 交通网络（不会被修改）。
+ * @param demand 节点数 × 节点数 的需求矩阵，例如 assignment_load_demand_csv() 的返回值。
+ * @param candidates 候选站址。
+ * @param candidate_count 候选站址数。
+ * @param options 参数。
+ * @param control 取消令牌与进度回调，可为NULL。进度阶段名为 "cost_matrix" 和 "facility"。
+ * @return FacilityResult* 结果，调用者需使用 free_facility_result() 释放。参数无效、内存不足或被取消时返回NULL。
+ */
+FacilityResult* optimize_hub_locations(const TrafficNetwork* network, const double* demand, const HubCandidate* candidates,
+                                       int candidate_count, const FacilityOptions* options, const SolveControl* control);
+
+/**
+ * @brief 释放枢纽选址的结果。传入NULL时不做任何操作。
+ */
+void free_facility_result(FacilityResult* result);
+
+#endif // FACILITY_H
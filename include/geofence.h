@@ -0,0 +1,72 @@
+#ifndef GEOFENCE_H
+#define GEOFENCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "graph.h"
+
+/**
+ * @file geofence.h
+ * @brief 规避区域：把多边形（例如封闭的省份、恶劣天气区域）预先转换为节点和路段的排除位图。
+ * @details 构建位图时对每个节点做一次点在多边形内测试，对每条路段（两节点之间的直线）做一次与多边形的相交测试，
+ *          先用多边形的外包矩形排除绝大多数路段；寻路时每条边只需一次位测试。
+ *          位图按 "多边形顶点 + 所有节点坐标" 缓存，相同的多边形在不同查询、同一网络的不同覆盖网络之间复用。
+ *          经纬度按平面坐标处理，适用于省、市范围的区域。
+ */
+
+/**
+ * @brief 多边形的一个顶点。
+ */
+typedef struct {
+    double latitude;            ///< 纬度。
+    double longitude;           ///< 经度。
+} GeoPoint;
+
+/**
+ * @brief 一个规避多边形（顶点按顺序排列，首尾自动闭合）。
+ */
+typedef struct {
+    const GeoPoint* points;     ///< 顶点数组，由调用者持有。
+    int point_count;            ///< 顶点数，至少为3。
+} GeoPolygon;
+
+/**
+ * @brief 规避区域的排除位图。
+ * @details 路段 (u, v) 被排除时，edge_bits 中第 u 行第 v 位为1；行宽为 row_bytes 字节。
+ *          位于区域内的节点，其所有出入路段也都被排除。请通过 geofence_acquire() 获取，不要直接修改。
+ */
+typedef struct GeofenceMask {
+    int node_count;             ///< 构建时的节点数。
+    int row_bytes;              ///< 每行的字节数。
+    uint8_t* node_bits;         ///< 节点位图：位于区域内的节点为1。
+    uint8_t* edge_bits;         ///< 路段位图：节点数 × 节点数 位。
+    int blocked_node_count;     ///< 位于区域内的节点数。
+} GeofenceMask;
+
+/**
+ * @brief 获取一组多边形在网络上的排除位图，命中缓存时直接返回已有的位图。
+ * @details 线程安全。返回的位图在 geofence_release() 之前不会被释放或修改。
+ *
+ * @param network 交通网络。
+ * @param polygons 多边形数组。
+ * @param polygon_count 多边形数。
+ * @return const GeofenceMask* 位图，用完后调用 geofence_release()。参数无效或内存不足时返回NULL。
+ */
+const GeofenceMask* geofence_acquire(const TrafficNetwork* network, const GeoPolygon* polygons, int polygon_count);
+
+/**
+ * @brief 释放对位图的引用。传入NULL时不做任何操作。
+ */
+void geofence_release(const GeofenceMask* mask);
+
+/**
+ * @brief 判断节点是否位于规避区域内。
+ */
+bool geofence_blocks_node(const GeofenceMask* mask, int node_id);
+
+/**
+ * @brief 清空缓存中没有被引用的位图，通常在程序退出前调用。
+ */
+void geofence_cache_clear(void);
+
+#endif // GEOFENCE_H
@@ -3,23 +3,41 @@
 
 #include "types.h"
 
+struct CityTables; // 同城全源最短路径表，见 city_tables.h
+
+/**
+ * @brief 变更日志中的一条记录。
+ * @details 物化的最短路径树等结果根据自身版本号之后的变更记录做增量修复。
+ */
+typedef struct {
+    unsigned long version;  ///< 该变更生效后的网络版本号。
+    int from_node_id;       ///< 路段起点；节点变更时为该节点。
+    int to_node_id;         ///< 路段终点；节点变更时为 -1。
+    int mode;               ///< 交通方式；节点变更时为 -1。
+} NetworkChange;
+
 /**
  * @brief 交通网络的核心数据结构。
  * @details 这是一个 "不透明" 结构体的句柄，封装了所有节点、城市和它们之间的关系。
  *          外部模块通过操作这个结构体的指针来与图数据交互，而无需关心其内部实现。
+ *          交通事件、变更日志和覆盖关系保存在内部状态中，只能通过本文件声明的函数读取和修改。
+ *          覆盖网络（见 traffic_network_create_overlay()）与基础网络共享各数组，第一次修改时才复制。
  */
-typedef struct {
+typedef struct TrafficNetwork {
     Node* nodes;            ///< 指向节点数组的指针，存储了所有的交通节点。
     int node_count;         ///< 节点数组中的元素总数。
     CityMeta* cities;       ///< 指向城市元数据数组的指针。
     int city_count;         ///< 城市数组中的元素总数。
     int node_capacity;
     int city_capacity;
+
+    struct NetworkState* state;     ///< 交通事件、变更日志、覆盖网络等内部状态，只在 graph.c 中定义。
 } TrafficNetwork;
 
 /**
  * @brief 从CSV文件加载数据，创建并初始化一个新的交通网络实例。
  * @details 这是程序的入口点之一，负责分配内存并解析数据文件来构建图。
+ *          程序内置了由同一路径生成的数据时（见 embedded_network.h），直接引用只读的内置数据表，不读取文件。
  *          调用者必须在程序结束时使用 traffic_network_destroy() 来释放返回的实例。
  * 
  * @param nodes_csv_path 指向包含节点数据的CSV文件的路径字符串。
@@ -28,6 +46,31 @@ typedef struct {
  */
 TrafficNetwork* traffic_network_create(const char* nodes_csv_path);
 
+/**
+ * @brief 从已有的节点和城市数组创建交通网络实例（例如从二进制快照加载时），数组内容会被复制。
+ * @details 节点的 id 必须等于其下标，city_id 必须是有效的城市下标。
+ *
+ * @param nodes 节点数组。
+ * @param node_count 节点数。
+ * @param cities 城市数组。
+ * @param city_count 城市数。
+ * @return TrafficNetwork* 新的网络，调用者需使用 traffic_network_destroy() 释放。数据不一致或内存不足时返回NULL。
+ */
+TrafficNetwork* traffic_network_create_from_arrays(const Node* nodes, int node_count, const CityMeta* cities, int city_count);
+
+/**
+ * @brief 创建直接引用外部只读数组的交通网络实例（例如映射的快照文件），不复制数组。
+ * @details 与覆盖网络一样，数组标记为共享，第一次修改节点或城市时才复制到网络自己的内存。
+ *          数组必须在网络销毁之前保持有效；映射为只读时多个进程共享同一份物理内存。
+ *
+ * @param nodes 节点数组，节点的 id 必须等于其下标。
+ * @param node_count 节点数。
+ * @param cities 城市数组。
+ * @param city_count 城市数。
+ * @return TrafficNetwork* 新的网络，调用者需使用 traffic_network_destroy() 释放（不会释放引用的数组）。数据不一致或内存不足时返回NULL。
+ */
+TrafficNetwork* traffic_network_wrap_arrays(const Node* nodes, int node_count, const CityMeta* cities, int city_count);
+
 /**
  * @brief 释放由 traffic_network_create() 创建的交通网络实例所占用的所有内存。
  * @details 这是一个关键的清理函数，用于防止内存泄漏。
@@ -65,4 +108,129 @@ int traffic_network_get_node_count(const TrafficNetwork* network);
  */
 int traffic_network_find_node_id_by_name(const TrafficNetwork* network, const char* name);
 
+/**
+ * @brief 封闭或重新开放一个节点（例如因天气关闭机场）。
+ * @details 封闭的节点不能作为路径的中转点或终点。网络的修改不是线程安全的，
+ *          必须在没有查询正在进行时调用。
+ *
+ * @param network 指向交通网络实例的指针。
+ * @param node_id 节点ID。
+ * @param enabled true 为开放，false 为封闭。
+ * @return bool 成功返回true；节点无效或内存不足时返回false。状态未变化时不记录变更。
+ */
+bool traffic_network_set_node_enabled(TrafficNetwork* network, int node_id, bool enabled);
+
+/**
+ * @brief 查询节点当前是否开放。
+ */
+bool traffic_network_is_node_enabled(const TrafficNetwork* network, int node_id);
+
+/**
+ * @brief 封闭或重新开放一条有向路段。
+ *
+ * @param network 指向交通网络实例的指针。
+ * @param from_node_id 路段起点。
+ * @param to_node_id 路段终点。
+ * @param mode 交通方式。
+ * @param enabled true 为开放，false 为封闭。
+ * @return bool 成功返回true；参数无效或内存不足时返回false。
+ */
+bool traffic_network_set_edge_enabled(TrafficNetwork* network, int from_node_id, int to_node_id, TransportMode mode, bool enabled);
+
+/**
+ * @brief 设置一条有向路段的通行时间倍数（例如道路拥堵或恶劣天气导致减速）。
+ *
+ * @param time_factor 通行时间倍数，必须不小于1（只能减速，不能快于固定速度模型，
+ *                    否则寻路的直线距离下界不再成立）；1.0 恢复正常速度。
+ * @return bool 成功返回true；参数无效或内存不足时返回false。
+ */
+bool traffic_network_set_edge_time_factor(TrafficNetwork* network, int from_node_id, int to_node_id, TransportMode mode, double time_factor);
+
+/**
+ * @brief 查询一条有向路段的实时状态，供寻路算法在计算边权时调用。
+ * @details 没有任何交通事件时直接返回，不查哈希表。
+ *
+ * @param time_factor 输出通行时间倍数。
+ * @return bool 路段及其两端节点均开放时返回true。
+ */
+bool traffic_network_get_edge_state(const TrafficNetwork* network, int from_node_id, int to_node_id, TransportMode mode, double* time_factor);
+
+/**
+ * @brief 撤销所有交通事件，恢复全部节点和路段的默认状态。每个被恢复的节点和路段都会记录一条变更。
+ */
+void traffic_network_clear_incidents(TrafficNetwork* network);
+
+/**
+ * @brief 判断网络当前是否有交通事件（被封闭的节点，或被封闭、减速的路段）。
+ */
+bool traffic_network_has_incidents(const TrafficNetwork* network);
+
+/**
+ * @brief 获取网络当前的版本号。网络每发生一次变更，版本号加一。
+ */
+unsigned long traffic_network_get_version(const TrafficNetwork* network);
+
+/**
+ * @brief 获取某个版本之后的所有变更记录。
+ *
+ * @param network 指向交通网络实例的指针。
+ * @param since_version 调用者结果对应的版本号。
+ * @param out_changes 输出指向日志内部数组的只读指针，下一次修改网络前有效。
+ * @param out_count 输出变更记录数。
+ * @return bool 成功返回true；如果所需的早期记录已从日志中丢弃，返回false，调用者应完整重新计算。
+ */
+bool traffic_network_get_changes_since(const TrafficNetwork* network, unsigned long since_version, const NetworkChange** out_changes,
+                                       int* out_count);
+
+/**
+ * @brief 基于一个基础网络创建轻量级的情景覆盖网络，用于"如果……会怎样"的分析。
+ * @details 覆盖网络创建时不复制任何数据，与基础网络共享节点、城市和交通事件状态；
+ *          在覆盖网络上封闭节点、修改路段或增加节点时，只有被修改的数组会复制一份私有副本（写时复制），
+ *          因此寻路算法读取覆盖网络与读取普通网络的开销相同。
+ *          同一个基础网络上的多个覆盖网络互不影响，可以在不同线程中并行使用。
+ *          覆盖网络存续期间，基础网络不能被修改或销毁。覆盖网络本身也可以作为基础网络。
+ *
+ * @param base 基础网络。
+ * @return TrafficNetwork* 新的覆盖网络，使用 traffic_network_destroy() 释放（不会释放基础网络）。内存不足时返回NULL。
+ */
+TrafficNetwork* traffic_network_create_overlay(const TrafficNetwork* base);
+
+/**
+ * @brief 获取覆盖网络的基础网络。普通网络返回NULL。
+ */
+const TrafficNetwork* traffic_network_get_base(const TrafficNetwork* network);
+
+/**
+ * @brief 获取创建覆盖网络时基础网络的版本号。普通网络返回0。
+ * @details 基于基础网络计算的结果，如果版本号与此相同，可以按覆盖网络自己的变更日志增量修复。
+ */
+unsigned long traffic_network_get_base_version(const TrafficNetwork* network);
+
+/**
+ * @brief 设置本网络寻路时查表使用的同城表（见 city_tables.h），NULL表示不查表。
+ * @details 表由调用者持有，必须是为本网络构建或加载的表，在被替换或网络销毁之前不能释放。
+ *          不能与本网络上的查询并发调用。每个网络只使用自己的表，不同网络上的查询互不影响；覆盖网络不继承基础网络的表。
+ */
+void traffic_network_set_city_tables(TrafficNetwork* network, const struct CityTables* tables);
+
+/**
+ * @brief 获取通过 traffic_network_set_city_tables() 设置的同城表，没有时返回NULL。
+ */
+const struct CityTables* traffic_network_get_city_tables(const TrafficNetwork* network);
+
+/**
+ * @brief 向网络中增加一个节点（例如假设在某城市新建高铁站），城市不存在时一并创建。
+ * @details 新节点的ID为当前节点数，并记录一条节点变更，已有的最短路径树可以增量扩展到新节点。
+ *
+ * @param network 交通网络（通常是覆盖网络）。
+ * @param city_name 所属城市名称。
+ * @param type 节点类型。
+ * @param node_name 节点名称，不能与已有节点重名。
+ * @param latitude 纬度。
+ * @param longitude 经度。
+ * @return int 新节点的ID；参数无效、重名或内存不足时返回-1。
+ */
+int traffic_network_add_node(TrafficNetwork* network, const char* city_name, NodeType type, const char* node_name, double latitude,
+                             double longitude);
+
 #endif // GRAPH_H 
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef HIERARCHICAL_TSP_H
+#define HIERARCHICAL_TSP_H
+
+#include "graph.h"
+#include "solve_control.h"
+#include "types.h"
+
+/**
+ * @brief 途经点的分簇方式。
+ */
+typedef enum {
+    CLUSTER_BY_KMEANS,      ///< 按经纬度做 k-means 聚类。
+    CLUSTER_BY_CITY,        ///< 按所属城市分组（过大的城市再用 k-means 细分）。
+} ClusterMethod;
+
+/**
+ * @brief 分层TSP求解的参数。
+ */
+typedef struct {
+    ClusterMethod method;   ///< 分簇方式。
+    int max_cluster_size;   ///< 每个簇的最大途经点数，决定了每个子问题的内存和时间上限。
+    int boundary_window;    ///< 拼接处抛光时，边界两侧各取的途经点数。0表示不抛光。
+    unsigned int seed;      ///< k-means 初始化使用的随机种子，相同输入和种子得到相同结果。
+    const struct RoutingEngine* engine; ///< 计算最终各路段使用的寻路引擎，NULL表示临时创建一个。
+} HierarchicalTspOptions;
+
+/**
+ * @brief 用默认值填充分层TSP参数（k-means，每簇最多10个点，边界窗口4，不指定寻路引擎）。
+ * @param options 要填充的参数结构体。
+ */
+void hierarchical_tsp_default_options(HierarchicalTspOptions* options);
+
+/**
+ * @brief 使用分层分解求解大规模TSP（数百到数千个途经点）。
+ * @details 求解分为四步：
+ *          1. 按经纬度或城市把途经点分成不超过 max_cluster_size 的簇；
+ *          2. 在线程池上并行求解每个簇内的环路（簇足够小时精确求解），每个簇只需要 簇大小² 的成本矩阵；
+ *          3. 以每个簇的代表点求解簇之间的访问顺序，再依次选择每个簇的进入点，把簇内环路拼接成整条路线；
+ *          4. 对每个拼接处两侧的窗口做端点固定的局部搜索抛光。
+ *          结果不保证最优，但内存占用与簇大小相关而不是与途经点总数的平方相关。
+ *
+ * @param network 指向交通网络实例的只读指针。
+ * @param node_ids_to_visit 待访问节点ID数组，第一个元素是起点和终点。
+ * @param num_nodes 待访问节点的数量。
+ * @param time_weight 时间权重。
+ * @param cost_weight 花费权重。
+ * @param options 求解参数，传入NULL时使用默认值。
+ * @param control 取消令牌与进度回调，可为NULL。进度阶段依次为 "clusters"、"cluster_order"、"boundaries"、"legs"。
+ * @return RoutePath* 成功时返回完整的环游路径，调用者需负责释放。无解、被取消或内存不足时返回NULL。
+ */
+RoutePath* solve_tsp_hierarchical(const TrafficNetwork* network, const int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight,
+                                  const HierarchicalTspOptions* options, const SolveControl* control);
+
+#endif // HIERARCHICAL_TSP_H
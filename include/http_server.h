@@ -0,0 +1,54 @@
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <stdbool.h>
+#include "graph.h"
+
+/**
+ * @file http_server.h
+ * @brief 服务模式：网络只加载一次，通过 HTTP/1.1（支持 keep-alive 和流水线请求）以JSON回答查询。
+ * @details 一个线程运行非阻塞的 epoll 事件循环，负责接受连接、读取和解析请求、写回响应；
+ *          解析出的请求放入有界队列，由固定数量的计算线程调用查询层（见 query_service.h）求解，
+ *          结果通过 eventfd 通知事件循环发送。同一连接上的请求按顺序处理，一个请求计算期间不读取下一个请求。
+ *          队列已满时立即返回503，而不是让请求无限排队。
+ *          多进程模式（process_count > 0）下，父进程加载数据、准备寻路引擎并打开监听套接字后 fork 出工作进程，
+ *          每个工作进程运行自己的事件循环和计算线程；只读数据（尤其是 snapshot_map() 映射的快照）由所有进程共享，
+ *          一个进程崩溃不影响其他进程，父进程立即重新 fork 一个，不重新加载数据。
+ */
+
+/**
+ * @brief 服务的配置。
+ */
+typedef struct {
+    const char* bind_address;   ///< 监听地址，默认 "127.0.0.1"。
+    int port;                   ///< 监听端口，默认8080。
+    int worker_count;           ///< 每个进程的计算线程数，小于等于0时使用CPU核心数（多进程模式下为1）。
+    int max_connections;        ///< 同时打开的连接数上限，默认1024；超出时新连接被立即关闭。
+    int queue_capacity;         ///< 等待计算的请求数上限，默认256；超出时返回503。
+    double request_timeout_ms;  ///< 单个请求的最长计算时间，小于等于0时使用查询层的默认值。
+    double idle_timeout_ms;     ///< 空闲连接在多久之后被关闭，默认60秒。
+    int process_count;          ///< 工作进程数，默认0表示在当前进程中直接服务。
+} HttpServerOptions;
+
+/**
+ * @brief 用默认值初始化服务配置。
+ */
+void http_server_options_init(HttpServerOptions* options);
+
+/**
+ * @brief 运行服务，直到 http_server_request_stop() 被调用。
+ * @details 停止时不再接受新请求，丢弃尚未开始计算的请求，等待正在计算的请求结束后返回；
+ *          多进程模式下向所有工作进程发送 SIGTERM 并等待它们退出，工作进程应把 SIGTERM 转为 http_server_request_stop()。
+ *
+ * @param network 交通网络，服务期间只读。
+ * @param options 服务配置，NULL表示全部使用默认值。
+ * @return int 正常停止返回0；监听失败等启动错误返回-1。
+ */
+int http_server_run(const TrafficNetwork* network, const HttpServerOptions* options);
+
+/**
+ * @brief 请求停止正在运行的服务。可以在任意线程或信号处理函数中调用。
+ */
+void http_server_request_stop(void);
+
+#endif // HTTP_SERVER_H
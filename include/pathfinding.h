@@ -1,9 +1,14 @@
 #ifndef PATHFINDING_H
 #define PATHFINDING_H
 
+#include "geofence.h"
 #include "graph.h"
+#include "solve_control.h"
+#include "speed_profile.h"
 #include "types.h"
 
+struct RoutingEngine; // 见 routing_engine.h
+
 /**
  * @brief 使用Dijkstra算法查找两个节点之间的最短加权路径。
  * @details "最短"是根据时间和花费的加权组合来定义的，并非单纯的地理距离最短。
@@ -19,8 +24,241 @@
 RoutePath* find_shortest_path(const TrafficNetwork* network, int start_node_id, int end_node_id, double time_weight, double cost_weight);
 
 /**
- * @brief 使用动态规划（Held-Karp算法）解决旅行商问题(TSP)。
+ * @brief find_shortest_path() 的可中断版本。
+ * @details 搜索循环每隔 SOLVE_CONTROL_CHECK_INTERVAL 次迭代检查一次取消令牌。
+ *
+ * @param control 取消令牌与进度回调，可为NULL（等价于 find_shortest_path()）。
+ * @return RoutePath* 同 find_shortest_path()。被取消时返回NULL，调用者可以通过令牌区分取消与无解。
+ */
+RoutePath* find_shortest_path_ex(const TrafficNetwork* network, int start_node_id, int end_node_id, double time_weight, double cost_weight,
+                                 const SolveControl* control);
+
+/**
+ * @brief 使用加权A*查找两个节点之间的近似最短路径，并在剩余时间内逐步改进（随时可中断）。
+ * @details 第一轮以启发式权重 (1+ε) 运行加权A*，得到的路径成本保证不超过最优值的 (1+ε) 倍；
+ *          之后每轮将 ε 减半并重新搜索，直到得到最优解（ε=0）或时间预算耗尽。
+ *          时间预算耗尽时返回目前为止找到的最好路线。
+ *
+ * @param network 指向交通网络实例的只读指针。
+ * @param start_node_id 起始节点的ID。
+ * @param end_node_id 目标节点的ID。
+ * @param time_weight 时间在总成本计算中的权重 (0.0 to 1.0)。
+ * @param cost_weight 花费在总成本计算中的权重 (0.0 to 1.0)。
+ * @param epsilon 初始的次优界 ε (≥ 0)。
+ * @param time_budget_ms 时间预算（毫秒）。小于等于0表示不限时，此时一定会得到最优解。
+ * @param achieved_epsilon 可选的输出参数，返回结果实际满足的次优界 ε；未找到路径时为 -1。可以传入NULL。
+ * @return RoutePath* 成功时返回路径，调用者有责任使用 free_route_path() 释放。
+ *                    如果不可达，或在第一轮搜索完成前时间就已耗尽，则返回NULL。
+ */
+RoutePath* find_shortest_path_anytime(const TrafficNetwork* network, int start_node_id, int end_node_id, double time_weight, double cost_weight,
+                                      double epsilon, double time_budget_ms, double* achieved_epsilon);
+
+/**
+ * @brief 按出发时刻查找两个节点之间的最短加权路径（时间依赖A*）。
+ * @details 每条路段的通行时间由其速度曲线在 "到达该路段起点的时刻" 积分得到，
+ *          因此同一对节点在早晚高峰和深夜出发可能得到不同的路线。速度曲线满足先进先出性质，
+ *          只考虑时间（cost_weight 为0）时结果是最早到达的路线；启发式按最大速度系数缩放，保持可采纳。
+ *
+ * @param network 指向交通网络实例的只读指针。
+ * @param profiles 速度曲线集合，NULL时等价于 find_shortest_path_ex()。
+ * @param start_node_id 起始节点的ID。
+ * @param end_node_id 目标节点的ID。
+ * @param time_weight 时间权重。
+ * @param cost_weight 花费权重。
+ * @param depart_hour 出发时刻（小时，例如 8.5 表示 8:30）。
+ * @param control 取消令牌与进度回调，可为NULL。
+ * @return RoutePath* 成功时返回路径，各路段的时间为按出发时刻计算的实际通行时间。不可达或被取消时返回NULL。
+ */
+RoutePath* find_shortest_path_td(const TrafficNetwork* network, const SpeedProfileSet* profiles, int start_node_id, int end_node_id,
+                                 double time_weight, double cost_weight, double depart_hour, const SolveControl* control);
+
+/**
+ * @brief 单次路径查询的可选条件。
+ */
+typedef struct {
+    double time_weight;         ///< 时间权重。
+    double cost_weight;         ///< 花费权重。
+    const GeofenceMask* avoid;  ///< 规避区域的排除位图（见 geofence_acquire()），NULL表示不规避。
+    TransportModeMask allowed_modes; ///< 允许使用的交通方式，例如 "不坐飞机" 为 TRANSPORT_MODE_ALL & ~TRANSPORT_MODE_BIT(FLIGHT)；0表示不限制。
+} RouteQueryOptions;
+
+/**
+ * @brief 按查询条件查找两个节点之间的最短加权路径（A*）。
+ * @details 规避区域在搜索中只是每条边的一次位测试，不做任何几何计算；
+ *          被排除的交通方式在松弛时整体跳过，并且启发式只按允许的交通方式计算，排除越多搜索越快。
+ *
+ * @param network 指向交通网络实例的只读指针。
+ * @param start_node_id 起始节点的ID。
+ * @param end_node_id 目标节点的ID。
+ * @param options 查询条件。
+ * @param control 取消令牌与进度回调，可为NULL。
+ * @return RoutePath* 成功时返回路径，调用者有责任使用 free_route_path() 释放。
+ *                    不可达、起终点位于规避区域内、位图与网络不匹配或被取消时返回NULL。
+ */
+RoutePath* find_shortest_path_query(const TrafficNetwork* network, int start_node_id, int end_node_id, const RouteQueryOptions* options,
+                                    const SolveControl* control);
+
+/**
+ * @brief 按查询条件计算从一个起点到多个终点的最短加权成本（一次单源搜索）。
+ * @details 所有终点都确定后立即停止，不必计算完整的最短路径树。
+ *
+ * @param network 指向交通网络实例的只读指针。
+ * @param source_node_id 起点节点ID。
+ * @param target_node_ids 终点节点ID数组，可以包含起点本身（成本为0）。
+ * @param target_count 终点数。
+ * @param options 查询条件。
+ * @param control 取消令牌与进度回调，可为NULL。
+ * @param out_costs 输出每个终点的成本（长度为 target_count），不可达时为 DBL_MAX。
+ * @return bool 成功返回true；参数无效、起点位于规避区域内、位图与网络不匹配或被取消时返回false。
+ */
+bool find_shortest_path_costs(const TrafficNetwork* network, int source_node_id, const int* target_node_ids, int target_count,
+                              const RouteQueryOptions* options, const SolveControl* control, double* out_costs);
+
+/**
+ * @brief 按固定速度模型评估两个节点之间以某种交通方式直达的时间和花费。
+ * @details 与寻路算法使用相同的交通规则（例如飞机只能往返于不同城市的机场之间），
+ *          供时刻表等其它模块复用现有的驾车/公交模型。
+ *
+ * @param network 指向交通网络实例的只读指针。
+ * @param from_node_id 起点节点ID。
+ * @param to_node_id 终点节点ID。
+ * @param mode 交通方式。
+ * @return TravelInfo 时间、花费和可达性。节点无效或距离过近时 is_reachable 为false。
+ */
+TravelInfo evaluate_direct_leg(const TrafficNetwork* network, int from_node_id, int to_node_id, TransportMode mode);
+
+/**
+ * @brief 一次评估两个节点之间所有交通方式的直达路段，距离只计算一次。
+ * @details 结果与对每种交通方式分别调用 evaluate_direct_leg() 相同，供需要展开整张图的预处理使用。
+ *
+ * @param network 指向交通网络实例的只读指针。
+ * @param from_node_id 起点节点ID。
+ * @param to_node_id 终点节点ID。
+ * @param legs 输出每种交通方式的评估结果（长度为 TRANSPORT_MODE_COUNT）。
+ * @return double 两节点之间的距离（公里）；节点无效时返回-1。
+ */
+double evaluate_direct_legs(const TrafficNetwork* network, int from_node_id, int to_node_id, TravelInfo* legs);
+
+/**
+ * @brief 计算一个路段的加权成本，与寻路算法使用完全相同的归一化方式。
+ *
+ * @param time_hours 通行时间（小时）。
+ * @param cost_yuan 花费（元）。
+ * @param time_weight 时间权重。
+ * @param cost_weight 花费权重。
+ * @return double 加权成本。
+ */
+double calculate_weighted_leg_cost(double time_hours, double cost_yuan, double time_weight, double cost_weight);
+
+/**
+ * @brief 每公里加权成本的下界：按固定速度模型，允许的交通方式的任意路段，加权成本都不低于 两端点的直线距离 × 该值。
+ * @details 与A*启发式使用的下界相同。权重为负时返回0。
+ *
+ * @param time_weight 时间权重。
+ * @param cost_weight 花费权重。
+ * @param allowed_modes 允许使用的交通方式，0表示不限制。排除的交通方式越多，下界越紧。
+ * @return double 每公里加权成本的下界。
+ */
+double weighted_cost_lower_bound_per_km(double time_weight, double cost_weight, TransportModeMask allowed_modes);
+
+/**
+ * @brief 单源最短路径树的句柄（不透明结构体）。
+ * @details 一次Dijkstra搜索即可得到从起点到所有节点的最短加权成本，适合构建成本矩阵等一对多场景。
+ */
+typedef struct ShortestPathTree ShortestPathTree;
+
+/**
+ * @brief 使用Dijkstra算法计算从起点到网络中所有节点的最短路径树。
+ *
+ * @param network 指向交通网络实例的只读指针。
+ * @param source_node_id 起点节点的ID。
+ * @param time_weight 时间权重。
+ * @param cost_weight 花费权重。
+ * @param control 取消令牌与进度回调，可为NULL。
+ * @return ShortestPathTree* 成功时返回新建的最短路径树，调用者需使用 free_shortest_path_tree() 释放。
+ *                           起点无效、内存不足或被取消时返回NULL。
+ */
+ShortestPathTree* compute_shortest_path_tree(const TrafficNetwork* network, int source_node_id, double time_weight, double cost_weight,
+                                             const SolveControl* control);
+
+/**
+ * @brief 查询最短路径树中从起点到某个节点的最短加权成本。
+ *
+ * @param tree 最短路径树。
+ * @param node_id 目标节点的ID。
+ * @return double 最短加权成本。不可达或参数无效时返回 DBL_MAX。
+ */
+double shortest_path_tree_get_cost(const ShortestPathTree* tree, int node_id);
+
+/**
+ * @brief 从最短路径树中提取从起点到某个节点的完整路径，无需重新搜索。
+ *
+ * @param network 计算该树时使用的交通网络。
+ * @param tree 最短路径树。
+ * @param target_node_id 目标节点的ID。
+ * @return RoutePath* 新建的路径，调用者需使用 free_route_path() 释放。不可达时返回NULL。
+ */
+RoutePath* shortest_path_tree_get_route(const TrafficNetwork* network, const ShortestPathTree* tree, int target_node_id);
+
+/**
+ * @brief 按网络的变更日志增量修复最短路径树，使其与网络的当前状态一致。
+ * @details 只重新计算受影响的部分，而不是重新做一次完整的Dijkstra：
+ *          - 树边被封闭或减速、节点被封闭或重新开放时，只有以该边终点（或该节点）为根的子树失效，
+ *            这些节点先从未受影响的节点取最优入边，再在子树内部传播；
+ *          - 路段恢复或提速时，只从成本下降的节点出发向外传播。
+ *          所需的变更记录已从日志中丢弃，或上一次修复被取消时，退化为完整重新计算。
+ *          在基础网络上计算的树（版本与创建覆盖网络时一致）也可以直接修复到覆盖网络上，修复后树属于覆盖网络。
+ *
+ * @param network 计算该树时使用的交通网络（可能已被修改），或以它为基础的覆盖网络。
+ * @param tree 要修复的最短路径树。
+ * @param control 取消令牌，可为NULL。被取消时树在下一次修复时完整重新计算。
+ * @return int 最短成本发生变化的节点数；被取消或内存不足时返回-1。
+ */
+int shortest_path_tree_repair(const TrafficNetwork* network, ShortestPathTree* tree, const SolveControl* control);
+
+/**
+ * @brief 释放最短路径树。
+ * @param tree 要释放的树。传入NULL时不做任何操作。
+ */
+void free_shortest_path_tree(ShortestPathTree* tree);
+
+/**
+ * @brief 复制一棵最短路径树。
+ * @details 情景分析时先在基础网络上计算一次树，每个覆盖网络复制一份后用 shortest_path_tree_repair() 增量修复，
+ *          只重新计算受情景影响的部分。
+ * @return ShortestPathTree* 新树，调用者需使用 free_shortest_path_tree() 释放。内存不足时返回NULL。
+ */
+ShortestPathTree* shortest_path_tree_clone(const ShortestPathTree* tree);
+
+/**
+ * @brief 在已有的树上（复用其内存和工作区）从新的起点重新计算最短路径树。
+ * @details 适合需要连续计算大量最短路径树的场景（如设施选址的候选评估），避免反复分配内存。
+ *          时间、花费权重沿用创建该树时的值。
+ *
+ * @param network 交通网络。
+ * @param tree 要重新计算的树。
+ * @param source_node_id 新的起点。
+ * @param control 取消令牌，可为NULL。
+ * @return bool 成功返回true；起点无效、内存不足或被取消时返回false。
+ */
+bool shortest_path_tree_recompute(const TrafficNetwork* network, ShortestPathTree* tree, int source_node_id, const SolveControl* control);
+
+/**
+ * @brief 查询最短路径树上某个节点的前驱。
+ *
+ * @param tree 最短路径树。
+ * @param node_id 节点ID。
+ * @param mode 可选的输出参数，返回从前驱到该节点使用的交通方式。可以传入NULL。
+ * @return int 前驱节点ID；起点、不可达节点或参数无效时返回-1。
+ */
+int shortest_path_tree_get_predecessor(const ShortestPathTree* tree, int node_id, TransportMode* mode);
+
+/**
+ * @brief 解决旅行商问题(TSP)。
  * @details 找到一条访问所有给定节点并返回起点的、总加权成本最低的路线。
+ *          不超过 HELD_KARP_MAX_NODES 个节点时使用动态规划（Held-Karp算法）；
+ *          不超过 TSP_BNB_MAX_NODES 个节点时使用分支定界，时间限制为 TSP_BNB_DEFAULT_TIME_LIMIT_MS，
+ *          超时后返回已找到的最优可行解；更多节点时使用分层分解（见 solve_tsp_hierarchical()），结果不保证最优。
  * 
  * @param network 指向交通网络实例的只读指针。
  * @param node_ids_to_visit 指向一个包含待访问节点ID数组的指针。数组的第一个元素被视作起点和终点。
@@ -31,9 +269,35 @@ RoutePath* find_shortest_path(const TrafficNetwork* network, int start_node_id,
  */
 RoutePath* solve_tsp(const TrafficNetwork* network, int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight);
 
+/**
+ * @brief solve_tsp() 的可中断版本，并报告进度。
+ * @details 进度分为 "cost_matrix"（构建成本矩阵）和 "dp"（动态规划）或 "branch_and_bound"（分支定界）两个阶段；
+ *          分层分解的进度阶段见 solve_tsp_hierarchical()。
+ *          成本矩阵中的每次寻路以及动态规划、分支定界的搜索都会定期检查取消令牌。
+ *
+ * @param control 取消令牌与进度回调，可为NULL（等价于 solve_tsp()）。
+ * @return RoutePath* 同 solve_tsp()。被取消时返回NULL。
+ */
+RoutePath* solve_tsp_ex(const TrafficNetwork* network, int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight,
+                        const SolveControl* control);
+
+/**
+ * @brief 带时间限制的TSP精确求解，并报告结果是否被证明最优。
+ * @details 与 solve_tsp_ex() 相同，但可以指定分支定界的时间限制。分支定界的进度阶段为 "branch_and_bound"。
+ *
+ * @param time_limit_ms 分支定界的时间限制（毫秒），小于等于0表示不限时。动态规划不受该限制。
+ * @param is_optimal 可选的输出参数，结果被证明最优时置为true（分层分解的结果总是false）。可以传入NULL。
+ * @param engine 构建成本矩阵和拼接路段使用的寻路引擎（例如查询服务常驻的引擎），NULL表示按本次查询量临时创建一个。
+ * @param control 取消令牌与进度回调，可为NULL。
+ * @return RoutePath* 同 solve_tsp()。超时返回当前最优可行解；被取消时返回NULL。
+ */
+RoutePath* solve_tsp_exact(const TrafficNetwork* network, int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight,
+                           double time_limit_ms, bool* is_optimal, const struct RoutingEngine* engine, const SolveControl* control);
+
 /**
  * @brief 按照给定的节点顺序，规划一条依次访问的路径。
  * @details 这不是TSP，它不会重新排序节点，而是严格按照用户指定的顺序连接各个点。
+ *          各路段相互独立，会在默认线程池上并行计算；重复出现的路段只计算一次。
  * 
  * @param network 指向交通网络实例的只读指针。
  * @param node_ids_to_visit 指向一个包含待访问节点ID数组的指针，路径将严格遵循此顺序。
@@ -44,6 +308,16 @@ RoutePath* solve_tsp(const TrafficNetwork* network, int* node_ids_to_visit, int
  */
 RoutePath* find_sequential_path(const TrafficNetwork* network, int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight);
 
+/**
+ * @brief find_sequential_path() 的可中断版本，并以 "legs" 阶段报告已完成路段的比例。
+ *
+ * @param engine 计算各路段使用的寻路引擎，NULL表示按路段数临时创建一个。
+ * @param control 取消令牌与进度回调，可为NULL（等价于 find_sequential_path()）。
+ * @return RoutePath* 同 find_sequential_path()。被取消时返回NULL。
+ */
+RoutePath* find_sequential_path_ex(const TrafficNetwork* network, int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight,
+                                   const struct RoutingEngine* engine, const SolveControl* control);
+
 /**
  * @brief 释放由寻路函数创建的RoutePath对象及其内部所有路径段所占用的内存。
  * 
@@ -0,0 +1,64 @@
+#ifndef QUERY_SERVICE_H
+#define QUERY_SERVICE_H
+
+#include <stddef.h>
+#include "graph.h"
+#include "routing_engine.h"
+
+/**
+ * @file query_service.h
+ * @brief 与传输方式无关的查询层：把 "路径 + URL参数" 形式的请求转换为寻路调用，并把结果序列化为JSON。
+ * @details 支持的请求（参数使用URL编码，节点可以用名称或ID表示，多个节点以逗号分隔）：
+ *          - /route?from=故宫&to=外滩[&time_weight=0.5&cost_weight=0.5&modes=driving,bus]
+ *          - /tsp?nodes=A,B,C[&time_weight=..&cost_weight=..&time_limit_ms=..]（超过40个节点时分层求解，optimal 为 false）
+ *          - /sequential?nodes=A,B,C[&time_weight=..&cost_weight=..]
+ *          - /matrix?nodes=A,B,C[&time_weight=..&cost_weight=..&modes=..]
+ *          - /health（节点数、引擎名称、合并的请求数）
+ *          服务在创建时为网络准备一个长期使用的寻路引擎，网络在服务销毁之前必须保持不变。
+ *          所有函数都可以在多个线程中同时调用。同时到达的相同 /route 请求（起终点、权重、交通方式和网络版本都相同）
+ *          只计算一次，其余请求等待并共享同一份结果；
+ *          计算超时的时候，自己的时限还没到的等待者重新计算，不共享超时结果。
+ */
+
+/**
+ * @brief 查询服务（不透明结构体）。
+ */
+typedef struct QueryService QueryService;
+
+/**
+ * @brief 单个请求的最长计算时间（毫秒），超时的请求返回504。
+ */
+#define QUERY_SERVICE_DEFAULT_TIMEOUT_MS 10000.0
+
+/**
+ * @brief 创建查询服务。
+ * @param network 交通网络，服务期间只读。
+ * @param timeout_ms 单个请求的最长计算时间（毫秒），小于等于0时使用 QUERY_SERVICE_DEFAULT_TIMEOUT_MS。
+ * @return QueryService* 服务实例，调用者需使用 query_service_destroy() 释放。失败时返回NULL。
+ */
+QueryService* query_service_create(const TrafficNetwork* network, double timeout_ms);
+
+/**
+ * @brief 处理一个请求。
+ *
+ * @param service 查询服务。
+ * @param path 请求路径，例如 "/route"。
+ * @param params URL编码的参数串（不含 '?'），可为NULL。
+ * @param out_json 输出JSON响应体（以 '\0' 结尾），调用者需使用 free() 释放。内存不足时为NULL。
+ * @param out_length 输出响应体的长度（不含 '\0'）。
+ * @return int HTTP状态码：200成功，400参数错误，404未知路径或无路可达，504超时，500内部错误。
+ */
+int query_service_handle(QueryService* service, const char* path, const char* params, char** out_json, size_t* out_length);
+
+/**
+ * @brief 返回服务创建时准备好的寻路引擎，供同一进程内不经过JSON的调用共用（见 traffic_planner.h）。
+ * @details 引擎归服务所有，在服务销毁之前有效，可以在多个线程中同时查询。
+ */
+const RoutingEngine* query_service_get_engine(const QueryService* service);
+
+/**
+ * @brief 销毁查询服务。传入NULL时不做任何操作。
+ */
+void query_service_destroy(QueryService* service);
+
+#endif // QUERY_SERVICE_H
@@ -0,0 +1,106 @@
+#ifndef RELIABILITY_H
+#define RELIABILITY_H
+
+#include <stdint.h>
+#include "graph.h"
+#include "solve_control.h"
+#include "types.h"
+
+/**
+ * @file reliability.h
+ * @brief 出行时间可靠性分析：对车速、票价和延误做蒙特卡洛抽样，统计到达时间分布和各条路线成为最优的频率。
+ * @details 每个样本独立抽取一组扰动并重新求解最短路径：
+ *          - 每种交通方式一个整体时间倍数和花费倍数（对数正态，均值为1），模拟天气、票价浮动等共同因素；
+ *          - 每条路段一个独立的时间倍数（对数正态，均值为1），模拟局部拥堵；
+ *          - 每条路段以一定概率附加一次延误（指数分布），模拟航班、高铁晚点。
+ *          每个样本的最优路线是在已知该样本全部扰动的前提下求得的（事后最优），因此平均用时可能低于无扰动时的用时。
+ *          所有样本共享预处理：可用路段使用寻路引擎的压缩邻接表（含交通事件状态，见 csr_engine.h），与各分布的分位数表一样只构建一次。
+ *          随机数由 (种子, 样本序号, 路段) 直接计算得到，结果与线程数和调度顺序无关；
+ *          样本在线程池上并行求解，每个工作线程复用自己的工作区。
+ */
+
+/**
+ * @brief 一种交通方式的不确定性参数。
+ */
+typedef struct {
+    double time_sigma;          ///< 整体时间倍数的对数标准差。
+    double link_time_sigma;     ///< 单条路段时间倍数的对数标准差。
+    double cost_sigma;          ///< 整体花费倍数的对数标准差。
+    double delay_probability;   ///< 每条路段发生延误的概率。
+    double mean_delay_hours;    ///< 发生延误时的平均延误时长（小时）。
+} ModeUncertainty;
+
+/**
+ * @brief 可靠性分析的参数。
+ */
+typedef struct {
+    double time_weight;         ///< 时间权重。
+    double cost_weight;         ///< 花费权重。
+    int sample_count;           ///< 样本数。
+    uint64_t seed;              ///< 随机种子，相同种子得到相同结果。
+    ModeUncertainty uncertainty[TRANSPORT_MODE_COUNT]; ///< 每种交通方式的不确定性。
+    TransportModeMask allowed_modes; ///< 允许使用的交通方式，0表示不限制。被排除的交通方式不参与搜索。
+} ReliabilityOptions;
+
+/**
+ * @brief 在某些样本中成为最优的一条路线。
+ */
+typedef struct {
+    int* node_ids;              ///< 途经节点，从起点到终点。
+    TransportMode* modes;       ///< 每一段的交通方式，共 node_count - 1 个。
+    int node_count;             ///< 途经节点数。
+    int optimal_count;          ///< 成为最优路线的样本数。
+    double mean_time_hours;     ///< 在这些样本中的平均用时（小时）。
+    double mean_cost_yuan;      ///< 在这些样本中的平均花费（元）。
+} ReliabilityRoute;
+
+/**
+ * @brief 可靠性分析的结果。
+ */
+typedef struct {
+    int sample_count;           ///< 样本总数。
+    int unreachable_count;      ///< 起点无法到达终点的样本数。
+    double baseline_time_hours; ///< 不加扰动时最优路线的用时（小时），不可达时为-1。
+    double mean_time_hours;     ///< 可达样本的平均用时（小时）。
+    double mean_cost_yuan;      ///< 可达样本的平均花费（元）。
+    double* sample_times;       ///< 可达样本的用时，从小到大排列。
+    double* sample_costs;       ///< 可达样本的花费，从小到大排列。
+    int reachable_count;        ///< 可达样本数，即上面两个数组的长度。
+    ReliabilityRoute* routes;   ///< 出现过的最优路线，按出现次数从多到少排列。
+    int route_count;            ///< 路线数。
+} ReliabilityResult;
+
+/**
+ * @brief 用默认值填充可靠性分析参数。
+ * @details 默认：1000 个样本；自驾、大巴的整体和路段时间波动较大，航班有较高的延误概率和票价波动，高铁最稳定。
+ */
+void reliability_default_options(ReliabilityOptions* options);
+
+/**
+ * @brief 对一次点到点查询做蒙特卡洛可靠性分析。
+ *
+ * @param network 交通网络。
+ * @param start_node_id 起点。
+ * @param end_node_id 终点。
+ * @param options 参数，NULL表示使用默认值。
+ * @param control 取消令牌与进度回调，可为NULL。进度阶段名为 "sampling"。
+ * @return ReliabilityResult* 结果，调用者需使用 free_reliability_result() 释放。参数无效、内存不足或被取消时返回NULL。
+ */
+ReliabilityResult* analyze_route_reliability(const TrafficNetwork* network, int start_node_id, int end_node_id,
+                                             const ReliabilityOptions* options, const SolveControl* control);
+
+/**
+ * @brief 返回可达样本用时的分位数。
+ *
+ * @param result 分析结果。
+ * @param percentile 百分位，范围 [0, 100]。
+ * @return double 用时（小时），没有可达样本时返回-1。
+ */
+double reliability_time_percentile(const ReliabilityResult* result, double percentile);
+
+/**
+ * @brief 释放可靠性分析的结果。传入NULL时不做任何操作。
+ */
+void free_reliability_result(ReliabilityResult* result);
+
+#endif // RELIABILITY_H
@@ -0,0 +1,151 @@
+#ifndef ROUTING_ENGINE_H
+#define ROUTING_ENGINE_H
+
+#include <stdbool.h>
+#include "graph.h"
+#include "pathfinding.h"
+#include "solve_control.h"
+#include "types.h"
+
+/**
+ * @file routing_engine.h
+ * @brief 可替换的寻路引擎：统一的引擎接口（预处理、点到点查询、一对多查询、释放）、引擎注册表和自动选择器。
+ * @details 内置三个引擎：
+ *          - "astar"：在隐式完全图上线性扫描的A*，无需预处理，适合一次性查询；
+ *          - "csr_linear"：预处理出所有可用路段的压缩邻接表（按起点和交通方式分段），线性扫描开放集，适合稠密网络上的批量查询；
+ *          - "csr_heap"：同一邻接表上用二叉堆管理开放集，适合稀疏网络（例如只允许飞机）上的批量查询。
+ *          求解TSP、顺序路径等需要大量查询的调用者通过 routing_engine_select() 选择引擎，而不是直接调用某个寻路函数。
+ *          选择器可以用 routing_engine_set_override() 或环境变量 TRAFFIC_ENGINE 强制指定引擎，便于对比测试。
+ */
+
+/**
+ * @brief 查询类型。
+ */
+typedef enum {
+    ROUTING_POINT_TO_POINT,     ///< 点到点查询。
+    ROUTING_ONE_TO_MANY         ///< 从一个起点到多个终点的成本（例如构建成本矩阵）。
+} RoutingQueryKind;
+
+/**
+ * @brief 一批查询的概况，供选择器估计预处理是否划算。
+ */
+typedef struct {
+    RoutingQueryKind kind;      ///< 查询类型。
+    int query_count;            ///< 预计的查询次数。
+    TransportModeMask allowed_modes; ///< 查询允许的交通方式，0表示不限制。影响网络的有效稠密程度。
+} RoutingWorkload;
+
+/**
+ * @brief 寻路引擎的函数表。所有函数都必须是线程安全的：同一个引擎实例会被多个线程同时查询。
+ */
+typedef struct RoutingEngineVTable {
+    const char* name;           ///< 引擎名称，在注册表中唯一。
+    const char* description;    ///< 简短说明。
+
+    /**
+     * @brief 预处理网络。
+     * @param state 输出引擎私有状态，无需预处理的引擎可以输出NULL。
+     * @return bool 成功返回true。
+     */
+    bool (*prepare)(const TrafficNetwork* network, void** state);
+
+    /**
+     * @brief 点到点查询，语义与 find_shortest_path_query() 相同。
+     */
+    RoutePath* (*query)(void* state, const TrafficNetwork* network, int start_node_id, int end_node_id, const RouteQueryOptions* options,
+                        const SolveControl* control);
+
+    /**
+     * @brief 一对多查询，语义与 find_shortest_path_costs() 相同。
+     */
+    bool (*one_to_many)(void* state, const TrafficNetwork* network, int source_node_id, const int* target_node_ids, int target_count,
+                        const RouteQueryOptions* options, const SolveControl* control, double* out_costs);
+
+    /**
+     * @brief 释放 prepare 输出的私有状态，state 可能为NULL。
+     */
+    void (*free_state)(void* state);
+} RoutingEngineVTable;
+
+/**
+ * @brief 引擎实例：一个引擎在一个网络上预处理后的结果（不透明结构体）。
+ */
+typedef struct RoutingEngine RoutingEngine;
+
+/**
+ * @brief 注册一个引擎。
+ * @details 应在程序启动时、开始查询之前调用。
+ * @return bool 名称重复或注册表已满时返回false。
+ */
+bool routing_engine_register(const RoutingEngineVTable* vtable);
+
+/**
+ * @brief 获取已注册的引擎数。
+ */
+int routing_engine_count(void);
+
+/**
+ * @brief 按注册顺序获取引擎，下标越界时返回NULL。
+ */
+const RoutingEngineVTable* routing_engine_get(int index);
+
+/**
+ * @brief 按名称查找引擎，找不到时返回NULL。
+ */
+const RoutingEngineVTable* routing_engine_find(const char* name);
+
+/**
+ * @brief 强制选择器返回指定的引擎，NULL表示恢复自动选择。优先于环境变量 TRAFFIC_ENGINE。
+ * @details 应在开始查询之前调用。
+ * @return bool 名称未注册时返回false（设置不变）。
+ */
+bool routing_engine_set_override(const char* name);
+
+/**
+ * @brief 为一批查询选择最快的引擎。
+ * @details 有强制指定时直接返回指定的引擎。否则：
+ *          查询次数少于预处理的开销（约8次点到点或3次一对多查询）时选择 "astar"；
+ *          批量查询时按抽样估计的平均出度 d 选择压缩邻接表引擎：d × log2(节点数) 小于节点数时开放集很小，用二叉堆（"csr_heap"），
+ *          否则线性扫描更快（"csr_linear"）。
+ *
+ * @param network 交通网络。
+ * @param workload 查询概况，NULL表示单次点到点查询。
+ * @return const RoutingEngineVTable* 选中的引擎。
+ */
+const RoutingEngineVTable* routing_engine_select(const TrafficNetwork* network, const RoutingWorkload* workload);
+
+/**
+ * @brief 在网络上创建引擎实例（执行预处理）。
+ * @details 网络在预处理之后发生变更（交通事件、增加节点）时，预处理过的引擎自动回退到 "astar" 的实现，结果仍然正确。
+ *
+ * @param vtable 引擎，NULL表示由选择器按单次点到点查询选择。
+ * @param network 交通网络，在引擎实例销毁之前不能被销毁。
+ * @return RoutingEngine* 引擎实例，调用者需使用 routing_engine_destroy() 释放。预处理失败时返回NULL。
+ */
+RoutingEngine* routing_engine_create(const RoutingEngineVTable* vtable, const TrafficNetwork* network);
+
+/**
+ * @brief 获取引擎实例使用的引擎名称。
+ */
+const char* routing_engine_get_name(const RoutingEngine* engine);
+
+/**
+ * @brief 点到点查询。可以在多个线程中同时调用。
+ * @return RoutePath* 同 find_shortest_path_query()。
+ */
+RoutePath* routing_engine_query(const RoutingEngine* engine, int start_node_id, int end_node_id, const RouteQueryOptions* options,
+                                const SolveControl* control);
+
+/**
+ * @brief 一对多查询。可以在多个线程中同时调用。
+ * @return bool 同 find_shortest_path_costs()。
+ */
+bool routing_engine_one_to_many(const RoutingEngine* engine, int source_node_id, const int* target_node_ids, int target_count,
+                                const RouteQueryOptions* options, const SolveControl* control, double* out_costs);
+
+/**
+ * @brief 销毁引擎实例。传入NULL时不做任何操作。
+ */
+void routing_engine_destroy(RoutingEngine* engine);
+
+#endif // ROUTING_ENGINE_H
@@ -0,0 +1,58 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include "city_tables.h"
+#include "graph.h"
+
+/**
+ * @file snapshot.h
+ * @brief 二进制快照：把交通网络的节点、城市和同城全源最短路径表保存到一个文件，启动时直接加载，
+ *        免去解析CSV和重新建表。
+ * @details 文件由固定大小的头部和按8字节对齐的数组组成，数组与内存中的结构体布局相同。
+ *          头部记录了字节序和结构体大小，在不同平台或不同版本的程序之间拒绝加载。
+ *          交通事件等运行时状态不保存。
+ */
+
+/**
+ * @brief 把网络和同城表保存为二进制快照。
+ *
+ * @param path 输出文件路径，已存在时整体替换（先写入 path.tmp 再改名），正在映射旧文件的进程不受影响。
+ * @param network 交通网络。
+ * @param tables 同城表，可为NULL（快照中不含表）。
+ * @return bool 成功返回true。
+ */
+bool snapshot_save(const char* path, const TrafficNetwork* network, const CityTables* tables);
+
+/**
+ * @brief 从二进制快照加载网络和同城表。
+ *
+ * @param path 快照文件路径。
+ * @param out_tables 输出与新网络绑定的同城表；快照中不含表时为NULL。调用者需使用 city_tables_destroy() 释放。
+ * @return TrafficNetwork* 新的网络，调用者需使用 traffic_network_destroy() 释放。文件不存在或格式不符时返回NULL。
+ */
+TrafficNetwork* snapshot_load(const char* path, CityTables** out_tables);
+
+/**
+ * @brief 只读映射的快照文件（不透明结构体）。
+ */
+typedef struct SnapshotMapping SnapshotMapping;
+
+/**
+ * @brief 以只读方式映射快照文件，网络和同城表直接引用映射的内存，不复制数组。
+ * @details 映射与文件共享页缓存：同一台机器上映射同一个快照的所有进程（包括 fork 出的子进程）共用一份物理内存。
+ *          网络第一次修改节点或城市时才把数组复制到自己的内存（见 traffic_network_wrap_arrays()）。
+ *
+ * @param path 快照文件路径。
+ * @param out_tables 输出引用映射内存的同城表；快照中不含表时为NULL。调用者需使用 city_tables_destroy() 释放。
+ * @param out_mapping 输出映射，调用者需在销毁网络和同城表之后使用 snapshot_unmap() 释放。
+ * @return TrafficNetwork* 新的网络，调用者需使用 traffic_network_destroy() 释放。文件不存在或格式不符时返回NULL。
+ */
+TrafficNetwork* snapshot_map(const char* path, CityTables** out_tables, SnapshotMapping** out_mapping);
+
+/**
+ * @brief 解除快照映射。必须在引用它的网络和同城表都销毁之后调用。传入NULL时不做任何操作。
+ */
+void snapshot_unmap(SnapshotMapping* mapping);
+
+#endif // SNAPSHOT_H
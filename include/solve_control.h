@@ -0,0 +1,84 @@
+#ifndef SOLVE_CONTROL_H
+#define SOLVE_CONTROL_H
+
+#include <stdbool.h>
+
+/**
+ * @brief 长时间求解的取消令牌。
+ * @details 调用者持有令牌并把它传给求解函数；任何线程（包括信号处理函数）都可以调用
+ *          cancel_token_cancel() 请求停止。也可以设置截止时间，到期后视同已取消。
+ *          求解函数会在搜索和动态规划循环中每隔固定的迭代次数检查一次令牌。
+ *          被取消（包括截止时间到期）的求解函数丢弃已有的部分结果，返回NULL（或文档中说明的失败值）；
+ *          求解函数自己的时间限制参数（例如 time_limit_ms）到期则不是取消，此时返回当前找到的最优可行解。
+ */
+typedef struct {
+    volatile int cancelled;     ///< 非0表示已请求取消。请通过下面的函数访问。
+    double deadline;            ///< 单调时钟上的截止时刻（秒），<=0 表示没有截止时间。
+} CancelToken;
+
+/**
+ * @brief 进度回调函数。
+ * @details 并行求解时回调可能在工作线程中被调用，但同一次求解内的调用总是串行的。
+ * @param stage 当前阶段的简短英文标识，例如 "cost_matrix"、"dp"、"legs"。
+ * @param fraction 当前阶段的完成比例 (0.0 to 1.0)。
+ * @param user_data 调用者在 SolveControl 中提供的自定义指针。
+ */
+typedef void (*ProgressCallback)(const char* stage, double fraction, void* user_data);
+
+/**
+ * @brief 传递给可中断求解函数的控制参数。
+ * @details 所有字段都可以为NULL；传入NULL的 SolveControl 指针等价于不取消、不报告进度。
+ */
+typedef struct {
+    CancelToken* cancel_token;      ///< 取消令牌，可为NULL。
+    ProgressCallback on_progress;   ///< 进度回调，可为NULL。
+    void* user_data;                ///< 原样传给进度回调的指针。
+} SolveControl;
+
+/**
+ * @brief 求解函数检查取消令牌的间隔（以循环迭代次数计）。
+ */
+#define SOLVE_CONTROL_CHECK_INTERVAL 64
+
+/**
+ * @brief 初始化取消令牌：未取消、没有截止时间。
+ * @param token 要初始化的令牌。
+ */
+void cancel_token_init(CancelToken* token);
+
+/**
+ * @brief 请求取消。可以在任意线程或信号处理函数中调用。
+ * @param token 要取消的令牌。
+ */
+void cancel_token_cancel(CancelToken* token);
+
+/**
+ * @brief 设置相对于当前时刻的截止时间，到期后令牌视同已取消。
+ * @param token 令牌。
+ * @param timeout_ms 从现在起的毫秒数。小于等于0表示清除截止时间。
+ */
+void cancel_token_set_deadline(CancelToken* token, double timeout_ms);
+
+/**
+ * @brief 判断令牌是否已被取消或已超过截止时间。
+ * @param token 令牌。传入NULL时返回false。
+ * @return bool 已取消返回true。
+ */
+bool cancel_token_is_cancelled(const CancelToken* token);
+
+/**
+ * @brief 判断求解是否应当停止。
+ * @param control 控制参数，可为NULL。
+ * @return bool 令牌已取消或超时返回true。
+ */
+bool solve_control_should_stop(const SolveControl* control);
+
+/**
+ * @brief 向调用者报告进度（如果设置了回调）。
+ * @param control 控制参数，可为NULL。
+ * @param stage 阶段标识。
+ * @param fraction 完成比例。
+ */
+void solve_control_report_progress(const SolveControl* control, const char* stage, double fraction);
+
+#endif // SOLVE_CONTROL_H
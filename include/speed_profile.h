@@ -0,0 +1,86 @@
+#ifndef SPEED_PROFILE_H
+#define SPEED_PROFILE_H
+
+#include "graph.h"
+#include "types.h"
+
+/**
+ * @file speed_profile.h
+ * @brief 随时段变化的行驶速度：按城市和交通方式定义的分段线性速度系数曲线。
+ * @details 速度系数 f(t) 是一天内时刻 t（小时）的周期性分段线性函数，实际速度 = 基础速度 × f(t)。
+ *          通行时间不是简单的 "距离 / 出发时刻的速度"，而是沿时间对速度积分直到走完全程，
+ *          因此晚出发一定不会早到达（满足先进先出性质），时间依赖的Dijkstra/A* 结果正确。
+ *
+ *          每条曲线的断点、斜率和按整点的分段索引在加载时预先计算，存放在定长数组中，
+ *          求值只做常数次查表和一次开方，不分配内存。
+ */
+
+/**
+ * @brief 一条曲线的最大断点数。
+ */
+#define SPEED_PROFILE_MAX_BREAKPOINTS 24
+
+/**
+ * @brief 一条周期为24小时的分段线性速度系数曲线。
+ */
+typedef struct {
+    int count;                                          ///< 断点数。
+    float hours[SPEED_PROFILE_MAX_BREAKPOINTS + 1];     ///< 断点时刻，严格递增；hours[count] = hours[0] + 24。
+    float factors[SPEED_PROFILE_MAX_BREAKPOINTS + 1];   ///< 断点处的速度系数；factors[count] = factors[0]。
+    float slopes[SPEED_PROFILE_MAX_BREAKPOINTS];        ///< 第i段的斜率（每小时系数变化量）。
+    float day_integral;                                 ///< 一整天内速度系数的积分，用于跳过整天。
+    unsigned char hour_segment[24];                     ///< hour_segment[k]：时刻 hours[0] + k 所在的段。
+} SpeedProfile;
+
+/**
+ * @brief 一组速度曲线及其按 (城市, 交通方式) 的查找表（不透明结构体）。
+ */
+typedef struct SpeedProfileSet SpeedProfileSet;
+
+/**
+ * @brief 从CSV文件加载速度曲线。
+ * @details 文件格式为 `city_name,mode,hour,speed_factor`，第一行为表头。
+ *          - city_name 为城市名时，曲线作用于该城市的市内路段；
+ *            为 `*` 时作用于所有没有单独定义曲线的城市的市内路段；为 `intercity` 时作用于城际路段。
+ *          - mode 为 mode_to_string() 给出的英文名称，例如 `driving`、`bus`。
+ *          - 同一条曲线的各行按 hour（0-24）严格递增给出，speed_factor 必须大于0。
+ *          没有对应曲线的路段速度系数恒为1。
+ *
+ * @param network 用于把城市名解析为城市ID的交通网络。
+ * @param csv_path CSV文件路径。
+ * @return SpeedProfileSet* 成功时返回曲线集合，调用者需使用 speed_profile_set_destroy() 释放。失败时返回NULL。
+ */
+SpeedProfileSet* speed_profile_set_load(const TrafficNetwork* network, const char* csv_path);
+
+/**
+ * @brief 释放速度曲线集合。传入NULL时不做任何操作。
+ */
+void speed_profile_set_destroy(SpeedProfileSet* set);
+
+/**
+ * @brief 查找一条路段使用的速度曲线。
+ * @return const SpeedProfile* 对应的曲线；没有时返回NULL（速度系数恒为1）。
+ */
+const SpeedProfile* speed_profile_set_lookup(const SpeedProfileSet* set, const Node* from_node, const Node* to_node, TransportMode mode);
+
+/**
+ * @brief 获取集合中所有曲线的最大速度系数（不小于1），用于构造时间依赖A*的可采纳启发式。
+ */
+double speed_profile_set_get_max_factor(const SpeedProfileSet* set);
+
+/**
+ * @brief 计算按曲线行驶时的实际通行时间。
+ * @param profile 速度曲线，NULL表示速度系数恒为1。
+ * @param free_flow_hours 以基础速度行驶所需的时间（小时）。
+ * @param depart_hour 出发时刻（小时，可以超过24或为负，按24小时取模）。
+ * @return double 实际通行时间（小时）。
+ */
+double speed_profile_travel_time(const SpeedProfile* profile, double free_flow_hours, double depart_hour);
+
+/**
+ * @brief 查找路段的速度曲线并计算实际通行时间，相当于 lookup + travel_time。
+ */
+double speed_profile_set_travel_time(const SpeedProfileSet* set, const Node* from_node, const Node* to_node, TransportMode mode,
+                                     double free_flow_hours, double depart_hour);
+
+#endif // SPEED_PROFILE_H
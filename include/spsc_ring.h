@@ -0,0 +1,54 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file spsc_ring.h
+ * @brief 有界的单生产者、单消费者无锁环形队列，用于连接流水线中相邻的两个线程。
+ * @details 队列中存放指针。生产者只写 tail、消费者只写 head，两者位于不同的缓存行，
+ *          通过 acquire/release 原子操作同步，不使用互斥锁。每个队列只能有一个线程入队、一个线程出队。
+ *          队列满或空时，阻塞版本先自旋，再让出CPU，等待较久时短暂休眠，不使用条件变量。
+ */
+
+/**
+ * @brief 环形队列（不透明结构体）。
+ */
+typedef struct SpscRing SpscRing;
+
+/**
+ * @brief 创建环形队列。
+ * @param capacity 最少容纳的元素数，实际容量向上取整为2的幂。
+ * @return SpscRing* 新队列，调用者需使用 spsc_ring_destroy() 释放。失败时返回NULL。
+ */
+SpscRing* spsc_ring_create(size_t capacity);
+
+/**
+ * @brief 释放环形队列（不释放队列中剩余指针指向的对象）。传入NULL时不做任何操作。
+ */
+void spsc_ring_destroy(SpscRing* ring);
+
+/**
+ * @brief 尝试入队（仅限生产者线程调用）。
+ * @return bool 队列已满时返回false。
+ */
+bool spsc_ring_try_push(SpscRing* ring, void* item);
+
+/**
+ * @brief 尝试出队（仅限消费者线程调用）。
+ * @return bool 队列为空时返回false。
+ */
+bool spsc_ring_try_pop(SpscRing* ring, void** item);
+
+/**
+ * @brief 入队，队列已满时等待消费者腾出空间。
+ */
+void spsc_ring_push(SpscRing* ring, void* item);
+
+/**
+ * @brief 出队，队列为空时等待生产者放入元素。
+ */
+void* spsc_ring_pop(SpscRing* ring);
+
+#endif // SPSC_RING_H
@@ -0,0 +1,67 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/**
+ * @brief 固定大小的工作线程池。
+ * @details 这是一个 "不透明" 结构体的句柄。线程池用于把相互独立的计算（例如多段路径的寻路）
+ *          分发到多个CPU核心上并行执行。
+ */
+typedef struct ThreadPool ThreadPool;
+
+/**
+ * @brief parallel_for 中每个任务项的处理函数。
+ * @param index 任务项的下标，范围是 [0, count)。
+ * @param worker_id 执行该任务项的工作线程编号，范围是 [0, thread_pool_get_size())，
+ *                  同一时刻不会有两个任务项使用相同的编号，可用于索引每线程独立的工作区。
+ * @param context 调用者传入的上下文指针。
+ */
+typedef void (*ParallelForFunc)(int index, int worker_id, void* context);
+
+/**
+ * @brief 创建一个线程池。
+ * @param num_threads 工作线程数量。小于等于0时使用CPU核心数。
+ * @return ThreadPool* 成功时返回新线程池，失败返回NULL。调用者需使用 thread_pool_destroy() 释放。
+ */
+ThreadPool* thread_pool_create(int num_threads);
+
+/**
+ * @brief 等待所有工作线程退出并释放线程池。
+ * @param pool 要销毁的线程池。传入NULL时不做任何操作。
+ */
+void thread_pool_destroy(ThreadPool* pool);
+
+/**
+ * @brief 获取线程池的工作线程数量，即 worker_id 的取值上限。
+ * @param pool 线程池。
+ * @return int 工作线程数量。如果pool为NULL，返回0。
+ */
+int thread_pool_get_size(const ThreadPool* pool);
+
+/**
+ * @brief 获取进程共享的默认线程池（首次调用时创建）。
+ * @details 线程数默认等于CPU核心数，可以通过环境变量 TRAFFIC_THREADS 覆盖。
+ * @return ThreadPool* 默认线程池，创建失败时返回NULL。不要销毁它。
+ */
+ThreadPool* thread_pool_get_default(void);
+
+/**
+ * @brief 在 fork() 出的子进程中重新创建默认线程池。
+ * @details fork 只复制调用线程，父进程已创建的默认线程池在子进程中没有工作线程。
+ *          子进程在再次使用默认线程池之前（通常紧接在 fork 之后）调用本函数；父进程的线程池对象直接丢弃。
+ *          父进程还没有创建默认线程池时不做任何操作。
+ */
+void thread_pool_reset_default_after_fork(void);
+
+/**
+ * @brief 并行执行 count 个任务项，返回时所有任务项都已完成。
+ * @details 如果从该线程池的工作线程内部调用（嵌套并行），当前线程也会参与执行，因此不会死锁。
+ *          如果pool为NULL，则在当前线程中以 worker_id = 0 顺序执行。
+ *
+ * @param pool 线程池。
+ * @param count 任务项数量。
+ * @param func 任务项处理函数。
+ * @param context 原样传给处理函数的上下文指针。
+ */
+void thread_pool_parallel_for(ThreadPool* pool, int count, ParallelForFunc func, void* context);
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,67 @@
+#ifndef TIMETABLE_H
+#define TIMETABLE_H
+
+#include "graph.h"
+#include "types.h"
+
+/**
+ * @file timetable.h
+ * @brief 基于时刻表的路径规划：使用连接扫描算法（Connection Scan Algorithm, CSA）求最早到达。
+ * @details 航班和高铁按班次运行。时刻表中的每一条 "连接" 是某个班次从一站出发、到达下一站的一段，
+ *          全部连接按出发时刻排序存放在一个连续数组中。查询时从出发时刻开始顺序扫描一遍，
+ *          逐个判断能否赶上该连接，内存访问完全是线性的。
+ *
+ *          同城节点之间的驾车或公交直达路段（沿用固定速度模型）作为换乘步行边：
+ *          从起点地标前往机场/车站、在城市内换乘、以及从终点机场/车站前往目的地。
+ *          换乘其它班次时需要预留换乘时间（机场45分钟，高铁站10分钟）；留在同一班次上不需要。
+ *
+ *          时刻表描述一天的班次并每天重复，内部展开为连续两天，因此可以查询跨越午夜的行程。
+ */
+
+/**
+ * @brief 时刻表（不透明结构体）。
+ */
+typedef struct Timetable Timetable;
+
+/**
+ * @brief 从CSV文件加载时刻表。
+ * @details 文件格式为 `trip_id,mode,from_node,to_node,departure,arrival,fare`，第一行为表头：
+ *          - trip_id：班次编号，同一班次的多段连接共享同一编号（例如一趟经停多站的高铁）；
+ *          - mode：mode_to_string() 给出的交通方式名称，例如 `flight`、`high_speed_rail`；
+ *          - from_node / to_node：节点名称，必须存在于交通网络中；
+ *          - departure / arrival：`HH:MM` 或 `HH:MM:SS`，小时可以超过24（表示次日，与GTFS一致），出发时刻不能超过48小时；
+ *          - fare：票价（元）。
+ *
+ * @param network 交通网络，用于解析节点名称和构建换乘步行边。
+ * @param csv_path CSV文件路径。
+ * @return Timetable* 成功时返回时刻表，调用者需使用 timetable_destroy() 释放。失败时返回NULL。
+ */
+Timetable* timetable_load(const TrafficNetwork* network, const char* csv_path);
+
+/**
+ * @brief 释放时刻表。传入NULL时不做任何操作。
+ */
+void timetable_destroy(Timetable* timetable);
+
+/**
+ * @brief 获取时刻表中一天的连接数。
+ */
+int timetable_get_connection_count(const Timetable* timetable);
+
+/**
+ * @brief 查询从起点在给定时刻出发、最早到达终点的行程。
+ * @details 网络中被封闭的站点（见 traffic_network_set_node_enabled()）不能上下车，但可以乘车经停。
+ *
+ * @param timetable 时刻表。
+ * @param network 加载时刻表时使用的交通网络。
+ * @param start_node_id 起点节点ID。
+ * @param end_node_id 终点节点ID。
+ * @param depart_hour 出发时刻（小时，0-24）。
+ * @param arrival_hour 可选的输出参数，返回到达时刻（小时，从出发当天零点起算，可能超过24）。可以传入NULL。
+ * @return RoutePath* 成功时返回行程，各路段为乘坐的班次连接和换乘路段；total_time 为包含候车时间在内的总耗时。
+ *                    在展开的两天内无法到达时返回NULL。调用者需使用 free_route_path() 释放。
+ */
+RoutePath* timetable_earliest_arrival(const Timetable* timetable, const TrafficNetwork* network, int start_node_id, int end_node_id,
+                                      double depart_hour, double* arrival_hour);
+
+#endif // TIMETABLE_H
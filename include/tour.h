@@ -0,0 +1,95 @@
+#ifndef TOUR_H
+#define TOUR_H
+
+#include <stdbool.h>
+#include "graph.h"
+#include "types.h"
+
+/**
+ * @brief 可增量编辑的环游行程（不透明结构体）。
+ * @details 行程对象保存了每个途经点的最短路径树、途经点之间的成本矩阵以及当前的最优/近似最优环路。
+ *          增加一个途经点只需要一次Dijkstra（新点的最短路径树同时给出矩阵的新行，
+ *          已有的树给出新列），随后用局部修复代替重新求解：
+ *          - 点数不超过 HELD_KARP_MAX_NODES 时，复用Held-Karp表中不含变化点的所有子集，结果是精确最优解；
+ *          - 点数更多时，使用最廉价插入加 2-opt/Or-opt 局部搜索修复环路。
+ *          第一个加入的途经点是环游的起点和终点。
+ */
+typedef struct TourPlanner TourPlanner;
+
+/**
+ * @brief 创建一个空的行程。
+ *
+ * @param network 交通网络。行程存续期间网络不能被销毁。
+ * @param time_weight 时间权重。
+ * @param cost_weight 花费权重。
+ * @return TourPlanner* 新行程，调用者需使用 tour_planner_destroy() 释放。内存不足时返回NULL。
+ */
+TourPlanner* tour_planner_create(const TrafficNetwork* network, double time_weight, double cost_weight);
+
+/**
+ * @brief 释放行程及其保存的所有最短路径树。传入NULL时不做任何操作。
+ */
+void tour_planner_destroy(TourPlanner* tour);
+
+/**
+ * @brief 向行程中增加一个途经点，并修复环路。
+ *
+ * @param tour 行程。
+ * @param node_id 要增加的节点ID。如果该节点已在行程中，不做任何修改。
+ * @return bool 成功（或节点已在行程中）返回true；节点无效或内存不足时返回false。
+ */
+bool tour_planner_add_stop(TourPlanner* tour, int node_id);
+
+/**
+ * @brief 从行程中删除一个途经点，并修复环路。
+ * @details 删除起点时，下一个加入的途经点成为新的起点，环路会在剩余点上重新求解。
+ *
+ * @param tour 行程。
+ * @param node_id 要删除的节点ID。
+ * @return bool 成功返回true；节点不在行程中时返回false。
+ */
+bool tour_planner_remove_stop(TourPlanner* tour, int node_id);
+
+/**
+ * @brief 获取行程中的途经点数量。
+ */
+int tour_planner_get_stop_count(const TourPlanner* tour);
+
+/**
+ * @brief 按环路顺序输出途经点的节点ID（从起点开始，不重复写出返回的起点）。
+ *
+ * @param tour 行程。
+ * @param out_node_ids 输出数组。
+ * @param capacity 输出数组的容量。
+ * @return int 实际写入的数量。
+ */
+int tour_planner_get_order(const TourPlanner* tour, int* out_node_ids, int capacity);
+
+/**
+ * @brief 获取当前环路的总加权成本。不存在可行环路时返回 DBL_MAX。
+ */
+double tour_planner_get_cost(const TourPlanner* tour);
+
+/**
+ * @brief 当前环路是否为精确最优解（由Held-Karp动态规划得到）。
+ */
+bool tour_planner_is_optimal(const TourPlanner* tour);
+
+/**
+ * @brief 根据当前环路生成完整的路径，各路段直接取自已保存的最短路径树，无需重新搜索。
+ * @return RoutePath* 新路径，调用者需使用 free_route_path() 释放。途经点少于2个或环路不可行时返回NULL。
+ */
+RoutePath* tour_planner_build_route(const TourPlanner* tour);
+
+/**
+ * @brief 使行程与交通网络的当前状态（封闭、减速等交通事件）保持一致。
+ * @details 各途经点的最短路径树在线程池上并行做增量修复，只有成本发生变化的矩阵元素被更新；
+ *          矩阵有变化时重新求解环路（精确范围内重建动态规划表，否则在当前环路上做局部搜索）。
+ *          增删途经点前会自动调用本函数，保证新旧矩阵行列基于同一版本的网络。
+ *
+ * @param tour 行程。
+ * @return int 发生变化的矩阵元素个数；内存不足时返回-1。
+ */
+int tour_planner_sync(TourPlanner* tour);
+
+#endif // TOUR_H
@@ -0,0 +1,199 @@
+#ifndef TRAFFIC_PLANNER_H
+#define TRAFFIC_PLANNER_H
+
+#include <stddef.h>
+
+/**
+ * @file traffic_planner.h
+ * @brief libtrafficplanner.so 的公共接口：供其他语言（Go、Java等）在同一进程内直接调用规划器。
+ * @details 这是共享库唯一导出的头文件，不依赖项目的其他头文件，内部结构体全部以不透明句柄表示，
+ *          结构体和枚举的布局只在主版本号变化时改变。内存归属规则：
+ *          - 库分配的对象（规划器、路线、JSON字符串）必须用对应的 *_close / *_free 函数释放，不能用调用方自己的 free()；
+ *          - 调用方传入的输出缓冲区（名称、成本矩阵、路段）由调用方分配和释放，库只写入不保留。
+ *          同一个规划器上的所有查询函数都可以在多个线程中同时调用；打开和关闭规划器不能与其上的查询并发。
+ *          每个规划器持有自己的网络、同城表和寻路引擎，不同规划器之间没有共享状态，可以在不同线程中独立打开、查询和关闭。
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define TRAFFIC_PLANNER_API __attribute__((visibility("default")))
+#else
+#define TRAFFIC_PLANNER_API
+#endif
+
+#define TRAFFIC_PLANNER_VERSION_MAJOR 1   ///< 主版本号，不兼容的接口变化时增加，与共享库的 soname 一致。
+#define TRAFFIC_PLANNER_VERSION_MINOR 0   ///< 次版本号，只新增接口时增加。
+
+/**
+ * @brief 规划器：加载好的交通网络、同城表和寻路引擎（不透明结构体）。
+ */
+typedef struct TrafficPlanner TrafficPlanner;
+
+/**
+ * @brief 一条规划好的路线（不透明结构体）。
+ */
+typedef struct TrafficPlannerRoute TrafficPlannerRoute;
+
+/**
+ * @brief 接口函数的返回状态。
+ */
+typedef enum {
+    TRAFFIC_PLANNER_OK = 0,                    ///< 成功。
+    TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT,    ///< 参数无效，例如句柄为NULL或节点ID越界。
+    TRAFFIC_PLANNER_ERROR_LOAD_FAILED,         ///< 网络文件或快照无法加载。
+    TRAFFIC_PLANNER_ERROR_NO_ROUTE,            ///< 起终点之间不可达。
+    TRAFFIC_PLANNER_ERROR_OUT_OF_MEMORY,       ///< 内存不足。
+} TrafficPlannerStatus;
+
+/**
+ * @brief 交通方式，取值与 TrafficPlannerSegment::mode 和交通方式位集合的位序号一致。
+ */
+enum {
+    TRAFFIC_PLANNER_MODE_DRIVING = 0,          ///< 驾车。
+    TRAFFIC_PLANNER_MODE_HIGH_SPEED_RAIL = 1,  ///< 高铁。
+    TRAFFIC_PLANNER_MODE_FLIGHT = 2,           ///< 飞机。
+    TRAFFIC_PLANNER_MODE_BUS = 3,              ///< 公交/大巴。
+};
+
+/**
+ * @brief 路线中的一个路段，由调用方分配，库负责填写。
+ */
+typedef struct {
+    int from_node_id;       ///< 路段起点节点ID。
+    int to_node_id;         ///< 路段终点节点ID。
+    int mode;               ///< 交通方式（TRAFFIC_PLANNER_MODE_*）。
+    double distance_km;     ///< 距离（公里）。
+    double time_hours;      ///< 时间（小时）。
+    double cost_yuan;       ///< 花费（元）。
+} TrafficPlannerSegment;
+
+/**
+ * @brief 返回运行时加载的库的版本号：(主版本号 << 16) | 次版本号。
+ * @details 调用方应检查主版本号与编译时的 TRAFFIC_PLANNER_VERSION_MAJOR 一致。
+ */
+TRAFFIC_PLANNER_API unsigned int traffic_planner_version(void);
+
+/**
+ * @brief 从CSV节点文件加载网络并创建规划器（同时构建同城表和寻路引擎）。
+ *
+ * @param nodes_csv_path 节点文件路径，例如 "data/nodes.csv"。
+ * @param out_planner 输出规划器，调用者需使用 traffic_planner_close() 释放；失败时为NULL。
+ * @return TrafficPlannerStatus 成功返回 TRAFFIC_PLANNER_OK。
+ */
+TRAFFIC_PLANNER_API TrafficPlannerStatus traffic_planner_open(const char* nodes_csv_path, TrafficPlanner** out_planner);
+
+/**
+ * @brief 映射二进制快照（见 TRAFFIC_SNAPSHOT）中的网络和同城表并创建规划器，免去解析CSV和建表。
+ * @details 快照以只读方式映射，同一台机器上打开同一快照的所有进程共享一份物理内存。
+ * @param snapshot_path 快照文件路径。
+ * @param out_planner 输出规划器，调用者需使用 traffic_planner_close() 释放；失败时为NULL。
+ * @return TrafficPlannerStatus 成功返回 TRAFFIC_PLANNER_OK。
+ */
+TRAFFIC_PLANNER_API TrafficPlannerStatus traffic_planner_open_snapshot(const char* snapshot_path, TrafficPlanner** out_planner);
+
+/**
+ * @brief 释放规划器。传入NULL时不做任何操作。之前返回的路线仍然有效，需要单独释放。
+ */
+TRAFFIC_PLANNER_API void traffic_planner_close(TrafficPlanner* planner);
+
+/**
+ * @brief 返回网络中的节点数，节点ID的范围是 [0, 节点数)。
+ */
+TRAFFIC_PLANNER_API int traffic_planner_node_count(const TrafficPlanner* planner);
+
+/**
+ * @brief 按名称（UTF-8）查找节点ID，找不到时返回-1。
+ */
+TRAFFIC_PLANNER_API int traffic_planner_find_node(const TrafficPlanner* planner, const char* name);
+
+/**
+ * @brief 把节点名称（UTF-8）复制到调用方的缓冲区。
+ * @details 与 snprintf 相同：缓冲区不够时截断并保证以 '\0' 结尾，返回值是完整名称的字节数，
+ *          因此可以先以 buffer=NULL、size=0 调用得到所需长度。
+ *
+ * @return size_t 名称的字节数（不含 '\0'）；节点ID无效时返回0。
+ */
+TRAFFIC_PLANNER_API size_t traffic_planner_node_name(const TrafficPlanner* planner, int node_id, char* buffer, size_t size);
+
+/**
+ * @brief 规划两个节点之间加权成本最小的路线。
+ *
+ * @param planner 规划器。
+ * @param from_node_id 起点节点ID。
+ * @param to_node_id 终点节点ID。
+ * @param time_weight 时间权重。
+ * @param cost_weight 花费权重。
+ * @param allowed_modes 允许的交通方式位集合（第 m 位对应 TRAFFIC_PLANNER_MODE_m），0表示不限制。
+ * @param out_route 输出路线，调用者需使用 traffic_planner_route_free() 释放；失败时为NULL。
+ * @return TrafficPlannerStatus 成功返回 TRAFFIC_PLANNER_OK，不可达返回 TRAFFIC_PLANNER_ERROR_NO_ROUTE。
+ */
+TRAFFIC_PLANNER_API TrafficPlannerStatus traffic_planner_route(const TrafficPlanner* planner, int from_node_id, int to_node_id,
+                                                               double time_weight, double cost_weight, unsigned int allowed_modes,
+                                                               TrafficPlannerRoute** out_route);
+
+/**
+ * @brief 读取路线的总距离（公里）、总时间（小时）和总花费（元）。不需要的输出可以传NULL。
+ */
+TRAFFIC_PLANNER_API void traffic_planner_route_totals(const TrafficPlannerRoute* route, double* distance_km, double* time_hours,
+                                                      double* cost_yuan);
+
+/**
+ * @brief 返回路线的路段数。
+ */
+TRAFFIC_PLANNER_API int traffic_planner_route_segment_count(const TrafficPlannerRoute* route);
+
+/**
+ * @brief 把路线的前 capacity 个路段复制到调用方的数组。
+ * @return int 实际复制的路段数。
+ */
+TRAFFIC_PLANNER_API int traffic_planner_route_get_segments(const TrafficPlannerRoute* route, TrafficPlannerSegment* segments, int capacity);
+
+/**
+ * @brief 释放路线。传入NULL时不做任何操作。
+ */
+TRAFFIC_PLANNER_API void traffic_planner_route_free(TrafficPlannerRoute* route);
+
+/**
+ * @brief 计算一组节点两两之间的最小加权成本矩阵。
+ *
+ * @param planner 规划器。
+ * @param node_ids 节点ID数组。
+ * @param count 节点数。
+ * @param time_weight 时间权重。
+ * @param cost_weight 花费权重。
+ * @param allowed_modes 允许的交通方式位集合，0表示不限制。
+ * @param out_costs 调用方分配的 count*count 数组，按行输出 i 到 j 的成本，不可达时为-1。
+ * @return TrafficPlannerStatus 成功返回 TRAFFIC_PLANNER_OK。
+ */
+TRAFFIC_PLANNER_API TrafficPlannerStatus traffic_planner_cost_matrix(const TrafficPlanner* planner, const int* node_ids, int count,
+                                                                     double time_weight, double cost_weight, unsigned int allowed_modes,
+                                                                     double* out_costs);
+
+/**
+ * @brief 以服务模式的请求格式查询并得到JSON结果，便于已经对接HTTP接口的调用方直接切换到进程内调用。
+ * @details 路径和参数与 --serve 相同，例如 path="/tsp"、params="nodes=0,3,7&time_limit_ms=2000"。
+ *
+ * @param planner 规划器。
+ * @param path 请求路径。
+ * @param params URL编码的参数串，可为NULL。
+ * @param out_json 输出JSON（以 '\0' 结尾），调用者需使用 traffic_planner_string_free() 释放。
+ * @param out_length 输出JSON的长度（不含 '\0'），可为NULL。
+ * @param out_http_status 输出与服务模式相同的HTTP状态码（200、400、404、504等），可为NULL。
+ * @return TrafficPlannerStatus 得到了JSON结果（包括错误描述）时返回 TRAFFIC_PLANNER_OK。
+ */
+TRAFFIC_PLANNER_API TrafficPlannerStatus traffic_planner_query_json(TrafficPlanner* planner, const char* path, const char* params,
+                                                                    char** out_json, size_t* out_length, int* out_http_status);
+
+/**
+ * @brief 释放 traffic_planner_query_json() 返回的字符串。传入NULL时不做任何操作。
+ */
+TRAFFIC_PLANNER_API void traffic_planner_string_free(char* text);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRAFFIC_PLANNER_H
@@ -0,0 +1,48 @@
+#ifndef TSP_BNB_H
+#define TSP_BNB_H
+
+#include <stdbool.h>
+#include "solve_control.h"
+
+/**
+ * @file tsp_bnb.h
+ * @brief 基于 Held-Karp 1-tree 下界的TSP分支定界精确求解器。
+ * @details 与 tsp_matrix.h 使用相同的成本矩阵约定：cost[i * stride + j] 为从第i个点到第j个点的成本，
+ *          DBL_MAX 表示不可达，第0个点固定为环路起点。
+ *
+ *          求解过程：
+ *          1. 用最廉价插入加局部搜索得到初始可行解（上界）。
+ *          2. 在根节点上做次梯度优化，得到使 1-tree 下界最大的拉格朗日乘子 π。
+ *          3. 从起点出发逐点扩展路径做深度优先搜索；每个搜索节点的下界为
+ *             "已确定路径的成本 + 剩余点与路径两端构成的 π 修正最小生成树"，不低于当前最优解时剪枝。
+ *          4. 深度为2的所有前缀作为独立子问题在线程池上并行搜索，各线程共享当前最优解。
+ *
+ *          非对称矩阵同样适用：下界使用 min(c[i][j], c[j][i]) 构成的对称矩阵，结果仍然是合法的下界。
+ */
+
+/**
+ * @brief 分支定界求解器支持的最大点数（访问集合用64位掩码表示）。
+ */
+#define TSP_BNB_MAX_NODES 40
+
+/**
+ * @brief solve_tsp() 在动态规划范围之外调用分支定界时使用的默认时间限制（毫秒）。
+ */
+#define TSP_BNB_DEFAULT_TIME_LIMIT_MS 30000.0
+
+/**
+ * @brief 用分支定界精确求解成本矩阵上的TSP。
+ *
+ * @param cost 成本矩阵。
+ * @param stride 成本矩阵的行跨度。
+ * @param n 点数，不超过 TSP_BNB_MAX_NODES。
+ * @param out_order 输出参数，长度至少为n，返回以0开头的访问顺序。
+ * @param time_limit_ms 时间限制（毫秒）。小于等于0表示不限时。超时后返回当前找到的最优可行解。
+ * @param control 取消令牌与进度回调（进度阶段为 "branch_and_bound"），可为NULL。
+ * @param is_optimal 可选的输出参数，搜索完整结束（结果被证明最优）时置为true。可以传入NULL。
+ * @return double 找到的最优环路的成本；不存在可行环路、参数无效或被取消时返回 DBL_MAX。
+ */
+double tsp_branch_and_bound(const double* cost, int stride, int n, int* out_order, double time_limit_ms,
+                            const SolveControl* control, bool* is_optimal);
+
+#endif // TSP_BNB_H
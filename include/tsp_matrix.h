@@ -0,0 +1,135 @@
+#ifndef TSP_MATRIX_H
+#define TSP_MATRIX_H
+
+#include <stdbool.h>
+#include "solve_control.h"
+
+/**
+ * @file tsp_matrix.h
+ * @brief 只依赖成本矩阵的TSP算法（精确动态规划与局部搜索启发式）。
+ * @details 这些函数不接触交通网络，只读取调用者构建好的成本矩阵：
+ *          cost[i * stride + j] 表示从第i个待访问点到第j个待访问点的加权成本，
+ *          DBL_MAX 表示不可达。stride 是矩阵的行跨度（不小于点数），便于调用者预留容量。
+ *          环路总是从第0个点出发并返回第0个点，第0个点在所有算法中都固定在环路首位。
+ */
+
+/**
+ * @brief Held-Karp动态规划支持的最大点数。复杂度为 O(n^2 * 2^n)。
+ */
+#define HELD_KARP_MAX_NODES 10
+
+/**
+ * @brief 可增量扩展的Held-Karp动态规划表（不透明结构体）。
+ * @details dp[mask][v] 只依赖 mask 中各点之间的成本，因此：
+ *          - 追加第n个点时，只需计算包含该点的 2^(n-1) 个子集；
+ *          - 删除一个点时，不含该点的子集的结果全部可以保留，只需重新编号。
+ *          从空表开始逐个追加点，等价于一次完整的动态规划。
+ */
+typedef struct HeldKarpTable HeldKarpTable;
+
+/**
+ * @brief 创建一个空的Held-Karp表（预先分配 HELD_KARP_MAX_NODES 个点所需的空间）。
+ * @return HeldKarpTable* 新表，内存不足时返回NULL。调用者需使用 held_karp_table_destroy() 释放。
+ */
+HeldKarpTable* held_karp_table_create(void);
+
+/**
+ * @brief 释放Held-Karp表。传入NULL时不做任何操作。
+ */
+void held_karp_table_destroy(HeldKarpTable* table);
+
+/**
+ * @brief 获取表中当前包含的点数。
+ */
+int held_karp_table_get_size(const HeldKarpTable* table);
+
+/**
+ * @brief 向表中追加一个点（编号为当前点数），只计算包含该点的子集。
+ * @details 成本矩阵中前 size+1 个点之间的成本必须已经就绪，且已有点之间的成本不能被修改过，
+ *          否则应当清空后重建。
+ *
+ * @param table Held-Karp表。
+ * @param cost 成本矩阵。
+ * @param stride 成本矩阵的行跨度。
+ * @param control 取消令牌，可为NULL。该函数只检查取消，不报告进度。
+ * @return bool 成功返回true。表已满或被取消时返回false，此时表保持追加前的状态。
+ */
+bool held_karp_table_extend(HeldKarpTable* table, const double* cost, int stride, const SolveControl* control);
+
+/**
+ * @brief 从表中删除一个点，保留所有不含该点的子集的结果，其后的点编号依次减一。
+ * @param table Held-Karp表。
+ * @param index 要删除的点的编号，必须在 [1, size) 范围内（起点不能删除）。
+ * @return bool 成功返回true，编号无效时返回false。
+ */
+bool held_karp_table_remove(HeldKarpTable* table, int index);
+
+/**
+ * @brief 清空Held-Karp表。
+ */
+void held_karp_table_clear(HeldKarpTable* table);
+
+/**
+ * @brief 从完整的表中读出最优环路。
+ *
+ * @param table Held-Karp表。
+ * @param cost 成本矩阵。
+ * @param stride 成本矩阵的行跨度。
+ * @param out_order 输出参数，长度至少为表的点数，返回以0开头的访问顺序。
+ * @return double 最优环路的总成本；表为空或不存在可行环路时返回 DBL_MAX。
+ */
+double held_karp_table_best_tour(const HeldKarpTable* table, const double* cost, int stride, int* out_order);
+
+/**
+ * @brief 计算一条环路（最后一个点返回第一个点）的总成本。
+ * @return double 总成本；任何一段不可达时返回 DBL_MAX。
+ */
+double tsp_tour_cost(const double* cost, int stride, const int* order, int len);
+
+/**
+ * @brief 最廉价插入：把一个点插入到环路中使总成本增加最少的位置。
+ *
+ * @param cost 成本矩阵。
+ * @param stride 成本矩阵的行跨度。
+ * @param order 当前环路，容量至少为 *len + 1。
+ * @param len 输入输出参数，环路中的点数，插入后加一。
+ * @param new_index 要插入的点的编号。
+ */
+void tsp_cheapest_insertion(const double* cost, int stride, int* order, int* len, int new_index);
+
+/**
+ * @brief 使用 2-opt 和 Or-opt 局部搜索改进环路，直到不再有改进。
+ * @details 适用于非对称成本矩阵：2-opt 的增量同时考虑了反转片段内部的方向变化。
+ *          order[0] 保持不动。
+ *
+ * @param cost 成本矩阵。
+ * @param stride 成本矩阵的行跨度。
+ * @param order 输入输出参数，要改进的环路。
+ * @param len 环路中的点数。
+ */
+void tsp_improve_tour(const double* cost, int stride, int* order, int len);
+
+/**
+ * @brief 使用 2-opt 和 Or-opt 局部搜索改进一条端点固定的开放路径。
+ * @details order[0] 和 order[len-1] 保持不动，只调整中间点的顺序。适合在拼接处做局部抛光。
+ *
+ * @param cost 成本矩阵。
+ * @param stride 成本矩阵的行跨度。
+ * @param order 输入输出参数，要改进的路径。
+ * @param len 路径中的点数。
+ */
+void tsp_improve_path(const double* cost, int stride, int* order, int len);
+
+/**
+ * @brief 在成本矩阵上求解环路：点数不超过 HELD_KARP_MAX_NODES 时精确求解，否则使用最廉价插入加局部搜索。
+ *
+ * @param cost 成本矩阵。
+ * @param stride 成本矩阵的行跨度。
+ * @param n 点数。
+ * @param out_order 输出参数，长度至少为n，返回以0开头的访问顺序。
+ * @param is_optimal 可选的输出参数，结果为精确最优解时置为true。可以传入NULL。
+ * @return double 环路总成本；不存在可行环路时返回 DBL_MAX。
+ */
+double tsp_solve_matrix(const double* cost, int stride, int n, int* out_order, bool* is_optimal);
+
+#endif // TSP_MATRIX_H
@@ -55,6 +55,15 @@ typedef enum {
     TRANSPORT_MODE_COUNT    ///< 交通方式的总数量，必须是最后一个。
 } TransportMode;
 
+/**
+ * @brief 交通方式的位集合，第 m 位对应 TransportMode m，用于限定查询允许使用的交通方式。
+ * @details 值为0时表示不限制，与 TRANSPORT_MODE_ALL 等价，因此全零初始化的查询条件默认允许所有交通方式。
+ */
+typedef unsigned int TransportModeMask;
+
+#define TRANSPORT_MODE_BIT(mode) (1u << (mode))                         ///< 单个交通方式对应的位。
+#define TRANSPORT_MODE_ALL ((1u << TRANSPORT_MODE_COUNT) - 1u)          ///< 所有交通方式。
+
 // 前向声明，因为 PathSegment 结构体中需要用到自己类型的指针。
 struct PathSegment;
 
@@ -92,6 +101,7 @@ typedef struct {
     double cost;                ///< 从起点到此节点的累计加权成本（时间+花费）。
     int predecessor_node_id;    ///< 在最短路径树上，此节点的前一个节点的ID。
     TransportMode predecessor_mode; ///< 从前驱节点到此节点所使用的交通方式。
+    double arrival_hours;       ///< 沿搜索树从起点到达此节点的累计时间（小时）。
 } DijkstraNode;
 
 /**
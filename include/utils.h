@@ -1,6 +1,7 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stdbool.h>
 #include "types.h"
 
 /**
@@ -17,4 +18,35 @@ const char* mode_to_string(TransportMode mode);
  */
 const char* mode_to_string_cn(TransportMode mode);
 
+/**
+ * @brief 将英文字符串解析为交通方式枚举，是 mode_to_string() 的逆操作。
+ * @param name 英文名称，例如 "driving"。
+ * @return int 对应的交通方式；无法识别时返回-1。
+ */
+int mode_from_string(const char* name);
+
+/**
+ * @brief 将逗号分隔的英文名称列表解析为交通方式集合，例如 "driving,high_speed_rail"。
+ * @details "all" 表示所有交通方式。
+ * @param names 名称列表。
+ * @param mask 输出解析得到的集合。
+ * @return bool 列表为空、含有无法识别的名称或空名称（开头、结尾或连续的逗号）时返回false，mask 保持不变。
+ */
+bool mode_mask_from_string(const char* names, TransportModeMask* mask);
+
+/**
+ * @brief 把交通方式集合展开为按枚举顺序排列的交通方式列表，集合为0时展开为所有交通方式。
+ * @param mask 交通方式集合。
+ * @param modes 输出列表，长度至少为 TRANSPORT_MODE_COUNT。
+ * @return int 列表中的交通方式数。
+ */
+int mode_mask_expand(TransportModeMask mask, TransportMode* modes);
+
+/**
+ * @brief 读取单调时钟的当前时刻。
+ * @details 不受系统时间调整影响，适合用于计算超时和截止时间。
+ * @return double 自某个固定起点以来经过的秒数。
+ */
+double monotonic_time_seconds(void);
+
 #endif // UTILS_H 
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef VRP_H
+#define VRP_H
+
+#include <stdbool.h>
+#include "graph.h"
+#include "solve_control.h"
+#include "types.h"
+
+/**
+ * @file vrp.h
+ * @brief 多旅行者路径规划（mTSP/VRP）：把途经点分配给多名旅行者并为每人排定访问顺序。
+ * @details 所有旅行者从同一个起点（途经点数组的第一个元素）出发并返回。求解使用大邻域搜索（LNS）：
+ *          每次迭代用随机、最差或相关移除破坏一部分分配，再用最廉价插入或后悔值插入修复，
+ *          修复后的路线用 2-opt/Or-opt 改进，按模拟退火准则接受。
+ *          多个搜索线程各自独立迭代，发现更好的解时写入共享的最优解，并定期从共享最优解重新出发。
+ */
+
+/**
+ * @brief 多旅行者路径规划的优化目标。
+ */
+typedef enum {
+    VRP_MINIMIZE_TOTAL,     ///< 最小化所有路线的加权成本之和。
+    VRP_MINIMIZE_MAX_ROUTE, ///< 最小化最长路线的加权成本（使各人的行程尽量均衡）。
+} VrpObjective;
+
+/**
+ * @brief 多旅行者路径规划的参数。
+ */
+typedef struct {
+    int num_travellers;         ///< 旅行者（车辆）数量。
+    int max_stops_per_route;    ///< 每人最多访问的途经点数（不含起点），0表示不限。
+    VrpObjective objective;     ///< 优化目标。
+    int num_threads;            ///< 独立搜索线程数，0表示与默认线程池大小相同。
+    int iterations;             ///< 每个线程的最大迭代次数。
+    double time_limit_ms;       ///< 搜索的时间限制（毫秒），小于等于0表示只受迭代次数限制。
+    unsigned int seed;          ///< 随机种子。单线程且不限时时，相同种子得到相同结果。
+} VrpOptions;
+
+/**
+ * @brief 多旅行者路径规划的结果。
+ */
+typedef struct {
+    int num_routes;         ///< 路线数，等于旅行者数量。
+    int** stop_ids;         ///< stop_ids[r]：第r名旅行者依次访问的节点ID（不含起点）。
+    int* stop_counts;       ///< 每名旅行者访问的途经点数，为0表示该旅行者不出行。
+    RoutePath** routes;     ///< 每名旅行者从起点出发并返回的完整路线，不出行时为NULL。
+    double* route_costs;    ///< 每条路线的加权成本。
+    double total_cost;      ///< 所有路线的加权成本之和。
+    double max_route_cost;  ///< 最长路线的加权成本。
+} VrpResult;
+
+/**
+ * @brief 用默认值填充参数（2名旅行者，不限人均途经点数，最小化总成本，每线程2000次迭代，限时10秒）。
+ * @param options 要填充的参数结构体。
+ */
+void vrp_default_options(VrpOptions* options);
+
+/**
+ * @brief 求解多旅行者路径规划。
+ *
+ * @param network 指向交通网络实例的只读指针。
+ * @param node_ids_to_visit 待访问节点ID数组，第一个元素为所有旅行者共同的起点和终点。
+ * @param num_nodes 待访问节点的数量（含起点）。
+ * @param time_weight 时间权重。
+ * @param cost_weight 花费权重。
+ * @param options 求解参数，传入NULL时使用默认值。
+ * @param control 取消令牌与进度回调，可为NULL。进度分为 "cost_matrix"、"search" 和 "legs" 三个阶段。
+ * @return VrpResult* 成功时返回结果，调用者需使用 free_vrp_result() 释放。
+ *         参数无效、不存在可行分配或被取消时返回NULL。
+ */
+VrpResult* solve_vrp(const TrafficNetwork* network, const int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight,
+                     const VrpOptions* options, const SolveControl* control);
+
+/**
+ * @brief 释放多旅行者路径规划的结果。传入NULL时不做任何操作。
+ */
+void free_vrp_result(VrpResult* result);
+
+#endif // VRP_H
@@ -0,0 +1,446 @@
+/**
+ * @file assignment.c
+ * @brief 实现了基于 Frank-Wolfe 算法和 BPR 路阻函数的用户均衡交通分配。
+ */
+#include "assignment.h"
+#include "csr_engine.h"
+#include "pathfinding.h"
+#include "thread_pool.h"
+#include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 线搜索的二分次数，步长精度约为 2^-30
+#define LINE_SEARCH_STEPS 30
+
+/**
+ * @brief 每个工作线程复用的最短路径工作区。
+ */
+typedef struct {
+    double* dist;               // 从起点出发的加权成本
+    int* pred_link;             // 到达该节点使用的路段，-1表示没有
+    unsigned char* settled;
+    CsrOpenSet open;
+} OriginWorkspace;
+
+/**
+ * @brief 所有迭代共享的路段数据。路段使用压缩邻接表（见 csr_engine.h）的编号。
+ */
+typedef struct {
+    const TrafficNetwork* network;
+    const double* demand;
+    const AssignmentOptions* options;
+    const SolveControl* control;
+    int node_count;
+
+    CsrLinkTable* links;        // 可用路段；link_hours 为自由流时间（含交通事件减速）
+    int* link_from;             // 每条路段的起点
+    TransportMode* link_mode;   // 每条路段的交通方式
+    double* factors;            // 每条路段当前的拥堵倍数
+    double time_coefficient;    // 加权成本 = 用时 × time_coefficient + 花费 × money_coefficient
+    double money_coefficient;
+
+    int* origins;               // 有出行需求的起点
+    int origin_count;
+
+    // 每个工作线程独立的工作区
+    int worker_count;
+    OriginWorkspace* workspaces;
+    double** aon_flows;         // 全有全无分配的流量
+    double* shortest_costs;     // 各线程累计的 需求 × 最短路径成本
+    double* unassigned;         // 各线程累计的不可达需求
+    int failed;                 // 任一线程失败时置1（原子写入）
+} AssignmentContext;
+
+void assignment_default_options(AssignmentOptions* options) {
+    if (!options) return;
+    options->time_weight = 1.0;
+    options->cost_weight = 0.0;
+    options->max_iterations = 100;
+    options->target_relative_gap = 1e-3;
+    options->bpr_alpha = 0.15;
+    options->bpr_beta = 4.0;
+    options->capacity[DRIVING] = 1800.0;
+    options->capacity[HIGH_SPEED_RAIL] = 6000.0;
+    options->capacity[FLIGHT] = 1500.0;
+    options->capacity[BUS] = 1200.0;
+}
+
+/**
+ * @brief BPR 路阻函数的拥堵倍数 1 + α (x/c)^β。
+ */
+static double bpr_factor(const AssignmentOptions* options, TransportMode mode, double flow) {
+    if (flow <= 0) return 1.0;
+    return 1.0 + options->bpr_alpha * pow(flow / options->capacity[mode], options->bpr_beta);
+}
+
+/**
+ * @brief 一条路段在给定流量下的加权成本，与寻路算法的边权一致。
+ */
+static double link_cost(const AssignmentContext* ctx, int link, double flow) {
+    double hours = ctx->links->link_hours[link] * bpr_factor(ctx->options, ctx->link_mode[link], flow);
+    return hours * ctx->time_coefficient + ctx->links->link_yuan[link] * ctx->money_coefficient;
+}
+
+/**
+ * @brief 在压缩邻接表上按当前拥堵倍数做 Dijkstra，得到起点到所有节点的最短路径（结果留在工作区中）。
+ * @return bool 被取消时返回false。
+ */
+static bool search_origin(const AssignmentContext* ctx, OriginWorkspace* ws, int origin) {
+    const CsrLinkTable* links = ctx->links;
+    for (int i = 0; i < ctx->node_count; i++) {
+        ws->dist[i] = DBL_MAX;
+        ws->pred_link[i] = -1;
+        ws->settled[i] = 0;
+    }
+    csr_open_set_clear(&ws->open);
+    ws->dist[origin] = 0.0;
+    csr_open_set_push(&ws->open, origin);
+
+    int u;
+    for (int iteration = 0; (u = csr_open_set_pop(&ws->open)) != -1; iteration++) {
+        if (iteration % SOLVE_CONTROL_CHECK_INTERVAL == 0 && solve_control_should_stop(ctx->control)) return false;
+        ws->settled[u] = 1;
+        for (int e = links->row_start[u * TRANSPORT_MODE_COUNT]; e < links->row_start[(u + 1) * TRANSPORT_MODE_COUNT]; e++) {
+            int v = links->link_to[e];
+            if (ws->settled[v]) continue;
+            double d = ws->dist[u] + links->link_hours[e] * ctx->factors[e] * ctx->time_coefficient + links->link_yuan[e] * ctx->money_coefficient;
+            if (d < ws->dist[v]) {
+                ws->dist[v] = d;
+                ws->pred_link[v] = e;
+                csr_open_set_push(&ws->open, v);
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief parallel_for 的任务项：从一个起点计算最短路径，把该起点的全部需求加载到最短路径上。
+ */
+static void load_origin(int index, int worker_id, void* context) {
+    AssignmentContext* ctx = (AssignmentContext*)context;
+    if (solve_control_should_stop(ctx->control)) return;
+    int n = ctx->node_count;
+    int origin = ctx->origins[index];
+    OriginWorkspace* ws = &ctx->workspaces[worker_id];
+    if (!search_origin(ctx, ws, origin)) {
+        __atomic_store_n(&ctx->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    double* flows = ctx->aon_flows[worker_id];
+    const double* row = &ctx->demand[(size_t)origin * n];
+    for (int d = 0; d < n; d++) {
+        if (row[d] <= 0 || d == origin) continue;
+        if (ws->dist[d] == DBL_MAX) {
+            ctx->unassigned[worker_id] += row[d];
+            continue;
+        }
+        ctx->shortest_costs[worker_id] += row[d] * ws->dist[d];
+
+        // 沿前驱路段从终点回溯到起点，逐段累加流量
+        for (int v = d; v != origin; v = ctx->link_from[ws->pred_link[v]]) flows[ws->pred_link[v]] += row[d];
+    }
+}
+
+static bool workspace_init(OriginWorkspace* ws, int n, bool use_heap) {
+    ws->dist = (double*)malloc(n * sizeof(double));
+    ws->pred_link = (int*)malloc(n * sizeof(int));
+    ws->settled = (unsigned char*)malloc(n);
+    bool open_ok = csr_open_set_init(&ws->open, n, ws->dist, use_heap);
+    return ws->dist && ws->pred_link && ws->settled && open_ok;
+}
+
+static void workspace_free(OriginWorkspace* ws) {
+    free(ws->dist);
+    free(ws->pred_link);
+    free(ws->settled);
+    csr_open_set_free(&ws->open);
+}
+
+/**
+ * @brief 全有全无分配：按当前拥堵倍数把所有需求加载到最短路径上。
+ *
+ * @param out_flows 输出的路段流量（只写入可用路段）。
+ * @param shortest_total 输出 Σ 需求 × 最短路径成本。
+ * @param unassigned 输出不可达的需求。
+ * @return bool 成功返回true；被取消或内存不足时返回false。
+ */
+static bool all_or_nothing(AssignmentContext* ctx, double* out_flows, double* shortest_total, double* unassigned) {
+    for (int w = 0; w < ctx->worker_count; w++) {
+        memset(ctx->aon_flows[w], 0, ctx->links->link_count * sizeof(double));
+        ctx->shortest_costs[w] = 0.0;
+        ctx->unassigned[w] = 0.0;
+    }
+    thread_pool_parallel_for(thread_pool_get_default(), ctx->origin_count, load_origin, ctx);
+    if (ctx->failed || solve_control_should_stop(ctx->control)) return false;
+
+    // 合并各线程的结果
+    *shortest_total = 0.0;
+    *unassigned = 0.0;
+    for (int w = 0; w < ctx->worker_count; w++) {
+        *shortest_total += ctx->shortest_costs[w];
+        *unassigned += ctx->unassigned[w];
+    }
+    for (int a = 0; a < ctx->links->link_count; a++) {
+        double sum = 0.0;
+        for (int w = 0; w < ctx->worker_count; w++) sum += ctx->aon_flows[w][a];
+        out_flows[a] = sum;
+    }
+    return true;
+}
+
+/**
+ * @brief 沿方向 (target - flows) 做线搜索：二分求 Beckmann 目标函数导数 Σ c_a(x + λd) d_a 的零点。
+ * @return double 步长 λ ∈ [0, 1]。
+ */
+static double line_search(const AssignmentContext* ctx, const double* flows, const double* target) {
+    double lo = 0.0, hi = 1.0;
+    for (int step = 0; step < LINE_SEARCH_STEPS; step++) {
+        double mid = 0.5 * (lo + hi);
+        double derivative = 0.0;
+        for (int a = 0; a < ctx->links->link_count; a++) {
+            double direction = target[a] - flows[a];
+            if (direction != 0.0) derivative += link_cost(ctx, a, flows[a] + mid * direction) * direction;
+        }
+        if (derivative > 0) hi = mid;
+        else lo = mid;
+    }
+    return 0.5 * (lo + hi);
+}
+
+static int compare_links_by_flow(const void* a, const void* b) {
+    double fa = ((const AssignedLink*)a)->flow;
+    double fb = ((const AssignedLink*)b)->flow;
+    return (fa < fb) - (fa > fb);
+}
+
+/**
+ * @brief 构建路段表：在共享的压缩邻接表之上补充每条路段的起点和交通方式，拥堵倍数初始为1。
+ */
+static bool build_links(AssignmentContext* ctx) {
+    ctx->links = csr_link_table_build(ctx->network);
+    if (!ctx->links) return false;
+    int count = ctx->links->link_count;
+    ctx->link_from = (int*)malloc((count + 1) * sizeof(int));
+    ctx->link_mode = (TransportMode*)malloc((count + 1) * sizeof(TransportMode));
+    ctx->factors = (double*)malloc((count + 1) * sizeof(double));
+    if (!ctx->link_from || !ctx->link_mode || !ctx->factors) return false;
+    for (int u = 0; u < ctx->node_count; u++) {
+        for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+            int row = u * TRANSPORT_MODE_COUNT + m;
+            for (int a = ctx->links->row_start[row]; a < ctx->links->row_start[row + 1]; a++) {
+                ctx->link_from[a] = u;
+                ctx->link_mode[a] = (TransportMode)m;
+                ctx->factors[a] = 1.0;
+            }
+        }
+    }
+    return true;
+}
+
+// 交通分配求解的实现
+AssignmentResult* solve_traffic_assignment(const TrafficNetwork* network, const double* demand, const AssignmentOptions* options,
+                                           const SolveControl* control) {
+    if (!network || !demand) return NULL;
+    AssignmentOptions defaults;
+    if (!options) {
+        assignment_default_options(&defaults);
+        options = &defaults;
+    }
+    for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+        if (!(options->capacity[m] > 0)) {
+            fprintf(stderr, "错误: 交通分配的通行能力必须大于0。\n");
+            return NULL;
+        }
+    }
+
+    int n = traffic_network_get_node_count(network);
+    AssignmentContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.network = network;
+    ctx.demand = demand;
+    ctx.options = options;
+    ctx.control = control;
+    ctx.node_count = n;
+    int pool_size = thread_pool_get_size(thread_pool_get_default());
+    ctx.worker_count = pool_size > 0 ? pool_size : 1;
+    // 加权成本对用时和花费是线性的，预先求出系数
+    ctx.time_coefficient = calculate_weighted_leg_cost(1.0, 0.0, options->time_weight, options->cost_weight);
+    ctx.money_coefficient = calculate_weighted_leg_cost(0.0, 1.0, options->time_weight, options->cost_weight);
+
+    double* flows = NULL;
+    double* target = NULL;
+    ctx.origins = (int*)malloc(n * sizeof(int));
+    ctx.workspaces = (OriginWorkspace*)calloc(ctx.worker_count, sizeof(OriginWorkspace));
+    ctx.aon_flows = (double**)calloc(ctx.worker_count, sizeof(double*));
+    ctx.shortest_costs = (double*)calloc(ctx.worker_count, sizeof(double));
+    ctx.unassigned = (double*)calloc(ctx.worker_count, sizeof(double));
+    AssignmentResult* result = (AssignmentResult*)calloc(1, sizeof(AssignmentResult));
+    bool ok = ctx.origins && ctx.workspaces && ctx.aon_flows && ctx.shortest_costs && ctx.unassigned && result && build_links(&ctx);
+    if (ok) {
+        flows = (double*)calloc(ctx.links->link_count + 1, sizeof(double));
+        target = (double*)calloc(ctx.links->link_count + 1, sizeof(double));
+        ok = flows && target;
+    }
+    bool use_heap = ok && csr_link_table_prefers_heap(ctx.links, TRANSPORT_MODE_ALL);
+    for (int w = 0; ok && w < ctx.worker_count; w++) {
+        ctx.aon_flows[w] = (double*)malloc((ctx.links->link_count + 1) * sizeof(double));
+        ok = ctx.aon_flows[w] != NULL && workspace_init(&ctx.workspaces[w], n, use_heap);
+    }
+    if (!ok) goto fail;
+
+    // 只从有出行需求的起点计算最短路径树
+    for (int o = 0; o < n; o++) {
+        bool has_demand = false;
+        for (int d = 0; d < n; d++) {
+            if (d != o && demand[(size_t)o * n + d] > 0) {
+                has_demand = true;
+                result->total_demand += demand[(size_t)o * n + d];
+            }
+        }
+        if (has_demand) ctx.origins[ctx.origin_count++] = o;
+    }
+
+    // 初始解：自由流状态下的全有全无分配
+    double shortest_total, unassigned;
+    if (!all_or_nothing(&ctx, flows, &shortest_total, &unassigned)) goto fail;
+    result->unassigned_demand = unassigned;
+    result->relative_gap = 1.0;
+
+    for (int iteration = 1; iteration <= options->max_iterations; iteration++) {
+        // 1. 按当前流量更新拥堵倍数，并计算总出行成本 Σ c_a(x_a) x_a
+        double total_cost = 0.0;
+        for (int a = 0; a < ctx.links->link_count; a++) {
+            ctx.factors[a] = bpr_factor(options, ctx.link_mode[a], flows[a]);
+            if (flows[a] > 0) total_cost += link_cost(&ctx, a, flows[a]) * flows[a];
+        }
+
+        // 2. 在当前成本下做全有全无分配，得到下降方向和相对间隙
+        if (!all_or_nothing(&ctx, target, &shortest_total, &unassigned)) goto fail;
+        result->iterations = iteration;
+        result->relative_gap = total_cost > 0 ? (total_cost - shortest_total) / total_cost : 0.0;
+        solve_control_report_progress(control, "assignment", (double)iteration / options->max_iterations);
+        if (result->relative_gap <= options->target_relative_gap) {
+            result->converged = true;
+            break;
+        }
+
+        // 3. 线搜索并沿方向更新流量
+        double lambda = line_search(&ctx, flows, target);
+        for (int a = 0; a < ctx.links->link_count; a++) {
+            flows[a] += lambda * (target[a] - flows[a]);
+        }
+    }
+    if (solve_control_should_stop(control)) goto fail; // 在最后一次迭代的进度回调中被取消
+
+    // 4. 输出有流量的路段
+    for (int a = 0; a < ctx.links->link_count; a++) {
+        if (flows[a] > 1e-9) result->link_count++;
+    }
+    result->links = (AssignedLink*)malloc((result->link_count + 1) * sizeof(AssignedLink));
+    if (!result->links) goto fail;
+    int count = 0;
+    for (int a = 0; a < ctx.links->link_count; a++) {
+        if (flows[a] <= 1e-9) continue;
+        AssignedLink* link = &result->links[count++];
+        link->mode = ctx.link_mode[a];
+        link->from_node_id = ctx.link_from[a];
+        link->to_node_id = ctx.links->link_to[a];
+        link->flow = flows[a];
+        link->free_flow_hours = ctx.links->link_hours[a];
+        link->congested_hours = ctx.links->link_hours[a] * bpr_factor(options, link->mode, flows[a]);
+        link->saturation = flows[a] / options->capacity[link->mode];
+        result->total_travel_hours += link->flow * link->congested_hours;
+    }
+    qsort(result->links, result->link_count, sizeof(AssignedLink), compare_links_by_flow);
+    goto cleanup;
+
+fail:
+    free_assignment_result(result);
+    result = NULL;
+
+cleanup:
+    for (int w = 0; w < ctx.worker_count; w++) {
+        if (ctx.workspaces) workspace_free(&ctx.workspaces[w]);
+        if (ctx.aon_flows) free(ctx.aon_flows[w]);
+    }
+    free(ctx.workspaces);
+    free(ctx.aon_flows);
+    free(ctx.shortest_costs);
+    free(ctx.unassigned);
+    free(ctx.origins);
+    csr_link_table_free(ctx.links);
+    free(ctx.link_from);
+    free(ctx.link_mode);
+    free(ctx.factors);
+    free(flows);
+    free(target);
+    return result;
+}
+
+void free_assignment_result(AssignmentResult* result) {
+    if (!result) return;
+    free(result->links);
+    free(result);
+}
+
+/**
+ * @brief 把起讫点名称解析为节点ID：先按节点名称查找，再按城市名称取该城市的第一个地标。
+ */
+static int resolve_endpoint(const TrafficNetwork* network, const char* name) {
+    int node_id = traffic_network_find_node_id_by_name(network, name);
+    if (node_id >= 0) return node_id;
+    for (int c = 0; c < network->city_count; c++) {
+        if (strcmp(network->cities[c].city_name, name) == 0) return network->cities[c].landmark_node_id;
+    }
+    return -1;
+}
+
+// 加载起讫点需求矩阵的实现
+double* assignment_load_demand_csv(const TrafficNetwork* network, const char* csv_path) {
+    if (!network || !csv_path) return NULL;
+    FILE* fp = fopen(csv_path, "rb");
+    if (!fp) {
+        fprintf(stderr, "错误：无法打开文件 %s (错误码: %d)\n", csv_path, errno);
+        return NULL;
+    }
+    int n = traffic_network_get_node_count(network);
+    double* demand = (double*)calloc((size_t)n * n, sizeof(double));
+    if (!demand) {
+        fclose(fp);
+        return NULL;
+    }
+
+    char line[512];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line_no == 1 || line[0] == '\0' || line[0] == '#') continue; // 跳过表头、空行和注释
+
+        char origin[100], destination[100];
+        double trips;
+        if (sscanf(line, "%99[^,],%99[^,],%lf", origin, destination, &trips) != 3 || trips < 0) {
+            fprintf(stderr, "错误: %s 第%d行格式错误。\n", csv_path, line_no);
+            free(demand);
+            fclose(fp);
+            return NULL;
+        }
+        int o = resolve_endpoint(network, origin);
+        int d = resolve_endpoint(network, destination);
+        if (o < 0 || d < 0) {
+            fprintf(stderr, "错误: %s 第%d行的起讫点 %s 或 %s 不存在。\n", csv_path, line_no, origin, destination);
+            free(demand);
+            fclose(fp);
+            return NULL;
+        }
+        demand[(size_t)o * n + d] += trips;
+    }
+    fclose(fp);
+    return demand;
+}
@@ -0,0 +1,384 @@
+/**
+ * @file batch_pipeline.c
+ * @brief 实现了批量路线规划的三级流水线：解析线程 → N 个寻路线程 → 输出线程。
+ * @details 每条查询是一个堆上的 BatchItem，沿流水线传递指针，由输出线程释放。
+ *          输入结束（或被取消）时，解析线程向每个寻路线程的输入队列放入一个NULL作为结束标记，
+ *          寻路线程把它转发到自己的输出队列后退出，输出线程取到第一个NULL即表示所有查询都已写出。
+ */
+#include "batch_pipeline.h"
+#include "pathfinding.h"
+#include "routing_engine.h"
+#include "spsc_ring.h"
+#include "thread_pool.h"
+#include "utils.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 一行最多的字段数：起点、终点、时间权重、花费权重、交通方式
+#define BATCH_MAX_FIELDS 5
+
+// 估计寻路引擎的工作量时，假定输入平均每行的字节数
+#define BATCH_BYTES_PER_LINE 16
+
+// 输出文件的缓冲区大小
+#define BATCH_OUTPUT_BUFFER (64 * 1024)
+
+typedef enum {
+    BATCH_PENDING,          // 等待寻路
+    BATCH_OK,
+    BATCH_INVALID,
+    BATCH_UNKNOWN_NODE,
+    BATCH_NO_ROUTE,
+    BATCH_CANCELLED
+} BatchStatus;
+
+static const char* const STATUS_NAMES[] = { "pending", "ok", "invalid", "unknown_node", "no_route", "cancelled" };
+
+/**
+ * @brief 一条查询及其结果。
+ */
+typedef struct {
+    long line_number;               // 在输入文件中的行号（从1开始）
+    BatchStatus status;
+    int from;
+    int to;
+    RouteQueryOptions options;
+    char from_text[sizeof(((Node*)0)->name)];  // 输入中的起终点原文，用于无法规划时的输出
+    char to_text[sizeof(((Node*)0)->name)];
+    RoutePath* path;
+} BatchItem;
+
+/**
+ * @brief 各级线程共享的流水线状态。
+ */
+typedef struct {
+    const TrafficNetwork* network;
+    const RoutingEngine* engine;
+    const SolveControl* control;
+    FILE* input;
+    long input_size;
+    int worker_count;
+    SpscRing** inputs;      // 第 i 个寻路线程的输入队列，生产者是解析线程
+    SpscRing** outputs;     // 第 i 个寻路线程的输出队列，消费者是输出线程
+    bool out_of_memory;     // 由解析线程写，所有线程结束后才读
+} BatchPipeline;
+
+typedef struct {
+    BatchPipeline* pipeline;
+    int index;
+} BatchWorker;
+
+void batch_options_init(BatchOptions* options) {
+    options->worker_count = 0;
+    options->queue_capacity = 256;
+}
+
+// --- 解析 ---
+
+static char* trim(char* text) {
+    while (*text == ' ' || *text == '\t') text++;
+    size_t length = strlen(text);
+    while (length > 0 && strchr(" \t\r\n", text[length - 1])) text[--length] = '\0';
+    return text;
+}
+
+/**
+ * @brief 按名称或节点ID查找节点，与查询服务的规则相同。
+ */
+static int resolve_node(const TrafficNetwork* network, const char* name) {
+    int id = traffic_network_find_node_id_by_name(network, name);
+    if (id >= 0 || name[0] == '\0' || strspn(name, "0123456789") != strlen(name) || strlen(name) > 9) return id;
+    id = atoi(name);
+    return id < traffic_network_get_node_count(network) ? id : -1;
+}
+
+static bool parse_weight(const char* text, double* value) {
+    char* end;
+    *value = strtod(text, &end);
+    return end != text && *end == '\0' && *value >= 0.0;
+}
+
+/**
+ * @brief 解析一行输入，填写查询或错误状态。
+ */
+static void parse_line(const TrafficNetwork* network, char* line, BatchItem* item) {
+    char* fields[BATCH_MAX_FIELDS];
+    int field_count = 0;
+    for (char* field = line; field;) {
+        char* comma = strchr(field, ',');
+        if (comma) *comma = '\0';
+        if (field_count == BATCH_MAX_FIELDS) {
+            field_count++;  // 字段过多
+            break;
+        }
+        fields[field_count++] = trim(field);
+        field = comma ? comma + 1 : NULL;
+    }
+
+    item->status = BATCH_INVALID;
+    item->options.time_weight = 0.5;
+    item->options.cost_weight = 0.5;
+    if (field_count >= 1) snprintf(item->from_text, sizeof(item->from_text), "%s", fields[0]);
+    if (field_count >= 2) snprintf(item->to_text, sizeof(item->to_text), "%s", fields[1]);
+    if (field_count != 2 && field_count != 4 && field_count != 5) return;
+    if (field_count >= 4 &&
+        (!parse_weight(fields[2], &item->options.time_weight) || !parse_weight(fields[3], &item->options.cost_weight))) {
+        return;
+    }
+    if (field_count == 5) {
+        // 字段本身以逗号分隔，交通方式列表在输入中用分号
+        for (char* c = fields[4]; *c; c++) {
+            if (*c == ';') *c = ',';
+        }
+        if (!mode_mask_from_string(fields[4], &item->options.allowed_modes)) return;
+    }
+
+    item->from = resolve_node(network, fields[0]);
+    item->to = resolve_node(network, fields[1]);
+    item->status = item->from >= 0 && item->to >= 0 ? BATCH_PENDING : BATCH_UNKNOWN_NODE;
+}
+
+/**
+ * @brief 解析线程：逐行读取输入，轮流交给各寻路线程，结束时向每个输入队列放入结束标记。
+ */
+static void* parse_stage(void* arg) {
+    BatchPipeline* pipeline = (BatchPipeline*)arg;
+    char* line = NULL;
+    size_t line_capacity = 0;
+    ssize_t length;
+    long line_number = 0;
+    long bytes_read = 0;
+    long item_count = 0;
+    while ((length = getline(&line, &line_capacity, pipeline->input)) >= 0) {
+        line_number++;
+        bytes_read += (long)length;
+        if (line_number % SOLVE_CONTROL_CHECK_INTERVAL == 0) {
+            if (solve_control_should_stop(pipeline->control)) break;
+            if (pipeline->input_size > 0) {
+                solve_control_report_progress(pipeline->control, "batch", (double)bytes_read / pipeline->input_size);
+            }
+        }
+        char* text = trim(line);
+        if (text[0] == '\0' || text[0] == '#') continue;
+
+        BatchItem* item = (BatchItem*)calloc(1, sizeof(BatchItem));
+        if (!item) {
+            pipeline->out_of_memory = true;
+            break;
+        }
+        item->line_number = line_number;
+        parse_line(pipeline->network, text, item);
+        spsc_ring_push(pipeline->inputs[item_count++ % pipeline->worker_count], item);
+    }
+    free(line);
+    for (int i = 0; i < pipeline->worker_count; i++) {
+        spsc_ring_push(pipeline->inputs[i], NULL);
+    }
+    return NULL;
+}
+
+// --- 寻路 ---
+
+/**
+ * @brief 寻路线程：计算输入队列中的每条查询，按原顺序放入输出队列，并转发结束标记。
+ */
+static void* route_stage(void* arg) {
+    BatchWorker* worker = (BatchWorker*)arg;
+    BatchPipeline* pipeline = worker->pipeline;
+    SpscRing* input = pipeline->inputs[worker->index];
+    SpscRing* output = pipeline->outputs[worker->index];
+    BatchItem* item;
+    while ((item = (BatchItem*)spsc_ring_pop(input)) != NULL) {
+        if (item->status == BATCH_PENDING) {
+            if (solve_control_should_stop(pipeline->control)) {
+                item->status = BATCH_CANCELLED;
+            } else {
+                item->path = routing_engine_query(pipeline->engine, item->from, item->to, &item->options, pipeline->control);
+                if (item->path) {
+                    item->status = BATCH_OK;
+                } else {
+                    item->status = solve_control_should_stop(pipeline->control) ? BATCH_CANCELLED : BATCH_NO_ROUTE;
+                }
+            }
+        }
+        spsc_ring_push(output, item);
+    }
+    spsc_ring_push(output, NULL);
+    return NULL;
+}
+
+// --- 输出 ---
+
+/**
+ * @brief 写一个CSV字段，含有逗号、引号或换行时加引号。
+ */
+static void write_csv_field(FILE* out, const char* text) {
+    if (!strpbrk(text, ",\"\r\n")) {
+        fputs(text, out);
+        return;
+    }
+    fputc('"', out);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"') fputc('"', out);
+        fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+static void write_item(FILE* out, const TrafficNetwork* network, const BatchItem* item) {
+    const char* from = item->from_text;
+    const char* to = item->to_text;
+    if (item->status != BATCH_INVALID && item->status != BATCH_UNKNOWN_NODE) {
+        from = traffic_network_get_node_by_id(network, item->from)->name;
+        to = traffic_network_get_node_by_id(network, item->to)->name;
+    }
+    fprintf(out, "%ld,", item->line_number);
+    write_csv_field(out, from);
+    fputc(',', out);
+    write_csv_field(out, to);
+    fprintf(out, ",%s,", STATUS_NAMES[item->status]);
+    if (item->status != BATCH_OK) {
+        fputs(",,,\n", out);
+        return;
+    }
+    const RoutePath* path = item->path;
+    fprintf(out, "%.2f,%.2f,%.2f,", path->total_distance, path->total_time, path->total_cost);
+    // 路线形如 起点 -交通方式-> 中转点 -交通方式-> 终点（节点名称中没有逗号，整个字段不需要加引号）
+    const PathSegment* seg = path->segments_head;
+    fputs(seg ? traffic_network_get_node_by_id(network, seg->from_node_id)->name : from, out);
+    for (; seg; seg = seg->next) {
+        fprintf(out, " -%s-> %s", mode_to_string(seg->mode), traffic_network_get_node_by_id(network, seg->to_node_id)->name);
+    }
+    fputc('\n', out);
+}
+
+// --- 流水线 ---
+
+static void destroy_rings(SpscRing** rings, int count) {
+    if (!rings) return;
+    for (int i = 0; i < count; i++) spsc_ring_destroy(rings[i]);
+    free(rings);
+}
+
+static SpscRing** create_rings(int count, int capacity) {
+    SpscRing** rings = (SpscRing**)calloc(count, sizeof(SpscRing*));
+    if (!rings) return NULL;
+    for (int i = 0; i < count; i++) {
+        rings[i] = spsc_ring_create((size_t)capacity);
+        if (!rings[i]) {
+            destroy_rings(rings, count);
+            return NULL;
+        }
+    }
+    return rings;
+}
+
+bool batch_route_file(const TrafficNetwork* network, const char* input_path, const char* output_path, const BatchOptions* options,
+                      const SolveControl* control, BatchStats* out_stats) {
+    double start_time = monotonic_time_seconds();
+    if (out_stats) memset(out_stats, 0, sizeof(*out_stats));
+    BatchOptions config;
+    if (options) {
+        config = *options;
+    } else {
+        batch_options_init(&config);
+    }
+    if (config.worker_count <= 0) config.worker_count = thread_pool_get_size(thread_pool_get_default());
+    if (config.worker_count <= 0) config.worker_count = 1;
+    if (config.queue_capacity <= 0) config.queue_capacity = 256;
+
+    FILE* input = fopen(input_path, "r");
+    if (!input) {
+        fprintf(stderr, "错误: 无法打开输入文件 %s\n", input_path);
+        return false;
+    }
+    FILE* output = fopen(output_path, "w");
+    if (!output) {
+        fprintf(stderr, "错误: 无法创建输出文件 %s\n", output_path);
+        fclose(input);
+        return false;
+    }
+    setvbuf(output, NULL, _IOFBF, BATCH_OUTPUT_BUFFER);
+
+    BatchPipeline pipeline = { network, NULL, control, input, 0, config.worker_count, NULL, NULL, false };
+    if (fseek(input, 0, SEEK_END) == 0) {
+        pipeline.input_size = ftell(input);
+        rewind(input);
+    }
+
+    // 所有寻路线程共用一个引擎；按输入文件的大小估计查询次数，让选择器判断预处理是否划算
+    RoutingWorkload workload = { ROUTING_POINT_TO_POINT, (int)(pipeline.input_size / BATCH_BYTES_PER_LINE) + 1, 0 };
+    RoutingEngine* engine = routing_engine_create(routing_engine_select(network, &workload), network);
+    pipeline.engine = engine;
+    pipeline.inputs = create_rings(config.worker_count, config.queue_capacity);
+    pipeline.outputs = create_rings(config.worker_count, config.queue_capacity);
+    BatchWorker* workers = (BatchWorker*)calloc(config.worker_count, sizeof(BatchWorker));
+    pthread_t* threads = (pthread_t*)calloc(config.worker_count, sizeof(pthread_t));
+    bool ok = engine && pipeline.inputs && pipeline.outputs && workers && threads;
+    if (!ok) fprintf(stderr, "错误: 内存不足，无法启动批量规划\n");
+
+    // 线程创建失败时用已经启动的寻路线程继续
+    int started = 0;
+    for (; ok && started < config.worker_count; started++) {
+        workers[started].pipeline = &pipeline;
+        workers[started].index = started;
+        if (pthread_create(&threads[started], NULL, route_stage, &workers[started]) != 0) break;
+    }
+    pipeline.worker_count = started;
+    pthread_t parser;
+    bool parser_started = started > 0 && pthread_create(&parser, NULL, parse_stage, &pipeline) == 0;
+    if (ok && !parser_started) {
+        fprintf(stderr, "错误: 无法创建批量规划线程\n");
+        ok = false;
+        for (int i = 0; i < started; i++) spsc_ring_push(pipeline.inputs[i], NULL);
+    }
+
+    long query_count = 0;
+    long routed_count = 0;
+    if (started > 0) {
+        fputs("line,from,to,status,distance_km,time_hours,cost_yuan,route\n", output);
+        for (long k = 0;; k++) {
+            BatchItem* item = (BatchItem*)spsc_ring_pop(pipeline.outputs[k % started]);
+            if (!item) break;
+            write_item(output, network, item);
+            query_count++;
+            if (item->status == BATCH_OK) routed_count++;
+            if (item->status == BATCH_CANCELLED) ok = false;
+            free_route_path(item->path);
+            free(item);
+        }
+    }
+
+    if (parser_started) pthread_join(parser, NULL);
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    if (pipeline.out_of_memory) {
+        fprintf(stderr, "错误: 内存不足，批量规划提前结束\n");
+        ok = false;
+    }
+    if (solve_control_should_stop(control)) ok = false;
+    if (ferror(input)) {
+        fprintf(stderr, "错误: 读取输入文件 %s 失败\n", input_path);
+        ok = false;
+    }
+    bool write_failed = ferror(output) != 0;
+    if (fclose(output) != 0 || write_failed) {
+        fprintf(stderr, "错误: 写入输出文件 %s 失败\n", output_path);
+        ok = false;
+    }
+    fclose(input);
+    free(threads);
+    free(workers);
+    destroy_rings(pipeline.inputs, config.worker_count);
+    destroy_rings(pipeline.outputs, config.worker_count);
+    routing_engine_destroy(engine);
+
+    if (ok && control && pipeline.input_size > 0) solve_control_report_progress(control, "batch", 1.0);
+    if (out_stats) {
+        out_stats->query_count = query_count;
+        out_stats->routed_count = routed_count;
+        out_stats->elapsed_seconds = monotonic_time_seconds() - start_time;
+    }
+    return ok;
+}
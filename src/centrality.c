@@ -0,0 +1,326 @@
+/**
+ * @file centrality.c
+ * @brief 实现了基于 Brandes 算法的并行介数中心性计算。
+ */
+#include "centrality.h"
+#include "csr_engine.h"
+#include "pathfinding.h"
+#include "thread_pool.h"
+#include "utils.h"
+#include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 两条路径的加权成本相对误差在此范围内时视为并列最优
+#define TIE_TOLERANCE 1e-9
+
+/**
+ * @brief 所有起点共享的数据。路段使用压缩邻接表（见 csr_engine.h）的编号。
+ */
+typedef struct {
+    const TrafficNetwork* network;
+    const SolveControl* control;
+    int node_count;
+
+    CsrLinkTable* links;
+    double* link_weight;        // 每条路段的加权成本
+    TransportMode modes[TRANSPORT_MODE_COUNT]; // 允许的交通方式
+    int mode_count;
+    bool use_heap;              // 开放集使用二叉堆还是线性扫描
+
+    char* is_endpoint;          // 节点是否在起讫点范围内
+    int* sources;
+    int source_count;
+
+    int worker_count;
+    struct BrandesWorkspace* workspaces;
+    pthread_mutex_t progress_mutex; // 串行化进度回调
+    int completed_sources;          // 已完成的起点数（受 progress_mutex 保护）
+} CentralityContext;
+
+/**
+ * @brief 每个工作线程复用的工作区和介数累加器。
+ */
+typedef struct BrandesWorkspace {
+    double* dist;
+    double* sigma;              // 最短路径条数
+    double* delta;              // 依赖值
+    int* order;                 // 按出队顺序排列的节点
+    int* position;              // 节点在 order 中的位置，-1表示未出队
+    CsrOpenSet open;            // 以 dist 为键的开放集
+    double* betweenness;        // 本线程累加的介数
+} BrandesWorkspace;
+
+static bool is_tie(double a, double b) {
+    return fabs(a - b) <= TIE_TOLERANCE * fmax(fabs(a), fabs(b));
+}
+
+/**
+ * @brief 构建可用路段表：使用寻路引擎共享的压缩邻接表，并预先算好每条路段的加权成本。
+ * @details 搜索时只访问允许的交通方式所在的行。
+ */
+static bool build_links(CentralityContext* ctx, const CentralityOptions* options) {
+    ctx->links = csr_link_table_build(ctx->network);
+    if (!ctx->links) return false;
+    ctx->link_weight = (double*)malloc((ctx->links->link_count + 1) * sizeof(double));
+    if (!ctx->link_weight) return false;
+    for (int e = 0; e < ctx->links->link_count; e++) {
+        ctx->link_weight[e] = calculate_weighted_leg_cost(ctx->links->link_hours[e], ctx->links->link_yuan[e], options->time_weight,
+                                                          options->cost_weight);
+    }
+    ctx->mode_count = mode_mask_expand(options->allowed_modes, ctx->modes);
+    ctx->use_heap = csr_link_table_prefers_heap(ctx->links, options->allowed_modes);
+    return true;
+}
+
+/**
+ * @brief parallel_for 的任务项：从一个起点做 Dijkstra 并统计最短路径条数，再逆序回传依赖值。
+ */
+static void accumulate_source(int index, int worker_id, void* context) {
+    CentralityContext* ctx = (CentralityContext*)context;
+    if (solve_control_should_stop(ctx->control)) return;
+    BrandesWorkspace* ws = &ctx->workspaces[worker_id];
+    int n = ctx->node_count;
+    int source = ctx->sources[index];
+
+    for (int i = 0; i < n; i++) {
+        ws->dist[i] = DBL_MAX;
+        ws->sigma[i] = 0.0;
+        ws->delta[i] = 0.0;
+        ws->position[i] = -1;
+    }
+    csr_open_set_clear(&ws->open);
+    ws->dist[source] = 0.0;
+    ws->sigma[source] = 1.0;
+    csr_open_set_push(&ws->open, source);
+
+    // 1. 压缩邻接表上的 Dijkstra，同时累计并列最短路径的条数
+    const CsrLinkTable* links = ctx->links;
+    int settled = 0, u;
+    while ((u = csr_open_set_pop(&ws->open)) != -1) {
+        ws->position[u] = settled;
+        ws->order[settled++] = u;
+
+        for (int i = 0; i < ctx->mode_count; i++) {
+            int row = u * TRANSPORT_MODE_COUNT + ctx->modes[i];
+            for (int k = links->row_start[row]; k < links->row_start[row + 1]; k++) {
+                int v = links->link_to[k];
+                if (ws->position[v] >= 0) continue;
+                double d = ws->dist[u] + ctx->link_weight[k];
+                if (ws->dist[v] != DBL_MAX && is_tie(d, ws->dist[v])) {
+                    ws->sigma[v] += ws->sigma[u];
+                } else if (d < ws->dist[v]) {
+                    ws->dist[v] = d;
+                    ws->sigma[v] = ws->sigma[u];
+                    csr_open_set_push(&ws->open, v);
+                }
+            }
+        }
+    }
+
+    // 2. 按出队的逆序回传依赖值：δ(v) = Σ σ(v)/σ(w) × (终点(w) + δ(w))，w 为最短路径DAG上 v 的后继
+    for (int i = settled - 1; i > 0; i--) {
+        int v = ws->order[i];
+        for (int m = 0; m < ctx->mode_count; m++) {
+            int row = v * TRANSPORT_MODE_COUNT + ctx->modes[m];
+            for (int k = links->row_start[row]; k < links->row_start[row + 1]; k++) {
+                int w = links->link_to[k];
+                if (ws->position[w] <= i || !is_tie(ws->dist[v] + ctx->link_weight[k], ws->dist[w])) continue;
+                ws->delta[v] += ws->sigma[v] / ws->sigma[w] * ((ctx->is_endpoint[w] ? 1.0 : 0.0) + ws->delta[w]);
+            }
+        }
+        ws->betweenness[v] += ws->delta[v];
+    }
+
+    pthread_mutex_lock(&ctx->progress_mutex);
+    ctx->completed_sources++;
+    solve_control_report_progress(ctx->control, "centrality", (double)ctx->completed_sources / ctx->source_count);
+    pthread_mutex_unlock(&ctx->progress_mutex);
+}
+
+static bool workspace_init(BrandesWorkspace* ws, int n, bool use_heap) {
+    ws->dist = (double*)malloc(n * sizeof(double));
+    ws->sigma = (double*)malloc(n * sizeof(double));
+    ws->delta = (double*)malloc(n * sizeof(double));
+    ws->order = (int*)malloc(n * sizeof(int));
+    ws->position = (int*)malloc(n * sizeof(int));
+    ws->betweenness = (double*)calloc(n, sizeof(double));
+    bool open_ok = csr_open_set_init(&ws->open, n, ws->dist, use_heap);
+    return ws->dist && ws->sigma && ws->delta && ws->order && ws->position && ws->betweenness && open_ok;
+}
+
+static void workspace_free(BrandesWorkspace* ws) {
+    free(ws->dist);
+    free(ws->sigma);
+    free(ws->delta);
+    free(ws->order);
+    free(ws->position);
+    free(ws->betweenness);
+    csr_open_set_free(&ws->open);
+}
+
+/**
+ * @brief splitmix64 伪随机数生成器，用于抽取起点。
+ */
+static uint64_t next_random(uint64_t* state) {
+    uint64_t x = (*state += 0x9E3779B97F4A7C15ULL);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+void centrality_default_options(CentralityOptions* options) {
+    if (!options) return;
+    options->time_weight = 1.0;
+    options->cost_weight = 0.0;
+    options->scope = CENTRALITY_ALL_NODES;
+    options->sample_sources = 0;
+    options->seed = 20240601;
+    options->allowed_modes = TRANSPORT_MODE_ALL;
+}
+
+// 介数中心性计算的实现
+CentralityResult* compute_betweenness_centrality(const TrafficNetwork* network, const CentralityOptions* options,
+                                                 const SolveControl* control) {
+    if (!network) return NULL;
+    CentralityOptions defaults;
+    if (!options) {
+        centrality_default_options(&defaults);
+        options = &defaults;
+    }
+    if (options->sample_sources < 0) {
+        fprintf(stderr, "错误: 介数中心性的抽样起点数不能为负数。\n");
+        return NULL;
+    }
+
+    int n = traffic_network_get_node_count(network);
+    CentralityContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.network = network;
+    ctx.control = control;
+    ctx.node_count = n;
+    int pool_size = thread_pool_get_size(thread_pool_get_default());
+    ctx.worker_count = pool_size > 0 ? pool_size : 1;
+    pthread_mutex_init(&ctx.progress_mutex, NULL);
+
+    CentralityResult* result = (CentralityResult*)calloc(1, sizeof(CentralityResult));
+    ctx.is_endpoint = (char*)calloc(n, 1);
+    ctx.sources = (int*)malloc(n * sizeof(int));
+    ctx.workspaces = (BrandesWorkspace*)calloc(ctx.worker_count, sizeof(BrandesWorkspace));
+    bool ok = result && ctx.is_endpoint && ctx.sources && ctx.workspaces && build_links(&ctx, options);
+    for (int w = 0; ok && w < ctx.worker_count; w++) ok = workspace_init(&ctx.workspaces[w], n, ctx.use_heap);
+    if (ok) {
+        result->node_count = n;
+        result->betweenness = (double*)calloc(n, sizeof(double));
+        result->share = (double*)calloc(n, sizeof(double));
+        ok = result->betweenness && result->share;
+    }
+    if (!ok) goto fail;
+
+    // 起讫点范围：关闭的节点不作为起讫点
+    for (int v = 0; v < n; v++) {
+        const Node* node = traffic_network_get_node_by_id(network, v);
+        bool hub = node->type == NODE_TYPE_AIRPORT || node->type == NODE_TYPE_HSR_STATION;
+        if (!traffic_network_is_node_enabled(network, v) || (options->scope == CENTRALITY_HUB_NODES && !hub)) continue;
+        ctx.is_endpoint[v] = 1;
+        ctx.sources[ctx.source_count++] = v;
+    }
+    result->endpoint_count = ctx.source_count;
+
+    // 抽样：部分 Fisher-Yates 洗牌取前 sample_sources 个起点
+    double scale = 1.0;
+    if (options->sample_sources > 0 && options->sample_sources < ctx.source_count) {
+        uint64_t state = options->seed;
+        for (int i = 0; i < options->sample_sources; i++) {
+            int j = i + (int)(next_random(&state) % (uint64_t)(ctx.source_count - i));
+            int tmp = ctx.sources[i];
+            ctx.sources[i] = ctx.sources[j];
+            ctx.sources[j] = tmp;
+        }
+        scale = (double)ctx.source_count / options->sample_sources;
+        ctx.source_count = options->sample_sources;
+        result->sampled = true;
+    }
+    result->source_count = ctx.source_count;
+
+    thread_pool_parallel_for(thread_pool_get_default(), ctx.source_count, accumulate_source, &ctx);
+    if (solve_control_should_stop(control)) goto fail;
+
+    // 合并各线程的累加器，并按可能经过该节点的有序起讫点对数归一化
+    int k = result->endpoint_count;
+    for (int v = 0; v < n; v++) {
+        for (int w = 0; w < ctx.worker_count; w++) result->betweenness[v] += ctx.workspaces[w].betweenness[v];
+        result->betweenness[v] *= scale;
+        double pairs = ctx.is_endpoint[v] ? (double)(k - 1) * (k - 2) : (double)k * (k - 1);
+        result->share[v] = pairs > 0 ? result->betweenness[v] / pairs : 0.0;
+    }
+    goto cleanup;
+
+fail:
+    free_centrality_result(result);
+    result = NULL;
+
+cleanup:
+    for (int w = 0; ctx.workspaces && w < ctx.worker_count; w++) workspace_free(&ctx.workspaces[w]);
+    free(ctx.workspaces);
+    csr_link_table_free(ctx.links);
+    free(ctx.link_weight);
+    free(ctx.is_endpoint);
+    free(ctx.sources);
+    pthread_mutex_destroy(&ctx.progress_mutex);
+    return result;
+}
+
+/**
+ * @brief 写CSV时按介数从大到小排列的节点。
+ */
+typedef struct {
+    int node_id;
+    double betweenness;
+} RankedNode;
+
+static int compare_ranked_nodes(const void* a, const void* b) {
+    const RankedNode* x = (const RankedNode*)a;
+    const RankedNode* y = (const RankedNode*)b;
+    if (x->betweenness != y->betweenness) return x->betweenness < y->betweenness ? 1 : -1;
+    return x->node_id - y->node_id;
+}
+
+bool centrality_write_csv(const TrafficNetwork* network, const CentralityResult* result, const char* csv_path) {
+    if (!network || !result || !csv_path) return false;
+    RankedNode* ranked = (RankedNode*)malloc((result->node_count + 1) * sizeof(RankedNode));
+    if (!ranked) return false;
+    for (int v = 0; v < result->node_count; v++) {
+        ranked[v].node_id = v;
+        ranked[v].betweenness = result->betweenness[v];
+    }
+    qsort(ranked, result->node_count, sizeof(RankedNode), compare_ranked_nodes);
+
+    FILE* fp = fopen(csv_path, "w");
+    if (!fp) {
+        fprintf(stderr, "错误：无法创建文件 %s (错误码: %d)\n", csv_path, errno);
+        free(ranked);
+        return false;
+    }
+    static const char* const type_names[] = {"landmark", "airport", "hsr"};
+    fprintf(fp, "node_name,city_name,node_type,betweenness,share\n");
+    for (int i = 0; i < result->node_count; i++) {
+        const Node* node = traffic_network_get_node_by_id(network, ranked[i].node_id);
+        fprintf(fp, "%s,%s,%s,%.3f,%.6f\n", node->name, network->cities[node->city_id].city_name, type_names[node->type],
+                ranked[i].betweenness, result->share[ranked[i].node_id]);
+    }
+    bool ok = fclose(fp) == 0;
+    free(ranked);
+    return ok;
+}
+
+void free_centrality_result(CentralityResult* result) {
+    if (!result) return;
+    free(result->betweenness);
+    free(result->share);
+    free(result);
+}
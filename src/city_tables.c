@@ -0,0 +1,491 @@
+/**
+ * @file city_tables.c
+ * @brief 实现了同城全源最短路径表的构建、查表、读写。
+ */
+#include "city_tables.h"
+#include "distance.h"
+#include "pathfinding.h"
+#include "thread_pool.h"
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 文件中同城表的标识 "CTBL"
+#define CITY_TABLES_MAGIC 0x4C425443u
+// 判断两组权重成比例时的相对误差
+#define PROFILE_TOLERANCE 1e-9
+
+/**
+ * @brief 表中的一项：城内从节点 i 到节点 j 的最优路线。
+ * @details 只保存第一段，完整路线沿各项的第一段依次查表得到。固定大小，可以直接写入文件。
+ */
+typedef struct {
+    double cost;                // 加权成本，城内不可达时为 DBL_MAX
+    int32_t next_node_id;       // 第一段的终点，-1表示不可达或起终点相同
+    int32_t mode;               // 第一段的交通方式
+    int32_t exact;              // 1 表示已证明该路线是全网最优
+    int32_t reserved;
+} CityLegEntry;
+
+/**
+ * @brief 文件中同城表的头部，其后依次是各数组。
+ */
+typedef struct {
+    uint32_t magic;
+    int32_t node_count;
+    int32_t city_count;
+    int32_t profile_count;
+    int32_t pair_count;
+    int32_t reserved;
+    uint64_t fingerprint;       // 所有节点城市、类型和坐标的哈希
+} CityTablesHeader;
+
+struct CityTables {
+    const TrafficNetwork* network; // 与之绑定的网络（仅用于比较，不会解引用）
+    int node_count;
+    int city_count;
+    int profile_count;
+    int pair_count;             // 所有城市的 节点数² 之和
+    uint64_t fingerprint;
+    WeightProfile* profiles;
+    int32_t* city_start;        // 城市 c 的节点为 city_nodes[city_start[c] .. city_start[c+1])
+    int32_t* city_nodes;        // 按城市分组的节点ID
+    int32_t* local_index;       // 节点在本城节点中的下标
+    int32_t* pair_start;        // 城市 c 的表项从每组权重内的 pair_start[c] 开始，按 i × 节点数 + j 排列
+    CityLegEntry* entries;      // 权重组数 × pair_count 项
+    bool borrowed;              // 各数组引用外部内存（见 city_tables_map()），销毁时不释放
+};
+
+/**
+ * @brief 每个工作线程复用的工作区，大小按节点最多的城市分配。
+ */
+typedef struct {
+    double* dist;
+    int* first_hop;             // 最优路线的第一段终点
+    int* first_mode;            // 最优路线的第一段交通方式
+    bool* done;
+    double* escape_km;          // escape_km[i × 节点数 + j]：经过任一外城节点从 i 到 j 的最短直线距离
+} CityWorkspace;
+
+typedef struct {
+    const TrafficNetwork* network;
+    CityTables* tables;
+    CityWorkspace* workspaces;
+} BuildContext;
+
+static const WeightProfile default_profiles[] = {
+    {1.0, 0.0},
+    {0.0, 1.0},
+    {0.5, 0.5},
+};
+
+static uint64_t hash_bytes(uint64_t h, const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) h = (h ^ p[i]) * 0x100000001B3ULL;
+    return h;
+}
+
+/**
+ * @brief 网络节点的指纹：节点数以及每个节点的城市、类型和坐标。
+ */
+static uint64_t network_fingerprint(const TrafficNetwork* network) {
+    int n = traffic_network_get_node_count(network);
+    uint64_t h = hash_bytes(0xCBF29CE484222325ULL, &n, sizeof(n));
+    for (int i = 0; i < n; i++) {
+        const Node* node = traffic_network_get_node_by_id(network, i);
+        int32_t fields[2] = {node->city_id, (int32_t)node->type};
+        h = hash_bytes(h, fields, sizeof(fields));
+        h = hash_bytes(h, &node->latitude, sizeof(node->latitude));
+        h = hash_bytes(h, &node->longitude, sizeof(node->longitude));
+    }
+    return h;
+}
+
+static CityLegEntry* entry_at(const CityTables* tables, int profile, int city, int i, int j) {
+    int k = tables->city_start[city + 1] - tables->city_start[city];
+    return &tables->entries[(size_t)profile * tables->pair_count + tables->pair_start[city] + i * k + j];
+}
+
+/**
+ * @brief parallel_for 的任务项：构建一个城市在所有权重组下的表。
+ */
+static void build_city(int city, int worker_id, void* context) {
+    BuildContext* ctx = (BuildContext*)context;
+    CityTables* tables = ctx->tables;
+    CityWorkspace* ws = &ctx->workspaces[worker_id];
+    int n = tables->node_count;
+    const int32_t* members = tables->city_nodes + tables->city_start[city];
+    int k = tables->city_start[city + 1] - tables->city_start[city];
+
+    // 1. 离开本城的路线必须经过某个外城节点 X，其直线距离之和不小于 min_X d(i, X) + d(X, j)
+    for (int p = 0; p < k * k; p++) ws->escape_km[p] = DBL_MAX;
+    for (int x = 0; x < n; x++) {
+        const Node* outside = traffic_network_get_node_by_id(ctx->network, x);
+        if (outside->city_id == city) continue;
+        for (int i = 0; i < k; i++) {
+            const Node* a = traffic_network_get_node_by_id(ctx->network, members[i]);
+            double da = calculate_distance(a->latitude, a->longitude, outside->latitude, outside->longitude);
+            for (int j = 0; j < k; j++) {
+                const Node* b = traffic_network_get_node_by_id(ctx->network, members[j]);
+                double total = da + calculate_distance(outside->latitude, outside->longitude, b->latitude, b->longitude);
+                if (total < ws->escape_km[i * k + j]) ws->escape_km[i * k + j] = total;
+            }
+        }
+    }
+
+    // 2. 每组权重、每个起点在城内节点上做一次 Dijkstra
+    for (int p = 0; p < tables->profile_count; p++) {
+        const WeightProfile* profile = &tables->profiles[p];
+        double rate = weighted_cost_lower_bound_per_km(profile->time_weight, profile->cost_weight, TRANSPORT_MODE_ALL);
+        for (int s = 0; s < k; s++) {
+            for (int i = 0; i < k; i++) {
+                ws->dist[i] = DBL_MAX;
+                ws->first_hop[i] = -1;
+                ws->first_mode[i] = -1;
+                ws->done[i] = false;
+            }
+            ws->dist[s] = 0.0;
+            for (;;) {
+                int u = -1;
+                for (int i = 0; i < k; i++) {
+                    if (!ws->done[i] && ws->dist[i] != DBL_MAX && (u == -1 || ws->dist[i] < ws->dist[u])) u = i;
+                }
+                if (u == -1) break;
+                ws->done[u] = true;
+                for (int v = 0; v < k; v++) {
+                    if (ws->done[v]) continue;
+                    for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+                        TravelInfo info = evaluate_direct_leg(ctx->network, members[u], members[v], (TransportMode)m);
+                        if (!info.is_reachable) continue;
+                        double cost = ws->dist[u] + calculate_weighted_leg_cost(info.time_hours, info.cost_yuan, profile->time_weight,
+                                                                                profile->cost_weight);
+                        if (cost < ws->dist[v]) {
+                            ws->dist[v] = cost;
+                            ws->first_hop[v] = u == s ? members[v] : ws->first_hop[u];
+                            ws->first_mode[v] = u == s ? m : ws->first_mode[u];
+                        }
+                    }
+                }
+            }
+            for (int t = 0; t < k; t++) {
+                CityLegEntry* e = entry_at(tables, p, city, s, t);
+                e->cost = ws->dist[t];
+                e->next_node_id = ws->first_hop[t];
+                e->mode = ws->first_mode[t];
+                // 城内路线的成本不超过任何离城路线的下界时，它就是全网最优
+                e->exact = ws->dist[t] != DBL_MAX && (ws->escape_km[s * k + t] == DBL_MAX || ws->dist[t] <= rate * ws->escape_km[s * k + t]);
+                e->reserved = 0;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 分配表的各数组（不含表项内容）。
+ */
+static CityTables* allocate_tables(int node_count, int city_count, int profile_count) {
+    CityTables* tables = (CityTables*)calloc(1, sizeof(CityTables));
+    if (!tables) return NULL;
+    tables->node_count = node_count;
+    tables->city_count = city_count;
+    tables->profile_count = profile_count;
+    tables->profiles = (WeightProfile*)malloc(profile_count * sizeof(WeightProfile));
+    tables->city_start = (int32_t*)malloc((city_count + 1) * sizeof(int32_t));
+    tables->city_nodes = (int32_t*)malloc(node_count * sizeof(int32_t));
+    tables->local_index = (int32_t*)malloc(node_count * sizeof(int32_t));
+    tables->pair_start = (int32_t*)malloc((city_count + 1) * sizeof(int32_t));
+    if (!tables->profiles || !tables->city_start || !tables->city_nodes || !tables->local_index || !tables->pair_start) {
+        city_tables_destroy(tables);
+        return NULL;
+    }
+    return tables;
+}
+
+// 同城表构建的实现
+CityTables* city_tables_build(const TrafficNetwork* network, const WeightProfile* profiles, int profile_count) {
+    if (!network) return NULL;
+    if (!profiles) {
+        profiles = default_profiles;
+        profile_count = (int)(sizeof(default_profiles) / sizeof(default_profiles[0]));
+    }
+    int n = traffic_network_get_node_count(network);
+    if (n <= 0 || profile_count <= 0) return NULL;
+    for (int p = 0; p < profile_count; p++) {
+        if (profiles[p].time_weight < 0 || profiles[p].cost_weight < 0 || profiles[p].time_weight + profiles[p].cost_weight <= 0) {
+            fprintf(stderr, "错误: 同城表的权重组无效。\n");
+            return NULL;
+        }
+    }
+
+    CityTables* tables = allocate_tables(n, network->city_count, profile_count);
+    if (!tables) return NULL;
+    tables->network = network;
+    tables->fingerprint = network_fingerprint(network);
+    memcpy(tables->profiles, profiles, profile_count * sizeof(WeightProfile));
+
+    // 按城市分组（计数排序），记录每个节点在本城中的下标
+    int cities = tables->city_count;
+    memset(tables->city_start, 0, (cities + 1) * sizeof(int32_t));
+    for (int i = 0; i < n; i++) tables->city_start[traffic_network_get_node_by_id(network, i)->city_id + 1]++;
+    int max_k = 0;
+    tables->pair_start[0] = 0;
+    for (int c = 0; c < cities; c++) {
+        int k = tables->city_start[c + 1];
+        if (k > max_k) max_k = k;
+        tables->city_start[c + 1] += tables->city_start[c];
+        tables->pair_start[c + 1] = tables->pair_start[c] + k * k;
+    }
+    tables->pair_count = tables->pair_start[cities];
+    int* fill = (int*)calloc(cities, sizeof(int));
+    tables->entries = (CityLegEntry*)malloc((size_t)profile_count * tables->pair_count * sizeof(CityLegEntry));
+    int worker_count = thread_pool_get_size(thread_pool_get_default());
+    if (worker_count <= 0) worker_count = 1;
+    CityWorkspace* workspaces = (CityWorkspace*)calloc(worker_count, sizeof(CityWorkspace));
+    bool ok = fill && tables->entries && workspaces;
+    for (int w = 0; ok && w < worker_count; w++) {
+        workspaces[w].dist = (double*)malloc(max_k * sizeof(double));
+        workspaces[w].first_hop = (int*)malloc(max_k * sizeof(int));
+        workspaces[w].first_mode = (int*)malloc(max_k * sizeof(int));
+        workspaces[w].done = (bool*)malloc(max_k * sizeof(bool));
+        workspaces[w].escape_km = (double*)malloc((size_t)max_k * max_k * sizeof(double));
+        ok = workspaces[w].dist && workspaces[w].first_hop && workspaces[w].first_mode && workspaces[w].done && workspaces[w].escape_km;
+    }
+    if (ok) {
+        for (int i = 0; i < n; i++) {
+            int c = traffic_network_get_node_by_id(network, i)->city_id;
+            tables->local_index[i] = fill[c];
+            tables->city_nodes[tables->city_start[c] + fill[c]++] = i;
+        }
+        BuildContext ctx = {network, tables, workspaces};
+        thread_pool_parallel_for(thread_pool_get_default(), cities, build_city, &ctx);
+    }
+
+    for (int w = 0; workspaces && w < worker_count; w++) {
+        free(workspaces[w].dist);
+        free(workspaces[w].first_hop);
+        free(workspaces[w].first_mode);
+        free(workspaces[w].done);
+        free(workspaces[w].escape_km);
+    }
+    free(workspaces);
+    free(fill);
+    if (!ok) {
+        city_tables_destroy(tables);
+        return NULL;
+    }
+    return tables;
+}
+
+/**
+ * @brief 找到与查询权重成比例的权重组。
+ * @return int 权重组下标，没有时返回-1。
+ */
+static int find_profile(const CityTables* tables, double time_weight, double cost_weight) {
+    if (time_weight < 0 || cost_weight < 0 || time_weight + cost_weight <= 0) return -1;
+    for (int p = 0; p < tables->profile_count; p++) {
+        const WeightProfile* profile = &tables->profiles[p];
+        double cross = time_weight * profile->cost_weight - cost_weight * profile->time_weight;
+        if (fabs(cross) <= PROFILE_TOLERANCE * (time_weight + cost_weight) * (profile->time_weight + profile->cost_weight)) return p;
+    }
+    return -1;
+}
+
+// 同城查表的实现
+RoutePath* city_tables_find_route(const CityTables* tables, const TrafficNetwork* network, int from_node_id, int to_node_id,
+                                  double time_weight, double cost_weight) {
+    if (!tables || network != tables->network || traffic_network_get_node_count(network) != tables->node_count) return NULL;
+    if (from_node_id < 0 || from_node_id >= tables->node_count || to_node_id < 0 || to_node_id >= tables->node_count) return NULL;
+    int city = traffic_network_get_node_by_id(network, from_node_id)->city_id;
+    if (traffic_network_get_node_by_id(network, to_node_id)->city_id != city) return NULL;
+    if (traffic_network_has_incidents(network)) return NULL;
+    int profile = find_profile(tables, time_weight, cost_weight);
+    if (profile < 0) return NULL;
+    int target = tables->local_index[to_node_id];
+    if (!entry_at(tables, profile, city, tables->local_index[from_node_id], target)->exact) return NULL;
+
+    RoutePath* path = (RoutePath*)calloc(1, sizeof(RoutePath));
+    if (!path) return NULL;
+    PathSegment** tail = &path->segments_head;
+    int k = tables->city_start[city + 1] - tables->city_start[city];
+    int current = from_node_id;
+    // 从当前节点到终点的最优路线的第一段，接上从该段终点到终点的最优路线，仍是最优路线
+    for (int step = 0; current != to_node_id && step < k; step++) {
+        const CityLegEntry* e = entry_at(tables, profile, city, tables->local_index[current], target);
+        PathSegment* segment = (PathSegment*)malloc(sizeof(PathSegment));
+        if (!segment) {
+            free_route_path(path);
+            return NULL;
+        }
+        const Node* from = traffic_network_get_node_by_id(network, current);
+        const Node* to = traffic_network_get_node_by_id(network, e->next_node_id);
+        TravelInfo travel = evaluate_direct_leg(network, current, e->next_node_id, (TransportMode)e->mode);
+        segment->from_node_id = current;
+        segment->to_node_id = e->next_node_id;
+        segment->mode = (TransportMode)e->mode;
+        segment->distance_km = calculate_distance(from->latitude, from->longitude, to->latitude, to->longitude);
+        segment->time_hours = travel.time_hours;
+        segment->cost_yuan = travel.cost_yuan;
+        segment->next = NULL;
+        *tail = segment;
+        tail = &segment->next;
+
+        path->total_distance += segment->distance_km;
+        path->total_time += segment->time_hours;
+        path->total_cost += segment->cost_yuan;
+        path->segment_count++;
+        current = e->next_node_id;
+    }
+    return path;
+}
+
+// 统计信息的实现
+void city_tables_get_stats(const CityTables* tables, int* city_count, int* exact_pair_count, int* pair_count) {
+    *city_count = tables ? tables->city_count : 0;
+    *pair_count = tables ? tables->pair_count * tables->profile_count : 0;
+    *exact_pair_count = 0;
+    for (size_t i = 0; i < (size_t)*pair_count; i++) {
+        if (tables->entries[i].exact) (*exact_pair_count)++;
+    }
+}
+
+/**
+ * @brief 写入数组并补齐到8字节边界，使后续数组按8字节对齐。
+ */
+static bool write_padded(FILE* fp, const void* data, size_t size) {
+    static const char zeros[8] = {0};
+    if (size > 0 && fwrite(data, 1, size, fp) != size) return false;
+    size_t padding = (8 - size % 8) % 8;
+    return padding == 0 || fwrite(zeros, 1, padding, fp) == padding;
+}
+
+static bool read_padded(FILE* fp, void* data, size_t size) {
+    char skipped[8];
+    if (size > 0 && fread(data, 1, size, fp) != size) return false;
+    size_t padding = (8 - size % 8) % 8;
+    return padding == 0 || fread(skipped, 1, padding, fp) == padding;
+}
+
+// 同城表写入的实现
+bool city_tables_write(const CityTables* tables, FILE* fp) {
+    if (!tables || !fp) return false;
+    CityTablesHeader header = {CITY_TABLES_MAGIC, tables->node_count, tables->city_count, tables->profile_count,
+                               tables->pair_count, 0, tables->fingerprint};
+    return write_padded(fp, &header, sizeof(header)) &&
+           write_padded(fp, tables->profiles, tables->profile_count * sizeof(WeightProfile)) &&
+           write_padded(fp, tables->city_start, (tables->city_count + 1) * sizeof(int32_t)) &&
+           write_padded(fp, tables->city_nodes, tables->node_count * sizeof(int32_t)) &&
+           write_padded(fp, tables->local_index, tables->node_count * sizeof(int32_t)) &&
+           write_padded(fp, tables->pair_start, (tables->city_count + 1) * sizeof(int32_t)) &&
+           write_padded(fp, tables->entries, (size_t)tables->profile_count * tables->pair_count * sizeof(CityLegEntry));
+}
+
+/**
+ * @brief 检查文件中的表头是否有效、是否与网络一致。
+ */
+static bool check_header(const CityTablesHeader* header, const TrafficNetwork* network) {
+    if (header->magic != CITY_TABLES_MAGIC) {
+        fprintf(stderr, "错误: 同城表格式无效。\n");
+        return false;
+    }
+    if (header->node_count != traffic_network_get_node_count(network) || header->city_count != network->city_count ||
+        header->profile_count <= 0 || header->pair_count <= 0 || header->fingerprint != network_fingerprint(network)) {
+        fprintf(stderr, "错误: 同城表与当前网络不一致，请重新构建。\n");
+        return false;
+    }
+    return true;
+}
+
+// 同城表读取的实现
+CityTables* city_tables_read(FILE* fp, const TrafficNetwork* network) {
+    if (!fp || !network) return NULL;
+    CityTablesHeader header;
+    if (!read_padded(fp, &header, sizeof(header))) {
+        fprintf(stderr, "错误: 同城表格式无效。\n");
+        return NULL;
+    }
+    if (!check_header(&header, network)) return NULL;
+
+    CityTables* tables = allocate_tables(header.node_count, header.city_count, header.profile_count);
+    if (!tables) return NULL;
+    tables->network = network;
+    tables->pair_count = header.pair_count;
+    tables->fingerprint = header.fingerprint;
+    tables->entries = (CityLegEntry*)malloc((size_t)header.profile_count * header.pair_count * sizeof(CityLegEntry));
+    bool ok = tables->entries &&
+              read_padded(fp, tables->profiles, tables->profile_count * sizeof(WeightProfile)) &&
+              read_padded(fp, tables->city_start, (tables->city_count + 1) * sizeof(int32_t)) &&
+              read_padded(fp, tables->city_nodes, tables->node_count * sizeof(int32_t)) &&
+              read_padded(fp, tables->local_index, tables->node_count * sizeof(int32_t)) &&
+              read_padded(fp, tables->pair_start, (tables->city_count + 1) * sizeof(int32_t)) &&
+              read_padded(fp, tables->entries, (size_t)tables->profile_count * tables->pair_count * sizeof(CityLegEntry));
+    if (!ok || tables->pair_start[tables->city_count] != tables->pair_count) {
+        fprintf(stderr, "错误: 同城表数据不完整。\n");
+        city_tables_destroy(tables);
+        return NULL;
+    }
+    return tables;
+}
+
+/**
+ * @brief 从内存中按顺序取出一个补齐到8字节的数组，剩余数据不足时返回NULL。
+ */
+static void* take_padded(const unsigned char** cursor, const unsigned char* end, size_t size) {
+    size_t padded = (size + 7) / 8 * 8;
+    if ((size_t)(end - *cursor) < padded) return NULL;
+    void* data = (void*)*cursor; // 引用的数组不会被写入，去掉 const 是安全的
+    *cursor += padded;
+    return data;
+}
+
+// 引用内存中同城表的实现
+CityTables* city_tables_map(const void* data, size_t size, const TrafficNetwork* network) {
+    if (!data || !network) return NULL;
+    const unsigned char* cursor = (const unsigned char*)data;
+    const unsigned char* end = cursor + size;
+    const CityTablesHeader* header = (const CityTablesHeader*)take_padded(&cursor, end, sizeof(CityTablesHeader));
+    if (!header) {
+        fprintf(stderr, "错误: 同城表格式无效。\n");
+        return NULL;
+    }
+    if (!check_header(header, network)) return NULL;
+
+    CityTables* tables = (CityTables*)calloc(1, sizeof(CityTables));
+    if (!tables) return NULL;
+    tables->network = network;
+    tables->node_count = header->node_count;
+    tables->city_count = header->city_count;
+    tables->profile_count = header->profile_count;
+    tables->pair_count = header->pair_count;
+    tables->fingerprint = header->fingerprint;
+    tables->borrowed = true;
+    tables->profiles = (WeightProfile*)take_padded(&cursor, end, tables->profile_count * sizeof(WeightProfile));
+    tables->city_start = (int32_t*)take_padded(&cursor, end, (tables->city_count + 1) * sizeof(int32_t));
+    tables->city_nodes = (int32_t*)take_padded(&cursor, end, tables->node_count * sizeof(int32_t));
+    tables->local_index = (int32_t*)take_padded(&cursor, end, tables->node_count * sizeof(int32_t));
+    tables->pair_start = (int32_t*)take_padded(&cursor, end, (tables->city_count + 1) * sizeof(int32_t));
+    tables->entries = (CityLegEntry*)take_padded(&cursor, end, (size_t)tables->profile_count * tables->pair_count * sizeof(CityLegEntry));
+    if (!tables->profiles || !tables->city_start || !tables->city_nodes || !tables->local_index || !tables->pair_start ||
+        !tables->entries || tables->pair_start[tables->city_count] != tables->pair_count) {
+        fprintf(stderr, "错误: 同城表数据不完整。\n");
+        free(tables);
+        return NULL;
+    }
+    return tables;
+}
+
+void city_tables_destroy(CityTables* tables) {
+    if (!tables) return;
+    if (tables->borrowed) {
+        free(tables);
+        return;
+    }
+    free(tables->profiles);
+    free(tables->city_start);
+    free(tables->city_nodes);
+    free(tables->local_index);
+    free(tables->pair_start);
+    free(tables->entries);
+    free(tables);
+}
@@ -0,0 +1,591 @@
+/**
+ * @file csr_engine.c
+ * @brief 实现了基于压缩邻接表的两个寻路引擎（线性扫描开放集与二叉堆开放集）。
+ */
+#include "csr_engine.h"
+#include "distance.h"
+#include "solve_control.h"
+#include "thread_pool.h"
+#include "utils.h"
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief 单次搜索的工作区。查询结束后放回引擎的空闲列表，供之后的查询复用。
+ */
+typedef struct CsrWorkspace {
+    double* g;                  // 从起点出发的加权成本
+    double* f;                  // g + 启发值，开放集的排序键
+    double* h;                  // 启发值
+    int* pred_node;             // 前驱节点
+    int* pred_link;             // 到达该节点使用的路段
+    unsigned char* closed;      // 已出队的节点
+    bool* is_target;            // 一对多查询的目标标记，查询结束后清零
+    CsrOpenSet open;
+    struct CsrWorkspace* next;  // 空闲列表中的下一个
+} CsrWorkspace;
+
+/**
+ * @brief 引擎预处理得到的状态：压缩邻接表及其对应的网络版本，以及空闲的搜索工作区。
+ * @details 同时进行的查询各取一个工作区，空闲列表的长度因此等于并发查询的最大线程数，
+ *          每个线程的查询不再分配和释放整套数组。
+ */
+typedef struct {
+    const TrafficNetwork* network; // 邻接表与之一致的网络（仅用于比较）
+    unsigned long version;      // 邻接表与之一致的网络版本号
+    CsrLinkTable* links;
+    pthread_mutex_t idle_mutex; // 保护 idle
+    CsrWorkspace* idle;         // 空闲的工作区
+} CsrGraph;
+
+/**
+ * @brief 一个起点出发的所有路段（按交通方式排列），预处理时暂存，最后拼接为邻接表。
+ */
+typedef struct {
+    int counts[TRANSPORT_MODE_COUNT]; // 每种交通方式的路段数
+    int total;
+    int* to;
+    double* hours;
+    double* yuan;
+    double* km;
+} CsrRow;
+
+/**
+ * @brief 预处理时各任务共享的数据。
+ */
+typedef struct {
+    const TrafficNetwork* network;
+    int node_count;
+    CsrRow* rows;               // 每个起点一行
+    TravelInfo* scratch;        // 每个工作线程 node_count * M 个路段评估结果（按交通方式、终点排列）
+    double* scratch_factors;    // 对应路段的减速倍数，不可用的路段为0
+    double* scratch_km;         // 每个工作线程 node_count 个终点的距离
+} CsrBuildContext;
+
+/**
+ * @brief parallel_for 的任务项：评估一个起点出发的所有路段，并保存为紧凑的一行。
+ */
+static void evaluate_row(int u, int worker_id, void* context) {
+    CsrBuildContext* ctx = (CsrBuildContext*)context;
+    int n = ctx->node_count;
+    TravelInfo* legs = ctx->scratch + (size_t)worker_id * n * TRANSPORT_MODE_COUNT;
+    double* factors = ctx->scratch_factors + (size_t)worker_id * n * TRANSPORT_MODE_COUNT;
+    double* km = ctx->scratch_km + (size_t)worker_id * n;
+    CsrRow* row = &ctx->rows[u];
+
+    for (int v = 0; v < n; v++) {
+        TravelInfo pair[TRANSPORT_MODE_COUNT];
+        km[v] = evaluate_direct_legs(ctx->network, u, v, pair);
+        for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+            size_t index = (size_t)m * n + v;
+            double factor;
+            legs[index] = pair[m];
+            factors[index] = 0.0;
+            if (!pair[m].is_reachable) continue;
+            if (!traffic_network_get_edge_state(ctx->network, u, v, (TransportMode)m, &factor)) continue; // 已封闭
+            factors[index] = factor;
+            row->counts[m]++;
+            row->total++;
+        }
+    }
+
+    int size = row->total > 0 ? row->total : 1;
+    row->to = (int*)malloc(size * sizeof(int));
+    row->hours = (double*)malloc(size * sizeof(double));
+    row->yuan = (double*)malloc(size * sizeof(double));
+    row->km = (double*)malloc(size * sizeof(double));
+    if (!row->to || !row->hours || !row->yuan || !row->km) return; // 由 csr_prepare 检查
+    int e = 0;
+    for (size_t index = 0; index < (size_t)n * TRANSPORT_MODE_COUNT; index++) {
+        if (factors[index] == 0.0) continue;
+        int v = (int)(index % n);
+        row->to[e] = v;
+        row->hours[e] = legs[index].time_hours * factors[index];
+        row->yuan[e] = legs[index].cost_yuan;
+        row->km[e] = km[v];
+        e++;
+    }
+}
+
+void csr_link_table_free(CsrLinkTable* table) {
+    if (!table) return;
+    free(table->row_start);
+    free(table->link_to);
+    free(table->link_hours);
+    free(table->link_yuan);
+    free(table->link_km);
+    free(table);
+}
+
+// 邻接表构建的实现：并行评估所有路段，再拼接为邻接表
+CsrLinkTable* csr_link_table_build(const TrafficNetwork* network) {
+    int n = traffic_network_get_node_count(network);
+    if (n <= 0) return NULL;
+
+    CsrBuildContext ctx;
+    ctx.network = network;
+    ctx.node_count = n;
+    int worker_count = thread_pool_get_size(thread_pool_get_default());
+    if (worker_count <= 0) worker_count = 1;
+    ctx.rows = (CsrRow*)calloc(n, sizeof(CsrRow));
+    ctx.scratch = (TravelInfo*)malloc((size_t)worker_count * n * TRANSPORT_MODE_COUNT * sizeof(TravelInfo));
+    ctx.scratch_factors = (double*)malloc((size_t)worker_count * n * TRANSPORT_MODE_COUNT * sizeof(double));
+    ctx.scratch_km = (double*)malloc((size_t)worker_count * n * sizeof(double));
+    CsrLinkTable* table = (CsrLinkTable*)calloc(1, sizeof(CsrLinkTable));
+    bool ok = ctx.rows && ctx.scratch && ctx.scratch_factors && ctx.scratch_km && table;
+    if (ok) thread_pool_parallel_for(thread_pool_get_default(), n, evaluate_row, &ctx);
+
+    size_t links = 0;
+    for (int u = 0; ok && u < n; u++) {
+        const CsrRow* row = &ctx.rows[u];
+        if (!row->to || !row->hours || !row->yuan || !row->km) ok = false;
+        links += row->total;
+    }
+    if (ok) {
+        size_t size = links > 0 ? links : 1;
+        table->row_start = (int*)malloc(((size_t)n * TRANSPORT_MODE_COUNT + 1) * sizeof(int));
+        table->link_to = (int*)malloc(size * sizeof(int));
+        table->link_hours = (double*)malloc(size * sizeof(double));
+        table->link_yuan = (double*)malloc(size * sizeof(double));
+        table->link_km = (double*)malloc(size * sizeof(double));
+        ok = table->row_start && table->link_to && table->link_hours && table->link_yuan && table->link_km;
+    }
+    if (ok) {
+        int e = 0;
+        for (int u = 0; u < n; u++) {
+            const CsrRow* row = &ctx.rows[u];
+            memcpy(table->link_to + e, row->to, row->total * sizeof(int));
+            memcpy(table->link_hours + e, row->hours, row->total * sizeof(double));
+            memcpy(table->link_yuan + e, row->yuan, row->total * sizeof(double));
+            memcpy(table->link_km + e, row->km, row->total * sizeof(double));
+            for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+                table->row_start[u * TRANSPORT_MODE_COUNT + m] = e;
+                e += row->counts[m];
+            }
+        }
+        table->row_start[(size_t)n * TRANSPORT_MODE_COUNT] = e;
+        table->node_count = n;
+        table->link_count = e;
+    }
+
+    for (int u = 0; ctx.rows && u < n; u++) {
+        free(ctx.rows[u].to);
+        free(ctx.rows[u].hours);
+        free(ctx.rows[u].yuan);
+        free(ctx.rows[u].km);
+    }
+    free(ctx.rows);
+    free(ctx.scratch);
+    free(ctx.scratch_factors);
+    free(ctx.scratch_km);
+    if (!ok) {
+        csr_link_table_free(table);
+        return NULL;
+    }
+    return table;
+}
+
+TransportMode csr_link_table_get_mode(const CsrLinkTable* table, int from_node_id, int link) {
+    int m = 0;
+    while (m + 1 < TRANSPORT_MODE_COUNT && link >= table->row_start[from_node_id * TRANSPORT_MODE_COUNT + m + 1]) m++;
+    return (TransportMode)m;
+}
+
+bool csr_link_table_prefers_heap(const CsrLinkTable* table, TransportModeMask allowed_modes) {
+    int n = table->node_count;
+    if (n <= 1) return false;
+    TransportMode modes[TRANSPORT_MODE_COUNT];
+    int mode_count = mode_mask_expand(allowed_modes, modes);
+    long long links = 0;
+    for (int u = 0; u < n; u++) {
+        for (int k = 0; k < mode_count; k++) {
+            int row = u * TRANSPORT_MODE_COUNT + modes[k];
+            links += table->row_start[row + 1] - table->row_start[row];
+        }
+    }
+    return (double)links / n * log2((double)n) < n;
+}
+
+// --- 开放集 ---
+
+bool csr_open_set_init(CsrOpenSet* set, int node_count, const double* key, bool use_heap) {
+    set->key = key;
+    set->items = (int*)malloc(node_count * sizeof(int));
+    set->position = (int*)malloc(node_count * sizeof(int));
+    set->count = 0;
+    set->use_heap = use_heap;
+    if (!set->items || !set->position) {
+        csr_open_set_free(set);
+        return false;
+    }
+    for (int i = 0; i < node_count; i++) set->position[i] = -1;
+    return true;
+}
+
+void csr_open_set_free(CsrOpenSet* set) {
+    free(set->items);
+    free(set->position);
+    set->items = NULL;
+    set->position = NULL;
+    set->count = 0;
+}
+
+void csr_open_set_clear(CsrOpenSet* set) {
+    for (int i = 0; i < set->count; i++) set->position[set->items[i]] = -1;
+    set->count = 0;
+}
+
+static void open_set_place(CsrOpenSet* set, int i, int node) {
+    set->items[i] = node;
+    set->position[node] = i;
+}
+
+// 二叉堆（按键排序的最小堆）的上浮和下沉
+static void open_set_sift_up(CsrOpenSet* set, int i) {
+    int node = set->items[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (set->key[set->items[parent]] <= set->key[node]) break;
+        open_set_place(set, i, set->items[parent]);
+        i = parent;
+    }
+    open_set_place(set, i, node);
+}
+
+static void open_set_sift_down(CsrOpenSet* set, int i) {
+    int node = set->items[i];
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= set->count) break;
+        if (child + 1 < set->count && set->key[set->items[child + 1]] < set->key[set->items[child]]) child++;
+        if (set->key[set->items[child]] >= set->key[node]) break;
+        open_set_place(set, i, set->items[child]);
+        i = child;
+    }
+    open_set_place(set, i, node);
+}
+
+void csr_open_set_push(CsrOpenSet* set, int node) {
+    if (set->position[node] < 0) open_set_place(set, set->count++, node);
+    if (set->use_heap) open_set_sift_up(set, set->position[node]);
+}
+
+int csr_open_set_pop(CsrOpenSet* set) {
+    if (set->count == 0) return -1;
+    int best = 0;
+    if (!set->use_heap) {
+        for (int i = 1; i < set->count; i++) {
+            if (set->key[set->items[i]] < set->key[set->items[best]]) best = i;
+        }
+    }
+    int node = set->items[best];
+    set->position[node] = -1;
+    int last = set->items[--set->count];
+    if (best < set->count) {
+        open_set_place(set, best, last);
+        if (set->use_heap) open_set_sift_down(set, best);
+    }
+    return node;
+}
+
+// --- 工作区 ---
+
+static void workspace_free(CsrWorkspace* ws) {
+    free(ws->g);
+    free(ws->f);
+    free(ws->h);
+    free(ws->pred_node);
+    free(ws->pred_link);
+    free(ws->closed);
+    free(ws->is_target);
+    csr_open_set_free(&ws->open);
+    free(ws);
+}
+
+/**
+ * @brief 取一个空闲的工作区，没有时新建一个。
+ * @return CsrWorkspace* 内存不足时返回NULL。
+ */
+static CsrWorkspace* acquire_workspace(CsrGraph* graph) {
+    pthread_mutex_lock(&graph->idle_mutex);
+    CsrWorkspace* ws = graph->idle;
+    if (ws) graph->idle = ws->next;
+    pthread_mutex_unlock(&graph->idle_mutex);
+    if (ws) return ws;
+
+    int n = graph->links->node_count;
+    ws = (CsrWorkspace*)calloc(1, sizeof(CsrWorkspace));
+    if (!ws) return NULL;
+    ws->g = (double*)malloc(n * sizeof(double));
+    ws->f = (double*)malloc(n * sizeof(double));
+    ws->h = (double*)malloc(n * sizeof(double));
+    ws->pred_node = (int*)malloc(n * sizeof(int));
+    ws->pred_link = (int*)malloc(n * sizeof(int));
+    ws->closed = (unsigned char*)calloc(n, 1);
+    ws->is_target = (bool*)calloc(n, sizeof(bool));
+    // 开放集的实现在搜索时按引擎设置，这里先用线性扫描初始化
+    bool open_ok = csr_open_set_init(&ws->open, n, ws->f, false);
+    if (!ws->g || !ws->f || !ws->h || !ws->pred_node || !ws->pred_link || !ws->closed || !ws->is_target || !open_ok) {
+        workspace_free(ws);
+        return NULL;
+    }
+    return ws;
+}
+
+/**
+ * @brief 清理一次搜索留下的状态，把工作区放回空闲列表。
+ */
+static void release_workspace(CsrGraph* graph, CsrWorkspace* ws) {
+    memset(ws->closed, 0, graph->links->node_count);
+    csr_open_set_clear(&ws->open);
+    pthread_mutex_lock(&graph->idle_mutex);
+    ws->next = graph->idle;
+    graph->idle = ws;
+    pthread_mutex_unlock(&graph->idle_mutex);
+}
+
+// --- 引擎 ---
+
+static void csr_graph_free(void* state) {
+    CsrGraph* graph = (CsrGraph*)state;
+    if (!graph) return;
+    while (graph->idle) {
+        CsrWorkspace* next = graph->idle->next;
+        workspace_free(graph->idle);
+        graph->idle = next;
+    }
+    pthread_mutex_destroy(&graph->idle_mutex);
+    csr_link_table_free(graph->links);
+    free(graph);
+}
+
+/**
+ * @brief 预处理：构建压缩邻接表，并记录它对应的网络版本。
+ */
+static bool csr_prepare(const TrafficNetwork* network, void** state) {
+    *state = NULL;
+    CsrGraph* graph = (CsrGraph*)calloc(1, sizeof(CsrGraph));
+    if (!graph) return false;
+    graph->network = network;
+    graph->version = traffic_network_get_version(network);
+    graph->links = csr_link_table_build(network);
+    if (!graph->links) {
+        free(graph);
+        return false;
+    }
+    pthread_mutex_init(&graph->idle_mutex, NULL);
+    *state = graph;
+    return true;
+}
+
+/**
+ * @brief 邻接表是否仍与网络一致。网络被修改后引擎回退到隐式图上的搜索。
+ */
+static bool csr_graph_is_current(const CsrGraph* graph, const TrafficNetwork* network) {
+    return graph && graph->network == network && graph->version == traffic_network_get_version(network) &&
+           graph->links->node_count == traffic_network_get_node_count(network);
+}
+
+// 搜索结果
+typedef enum { CSR_UNREACHABLE, CSR_FOUND, CSR_ABORTED } CsrStatus;
+
+/**
+ * @brief 在邻接表上运行 A*（有终点时）或 Dijkstra（一对多时）。
+ *
+ * @param target 终点，-1表示一对多。
+ * @param is_target 一对多时需要确定成本的节点标记。
+ * @param target_count is_target 中标记的节点数，全部确定后停止搜索。
+ */
+static CsrStatus csr_search(const CsrLinkTable* graph, const TrafficNetwork* network, int source, int target, const bool* is_target,
+                            int target_count, const RouteQueryOptions* options, const SolveControl* control, CsrWorkspace* ws) {
+    int n = graph->node_count;
+    TransportMode modes[TRANSPORT_MODE_COUNT];
+    int mode_count = mode_mask_expand(options->allowed_modes, modes);
+
+    // 加权成本对时间和花费是线性的，先求出两个系数，松弛时只做两次乘加
+    double per_hour = calculate_weighted_leg_cost(1.0, 0.0, options->time_weight, options->cost_weight);
+    double per_yuan = calculate_weighted_leg_cost(0.0, 1.0, options->time_weight, options->cost_weight);
+    double rate = target >= 0 ? weighted_cost_lower_bound_per_km(options->time_weight, options->cost_weight, options->allowed_modes)
+                                : 0.0;
+    const Node* end_node = target >= 0 ? traffic_network_get_node_by_id(network, target) : NULL;
+    for (int i = 0; i < n; i++) {
+        ws->g[i] = DBL_MAX;
+        ws->pred_node[i] = -1;
+        ws->h[i] = 0.0;
+        if (rate > 0) {
+            const Node* node = traffic_network_get_node_by_id(network, i);
+            ws->h[i] = rate * calculate_distance(node->latitude, node->longitude, end_node->latitude, end_node->longitude);
+        }
+    }
+    ws->g[source] = 0.0;
+    ws->f[source] = ws->h[source];
+    csr_open_set_push(&ws->open, source);
+
+    const GeofenceMask* avoid = options->avoid;
+    int settled_targets = 0;
+    for (int iteration = 0;; iteration++) {
+        if (iteration % SOLVE_CONTROL_CHECK_INTERVAL == 0 && solve_control_should_stop(control)) return CSR_ABORTED;
+        int u = csr_open_set_pop(&ws->open);
+        if (u == -1) return target < 0 ? CSR_FOUND : CSR_UNREACHABLE;
+        ws->closed[u] = 1;
+        if (u == target) return CSR_FOUND;
+        if (is_target && is_target[u] && ++settled_targets == target_count) return CSR_FOUND;
+
+        const uint8_t* avoid_row = avoid ? avoid->edge_bits + (size_t)u * avoid->row_bytes : NULL;
+        for (int k = 0; k < mode_count; k++) {
+            int row = u * TRANSPORT_MODE_COUNT + modes[k];
+            for (int e = graph->row_start[row]; e < graph->row_start[row + 1]; e++) {
+                int v = graph->link_to[e];
+                if (ws->closed[v]) continue;
+                if (avoid_row && ((avoid_row[v >> 3] >> (v & 7)) & 1)) continue; // 穿过规避区域
+                double cost = ws->g[u] + per_hour * graph->link_hours[e] + per_yuan * graph->link_yuan[e];
+                if (cost < ws->g[v]) {
+                    ws->g[v] = cost;
+                    ws->f[v] = cost + ws->h[v];
+                    ws->pred_node[v] = u;
+                    ws->pred_link[v] = e;
+                    csr_open_set_push(&ws->open, v);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief 沿前驱链回溯，构建从起点到终点的路径。
+ */
+static RoutePath* build_route(const CsrLinkTable* graph, const CsrWorkspace* ws, int source, int target) {
+    RoutePath* path = (RoutePath*)calloc(1, sizeof(RoutePath));
+    if (!path) return NULL;
+    for (int v = target; v != source; v = ws->pred_node[v]) {
+        int u = ws->pred_node[v];
+        int e = ws->pred_link[v];
+        PathSegment* segment = (PathSegment*)malloc(sizeof(PathSegment));
+        if (!segment) {
+            free_route_path(path);
+            return NULL;
+        }
+        segment->from_node_id = u;
+        segment->to_node_id = v;
+        segment->mode = csr_link_table_get_mode(graph, u, e);
+        segment->distance_km = graph->link_km[e];
+        segment->time_hours = graph->link_hours[e];
+        segment->cost_yuan = graph->link_yuan[e];
+        segment->next = path->segments_head;
+        path->segments_head = segment;
+
+        path->total_distance += segment->distance_km;
+        path->total_time += segment->time_hours;
+        path->total_cost += segment->cost_yuan;
+        path->segment_count++;
+    }
+    return path;
+}
+
+/**
+ * @brief 规避区域的位图是否可以直接使用；不能使用时交给隐式图上的搜索报告错误。
+ */
+static bool avoid_is_usable(const CsrLinkTable* graph, const GeofenceMask* avoid, int source, int target) {
+    if (!avoid) return true;
+    if (avoid->node_count != graph->node_count) return false;
+    return !geofence_blocks_node(avoid, source) && (target < 0 || !geofence_blocks_node(avoid, target));
+}
+
+static RoutePath* csr_query(void* state, const TrafficNetwork* network, int start_node_id, int end_node_id, const RouteQueryOptions* options,
+                            const SolveControl* control, bool use_heap) {
+    CsrGraph* graph = (CsrGraph*)state;
+    int n = traffic_network_get_node_count(network);
+    if (!options || start_node_id < 0 || start_node_id >= n || end_node_id < 0 || end_node_id >= n) return NULL;
+    if (!csr_graph_is_current(graph, network) || !avoid_is_usable(graph->links, options->avoid, start_node_id, end_node_id)) {
+        return find_shortest_path_query(network, start_node_id, end_node_id, options, control);
+    }
+
+    CsrWorkspace* ws = acquire_workspace(graph);
+    if (!ws) return NULL;
+    ws->open.use_heap = use_heap;
+    RoutePath* path = NULL;
+    if (csr_search(graph->links, network, start_node_id, end_node_id, NULL, 0, options, control, ws) == CSR_FOUND) {
+        path = build_route(graph->links, ws, start_node_id, end_node_id);
+    }
+    release_workspace(graph, ws);
+    return path;
+}
+
+static bool csr_one_to_many(void* state, const TrafficNetwork* network, int source_node_id, const int* target_node_ids, int target_count,
+                            const RouteQueryOptions* options, const SolveControl* control, double* out_costs, bool use_heap) {
+    CsrGraph* graph = (CsrGraph*)state;
+    int n = traffic_network_get_node_count(network);
+    if (!options || !out_costs || target_count < 0 || (target_count > 0 && !target_node_ids)) return false;
+    if (source_node_id < 0 || source_node_id >= n) return false;
+    if (!csr_graph_is_current(graph, network) || !avoid_is_usable(graph->links, options->avoid, source_node_id, -1)) {
+        return find_shortest_path_costs(network, source_node_id, target_node_ids, target_count, options, control, out_costs);
+    }
+
+    CsrWorkspace* ws = acquire_workspace(graph);
+    if (!ws) return false;
+    ws->open.use_heap = use_heap;
+    bool* is_target = ws->is_target;
+    int distinct_targets = 0;
+    for (int k = 0; k < target_count; k++) {
+        int t = target_node_ids[k];
+        if (t >= 0 && t < n && !is_target[t]) {
+            is_target[t] = true;
+            distinct_targets++;
+        }
+    }
+    bool ok = distinct_targets == 0 ||
+              csr_search(graph->links, network, source_node_id, -1, is_target, distinct_targets, options, control, ws) != CSR_ABORTED;
+    for (int k = 0; k < target_count; k++) {
+        int t = target_node_ids[k];
+        if (t < 0 || t >= n) {
+            if (ok) out_costs[k] = DBL_MAX;
+            continue;
+        }
+        if (ok) out_costs[k] = ws->g[t];
+        is_target[t] = false;
+    }
+    release_workspace(graph, ws);
+    return ok;
+}
+
+static RoutePath* csr_linear_query(void* state, const TrafficNetwork* network, int start_node_id, int end_node_id,
+                                   const RouteQueryOptions* options, const SolveControl* control) {
+    return csr_query(state, network, start_node_id, end_node_id, options, control, false);
+}
+
+static bool csr_linear_one_to_many(void* state, const TrafficNetwork* network, int source_node_id, const int* target_node_ids, int target_count,
+                                   const RouteQueryOptions* options, const SolveControl* control, double* out_costs) {
+    return csr_one_to_many(state, network, source_node_id, target_node_ids, target_count, options, control, out_costs, false);
+}
+
+static RoutePath* csr_heap_query(void* state, const TrafficNetwork* network, int start_node_id, int end_node_id,
+                                 const RouteQueryOptions* options, const SolveControl* control) {
+    return csr_query(state, network, start_node_id, end_node_id, options, control, true);
+}
+
+static bool csr_heap_one_to_many(void* state, const TrafficNetwork* network, int source_node_id, const int* target_node_ids, int target_count,
+                                 const RouteQueryOptions* options, const SolveControl* control, double* out_costs) {
+    return csr_one_to_many(state, network, source_node_id, target_node_ids, target_count, options, control, out_costs, true);
+}
+
+const RoutingEngineVTable csr_linear_engine = {
+    "csr_linear",
+    "压缩邻接表 + 线性扫描开放集，适合稠密网络上的批量查询",
+    csr_prepare,
+    csr_linear_query,
+    csr_linear_one_to_many,
+    csr_graph_free,
+};
+
+const RoutingEngineVTable csr_heap_engine = {
+    "csr_heap",
+    "压缩邻接表 + 二叉堆开放集，适合稀疏网络上的批量查询",
+    csr_prepare,
+    csr_heap_query,
+    csr_heap_one_to_many,
+    csr_graph_free,
+};
@@ -0,0 +1,20 @@
+/**
+ * @file embedded_network.c
+ * @brief 内置网络数据的入口。
+ * @details 以 TRAFFIC_EMBEDDED_NETWORK 编译时包含 tools/embed_network 生成的数据表（见 Makefile 的 embedded 目标），
+ *          否则没有内置数据。
+ */
+#include "embedded_network.h"
+#include <stddef.h>
+
+#ifdef TRAFFIC_EMBEDDED_NETWORK
+#include "embedded_network_data.inc"
+
+const EmbeddedNetwork* embedded_network_get(void) {
+    return &embedded_network;
+}
+#else
+const EmbeddedNetwork* embedded_network_get(void) {
+    return NULL;
+}
+#endif
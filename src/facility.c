@@ -0,0 +1,449 @@
+/**
+ * @file facility.c
+ * @brief 实现了基于增量最短路径更新和 CELF 惰性贪心的枢纽选址。
+ */
+#include "facility.h"
+#include "pathfinding.h"
+#include "thread_pool.h"
+#include <errno.h>
+#include <float.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 不可达的起讫点对计入目标函数的加权成本（远大于任何实际路线的加权成本）
+#define UNREACHABLE_COST 10.0
+
+/**
+ * @brief 一个需求大于0的起讫点对。
+ */
+typedef struct {
+    int origin;
+    int destination;
+    double trips;
+} DemandPair;
+
+/**
+ * @brief CELF 队列中的一个候选站址。
+ */
+typedef struct {
+    int candidate;
+    double bound;               // 最近一次评估的收益，是当前收益的上界；站址无效时为-1
+    int round;                  // 最近一次评估时已选中的枢纽数
+    bool chosen;
+} CelfEntry;
+
+/**
+ * @brief 每个工作线程复用的工作区。
+ */
+typedef struct {
+    double* link_in;            // 各节点到新枢纽的最小加权成本
+    double* link_out;           // 新枢纽到各节点的最小加权成本
+    double* into;               // 各节点经任意路线到达新枢纽的最短距离
+    double* from;               // 新枢纽经任意路线到达各节点的最短距离
+} HubWorkspace;
+
+typedef struct {
+    const FacilityOptions* options;
+    const SolveControl* control;
+    const HubCandidate* candidates;
+    TrafficNetwork* planning;   // 基础网络上的覆盖网络，选中的枢纽依次加入其中
+    int node_count;             // 规划网络当前的节点数
+    int stride;                 // 距离矩阵的行宽（基础节点数 + k）
+    double* dist;               // 全源最短距离 dist[s * stride + t]，不可达为 DBL_MAX
+
+    DemandPair* pairs;
+    int pair_count;
+    char* is_origin;
+    char* is_destination;
+
+    int worker_count;
+    HubWorkspace* workspaces;
+    ShortestPathTree** trees;   // 计算初始距离矩阵时各线程复用的最短路径树
+    int* batch;                 // 本批要重新评估的候选站址
+    double* batch_gains;
+    pthread_mutex_t progress_mutex; // 串行化进度回调
+    int completed;                  // 已完成的起点数（受 progress_mutex 保护）
+    int failed;                     // 任一线程失败时置1（原子写入）
+} FacilityContext;
+
+/**
+ * @brief 目标函数中一个起讫点对的成本。
+ */
+static double pair_cost(double distance) {
+    return distance == DBL_MAX ? UNREACHABLE_COST : distance;
+}
+
+/**
+ * @brief parallel_for 的任务项：计算初始距离矩阵的一行。
+ */
+static void compute_distance_row(int source, int worker_id, void* context) {
+    FacilityContext* ctx = (FacilityContext*)context;
+    if (solve_control_should_stop(ctx->control)) return;
+    // 线程的第一行新建树，之后的行在同一棵树上原地重新计算
+    ShortestPathTree* tree = ctx->trees[worker_id];
+    bool ok;
+    if (!tree) {
+        tree = ctx->trees[worker_id] =
+            compute_shortest_path_tree(ctx->planning, source, ctx->options->time_weight, ctx->options->cost_weight, ctx->control);
+        ok = tree != NULL;
+    } else {
+        ok = shortest_path_tree_recompute(ctx->planning, tree, source, ctx->control);
+    }
+    if (!ok) {
+        __atomic_store_n(&ctx->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    double* row = &ctx->dist[(size_t)source * ctx->stride];
+    for (int t = 0; t < ctx->node_count; t++) row[t] = shortest_path_tree_get_cost(tree, t);
+
+    pthread_mutex_lock(&ctx->progress_mutex);
+    ctx->completed++;
+    solve_control_report_progress(ctx->control, "cost_matrix", (double)ctx->completed / ctx->node_count);
+    pthread_mutex_unlock(&ctx->progress_mutex);
+}
+
+/**
+ * @brief 计算新枢纽 hub 与网络中已有节点之间的直达路段成本（各交通方式取最小值）。
+ */
+static void compute_hub_links(const FacilityContext* ctx, const TrafficNetwork* network, int hub, HubWorkspace* ws) {
+    for (int u = 0; u < ctx->node_count; u++) {
+        ws->link_in[u] = DBL_MAX;
+        ws->link_out[u] = DBL_MAX;
+        for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+            for (int dir = 0; dir < 2; dir++) {
+                int from = dir == 0 ? u : hub;
+                int to = dir == 0 ? hub : u;
+                TravelInfo info = evaluate_direct_leg(network, from, to, (TransportMode)m);
+                double incident_factor;
+                if (!info.is_reachable || !traffic_network_get_edge_state(network, from, to, (TransportMode)m, &incident_factor)) continue;
+                double w = calculate_weighted_leg_cost(info.time_hours * incident_factor, info.cost_yuan, ctx->options->time_weight,
+                                                       ctx->options->cost_weight);
+                double* slot = dir == 0 ? &ws->link_in[u] : &ws->link_out[u];
+                if (w < *slot) *slot = w;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 由直达路段和当前距离矩阵求经过新枢纽的最短距离：
+ *        into[s] = min_u D(s, u) + w(u, h)，from[t] = min_v w(h, v) + D(v, t)。
+ *        mask 非NULL时只计算 mask 中标记的行或列。
+ */
+static void compute_hub_distances(const FacilityContext* ctx, HubWorkspace* ws, const char* origin_mask, const char* destination_mask) {
+    int n = ctx->node_count;
+    for (int s = 0; s < n; s++) {
+        ws->into[s] = DBL_MAX;
+        if (origin_mask && !origin_mask[s]) continue;
+        const double* row = &ctx->dist[(size_t)s * ctx->stride];
+        for (int u = 0; u < n; u++) {
+            if (ws->link_in[u] == DBL_MAX || row[u] == DBL_MAX) continue;
+            double d = row[u] + ws->link_in[u];
+            if (d < ws->into[s]) ws->into[s] = d;
+        }
+    }
+    for (int t = 0; t < n; t++) ws->from[t] = destination_mask && !destination_mask[t] ? -1.0 : DBL_MAX;
+    for (int v = 0; v < n; v++) {
+        if (ws->link_out[v] == DBL_MAX) continue;
+        const double* row = &ctx->dist[(size_t)v * ctx->stride];
+        for (int t = 0; t < n; t++) {
+            if (ws->from[t] < 0 || row[t] == DBL_MAX) continue;
+            double d = ws->link_out[v] + row[t];
+            if (d < ws->from[t]) ws->from[t] = d;
+        }
+    }
+}
+
+/**
+ * @brief 计算在当前规划网络上新建候选站址的收益（需求加权总成本的减少量）。
+ * @return double 收益；站址无效（例如与已有节点重名）时返回-1。
+ */
+static double evaluate_candidate(FacilityContext* ctx, HubWorkspace* ws, int candidate) {
+    const HubCandidate* c = &ctx->candidates[candidate];
+    TrafficNetwork* scenario = traffic_network_create_overlay(ctx->planning);
+    if (!scenario) {
+        __atomic_store_n(&ctx->failed, 1, __ATOMIC_RELAXED);
+        return -1.0;
+    }
+    int hub = traffic_network_add_node(scenario, c->city_name, c->type, c->name, c->latitude, c->longitude);
+    if (hub < 0) {
+        traffic_network_destroy(scenario);
+        return -1.0;
+    }
+    compute_hub_links(ctx, scenario, hub, ws);
+    traffic_network_destroy(scenario);
+
+    compute_hub_distances(ctx, ws, ctx->is_origin, ctx->is_destination);
+    double gain = 0.0;
+    for (int i = 0; i < ctx->pair_count; i++) {
+        const DemandPair* p = &ctx->pairs[i];
+        if (ws->into[p->origin] == DBL_MAX || ws->from[p->destination] == DBL_MAX) continue;
+        double current = pair_cost(ctx->dist[(size_t)p->origin * ctx->stride + p->destination]);
+        double via_hub = ws->into[p->origin] + ws->from[p->destination];
+        if (via_hub < current) gain += p->trips * (current - via_hub);
+    }
+    return gain;
+}
+
+/**
+ * @brief parallel_for 的任务项：重新评估本批中的一个候选站址。
+ */
+static void evaluate_batch_item(int index, int worker_id, void* context) {
+    FacilityContext* ctx = (FacilityContext*)context;
+    if (solve_control_should_stop(ctx->control)) return;
+    ctx->batch_gains[index] = evaluate_candidate(ctx, &ctx->workspaces[worker_id], ctx->batch[index]);
+}
+
+/**
+ * @brief 把候选站址加入规划网络，并增量更新整个距离矩阵。
+ */
+static bool commit_hub(FacilityContext* ctx, int candidate) {
+    const HubCandidate* c = &ctx->candidates[candidate];
+    int hub = traffic_network_add_node(ctx->planning, c->city_name, c->type, c->name, c->latitude, c->longitude);
+    if (hub != ctx->node_count) return false;
+
+    HubWorkspace* ws = &ctx->workspaces[0];
+    compute_hub_links(ctx, ctx->planning, hub, ws);
+    compute_hub_distances(ctx, ws, NULL, NULL);
+    int n = ctx->node_count;
+    for (int s = 0; s < n; s++) {
+        double* row = &ctx->dist[(size_t)s * ctx->stride];
+        if (ws->into[s] != DBL_MAX) {
+            for (int t = 0; t < n; t++) {
+                if (ws->from[t] == DBL_MAX) continue;
+                double d = ws->into[s] + ws->from[t];
+                if (d < row[t]) row[t] = d;
+            }
+        }
+        row[hub] = ws->into[s];
+    }
+    double* hub_row = &ctx->dist[(size_t)hub * ctx->stride];
+    for (int t = 0; t < n; t++) hub_row[t] = ws->from[t];
+    hub_row[hub] = 0.0;
+    ctx->node_count++;
+    return true;
+}
+
+static double total_objective(const FacilityContext* ctx) {
+    double total = 0.0;
+    for (int i = 0; i < ctx->pair_count; i++) {
+        const DemandPair* p = &ctx->pairs[i];
+        total += p->trips * pair_cost(ctx->dist[(size_t)p->origin * ctx->stride + p->destination]);
+    }
+    return total;
+}
+
+static int compare_entries_by_bound(const void* a, const void* b) {
+    const CelfEntry* x = (const CelfEntry*)a;
+    const CelfEntry* y = (const CelfEntry*)b;
+    if (x->chosen != y->chosen) return x->chosen ? 1 : -1;
+    if (x->bound != y->bound) return x->bound < y->bound ? 1 : -1;
+    return x->candidate - y->candidate;
+}
+
+/**
+ * @brief 并行重新评估一批候选站址，更新它们的上界。
+ */
+static bool reevaluate(FacilityContext* ctx, CelfEntry* entries, int* entry_ids, int count, int round) {
+    for (int i = 0; i < count; i++) ctx->batch[i] = entries[entry_ids[i]].candidate;
+    thread_pool_parallel_for(thread_pool_get_default(), count, evaluate_batch_item, ctx);
+    if (ctx->failed || solve_control_should_stop(ctx->control)) return false;
+    for (int i = 0; i < count; i++) {
+        entries[entry_ids[i]].bound = ctx->batch_gains[i];
+        entries[entry_ids[i]].round = round;
+    }
+    return true;
+}
+
+// 枢纽选址的实现
+FacilityResult* optimize_hub_locations(const TrafficNetwork* network, const double* demand, const HubCandidate* candidates,
+                                       int candidate_count, const FacilityOptions* options, const SolveControl* control) {
+    if (!network || !demand || !candidates || candidate_count <= 0 || !options) return NULL;
+    if (options->hub_count <= 0) {
+        fprintf(stderr, "错误: 要新建的枢纽数必须大于0。\n");
+        return NULL;
+    }
+    int k = options->hub_count < candidate_count ? options->hub_count : candidate_count;
+    int n = traffic_network_get_node_count(network);
+
+    FacilityContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.options = options;
+    ctx.control = control;
+    ctx.candidates = candidates;
+    ctx.node_count = n;
+    ctx.stride = n + k;
+    int pool_size = thread_pool_get_size(thread_pool_get_default());
+    ctx.worker_count = pool_size > 0 ? pool_size : 1;
+    pthread_mutex_init(&ctx.progress_mutex, NULL);
+
+    FacilityResult* result = (FacilityResult*)calloc(1, sizeof(FacilityResult));
+    CelfEntry* entries = (CelfEntry*)malloc(candidate_count * sizeof(CelfEntry));
+    int* entry_ids = (int*)malloc(candidate_count * sizeof(int));
+    ctx.planning = traffic_network_create_overlay(network);
+    ctx.dist = (double*)malloc((size_t)ctx.stride * ctx.stride * sizeof(double));
+    ctx.pairs = (DemandPair*)malloc(((size_t)n * n + 1) * sizeof(DemandPair));
+    ctx.is_origin = (char*)calloc(ctx.stride, 1);
+    ctx.is_destination = (char*)calloc(ctx.stride, 1);
+    ctx.workspaces = (HubWorkspace*)calloc(ctx.worker_count, sizeof(HubWorkspace));
+    ctx.trees = (ShortestPathTree**)calloc(ctx.worker_count, sizeof(ShortestPathTree*));
+    ctx.batch = (int*)malloc(candidate_count * sizeof(int));
+    ctx.batch_gains = (double*)malloc(candidate_count * sizeof(double));
+    bool ok = result && entries && entry_ids && ctx.planning && ctx.dist && ctx.pairs && ctx.is_origin && ctx.is_destination &&
+              ctx.workspaces && ctx.trees && ctx.batch && ctx.batch_gains;
+    if (ok) {
+        result->chosen = (int*)malloc(k * sizeof(int));
+        result->gains = (double*)malloc(k * sizeof(double));
+        ok = result->chosen && result->gains;
+    }
+    for (int w = 0; ok && w < ctx.worker_count; w++) {
+        HubWorkspace* ws = &ctx.workspaces[w];
+        ws->link_in = (double*)malloc(ctx.stride * sizeof(double));
+        ws->link_out = (double*)malloc(ctx.stride * sizeof(double));
+        ws->into = (double*)malloc(ctx.stride * sizeof(double));
+        ws->from = (double*)malloc(ctx.stride * sizeof(double));
+        ok = ws->link_in && ws->link_out && ws->into && ws->from;
+    }
+    if (!ok) goto fail;
+
+    for (int o = 0; o < n; o++) {
+        for (int d = 0; d < n; d++) {
+            double trips = demand[(size_t)o * n + d];
+            if (o == d || trips <= 0) continue;
+            ctx.pairs[ctx.pair_count++] = (DemandPair){o, d, trips};
+            ctx.is_origin[o] = 1;
+            ctx.is_destination[d] = 1;
+        }
+    }
+
+    // 1. 当前网络的全源最短距离
+    thread_pool_parallel_for(thread_pool_get_default(), n, compute_distance_row, &ctx);
+    if (ctx.failed || solve_control_should_stop(control)) goto fail;
+    result->initial_objective = total_objective(&ctx);
+
+    // 2. 第一轮评估全部候选站址
+    for (int c = 0; c < candidate_count; c++) {
+        entries[c] = (CelfEntry){c, 0.0, -1, false};
+        entry_ids[c] = c;
+    }
+    if (!reevaluate(&ctx, entries, entry_ids, candidate_count, 0)) goto fail;
+    result->evaluations = candidate_count;
+
+    // 3. CELF：上界最大的候选站址收益已是最新时选中；否则并行重新评估上界最大的一批
+    while (result->chosen_count < k) {
+        int round = result->chosen_count;
+        qsort(entries, candidate_count, sizeof(CelfEntry), compare_entries_by_bound);
+        CelfEntry* top = &entries[0];
+        if (top->chosen || top->bound <= 0) break;
+        if (top->round == round) {
+            if (!commit_hub(&ctx, top->candidate)) goto fail;
+            top->chosen = true;
+            result->chosen[result->chosen_count] = top->candidate;
+            result->gains[result->chosen_count] = top->bound;
+            result->chosen_count++;
+            solve_control_report_progress(control, "facility", (double)result->chosen_count / k);
+            continue;
+        }
+        int count = 0;
+        for (int i = 0; i < candidate_count && count < ctx.worker_count; i++) {
+            if (entries[i].chosen || entries[i].bound <= 0) break;
+            if (entries[i].round != round) entry_ids[count++] = i;
+        }
+        if (!reevaluate(&ctx, entries, entry_ids, count, round)) goto fail;
+        result->evaluations += count;
+    }
+    result->final_objective = total_objective(&ctx);
+    goto cleanup;
+
+fail:
+    free_facility_result(result);
+    result = NULL;
+
+cleanup:
+    for (int w = 0; w < ctx.worker_count; w++) {
+        if (ctx.workspaces) {
+            free(ctx.workspaces[w].link_in);
+            free(ctx.workspaces[w].link_out);
+            free(ctx.workspaces[w].into);
+            free(ctx.workspaces[w].from);
+        }
+        if (ctx.trees) free_shortest_path_tree(ctx.trees[w]);
+    }
+    free(ctx.workspaces);
+    free(ctx.trees);
+    free(ctx.batch);
+    free(ctx.batch_gains);
+    free(ctx.is_origin);
+    free(ctx.is_destination);
+    free(ctx.pairs);
+    free(ctx.dist);
+    traffic_network_destroy(ctx.planning);
+    free(entries);
+    free(entry_ids);
+    pthread_mutex_destroy(&ctx.progress_mutex);
+    return result;
+}
+
+void free_facility_result(FacilityResult* result) {
+    if (!result) return;
+    free(result->chosen);
+    free(result->gains);
+    free(result);
+}
+
+// 加载候选站址的实现
+HubCandidate* facility_load_candidates_csv(const char* csv_path, int* out_count) {
+    if (!csv_path || !out_count) return NULL;
+    *out_count = 0;
+    FILE* fp = fopen(csv_path, "rb");
+    if (!fp) {
+        fprintf(stderr, "错误：无法打开文件 %s (错误码: %d)\n", csv_path, errno);
+        return NULL;
+    }
+
+    int capacity = 16, count = 0;
+    HubCandidate* candidates = (HubCandidate*)malloc(capacity * sizeof(HubCandidate));
+    char line[512];
+    int line_no = 0;
+    while (candidates && fgets(line, sizeof(line), fp)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line_no == 1 || line[0] == '\0' || line[0] == '#') continue; // 跳过表头、空行和注释
+
+        HubCandidate c;
+        char type_str[20];
+        if (sscanf(line, "%49[^,],%19[^,],%99[^,],%lf,%lf", c.city_name, type_str, c.name, &c.latitude, &c.longitude) != 5) {
+            fprintf(stderr, "错误: %s 第%d行格式错误。\n", csv_path, line_no);
+            free(candidates);
+            candidates = NULL;
+            break;
+        }
+        if (strcmp(type_str, "airport") == 0) {
+            c.type = NODE_TYPE_AIRPORT;
+        } else if (strcmp(type_str, "hsr") == 0) {
+            c.type = NODE_TYPE_HSR_STATION;
+        } else {
+            fprintf(stderr, "错误: %s 第%d行的站址类型 '%s' 无效，只能是 airport 或 hsr。\n", csv_path, line_no, type_str);
+            free(candidates);
+            candidates = NULL;
+            break;
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            HubCandidate* grown = (HubCandidate*)realloc(candidates, capacity * sizeof(HubCandidate));
+            if (!grown) {
+                free(candidates);
+                candidates = NULL;
+                break;
+            }
+            candidates = grown;
+        }
+        candidates[count++] = c;
+    }
+    fclose(fp);
+    if (candidates) *out_count = count;
+    return candidates;
+}
@@ -0,0 +1,330 @@
+/**
+ * @file geofence.c
+ * @brief 实现了规避区域的排除位图构建与缓存。
+ */
+#include "geofence.h"
+#include "thread_pool.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 缓存的位图数量上限
+#define GEOFENCE_CACHE_SIZE 8
+
+/**
+ * @brief 带缓存信息的位图。mask 必须是第一个成员，以便与 GeofenceMask 指针互相转换。
+ */
+typedef struct {
+    GeofenceMask mask;
+    uint64_t key;               // 多边形顶点与节点坐标的哈希
+    GeoPoint* points;           // 所有多边形顶点的副本，依次排列
+    int* point_counts;          // 每个多边形的顶点数
+    int polygon_count;
+    int total_points;
+    int refcount;               // 外部引用数（受 cache_mutex 保护）
+    unsigned long last_used;    // 最近一次被获取的时刻（受 cache_mutex 保护）
+    bool in_cache;              // 是否在缓存中；不在缓存中的位图在最后一次释放时销毁
+} CachedMask;
+
+/**
+ * @brief 多边形的外包矩形。
+ */
+typedef struct {
+    double min_lat, max_lat, min_lon, max_lon;
+} BoundingBox;
+
+/**
+ * @brief 构建位图时各任务共享的数据。
+ */
+typedef struct {
+    const TrafficNetwork* network;
+    CachedMask* cached;
+    BoundingBox* boxes;         // 每个多边形的外包矩形
+} BuildContext;
+
+static CachedMask* cache[GEOFENCE_CACHE_SIZE];
+static unsigned long cache_clock;
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t hash_bytes(uint64_t h, const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) h = (h ^ p[i]) * 0x100000001B3ULL;
+    return h;
+}
+
+/**
+ * @brief 射线法判断点是否在多边形内。
+ */
+static bool point_in_polygon(const GeoPoint* poly, int count, double lat, double lon) {
+    bool inside = false;
+    for (int i = 0, j = count - 1; i < count; j = i++) {
+        if ((poly[i].latitude > lat) != (poly[j].latitude > lat)) {
+            double cross_lon = poly[j].longitude +
+                               (lat - poly[j].latitude) * (poly[i].longitude - poly[j].longitude) / (poly[i].latitude - poly[j].latitude);
+            if (lon < cross_lon) inside = !inside;
+        }
+    }
+    return inside;
+}
+
+static double orientation(const GeoPoint* a, const GeoPoint* b, const GeoPoint* c) {
+    return (b->longitude - a->longitude) * (c->latitude - a->latitude) - (b->latitude - a->latitude) * (c->longitude - a->longitude);
+}
+
+/**
+ * @brief 已知 a、b、c 共线时，判断 c 是否落在线段 ab 上。
+ */
+static bool on_segment(const GeoPoint* a, const GeoPoint* b, const GeoPoint* c) {
+    return c->longitude >= fmin(a->longitude, b->longitude) && c->longitude <= fmax(a->longitude, b->longitude) &&
+           c->latitude >= fmin(a->latitude, b->latitude) && c->latitude <= fmax(a->latitude, b->latitude);
+}
+
+/**
+ * @brief 判断线段 p1p2 与 q1q2 是否相交（含端点接触和共线重叠）。
+ */
+static bool segments_intersect(const GeoPoint* p1, const GeoPoint* p2, const GeoPoint* q1, const GeoPoint* q2) {
+    double d1 = orientation(q1, q2, p1);
+    double d2 = orientation(q1, q2, p2);
+    double d3 = orientation(p1, p2, q1);
+    double d4 = orientation(p1, p2, q2);
+    if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) return true;
+    return (d1 == 0 && on_segment(q1, q2, p1)) || (d2 == 0 && on_segment(q1, q2, p2)) || (d3 == 0 && on_segment(p1, p2, q1)) ||
+           (d4 == 0 && on_segment(p1, p2, q2));
+}
+
+/**
+ * @brief 判断两节点之间的直线是否穿过某个多边形（端点在多边形内的情况由节点位图处理）。
+ */
+static bool segment_crosses_polygons(const BuildContext* ctx, const GeoPoint* a, const GeoPoint* b) {
+    const CachedMask* cached = ctx->cached;
+    double min_lat = fmin(a->latitude, b->latitude), max_lat = fmax(a->latitude, b->latitude);
+    double min_lon = fmin(a->longitude, b->longitude), max_lon = fmax(a->longitude, b->longitude);
+    const GeoPoint* poly = cached->points;
+    for (int p = 0; p < cached->polygon_count; poly += cached->point_counts[p], p++) {
+        const BoundingBox* box = &ctx->boxes[p];
+        // 外包矩形不相交时直接跳过
+        if (max_lat < box->min_lat || min_lat > box->max_lat || max_lon < box->min_lon || min_lon > box->max_lon) continue;
+        int count = cached->point_counts[p];
+        for (int i = 0, j = count - 1; i < count; j = i++) {
+            if (segments_intersect(a, b, &poly[j], &poly[i])) return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief parallel_for 的任务项：计算路段位图的一行。每行占用独立的字节，线程之间不会写同一个字节。
+ */
+static void build_edge_row(int u, int worker_id, void* context) {
+    (void)worker_id;
+    BuildContext* ctx = (BuildContext*)context;
+    GeofenceMask* mask = &ctx->cached->mask;
+    uint8_t* row = &mask->edge_bits[(size_t)u * mask->row_bytes];
+    const Node* from = traffic_network_get_node_by_id(ctx->network, u);
+    GeoPoint a = {from->latitude, from->longitude};
+    bool from_blocked = geofence_blocks_node(mask, u);
+    for (int v = 0; v < mask->node_count; v++) {
+        if (v == u) continue;
+        const Node* to = traffic_network_get_node_by_id(ctx->network, v);
+        GeoPoint b = {to->latitude, to->longitude};
+        if (from_blocked || geofence_blocks_node(mask, v) || segment_crosses_polygons(ctx, &a, &b)) {
+            row[v >> 3] |= (uint8_t)(1u << (v & 7));
+        }
+    }
+}
+
+static void free_cached_mask(CachedMask* cached) {
+    if (!cached) return;
+    free(cached->mask.node_bits);
+    free(cached->mask.edge_bits);
+    free(cached->points);
+    free(cached->point_counts);
+    free(cached);
+}
+
+/**
+ * @brief 计算多边形顶点和所有节点坐标的哈希，作为缓存的键。
+ */
+static uint64_t compute_key(const TrafficNetwork* network, const GeoPolygon* polygons, int polygon_count) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (int p = 0; p < polygon_count; p++) {
+        h = hash_bytes(h, &polygons[p].point_count, sizeof(int));
+        h = hash_bytes(h, polygons[p].points, polygons[p].point_count * sizeof(GeoPoint));
+    }
+    int n = traffic_network_get_node_count(network);
+    for (int i = 0; i < n; i++) {
+        const Node* node = traffic_network_get_node_by_id(network, i);
+        h = hash_bytes(h, &node->latitude, sizeof(double));
+        h = hash_bytes(h, &node->longitude, sizeof(double));
+    }
+    return h;
+}
+
+/**
+ * @brief 判断缓存项是否与给定的多边形和网络完全一致。
+ */
+static bool cached_matches(const CachedMask* cached, uint64_t key, int node_count, const GeoPolygon* polygons, int polygon_count) {
+    if (cached->key != key || cached->mask.node_count != node_count || cached->polygon_count != polygon_count) return false;
+    const GeoPoint* points = cached->points;
+    for (int p = 0; p < polygon_count; p++) {
+        if (cached->point_counts[p] != polygons[p].point_count) return false;
+        if (memcmp(points, polygons[p].points, polygons[p].point_count * sizeof(GeoPoint)) != 0) return false;
+        points += polygons[p].point_count;
+    }
+    return true;
+}
+
+/**
+ * @brief 构建一组多边形在网络上的位图（不加入缓存）。
+ */
+static CachedMask* build_mask(const TrafficNetwork* network, const GeoPolygon* polygons, int polygon_count, uint64_t key) {
+    int n = traffic_network_get_node_count(network);
+    CachedMask* cached = (CachedMask*)calloc(1, sizeof(CachedMask));
+    if (!cached) return NULL;
+    cached->key = key;
+    cached->polygon_count = polygon_count;
+    for (int p = 0; p < polygon_count; p++) cached->total_points += polygons[p].point_count;
+    cached->points = (GeoPoint*)malloc(cached->total_points * sizeof(GeoPoint));
+    cached->point_counts = (int*)malloc(polygon_count * sizeof(int));
+    cached->mask.node_count = n;
+    cached->mask.row_bytes = (n + 7) / 8;
+    cached->mask.node_bits = (uint8_t*)calloc(cached->mask.row_bytes, 1);
+    cached->mask.edge_bits = (uint8_t*)calloc((size_t)n * cached->mask.row_bytes + 1, 1);
+    BoundingBox* boxes = (BoundingBox*)malloc(polygon_count * sizeof(BoundingBox));
+    if (!cached->points || !cached->point_counts || !cached->mask.node_bits || !cached->mask.edge_bits || !boxes) {
+        free(boxes);
+        free_cached_mask(cached);
+        return NULL;
+    }
+
+    GeoPoint* points = cached->points;
+    for (int p = 0; p < polygon_count; p++) {
+        int count = polygons[p].point_count;
+        memcpy(points, polygons[p].points, count * sizeof(GeoPoint));
+        cached->point_counts[p] = count;
+        boxes[p] = (BoundingBox){points[0].latitude, points[0].latitude, points[0].longitude, points[0].longitude};
+        for (int i = 1; i < count; i++) {
+            boxes[p].min_lat = fmin(boxes[p].min_lat, points[i].latitude);
+            boxes[p].max_lat = fmax(boxes[p].max_lat, points[i].latitude);
+            boxes[p].min_lon = fmin(boxes[p].min_lon, points[i].longitude);
+            boxes[p].max_lon = fmax(boxes[p].max_lon, points[i].longitude);
+        }
+        points += count;
+    }
+
+    // 1. 节点位图：点在多边形内测试
+    for (int v = 0; v < n; v++) {
+        const Node* node = traffic_network_get_node_by_id(network, v);
+        const GeoPoint* poly = cached->points;
+        for (int p = 0; p < polygon_count; poly += cached->point_counts[p], p++) {
+            const BoundingBox* box = &boxes[p];
+            if (node->latitude < box->min_lat || node->latitude > box->max_lat || node->longitude < box->min_lon ||
+                node->longitude > box->max_lon) {
+                continue;
+            }
+            if (point_in_polygon(poly, cached->point_counts[p], node->latitude, node->longitude)) {
+                cached->mask.node_bits[v >> 3] |= (uint8_t)(1u << (v & 7));
+                cached->mask.blocked_node_count++;
+                break;
+            }
+        }
+    }
+
+    // 2. 路段位图：按行并行
+    BuildContext ctx = {network, cached, boxes};
+    thread_pool_parallel_for(thread_pool_get_default(), n, build_edge_row, &ctx);
+    free(boxes);
+    return cached;
+}
+
+/**
+ * @brief 在缓存中查找匹配项。调用者需持有 cache_mutex。
+ */
+static CachedMask* find_cached(uint64_t key, int node_count, const GeoPolygon* polygons, int polygon_count) {
+    for (int i = 0; i < GEOFENCE_CACHE_SIZE; i++) {
+        if (cache[i] && cached_matches(cache[i], key, node_count, polygons, polygon_count)) return cache[i];
+    }
+    return NULL;
+}
+
+// 获取排除位图的实现
+const GeofenceMask* geofence_acquire(const TrafficNetwork* network, const GeoPolygon* polygons, int polygon_count) {
+    if (!network || !polygons || polygon_count <= 0) return NULL;
+    for (int p = 0; p < polygon_count; p++) {
+        if (!polygons[p].points || polygons[p].point_count < 3) {
+            fprintf(stderr, "错误: 规避多边形至少需要3个顶点。\n");
+            return NULL;
+        }
+    }
+    int n = traffic_network_get_node_count(network);
+    uint64_t key = compute_key(network, polygons, polygon_count);
+
+    pthread_mutex_lock(&cache_mutex);
+    CachedMask* cached = find_cached(key, n, polygons, polygon_count);
+    if (cached) {
+        cached->refcount++;
+        cached->last_used = ++cache_clock;
+        pthread_mutex_unlock(&cache_mutex);
+        return &cached->mask;
+    }
+    pthread_mutex_unlock(&cache_mutex);
+
+    // 在锁外构建，避免阻塞其他查询
+    CachedMask* built = build_mask(network, polygons, polygon_count, key);
+    if (!built) return NULL;
+
+    pthread_mutex_lock(&cache_mutex);
+    cached = find_cached(key, n, polygons, polygon_count);
+    if (cached) {
+        // 其他线程已经构建了同一个位图
+        free_cached_mask(built);
+    } else {
+        cached = built;
+        // 放入空位或替换最久未使用且没有被引用的位图；都被引用时不缓存
+        int slot = -1;
+        for (int i = 0; i < GEOFENCE_CACHE_SIZE; i++) {
+            if (!cache[i]) {
+                slot = i;
+                break;
+            }
+            if (cache[i]->refcount == 0 && (slot == -1 || cache[i]->last_used < cache[slot]->last_used)) slot = i;
+        }
+        if (slot >= 0) {
+            if (cache[slot]) free_cached_mask(cache[slot]);
+            cache[slot] = cached;
+            cached->in_cache = true;
+        }
+    }
+    cached->refcount++;
+    cached->last_used = ++cache_clock;
+    pthread_mutex_unlock(&cache_mutex);
+    return &cached->mask;
+}
+
+void geofence_release(const GeofenceMask* mask) {
+    if (!mask) return;
+    CachedMask* cached = (CachedMask*)mask;
+    pthread_mutex_lock(&cache_mutex);
+    cached->refcount--;
+    bool destroy = !cached->in_cache && cached->refcount == 0;
+    pthread_mutex_unlock(&cache_mutex);
+    if (destroy) free_cached_mask(cached);
+}
+
+bool geofence_blocks_node(const GeofenceMask* mask, int node_id) {
+    if (!mask || node_id < 0 || node_id >= mask->node_count) return false;
+    return (mask->node_bits[node_id >> 3] >> (node_id & 7)) & 1;
+}
+
+void geofence_cache_clear(void) {
+    pthread_mutex_lock(&cache_mutex);
+    for (int i = 0; i < GEOFENCE_CACHE_SIZE; i++) {
+        if (cache[i] && cache[i]->refcount == 0) {
+            free_cached_mask(cache[i]);
+            cache[i] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&cache_mutex);
+}
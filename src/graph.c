@@ -5,10 +5,217 @@
  *          所有内存分配和释放的责任都集中在此模块中。
  */
 #include "graph.h"
+#include "embedded_network.h"
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// 变更日志最多保留的记录数，超出后丢弃较早的一半
+#define CHANGE_LOG_MAX 4096
+// 路段覆盖表的初始槽位数
+#define EDGE_OVERRIDE_INITIAL_CAPACITY 64
+
+/**
+ * @brief 单条有向路段（起点、终点、交通方式）的实时状态覆盖。
+ * @details 只有被交通事件修改过的路段才会出现在覆盖表中，未出现的路段按默认状态（畅通、不减速）处理。
+ */
+typedef struct {
+    int from_node_id;       ///< 路段起点。
+    int to_node_id;         ///< 路段终点。
+    int mode;               ///< 交通方式；-1 表示哈希表中的空槽。
+    double time_factor;     ///< 通行时间倍数，1.0 表示正常，大于1表示减速（不允许小于1）。
+    bool disabled;          ///< 路段是否被封闭。
+} EdgeOverride;
+
+/**
+ * @brief 交通网络的内部状态，其他模块只能通过 graph.h 中的函数访问。
+ */
+struct NetworkState {
+    // --- 交通事件（实时状态） ---
+    bool* node_disabled;            ///< 每个节点是否被封闭；NULL表示从未封闭过节点。
+    int disabled_node_count;        ///< 当前被封闭的节点数。
+    EdgeOverride* edge_overrides;   ///< 路段状态覆盖表（开放寻址哈希表）。
+    int edge_override_capacity;     ///< 覆盖表的槽位数（2的幂）。
+    int edge_override_count;        ///< 覆盖表中已占用的槽位数。
+    int active_edge_override_count; ///< 处于非默认状态（封闭或减速）的路段数。
+    NetworkChange* changes;         ///< 变更日志，按版本号递增排列。
+    int change_count;
+    int change_capacity;
+    unsigned long version;          ///< 当前版本号，每次变更加一。
+    unsigned long change_log_floor; ///< 日志只保留版本号大于该值的变更，更早的已被丢弃。
+
+    // --- 情景覆盖（写时复制） ---
+    const TrafficNetwork* base;     ///< 覆盖网络的基础网络；普通网络为NULL。
+    unsigned long base_version;     ///< 创建覆盖网络时基础网络的版本号。
+    bool shares_nodes;              ///< 节点数组仍与基础网络共享。
+    bool shares_cities;             ///< 城市数组仍与基础网络共享。
+    bool shares_node_disabled;      ///< 节点封闭标记数组仍与基础网络共享。
+    bool shares_edge_overrides;     ///< 路段覆盖表仍与基础网络共享。
+
+    // --- 内置数据（见 embedded_network.h） ---
+    const int* name_index;          ///< 按名称排序的节点ID，NULL表示没有；只在节点数仍为 name_index_count 时使用。
+    int name_index_count;
+
+    // --- 同城表（见 city_tables.h） ---
+    const struct CityTables* city_tables; ///< 寻路时查表使用的同城表，由调用者持有；NULL表示不查表。
+};
+
+/**
+ * @brief 网络句柄和内部状态放在同一块内存中，一次分配、一次释放。
+ */
+typedef struct {
+    TrafficNetwork network;
+    struct NetworkState state;
+} NetworkBlock;
+
+/**
+ * @brief 分配一个所有字段都为零的网络句柄及其内部状态。
+ * @return TrafficNetwork* 内存不足时返回NULL。
+ */
+static TrafficNetwork* allocate_network(void) {
+    NetworkBlock* block = (NetworkBlock*)calloc(1, sizeof(NetworkBlock));
+    if (!block) return NULL;
+    block->network.state = &block->state;
+    return &block->network;
+}
+
+/**
+ * @brief 向网络追加一个节点，所属城市不存在时一并创建。
+ * @details 调用者需保证节点、城市和封闭标记数组都归该网络所有（覆盖网络需先完成写时复制）。
+ * @return int 新节点的ID；内存不足时返回-1。
+ */
+static int append_node(TrafficNetwork* network, const char* city_name, NodeType ntype, const char* node_name, double lat, double lon) {
+    // --- 城市管理 ---
+    // 查找或创建城市记录
+    int city_id = -1;
+    
+    // 遍历现有城市查找匹配项
+    for (int i = 0; i < network->city_count; i++) {
+        if (strcmp(network->cities[i].city_name, city_name) == 0) {
+            city_id = i;
+            break;
+        }
+    }
+    
+    // 如果是新城市
+    if (city_id == -1) {
+        // 检查城市数组容量
+        if (network->city_count >= network->city_capacity) {
+            // 容量翻倍策略减少realloc次数
+            int new_capacity = network->city_capacity * 2;
+            CityMeta* new_cities = (CityMeta*)realloc(
+                network->cities, new_capacity * sizeof(CityMeta));
+            
+            if (!new_cities) {
+                fprintf(stderr, "错误: 城市数组扩容失败\n");
+                return -1;
+            }
+            
+            network->cities = new_cities;
+            network->city_capacity = new_capacity;
+        }
+        
+        // 初始化新城市记录
+        city_id = network->city_count;
+        CityMeta* city = &network->cities[city_id];
+        
+        city->city_id = city_id;
+        // 安全拷贝城市名称（确保终止符）
+        strncpy(city->city_name, city_name, sizeof(city->city_name) - 1);
+        city->city_name[sizeof(city->city_name) - 1] = '\0';
+        
+        // 初始化枢纽节点ID为-1（表示未设置）
+        city->landmark_node_id = -1;
+        city->airport_node_id = -1;
+        city->hsr_node_id = -1;
+        
+        network->city_count++;
+    }
+
+    // --- 节点添加 ---
+    // 检查节点数组容量
+    if (network->node_count >= network->node_capacity) {
+        // 容量翻倍策略
+        int new_capacity = network->node_capacity * 2;
+        Node* new_nodes = (Node*)realloc(
+            network->nodes, new_capacity * sizeof(Node));
+        
+        if (!new_nodes) {
+            fprintf(stderr, "错误: 节点数组扩容失败\n");
+            return -1;
+        }
+        
+        network->nodes = new_nodes;
+        network->node_capacity = new_capacity;
+    }
+    // 封闭标记数组与节点数组等长
+    if (network->state->node_disabled) {
+        bool* disabled = (bool*)realloc(network->state->node_disabled, network->node_capacity * sizeof(bool));
+        if (!disabled) {
+            fprintf(stderr, "错误: 节点状态数组扩容失败\n");
+            return -1;
+        }
+        memset(disabled + network->node_count, 0, (network->node_capacity - network->node_count) * sizeof(bool));
+        network->state->node_disabled = disabled;
+    }
+    
+    // 获取当前节点指针
+    Node* node = &network->nodes[network->node_count];
+    
+    // 初始化节点字段
+    node->id = network->node_count; // ID等于当前计数
+    node->city_id = city_id;
+    node->type = ntype;
+    node->latitude = lat;
+    node->longitude = lon;
+    
+    // 安全拷贝节点名称（确保终止符）
+    strncpy(node->name, node_name, sizeof(node->name) - 1);
+    node->name[sizeof(node->name) - 1] = '\0';
+    
+    // --- 更新城市索引 ---
+    // 如果是该城市第一个此类枢纽节点，则记录其ID
+    CityMeta* city = &network->cities[city_id];
+    switch (ntype) {
+        case NODE_TYPE_LANDMARK:
+            if (city->landmark_node_id == -1) {
+                city->landmark_node_id = node->id;
+            }
+            break;
+            
+        case NODE_TYPE_AIRPORT:
+            if (city->airport_node_id == -1) {
+                city->airport_node_id = node->id;
+            }
+            break;
+            
+        case NODE_TYPE_HSR_STATION:
+            if (city->hsr_node_id == -1) {
+                city->hsr_node_id = node->id;
+            }
+            break;
+            
+        default:
+            break; // 不应发生（前面已过滤）
+    }
+    
+    network->node_count++; // 成功添加节点
+    return node->id;
+}
+
+/**
+ * @brief 用内置数据创建网络：直接引用只读的数据表，第一次修改时才复制。
+ */
+static TrafficNetwork* wrap_embedded_network(const EmbeddedNetwork* embedded) {
+    TrafficNetwork* network = traffic_network_wrap_arrays(embedded->nodes, embedded->node_count, embedded->cities, embedded->city_count);
+    if (!network) return NULL;
+    network->state->name_index = embedded->name_index;
+    network->state->name_index_count = embedded->node_count;
+    printf("成功加载内置数据: %d 个城市, %d 个节点\n", network->city_count, network->node_count);
+    return network;
+}
+
 /**
  * @brief 从CSV文件创建交通网络结构
  * @details 该函数负责：
@@ -20,6 +227,11 @@
  * @return TrafficNetwork* 成功返回网络指针，失败返回NULL
  */
 TrafficNetwork* traffic_network_create(const char* nodes_csv_path) {
+    const EmbeddedNetwork* embedded = embedded_network_get();
+    if (embedded && nodes_csv_path && strcmp(nodes_csv_path, embedded->source_path) == 0) {
+        return wrap_embedded_network(embedded);
+    }
+
     // ==================== 文件打开阶段 ====================
     // 以只读模式打开CSV文件，使用二进制模式避免文本转换问题
     FILE* fp = fopen(nodes_csv_path, "rb");
@@ -32,7 +244,7 @@ TrafficNetwork* traffic_network_create(const char* nodes_csv_path) {
 
     // ==================== 内存分配阶段 ====================
     // 为整个交通网络结构体分配内存（使用calloc确保零初始化）
-    TrafficNetwork* network = (TrafficNetwork*)calloc(1, sizeof(TrafficNetwork));
+    TrafficNetwork* network = allocate_network();
     if (!network) {
         fprintf(stderr, "错误: 交通网络对象内存分配失败\n");
         fclose(fp);
@@ -113,111 +325,7 @@ TrafficNetwork* traffic_network_create(const char* nodes_csv_path) {
             continue; // 跳过不支持的类型
         }
 
-        // --- 城市管理 ---
-        // 查找或创建城市记录
-        int city_id = -1;
-        
-        // 遍历现有城市查找匹配项
-        for (int i = 0; i < network->city_count; i++) {
-            if (strcmp(network->cities[i].city_name, city_name) == 0) {
-                city_id = i;
-                break;
-            }
-        }
-        
-        // 如果是新城市
-        if (city_id == -1) {
-            // 检查城市数组容量
-            if (network->city_count >= network->city_capacity) {
-                // 容量翻倍策略减少realloc次数
-                int new_capacity = network->city_capacity * 2;
-                CityMeta* new_cities = (CityMeta*)realloc(
-                    network->cities, new_capacity * sizeof(CityMeta));
-                
-                if (!new_cities) {
-                    fprintf(stderr, "错误: 城市数组扩容失败\n");
-                    continue; // 跳过当前节点（不终止整个加载过程）
-                }
-                
-                network->cities = new_cities;
-                network->city_capacity = new_capacity;
-            }
-            
-            // 初始化新城市记录
-            city_id = network->city_count;
-            CityMeta* city = &network->cities[city_id];
-            
-            city->city_id = city_id;
-            // 安全拷贝城市名称（确保终止符）
-            strncpy(city->city_name, city_name, sizeof(city->city_name) - 1);
-            city->city_name[sizeof(city->city_name) - 1] = '\0';
-            
-            // 初始化枢纽节点ID为-1（表示未设置）
-            city->landmark_node_id = -1;
-            city->airport_node_id = -1;
-            city->hsr_node_id = -1;
-            
-            network->city_count++;
-        }
-
-        // --- 节点添加 ---
-        // 检查节点数组容量
-        if (network->node_count >= network->node_capacity) {
-            // 容量翻倍策略
-            int new_capacity = network->node_capacity * 2;
-            Node* new_nodes = (Node*)realloc(
-                network->nodes, new_capacity * sizeof(Node));
-            
-            if (!new_nodes) {
-                fprintf(stderr, "错误: 节点数组扩容失败\n");
-                continue;
-            }
-            
-            network->nodes = new_nodes;
-            network->node_capacity = new_capacity;
-        }
-        
-        // 获取当前节点指针
-        Node* node = &network->nodes[network->node_count];
-        
-        // 初始化节点字段
-        node->id = network->node_count; // ID等于当前计数
-        node->city_id = city_id;
-        node->type = ntype;
-        node->latitude = lat;
-        node->longitude = lon;
-        
-        // 安全拷贝节点名称（确保终止符）
-        strncpy(node->name, node_name, sizeof(node->name) - 1);
-        node->name[sizeof(node->name) - 1] = '\0';
-        
-        // --- 更新城市索引 ---
-        // 如果是该城市第一个此类枢纽节点，则记录其ID
-        CityMeta* city = &network->cities[city_id];
-        switch (ntype) {
-            case NODE_TYPE_LANDMARK:
-                if (city->landmark_node_id == -1) {
-                    city->landmark_node_id = node->id;
-                }
-                break;
-                
-            case NODE_TYPE_AIRPORT:
-                if (city->airport_node_id == -1) {
-                    city->airport_node_id = node->id;
-                }
-                break;
-                
-            case NODE_TYPE_HSR_STATION:
-                if (city->hsr_node_id == -1) {
-                    city->hsr_node_id = node->id;
-                }
-                break;
-                
-            default:
-                break; // 不应发生（前面已过滤）
-        }
-        
-        network->node_count++; // 成功添加节点
+        append_node(network, city_name, ntype, node_name, lat, lon);
     }
 
     // ==================== 清理阶段 ====================
@@ -230,11 +338,68 @@ TrafficNetwork* traffic_network_create(const char* nodes_csv_path) {
     return network;
 }
 
+/**
+ * @brief 检查外部传入的节点和城市数组是否一致：节点 id 等于下标，city_id 是有效的城市下标。
+ */
+static bool check_arrays(const Node* nodes, int node_count, const CityMeta* cities, int city_count) {
+    if (!nodes || !cities || node_count <= 0 || city_count <= 0) return false;
+    for (int i = 0; i < node_count; i++) {
+        if (nodes[i].id != i || nodes[i].city_id < 0 || nodes[i].city_id >= city_count) {
+            fprintf(stderr, "错误: 节点数据不一致（节点 %d）\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+TrafficNetwork* traffic_network_create_from_arrays(const Node* nodes, int node_count, const CityMeta* cities, int city_count) {
+    if (!check_arrays(nodes, node_count, cities, city_count)) return NULL;
+
+    TrafficNetwork* network = allocate_network();
+    if (!network) {
+        fprintf(stderr, "错误: 交通网络对象内存分配失败\n");
+        return NULL;
+    }
+    network->nodes = (Node*)malloc(node_count * sizeof(Node));
+    network->cities = (CityMeta*)malloc(city_count * sizeof(CityMeta));
+    if (!network->nodes || !network->cities) {
+        fprintf(stderr, "错误: 节点或城市数组内存分配失败\n");
+        traffic_network_destroy(network);
+        return NULL;
+    }
+    memcpy(network->nodes, nodes, node_count * sizeof(Node));
+    memcpy(network->cities, cities, city_count * sizeof(CityMeta));
+    network->node_count = network->node_capacity = node_count;
+    network->city_count = network->city_capacity = city_count;
+    return network;
+}
+
+TrafficNetwork* traffic_network_wrap_arrays(const Node* nodes, int node_count, const CityMeta* cities, int city_count) {
+    if (!check_arrays(nodes, node_count, cities, city_count)) return NULL;
+    TrafficNetwork* network = allocate_network();
+    if (!network) {
+        fprintf(stderr, "错误: 交通网络对象内存分配失败\n");
+        return NULL;
+    }
+    // 与覆盖网络一样标记为共享：共享的数组不会被写入或释放，去掉 const 是安全的
+    network->nodes = (Node*)nodes;
+    network->node_count = network->node_capacity = node_count;
+    network->cities = (CityMeta*)cities;
+    network->city_count = network->city_capacity = city_count;
+    network->state->shares_nodes = true;
+    network->state->shares_cities = true;
+    return network;
+}
+
 void traffic_network_destroy(TrafficNetwork* network) {
     if (network) {
-        free(network->nodes);   // 释放节点数组
-        free(network->cities);  // 释放城市数组
-        free(network);          // 释放网络结构体本身
+        // 覆盖网络只释放自己拥有（已写时复制）的数组，与基础网络共享的数组由基础网络释放
+        if (!network->state->shares_nodes) free(network->nodes);   // 释放节点数组
+        if (!network->state->shares_cities) free(network->cities); // 释放城市数组
+        if (!network->state->shares_node_disabled) free(network->state->node_disabled);   // 释放交通事件相关的状态
+        if (!network->state->shares_edge_overrides) free(network->state->edge_overrides);
+        free(network->state->changes);
+        free(network);          // 释放网络结构体本身（内部状态与它在同一块内存中）
     }
 }
 
@@ -252,6 +417,17 @@ int traffic_network_get_node_count(const TrafficNetwork* network) {
 
 int traffic_network_find_node_id_by_name(const TrafficNetwork* network, const char* name) {
     if (!network || !name) return -1; // 防御性检查
+    // 内置数据带有按名称排序的索引，二分查找第一个名称匹配的节点
+    if (network->state->name_index && network->state->name_index_count == network->node_count) {
+        int lo = 0, hi = network->node_count;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (strcmp(network->nodes[network->state->name_index[mid]].name, name) < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo < network->node_count && strcmp(network->nodes[network->state->name_index[lo]].name, name) == 0) return network->state->name_index[lo];
+        return -1;
+    }
     // 遍历所有节点
     for (int i = 0; i < network->node_count; i++) {
         // 如果找到名称匹配的节点
@@ -260,4 +436,325 @@ int traffic_network_find_node_id_by_name(const TrafficNetwork* network, const ch
         }
     }
     return -1; // 遍历完都未找到，返回-1
-} 
\ No newline at end of file
+} 
+
+// ==================== 写时复制 ====================
+// 覆盖网络创建时与基础网络共享所有数组，第一次修改某个数组时才复制一份私有副本。
+
+static bool make_nodes_private(TrafficNetwork* network) {
+    if (!network->state->shares_nodes) return true;
+    Node* nodes = (Node*)malloc(network->node_capacity * sizeof(Node));
+    if (!nodes) {
+        fprintf(stderr, "错误: 节点数组复制失败\n");
+        return false;
+    }
+    memcpy(nodes, network->nodes, network->node_count * sizeof(Node));
+    network->nodes = nodes;
+    network->state->shares_nodes = false;
+    return true;
+}
+
+static bool make_cities_private(TrafficNetwork* network) {
+    if (!network->state->shares_cities) return true;
+    CityMeta* cities = (CityMeta*)malloc(network->city_capacity * sizeof(CityMeta));
+    if (!cities) {
+        fprintf(stderr, "错误: 城市数组复制失败\n");
+        return false;
+    }
+    memcpy(cities, network->cities, network->city_count * sizeof(CityMeta));
+    network->cities = cities;
+    network->state->shares_cities = false;
+    return true;
+}
+
+static bool make_node_disabled_private(TrafficNetwork* network) {
+    if (!network->state->shares_node_disabled) return true;
+    bool* disabled = (bool*)calloc(network->node_capacity, sizeof(bool));
+    if (!disabled) {
+        fprintf(stderr, "错误: 节点状态数组复制失败\n");
+        return false;
+    }
+    memcpy(disabled, network->state->node_disabled, network->node_count * sizeof(bool));
+    network->state->node_disabled = disabled;
+    network->state->shares_node_disabled = false;
+    return true;
+}
+
+static bool make_edge_overrides_private(TrafficNetwork* network) {
+    if (!network->state->shares_edge_overrides) return true;
+    EdgeOverride* table = (EdgeOverride*)malloc(network->state->edge_override_capacity * sizeof(EdgeOverride));
+    if (!table) {
+        fprintf(stderr, "错误: 路段状态表复制失败\n");
+        return false;
+    }
+    memcpy(table, network->state->edge_overrides, network->state->edge_override_capacity * sizeof(EdgeOverride));
+    network->state->edge_overrides = table;
+    network->state->shares_edge_overrides = false;
+    return true;
+}
+
+TrafficNetwork* traffic_network_create_overlay(const TrafficNetwork* base) {
+    if (!base) return NULL;
+    TrafficNetwork* overlay = allocate_network();
+    if (!overlay) {
+        fprintf(stderr, "错误: 覆盖网络内存分配失败\n");
+        return NULL;
+    }
+    // 所有数组指针都指向基础网络的数据
+    struct NetworkState* state = overlay->state;
+    *overlay = *base;
+    *state = *base->state;
+    overlay->state = state;
+
+    overlay->state->base = base;
+    overlay->state->base_version = base->state->version;
+    overlay->state->shares_nodes = true;
+    overlay->state->shares_cities = true;
+    overlay->state->shares_node_disabled = base->state->node_disabled != NULL;
+    overlay->state->shares_edge_overrides = base->state->edge_overrides != NULL;
+
+    // 变更日志只记录覆盖网络自己的变更，版本号从基础网络的当前版本继续
+    overlay->state->changes = NULL;
+    overlay->state->change_count = 0;
+    overlay->state->change_capacity = 0;
+    overlay->state->change_log_floor = base->state->version;
+    // 同城表与建表时的网络绑定，覆盖网络不查表
+    overlay->state->city_tables = NULL;
+    return overlay;
+}
+
+const TrafficNetwork* traffic_network_get_base(const TrafficNetwork* network) {
+    return network ? network->state->base : NULL;
+}
+
+/**
+ * @brief 追加一条变更记录，并把网络版本号加一。
+ * @return bool 内存不足时返回false。
+ */
+static bool record_change(TrafficNetwork* network, int from_node_id, int to_node_id, int mode) {
+    if (network->state->change_count >= CHANGE_LOG_MAX) {
+        // 丢弃较早的一半；版本号不晚于它们的结果只能完整重新计算
+        int dropped = CHANGE_LOG_MAX / 2;
+        network->state->change_log_floor = network->state->changes[dropped - 1].version;
+        memmove(network->state->changes, network->state->changes + dropped, (network->state->change_count - dropped) * sizeof(NetworkChange));
+        network->state->change_count -= dropped;
+    }
+    if (network->state->change_count >= network->state->change_capacity) {
+        int new_capacity = network->state->change_capacity ? network->state->change_capacity * 2 : 64;
+        NetworkChange* changes = (NetworkChange*)realloc(network->state->changes, new_capacity * sizeof(NetworkChange));
+        if (!changes) {
+            fprintf(stderr, "错误: 变更日志扩容失败\n");
+            return false;
+        }
+        network->state->changes = changes;
+        network->state->change_capacity = new_capacity;
+    }
+    NetworkChange* change = &network->state->changes[network->state->change_count++];
+    change->version = ++network->state->version;
+    change->from_node_id = from_node_id;
+    change->to_node_id = to_node_id;
+    change->mode = mode;
+    return true;
+}
+
+bool traffic_network_set_node_enabled(TrafficNetwork* network, int node_id, bool enabled) {
+    if (!network || node_id < 0 || node_id >= network->node_count) return false;
+    if (traffic_network_is_node_enabled(network, node_id) == enabled) return true; // 状态未变化
+
+    // 第一次封闭节点时才分配标记数组；覆盖网络第一次修改时复制基础网络的标记数组
+    if (!make_node_disabled_private(network)) return false;
+    if (!network->state->node_disabled) {
+        network->state->node_disabled = (bool*)calloc(network->node_capacity, sizeof(bool));
+        if (!network->state->node_disabled) return false;
+    }
+    network->state->node_disabled[node_id] = !enabled;
+    network->state->disabled_node_count += enabled ? -1 : 1;
+    return record_change(network, node_id, -1, -1);
+}
+
+bool traffic_network_is_node_enabled(const TrafficNetwork* network, int node_id) {
+    if (!network || node_id < 0 || node_id >= network->node_count) return false;
+    return !network->state->node_disabled || !network->state->node_disabled[node_id];
+}
+
+static unsigned int edge_hash(int from_node_id, int to_node_id, int mode) {
+    unsigned int h = (unsigned int)from_node_id * 73856093u;
+    h ^= (unsigned int)to_node_id * 19349663u;
+    h ^= (unsigned int)mode * 83492791u;
+    return h;
+}
+
+/**
+ * @brief 在覆盖表中查找一条路段。
+ * @return EdgeOverride* 找到时返回对应槽位，否则返回NULL。
+ */
+static EdgeOverride* find_edge_override(const TrafficNetwork* network, int from_node_id, int to_node_id, int mode) {
+    if (network->state->edge_override_capacity == 0) return NULL;
+    unsigned int mask = (unsigned int)network->state->edge_override_capacity - 1;
+    unsigned int h = edge_hash(from_node_id, to_node_id, mode) & mask;
+    while (network->state->edge_overrides[h].mode != -1) {
+        EdgeOverride* e = &network->state->edge_overrides[h];
+        if (e->from_node_id == from_node_id && e->to_node_id == to_node_id && e->mode == mode) return e;
+        h = (h + 1) & mask;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 查找一条路段的覆盖项，不存在时以默认状态插入。
+ * @details 槽位不会被删除：路段恢复默认状态后仍保留在表中，只从活动计数中减去。
+ */
+static EdgeOverride* get_or_insert_edge_override(TrafficNetwork* network, int from_node_id, int to_node_id, int mode) {
+    if (!make_edge_overrides_private(network)) return NULL;
+    EdgeOverride* existing = find_edge_override(network, from_node_id, to_node_id, mode);
+    if (existing) return existing;
+
+    // 装载因子超过一半时扩容并重新插入
+    if ((network->state->edge_override_count + 1) * 2 > network->state->edge_override_capacity) {
+        int new_capacity = network->state->edge_override_capacity ? network->state->edge_override_capacity * 2 : EDGE_OVERRIDE_INITIAL_CAPACITY;
+        EdgeOverride* table = (EdgeOverride*)malloc(new_capacity * sizeof(EdgeOverride));
+        if (!table) {
+            fprintf(stderr, "错误: 路段状态表扩容失败\n");
+            return NULL;
+        }
+        for (int i = 0; i < new_capacity; i++) table[i].mode = -1;
+        for (int i = 0; i < network->state->edge_override_capacity; i++) {
+            const EdgeOverride* e = &network->state->edge_overrides[i];
+            if (e->mode == -1) continue;
+            unsigned int h = edge_hash(e->from_node_id, e->to_node_id, e->mode) & (unsigned int)(new_capacity - 1);
+            while (table[h].mode != -1) h = (h + 1) & (unsigned int)(new_capacity - 1);
+            table[h] = *e;
+        }
+        free(network->state->edge_overrides);
+        network->state->edge_overrides = table;
+        network->state->edge_override_capacity = new_capacity;
+    }
+
+    unsigned int mask = (unsigned int)network->state->edge_override_capacity - 1;
+    unsigned int h = edge_hash(from_node_id, to_node_id, mode) & mask;
+    while (network->state->edge_overrides[h].mode != -1) h = (h + 1) & mask;
+    EdgeOverride* e = &network->state->edge_overrides[h];
+    e->from_node_id = from_node_id;
+    e->to_node_id = to_node_id;
+    e->mode = mode;
+    e->time_factor = 1.0;
+    e->disabled = false;
+    network->state->edge_override_count++;
+    return e;
+}
+
+static bool edge_override_is_default(const EdgeOverride* e) {
+    return !e->disabled && e->time_factor == 1.0;
+}
+
+/**
+ * @brief 修改一条路段的状态：更新活动计数并记录变更。状态未变化时不做任何事。
+ */
+static bool update_edge(TrafficNetwork* network, int from_node_id, int to_node_id, TransportMode mode, bool disabled, double time_factor) {
+    if (!network || from_node_id < 0 || from_node_id >= network->node_count || to_node_id < 0 || to_node_id >= network->node_count ||
+        mode < 0 || mode >= TRANSPORT_MODE_COUNT) {
+        return false;
+    }
+    EdgeOverride* e = get_or_insert_edge_override(network, from_node_id, to_node_id, mode);
+    if (!e) return false;
+    if (e->disabled == disabled && e->time_factor == time_factor) return true;
+
+    bool was_default = edge_override_is_default(e);
+    e->disabled = disabled;
+    e->time_factor = time_factor;
+    bool is_default = edge_override_is_default(e);
+    if (was_default && !is_default) network->state->active_edge_override_count++;
+    if (!was_default && is_default) network->state->active_edge_override_count--;
+    return record_change(network, from_node_id, to_node_id, mode);
+}
+
+bool traffic_network_set_edge_enabled(TrafficNetwork* network, int from_node_id, int to_node_id, TransportMode mode, bool enabled) {
+    if (!network) return false;
+    const EdgeOverride* e = find_edge_override(network, from_node_id, to_node_id, mode);
+    return update_edge(network, from_node_id, to_node_id, mode, !enabled, e ? e->time_factor : 1.0);
+}
+
+bool traffic_network_set_edge_time_factor(TrafficNetwork* network, int from_node_id, int to_node_id, TransportMode mode, double time_factor) {
+    // 只允许减速：A*启发式和CSR引擎的闭集搜索都假定边权不低于固定速度模型下的值
+    if (!network || !(time_factor >= 1.0)) return false;
+    const EdgeOverride* e = find_edge_override(network, from_node_id, to_node_id, mode);
+    return update_edge(network, from_node_id, to_node_id, mode, e ? e->disabled : false, time_factor);
+}
+
+bool traffic_network_get_edge_state(const TrafficNetwork* network, int from_node_id, int to_node_id, TransportMode mode, double* time_factor) {
+    *time_factor = 1.0;
+    if (network->state->disabled_node_count > 0 && (network->state->node_disabled[from_node_id] || network->state->node_disabled[to_node_id])) return false;
+    if (network->state->active_edge_override_count == 0) return true; // 没有路段事件时不查表
+
+    const EdgeOverride* e = find_edge_override(network, from_node_id, to_node_id, mode);
+    if (!e) return true;
+    *time_factor = e->time_factor;
+    return !e->disabled;
+}
+
+void traffic_network_clear_incidents(TrafficNetwork* network) {
+    if (!network) return;
+    for (int i = 0; i < network->node_count && network->state->disabled_node_count > 0; i++) {
+        if (network->state->node_disabled[i]) traffic_network_set_node_enabled(network, i, true);
+    }
+    for (int i = 0; i < network->state->edge_override_capacity; i++) {
+        const EdgeOverride* e = &network->state->edge_overrides[i];
+        if (e->mode != -1 && !edge_override_is_default(e)) {
+            update_edge(network, e->from_node_id, e->to_node_id, (TransportMode)e->mode, false, 1.0);
+        }
+    }
+}
+
+bool traffic_network_has_incidents(const TrafficNetwork* network) {
+    return network && (network->state->disabled_node_count > 0 || network->state->active_edge_override_count > 0);
+}
+
+unsigned long traffic_network_get_version(const TrafficNetwork* network) {
+    return network ? network->state->version : 0;
+}
+
+unsigned long traffic_network_get_base_version(const TrafficNetwork* network) {
+    return network && network->state->base ? network->state->base_version : 0;
+}
+
+void traffic_network_set_city_tables(TrafficNetwork* network, const struct CityTables* tables) {
+    if (network) network->state->city_tables = tables;
+}
+
+const struct CityTables* traffic_network_get_city_tables(const TrafficNetwork* network) {
+    return network ? network->state->city_tables : NULL;
+}
+
+bool traffic_network_get_changes_since(const TrafficNetwork* network, unsigned long since_version, const NetworkChange** out_changes,
+                                       int* out_count) {
+    *out_changes = NULL;
+    *out_count = 0;
+    if (!network || since_version < network->state->change_log_floor) return false;
+
+    // 日志按版本号递增，二分查找第一条晚于 since_version 的记录
+    int lo = 0, hi = network->state->change_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (network->state->changes[mid].version <= since_version) lo = mid + 1;
+        else hi = mid;
+    }
+    *out_changes = network->state->changes + lo;
+    *out_count = network->state->change_count - lo;
+    return true;
+}
+
+int traffic_network_add_node(TrafficNetwork* network, const char* city_name, NodeType type, const char* node_name, double latitude,
+                             double longitude) {
+    if (!network || !city_name || !node_name || type < NODE_TYPE_LANDMARK || type > NODE_TYPE_HSR_STATION) return -1;
+    if (traffic_network_find_node_id_by_name(network, node_name) != -1) {
+        fprintf(stderr, "错误: 节点 %s 已存在\n", node_name);
+        return -1;
+    }
+    if (!make_nodes_private(network) || !make_cities_private(network) || !make_node_disabled_private(network)) return -1;
+
+    int node_id = append_node(network, city_name, type, node_name, latitude, longitude);
+    if (node_id < 0) return -1;
+    // 新节点记为一次节点变更，已有的最短路径树据此增量扩展
+    if (!record_change(network, node_id, -1, -1)) return -1;
+    return node_id;
+}
@@ -0,0 +1,629 @@
+/**
+ * @file hierarchical_tsp.c
+ * @brief 实现了大规模TSP的分层分解求解：分簇、簇内并行求解、簇间排序、拼接与边界抛光。
+ */
+#include "hierarchical_tsp.h"
+#include "pathfinding.h"
+#include "thread_pool.h"
+#include "tsp_matrix.h"
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 为一些可能没有定义 M_PI 的编译器提供一个备份定义。
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// k-means 的最大迭代次数
+#define KMEANS_MAX_ITERATIONS 50
+
+/**
+ * @brief 一个途经点簇。
+ */
+typedef struct {
+    int* members;           // 簇内途经点的下标（指向去重后的途经点数组）
+    int count;              // 簇内途经点数量
+    int representative;     // 最接近簇中心的途经点下标，用于求解簇间顺序
+    double* matrix;         // count × count 的簇内成本矩阵（簇内局部下标）
+    int* tour;              // 簇内环路（簇内局部下标）
+} StopCluster;
+
+/**
+ * @brief 簇的动态数组。
+ */
+typedef struct {
+    StopCluster* items;
+    int count;
+    int capacity;
+} ClusterList;
+
+/**
+ * @brief 分层求解过程中各并行阶段共享的上下文。
+ */
+typedef struct {
+    const TrafficNetwork* network;
+    const int* stop_nodes;          // 去重后的途经点节点ID
+    ClusterList* clusters;
+    double time_weight;
+    double cost_weight;
+    const SolveControl* control;
+
+    double* cluster_matrix;         // 簇间成本矩阵（簇数 × 簇数）
+    const int* window_nodes;        // 边界抛光窗口中的节点ID
+    double* window_matrix;          // 窗口成本矩阵
+    int window_size;                // 窗口中的点数
+
+    pthread_mutex_t mutex;          // 保护下面两个字段和进度回调
+    int completed;                  // 当前阶段已完成的任务项数
+    int failed;                     // 非0表示某个任务项失败（不可达、内存不足或被取消）
+} HierarchicalContext;
+
+void hierarchical_tsp_default_options(HierarchicalTspOptions* options) {
+    if (!options) return;
+    options->method = CLUSTER_BY_KMEANS;
+    options->max_cluster_size = HELD_KARP_MAX_NODES;
+    options->boundary_window = 4;
+    options->seed = 12345u;
+    options->engine = NULL;
+}
+
+/**
+ * @brief xorshift32 伪随机数生成器。
+ */
+static unsigned int next_random(unsigned int* state) {
+    unsigned int x = *state ? *state : 0x9E3779B9u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static bool append_cluster(ClusterList* list, const int* members, int count) {
+    if (list->count >= list->capacity) {
+        int new_capacity = list->capacity ? list->capacity * 2 : 16;
+        StopCluster* items = (StopCluster*)realloc(list->items, new_capacity * sizeof(StopCluster));
+        if (!items) return false;
+        list->items = items;
+        list->capacity = new_capacity;
+    }
+    StopCluster* cluster = &list->items[list->count];
+    memset(cluster, 0, sizeof(StopCluster));
+    cluster->members = (int*)malloc(count * sizeof(int));
+    if (!cluster->members) return false;
+    memcpy(cluster->members, members, count * sizeof(int));
+    cluster->count = count;
+    list->count++;
+    return true;
+}
+
+static void free_cluster_list(ClusterList* list) {
+    for (int i = 0; i < list->count; i++) {
+        free(list->items[i].members);
+        free(list->items[i].matrix);
+        free(list->items[i].tour);
+    }
+    free(list->items);
+}
+
+/**
+ * @brief 对一组点做 k-means 聚类（k-means++ 初始化）。
+ *
+ * @param x,y 所有途经点的平面坐标。
+ * @param idx 参与聚类的途经点下标。
+ * @param count 参与聚类的点数。
+ * @param k 簇数。
+ * @param rng 随机数状态。
+ * @param assign 输出参数，assign[i] 是 idx[i] 所属的簇。
+ */
+static void kmeans(const double* x, const double* y, const int* idx, int count, int k, unsigned int* rng, int* assign) {
+    double* cx = (double*)malloc(k * sizeof(double));
+    double* cy = (double*)malloc(k * sizeof(double));
+    double* dist2 = (double*)malloc(count * sizeof(double));
+    int* sizes = (int*)malloc(k * sizeof(int));
+    if (!cx || !cy || !dist2 || !sizes) {
+        for (int i = 0; i < count; i++) assign[i] = i % k;
+        free(cx); free(cy); free(dist2); free(sizes);
+        return;
+    }
+
+    // k-means++：第一个中心随机选取，之后按到最近中心距离的平方加权选取
+    int first = next_random(rng) % count;
+    cx[0] = x[idx[first]];
+    cy[0] = y[idx[first]];
+    for (int c = 1; c < k; c++) {
+        double total = 0.0;
+        for (int i = 0; i < count; i++) {
+            double best = DBL_MAX;
+            for (int j = 0; j < c; j++) {
+                double dx = x[idx[i]] - cx[j], dy = y[idx[i]] - cy[j];
+                if (dx * dx + dy * dy < best) best = dx * dx + dy * dy;
+            }
+            dist2[i] = best;
+            total += best;
+        }
+        int chosen = next_random(rng) % count;
+        if (total > 0) {
+            double r = (double)next_random(rng) / 4294967296.0 * total;
+            for (int i = 0; i < count; i++) {
+                r -= dist2[i];
+                if (r <= 0) {
+                    chosen = i;
+                    break;
+                }
+            }
+        }
+        cx[c] = x[idx[chosen]];
+        cy[c] = y[idx[chosen]];
+    }
+
+    // Lloyd 迭代
+    for (int i = 0; i < count; i++) assign[i] = -1;
+    for (int iter = 0; iter < KMEANS_MAX_ITERATIONS; iter++) {
+        bool changed = false;
+        for (int i = 0; i < count; i++) {
+            int best_c = 0;
+            double best = DBL_MAX;
+            for (int c = 0; c < k; c++) {
+                double dx = x[idx[i]] - cx[c], dy = y[idx[i]] - cy[c];
+                if (dx * dx + dy * dy < best) {
+                    best = dx * dx + dy * dy;
+                    best_c = c;
+                }
+            }
+            if (assign[i] != best_c) {
+                assign[i] = best_c;
+                changed = true;
+            }
+        }
+        if (!changed) break;
+
+        for (int c = 0; c < k; c++) {
+            cx[c] = cy[c] = 0.0;
+            sizes[c] = 0;
+        }
+        for (int i = 0; i < count; i++) {
+            cx[assign[i]] += x[idx[i]];
+            cy[assign[i]] += y[idx[i]];
+            sizes[assign[i]]++;
+        }
+        for (int c = 0; c < k; c++) {
+            if (sizes[c] > 0) {
+                cx[c] /= sizes[c];
+                cy[c] /= sizes[c];
+            }
+        }
+    }
+    free(cx);
+    free(cy);
+    free(dist2);
+    free(sizes);
+}
+
+/**
+ * @brief 递归地把一组途经点切分成不超过 max_size 的簇。
+ * @details 超出上限的组用 k-means 切成 ⌈count / max_size⌉ 份后继续递归；
+ *          所有点坐标相同导致 k-means 无法切分时，直接按顺序分块。
+ */
+static bool split_into_clusters(const double* x, const double* y, const int* idx, int count, int max_size, unsigned int* rng, ClusterList* out) {
+    if (count <= max_size) return append_cluster(out, idx, count);
+
+    int k = (count + max_size - 1) / max_size;
+    if (k < 2) k = 2;
+    int* assign = (int*)malloc(count * sizeof(int));
+    int* group = (int*)malloc(count * sizeof(int));
+    if (!assign || !group) {
+        free(assign);
+        free(group);
+        return false;
+    }
+    kmeans(x, y, idx, count, k, rng, assign);
+
+    bool ok = true;
+    bool degenerate = false;
+    for (int c = 0; c < k && !degenerate; c++) {
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            if (assign[i] == c) n++;
+        }
+        if (n == count) degenerate = true;
+    }
+
+    if (degenerate) {
+        for (int start = 0; start < count && ok; start += max_size) {
+            int n = count - start < max_size ? count - start : max_size;
+            ok = append_cluster(out, idx + start, n);
+        }
+    } else {
+        for (int c = 0; c < k && ok; c++) {
+            int n = 0;
+            for (int i = 0; i < count; i++) {
+                if (assign[i] == c) group[n++] = idx[i];
+            }
+            if (n > 0) ok = split_into_clusters(x, y, group, n, max_size, rng, out);
+        }
+    }
+    free(assign);
+    free(group);
+    return ok;
+}
+
+/**
+ * @brief 为每个簇选出最接近簇中心的途经点作为代表点。
+ */
+static void choose_representatives(ClusterList* list, const double* x, const double* y) {
+    for (int c = 0; c < list->count; c++) {
+        StopCluster* cluster = &list->items[c];
+        double mx = 0.0, my = 0.0;
+        for (int i = 0; i < cluster->count; i++) {
+            mx += x[cluster->members[i]];
+            my += y[cluster->members[i]];
+        }
+        mx /= cluster->count;
+        my /= cluster->count;
+        double best = DBL_MAX;
+        for (int i = 0; i < cluster->count; i++) {
+            double dx = x[cluster->members[i]] - mx, dy = y[cluster->members[i]] - my;
+            if (dx * dx + dy * dy < best) {
+                best = dx * dx + dy * dy;
+                cluster->representative = cluster->members[i];
+            }
+        }
+    }
+}
+
+/**
+ * @brief 按城市分组时使用的排序键。
+ */
+typedef struct {
+    int city_id;
+    int stop;
+} CityStop;
+
+static int compare_city_stop(const void* a, const void* b) {
+    const CityStop* lhs = (const CityStop*)a;
+    const CityStop* rhs = (const CityStop*)b;
+    if (lhs->city_id != rhs->city_id) return lhs->city_id < rhs->city_id ? -1 : 1;
+    return lhs->stop - rhs->stop;
+}
+
+/**
+ * @brief 按所选方式把所有途经点分簇。
+ */
+static bool build_clusters(const TrafficNetwork* network, const int* stop_nodes, int num_stops, const HierarchicalTspOptions* options, ClusterList* out) {
+    double* x = (double*)malloc(num_stops * sizeof(double));
+    double* y = (double*)malloc(num_stops * sizeof(double));
+    int* idx = (int*)malloc(num_stops * sizeof(int));
+    CityStop* by_city = (CityStop*)malloc(num_stops * sizeof(CityStop));
+    bool ok = x && y && idx && by_city;
+
+    if (ok) {
+        // 等距圆柱投影：经度按平均纬度的余弦缩放，使平面距离近似于地面距离
+        double mean_lat = 0.0;
+        for (int i = 0; i < num_stops; i++) mean_lat += traffic_network_get_node_by_id(network, stop_nodes[i])->latitude;
+        mean_lat /= num_stops;
+        double scale = cos(mean_lat * M_PI / 180.0);
+        for (int i = 0; i < num_stops; i++) {
+            const Node* node = traffic_network_get_node_by_id(network, stop_nodes[i]);
+            x[i] = node->longitude * scale;
+            y[i] = node->latitude;
+            idx[i] = i;
+        }
+
+        unsigned int rng = options->seed;
+        if (options->method == CLUSTER_BY_CITY) {
+            for (int i = 0; i < num_stops; i++) {
+                by_city[i].city_id = traffic_network_get_node_by_id(network, stop_nodes[i])->city_id;
+                by_city[i].stop = i;
+            }
+            qsort(by_city, num_stops, sizeof(CityStop), compare_city_stop);
+            for (int start = 0; start < num_stops && ok;) {
+                int end = start;
+                while (end < num_stops && by_city[end].city_id == by_city[start].city_id) {
+                    idx[end - start] = by_city[end].stop;
+                    end++;
+                }
+                ok = split_into_clusters(x, y, idx, end - start, options->max_cluster_size, &rng, out);
+                start = end;
+            }
+        } else {
+            ok = split_into_clusters(x, y, idx, num_stops, options->max_cluster_size, &rng, out);
+        }
+        if (ok) choose_representatives(out, x, y);
+    }
+    free(x);
+    free(y);
+    free(idx);
+    free(by_city);
+    return ok;
+}
+
+/**
+ * @brief 登记一个任务项的结果并报告进度。
+ */
+static void finish_item(HierarchicalContext* ctx, const char* stage, int total, bool failed) {
+    pthread_mutex_lock(&ctx->mutex);
+    if (failed) ctx->failed = 1;
+    ctx->completed++;
+    solve_control_report_progress(ctx->control, stage, (double)ctx->completed / total);
+    pthread_mutex_unlock(&ctx->mutex);
+}
+
+static bool has_failed(HierarchicalContext* ctx) {
+    pthread_mutex_lock(&ctx->mutex);
+    bool failed = ctx->failed != 0;
+    pthread_mutex_unlock(&ctx->mutex);
+    return failed || solve_control_should_stop(ctx->control);
+}
+
+/**
+ * @brief parallel_for 的任务项：构建一个簇的成本矩阵并求解簇内环路。
+ */
+static void solve_cluster(int index, int worker_id, void* context) {
+    (void)worker_id;
+    HierarchicalContext* ctx = (HierarchicalContext*)context;
+    StopCluster* cluster = &ctx->clusters->items[index];
+    int s = cluster->count;
+    bool failed = has_failed(ctx);
+
+    if (!failed) {
+        cluster->matrix = (double*)malloc(s * s * sizeof(double));
+        cluster->tour = (int*)malloc(s * sizeof(int));
+        failed = !cluster->matrix || !cluster->tour;
+    }
+    // 簇内每个点一次单源搜索，树用完即释放，内存只与簇大小有关
+    for (int i = 0; i < s && !failed; i++) {
+        ShortestPathTree* tree = compute_shortest_path_tree(ctx->network, ctx->stop_nodes[cluster->members[i]],
+                                                            ctx->time_weight, ctx->cost_weight, ctx->control);
+        if (!tree) {
+            failed = true;
+            break;
+        }
+        for (int j = 0; j < s; j++) {
+            cluster->matrix[i * s + j] = (i == j) ? 0.0 : shortest_path_tree_get_cost(tree, ctx->stop_nodes[cluster->members[j]]);
+        }
+        free_shortest_path_tree(tree);
+    }
+    if (!failed && tsp_solve_matrix(cluster->matrix, s, s, cluster->tour, NULL) == DBL_MAX) failed = true;
+    finish_item(ctx, "clusters", ctx->clusters->count, failed);
+}
+
+/**
+ * @brief parallel_for 的任务项：计算簇间成本矩阵的一行（从一个簇的代表点出发）。
+ */
+static void compute_cluster_row(int index, int worker_id, void* context) {
+    (void)worker_id;
+    HierarchicalContext* ctx = (HierarchicalContext*)context;
+    int k = ctx->clusters->count;
+    bool failed = has_failed(ctx);
+    if (!failed) {
+        ShortestPathTree* tree = compute_shortest_path_tree(ctx->network, ctx->stop_nodes[ctx->clusters->items[index].representative],
+                                                            ctx->time_weight, ctx->cost_weight, ctx->control);
+        failed = !tree;
+        for (int j = 0; j < k && tree; j++) {
+            ctx->cluster_matrix[index * k + j] = (index == j) ? 0.0 :
+                shortest_path_tree_get_cost(tree, ctx->stop_nodes[ctx->clusters->items[j].representative]);
+        }
+        free_shortest_path_tree(tree);
+    }
+    finish_item(ctx, "cluster_order", k, failed);
+}
+
+/**
+ * @brief parallel_for 的任务项：计算边界窗口成本矩阵的一行。
+ */
+static void compute_window_row(int index, int worker_id, void* context) {
+    (void)worker_id;
+    HierarchicalContext* ctx = (HierarchicalContext*)context;
+    int w = ctx->window_size;
+    ShortestPathTree* tree = compute_shortest_path_tree(ctx->network, ctx->window_nodes[index], ctx->time_weight, ctx->cost_weight, ctx->control);
+    for (int j = 0; j < w; j++) {
+        ctx->window_matrix[index * w + j] = (index == j || !tree) ? (index == j ? 0.0 : DBL_MAX) : shortest_path_tree_get_cost(tree, ctx->window_nodes[j]);
+    }
+    free_shortest_path_tree(tree);
+}
+
+/**
+ * @brief 依次把各簇的环路切开并首尾相接，得到整条访问顺序。
+ * @details 起点所在的簇从起点开始；其余每个簇选择一个进入点，使 "上一个簇的出口 → 进入点" 的成本
+ *          减去被切断的簇内边的成本最小。每个簇只需一次从上一个出口出发的单源搜索。
+ */
+static bool stitch_clusters(HierarchicalContext* ctx, const int* cluster_order, int* order) {
+    ClusterList* list = ctx->clusters;
+    int pos = 0;
+    for (int ci = 0; ci < list->count; ci++) {
+        StopCluster* cluster = &list->items[cluster_order[ci]];
+        int s = cluster->count;
+        int start = 0;
+        if (ci == 0) {
+            // 起点簇：从0号途经点开始
+            for (int t = 0; t < s; t++) {
+                if (cluster->members[cluster->tour[t]] == 0) start = t;
+            }
+        } else if (s > 1) {
+            ShortestPathTree* tree = compute_shortest_path_tree(ctx->network, ctx->stop_nodes[order[pos - 1]],
+                                                                ctx->time_weight, ctx->cost_weight, ctx->control);
+            if (!tree) return false;
+            double best = DBL_MAX;
+            for (int b = 0; b < s; b++) {
+                int exit_local = cluster->tour[b];
+                int entry_local = cluster->tour[(b + 1) % s];
+                double enter = shortest_path_tree_get_cost(tree, ctx->stop_nodes[cluster->members[entry_local]]);
+                double cut = cluster->matrix[exit_local * s + entry_local];
+                if (enter == DBL_MAX || cut == DBL_MAX) continue;
+                if (enter - cut < best) {
+                    best = enter - cut;
+                    start = (b + 1) % s;
+                }
+            }
+            free_shortest_path_tree(tree);
+        }
+        for (int t = 0; t < s; t++) order[pos++] = cluster->members[cluster->tour[(start + t) % s]];
+    }
+    return true;
+}
+
+/**
+ * @brief 对访问顺序中的一个窗口做端点固定的局部搜索。
+ * @param positions 窗口中各点在访问顺序中的位置，首尾两个位置固定不动。
+ * @param len 窗口长度。
+ */
+static void polish_window(HierarchicalContext* ctx, int* order, const int* positions, int len) {
+    int* nodes = (int*)malloc(len * sizeof(int));
+    int* perm = (int*)malloc(len * sizeof(int));
+    int* stops = (int*)malloc(len * sizeof(int));
+    double* matrix = (double*)malloc(len * len * sizeof(double));
+    if (nodes && perm && stops && matrix) {
+        for (int i = 0; i < len; i++) {
+            stops[i] = order[positions[i]];
+            nodes[i] = ctx->stop_nodes[stops[i]];
+            perm[i] = i;
+        }
+        ctx->window_nodes = nodes;
+        ctx->window_matrix = matrix;
+        ctx->window_size = len;
+        thread_pool_parallel_for(thread_pool_get_default(), len, compute_window_row, ctx);
+        tsp_improve_path(matrix, len, perm, len);
+        for (int i = 0; i < len; i++) order[positions[i]] = stops[perm[i]];
+    }
+    free(nodes);
+    free(perm);
+    free(stops);
+    free(matrix);
+}
+
+/**
+ * @brief 对每个簇与簇之间的拼接处（包括回到起点的最后一处）做局部抛光。
+ */
+static void polish_boundaries(HierarchicalContext* ctx, const int* cluster_order, int* order, int num_stops, int window) {
+    ClusterList* list = ctx->clusters;
+    int* positions = (int*)malloc((2 * window + 1) * sizeof(int));
+    if (!positions || window <= 0) {
+        free(positions);
+        return;
+    }
+
+    int boundary = 0;
+    for (int ci = 0; ci < list->count; ci++) {
+        boundary += list->items[cluster_order[ci]].count; // 当前簇之后的第一个位置
+        if (solve_control_should_stop(ctx->control)) break;
+
+        int len = 0;
+        int lo = boundary - window < 1 ? 1 : boundary - window; // 0号位置（起点）只作为固定端点
+        if (boundary >= num_stops) {
+            // 最后一处拼接：窗口末尾接回起点
+            for (int p = lo - 1; p < num_stops; p++) positions[len++] = p;
+            positions[len++] = 0;
+        } else {
+            int hi = boundary + window - 1 < num_stops - 1 ? boundary + window - 1 : num_stops - 1;
+            for (int p = lo - 1; p <= hi; p++) positions[len++] = p;
+        }
+        if (len >= 4) polish_window(ctx, order, positions, len);
+        solve_control_report_progress(ctx->control, "boundaries", (double)(ci + 1) / list->count);
+    }
+    free(positions);
+}
+
+// 分层TSP求解的实现
+RoutePath* solve_tsp_hierarchical(const TrafficNetwork* network, const int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight,
+                                  const HierarchicalTspOptions* options, const SolveControl* control) {
+    if (!network || !node_ids_to_visit || num_nodes <= 1) return NULL;
+    HierarchicalTspOptions defaults;
+    if (!options) {
+        hierarchical_tsp_default_options(&defaults);
+        options = &defaults;
+    }
+    if (options->max_cluster_size < 2) {
+        fprintf(stderr, "错误: 每个簇至少需要2个途经点。\n");
+        return NULL;
+    }
+
+    // 去掉重复的途经点（保留第一次出现的位置，起点始终在最前面）
+    int* stop_nodes = (int*)malloc(num_nodes * sizeof(int));
+    if (!stop_nodes) return NULL;
+    int num_stops = 0;
+    for (int i = 0; i < num_nodes; i++) {
+        if (!traffic_network_get_node_by_id(network, node_ids_to_visit[i])) {
+            fprintf(stderr, "错误: 无效的节点ID %d。\n", node_ids_to_visit[i]);
+            free(stop_nodes);
+            return NULL;
+        }
+        bool duplicate = false;
+        for (int j = 0; j < num_stops && !duplicate; j++) duplicate = stop_nodes[j] == node_ids_to_visit[i];
+        if (!duplicate) stop_nodes[num_stops++] = node_ids_to_visit[i];
+    }
+    if (num_stops < 2) {
+        free(stop_nodes);
+        return NULL;
+    }
+
+    ClusterList clusters = { NULL, 0, 0 };
+    HierarchicalContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.network = network;
+    ctx.stop_nodes = stop_nodes;
+    ctx.clusters = &clusters;
+    ctx.time_weight = time_weight;
+    ctx.cost_weight = cost_weight;
+    ctx.control = control;
+    pthread_mutex_init(&ctx.mutex, NULL);
+
+    int* cluster_order = NULL;
+    int* order = NULL;
+    int* sequence = NULL;
+    RoutePath* result = NULL;
+
+    // 1. 分簇
+    if (!build_clusters(network, stop_nodes, num_stops, options, &clusters)) goto cleanup;
+    int k = clusters.count;
+
+    // 2. 并行求解每个簇内的环路
+    thread_pool_parallel_for(thread_pool_get_default(), k, solve_cluster, &ctx);
+    if (ctx.failed || solve_control_should_stop(control)) goto cleanup;
+
+    // 3. 求解簇间顺序：起点所在的簇放在0号位置，作为簇级环路的起点
+    for (int c = 0; c < k; c++) {
+        bool has_start = false;
+        for (int i = 0; i < clusters.items[c].count; i++) has_start |= clusters.items[c].members[i] == 0;
+        if (has_start) {
+            StopCluster tmp = clusters.items[0];
+            clusters.items[0] = clusters.items[c];
+            clusters.items[c] = tmp;
+            break;
+        }
+    }
+    cluster_order = (int*)malloc(k * sizeof(int));
+    ctx.cluster_matrix = (double*)malloc(k * k * sizeof(double));
+    if (!cluster_order || !ctx.cluster_matrix) goto cleanup;
+    ctx.completed = 0;
+    thread_pool_parallel_for(thread_pool_get_default(), k, compute_cluster_row, &ctx);
+    if (ctx.failed || solve_control_should_stop(control)) goto cleanup;
+    if (tsp_solve_matrix(ctx.cluster_matrix, k, k, cluster_order, NULL) == DBL_MAX) goto cleanup;
+
+    // 4. 拼接各簇，并抛光拼接处
+    order = (int*)malloc(num_stops * sizeof(int));
+    if (!order || !stitch_clusters(&ctx, cluster_order, order)) goto cleanup;
+    polish_boundaries(&ctx, cluster_order, order, num_stops, options->boundary_window);
+    if (solve_control_should_stop(control)) goto cleanup;
+
+    // 5. 按最终顺序计算各路段（并行）并拼接成完整环游
+    sequence = (int*)malloc((num_stops + 1) * sizeof(int));
+    if (!sequence) goto cleanup;
+    for (int i = 0; i < num_stops; i++) sequence[i] = stop_nodes[order[i]];
+    sequence[num_stops] = stop_nodes[0];
+    result = find_sequential_path_ex(network, sequence, num_stops + 1, time_weight, cost_weight, options->engine, control);
+
+cleanup:
+    pthread_mutex_destroy(&ctx.mutex);
+    free_cluster_list(&clusters);
+    free(ctx.cluster_matrix);
+    free(cluster_order);
+    free(order);
+    free(sequence);
+    free(stop_nodes);
+    return result;
+}
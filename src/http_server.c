@@ -0,0 +1,789 @@
+/**
+ * @file http_server.c
+ * @brief 实现了服务模式：epoll 事件循环、HTTP/1.1 请求解析与响应、计算线程池。
+ */
+#define _DEFAULT_SOURCE // SO_REUSEPORT 不属于 POSIX
+#include "http_server.h"
+#include "query_service.h"
+#include "thread_pool.h"
+#include "utils.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// 请求头的最大长度，以及请求体（POST参数）的最大长度
+#define HTTP_MAX_HEADER 16384
+#define HTTP_MAX_BODY 65536
+
+// epoll 事件中用来区分监听套接字和唤醒描述符的标识（连接使用其槽位下标）
+#define EVENT_LISTEN UINT64_C(0xFFFFFFFF00000001)
+#define EVENT_WAKE UINT64_C(0xFFFFFFFF00000002)
+
+#define EPOLL_BATCH 256
+
+/**
+ * @brief 一个客户端连接。槽位在服务期间复用，generation 用于丢弃已关闭连接的迟到结果。
+ */
+typedef struct {
+    int fd;                     // -1 表示槽位空闲
+    unsigned generation;        // 每次关闭时加一
+    char* in;                   // 已读取但尚未处理的数据
+    size_t in_length;
+    size_t in_capacity;
+    char* out;                  // 正在发送的响应
+    size_t out_length;
+    size_t out_sent;
+    bool busy;                  // 有请求正在排队或计算
+    bool close_after_write;     // 响应发送完后关闭连接
+    bool peer_closed;           // 对端已关闭写方向（读到EOF），缓冲区中的请求仍然回复
+    double last_active;         // 最近一次读写的时刻（单调时钟，秒）
+    uint32_t interest;          // 当前在 epoll 中登记的事件
+} Connection;
+
+/**
+ * @brief 交给计算线程的请求，完成后带着结果回到事件循环。
+ */
+typedef struct Job {
+    int slot;                   // 连接槽位
+    unsigned generation;        // 提交时连接的 generation
+    bool keep_alive;
+    char* path;
+    char* params;
+    int status;                 // 结果：HTTP状态码
+    char* body;                 // 结果：JSON响应体
+    size_t body_length;
+    struct Job* next;
+} Job;
+
+/**
+ * @brief 服务运行期间的全部状态。
+ */
+typedef struct {
+    QueryService* service;
+    const HttpServerOptions* options;
+    int epoll_fd;
+    int listen_fd;
+    Connection* connections;
+    int* free_slots;            // 空闲槽位栈
+    int free_count;
+
+    pthread_mutex_t mutex;      // 保护下面的两个队列和 stopping
+    pthread_cond_t job_cond;    // 请求队列非空或需要退出时通知计算线程
+    Job* pending_head;          // 等待计算的请求
+    Job* pending_tail;
+    int pending_count;
+    Job* done_head;             // 已完成、等待发送的请求
+    Job* done_tail;
+    bool stopping;
+
+    pthread_t* workers;
+    int worker_count;
+    unsigned long served;       // 已发送的响应数（仅事件循环访问）
+} ServerState;
+
+// 唤醒事件循环的 eventfd；计算线程和信号处理函数都会写它
+static int wake_fd = -1;
+static volatile sig_atomic_t stop_requested;
+
+void http_server_options_init(HttpServerOptions* options) {
+    options->bind_address = "127.0.0.1";
+    options->port = 8080;
+    options->worker_count = 0;
+    options->max_connections = 1024;
+    options->queue_capacity = 256;
+    options->request_timeout_ms = 0.0;
+    options->idle_timeout_ms = 60000.0;
+    options->process_count = 0;
+}
+
+void http_server_request_stop(void) {
+    stop_requested = 1;
+    if (wake_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+static void wake_event_loop(void) {
+    uint64_t one = 1;
+    ssize_t ignored = write(wake_fd, &one, sizeof(one));
+    (void)ignored;
+}
+
+static void free_job(Job* job) {
+    if (!job) return;
+    free(job->path);
+    free(job->params);
+    free(job->body);
+    free(job);
+}
+
+// --- 计算线程 ---
+
+static void* worker_main(void* arg) {
+    ServerState* state = (ServerState*)arg;
+    pthread_mutex_lock(&state->mutex);
+    for (;;) {
+        while (!state->pending_head && !state->stopping) pthread_cond_wait(&state->job_cond, &state->mutex);
+        if (state->stopping) break;
+        Job* job = state->pending_head;
+        state->pending_head = job->next;
+        if (!state->pending_head) state->pending_tail = NULL;
+        state->pending_count--;
+        pthread_mutex_unlock(&state->mutex);
+
+        job->status = query_service_handle(state->service, job->path, job->params, &job->body, &job->body_length);
+        job->next = NULL;
+
+        pthread_mutex_lock(&state->mutex);
+        if (state->done_tail) state->done_tail->next = job;
+        else state->done_head = job;
+        state->done_tail = job;
+        wake_event_loop();
+    }
+    pthread_mutex_unlock(&state->mutex);
+    return NULL;
+}
+
+// --- 连接管理 ---
+
+static void update_interest(ServerState* state, int slot, uint32_t events) {
+    Connection* conn = &state->connections[slot];
+    if (conn->interest == events) return;
+    struct epoll_event event;
+    event.events = events;
+    event.data.u64 = (uint64_t)slot;
+    epoll_ctl(state->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+    conn->interest = events;
+}
+
+static void close_connection(ServerState* state, int slot) {
+    Connection* conn = &state->connections[slot];
+    if (conn->fd < 0) return;
+    epoll_ctl(state->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    conn->fd = -1;
+    conn->generation++;
+    free(conn->in);
+    free(conn->out);
+    conn->in = NULL;
+    conn->out = NULL;
+    conn->in_length = conn->in_capacity = 0;
+    conn->out_length = conn->out_sent = 0;
+    conn->busy = false;
+    state->free_slots[state->free_count++] = slot;
+}
+
+static void accept_connections(ServerState* state) {
+    for (;;) {
+        int fd = accept(state->listen_fd, NULL, NULL);
+        if (fd < 0) return; // EAGAIN：已接受全部等待中的连接
+        if (state->free_count == 0) { // 连接数已达上限
+            close(fd);
+            continue;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        int slot = state->free_slots[--state->free_count];
+        Connection* conn = &state->connections[slot];
+        conn->fd = fd;
+        conn->close_after_write = false;
+        conn->peer_closed = false;
+        conn->last_active = monotonic_time_seconds();
+        conn->interest = EPOLLIN;
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = (uint64_t)slot;
+        if (epoll_ctl(state->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) close_connection(state, slot);
+    }
+}
+
+// --- 响应 ---
+
+static const char* status_text(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default: return "Internal Server Error";
+    }
+}
+
+/**
+ * @brief 组装完整的响应（状态行、头部和响应体），放入连接的发送缓冲区。
+ */
+static bool set_response(Connection* conn, int status, const char* body, size_t body_length, bool keep_alive) {
+    char header[256];
+    int header_length = snprintf(header, sizeof(header),
+                                 "HTTP/1.1 %d %s\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: %zu\r\n"
+                                 "Connection: %s\r\n\r\n",
+                                 status, status_text(status), body_length, keep_alive ? "keep-alive" : "close");
+    free(conn->out);
+    conn->out = (char*)malloc(header_length + body_length);
+    if (!conn->out) return false;
+    memcpy(conn->out, header, header_length);
+    if (body_length > 0) memcpy(conn->out + header_length, body, body_length);
+    conn->out_length = header_length + body_length;
+    conn->out_sent = 0;
+    conn->close_after_write = !keep_alive;
+    return true;
+}
+
+static void process_input(ServerState* state, int slot);
+
+/**
+ * @brief 尽量发送缓冲区中的响应；发送完后处理同一连接上已到达的下一个请求。
+ */
+static void flush_output(ServerState* state, int slot) {
+    Connection* conn = &state->connections[slot];
+    while (conn->out_sent < conn->out_length) {
+        ssize_t n = send(conn->fd, conn->out + conn->out_sent, conn->out_length - conn->out_sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                update_interest(state, slot, EPOLLOUT);
+                return;
+            }
+            if (errno == EINTR) continue;
+            close_connection(state, slot);
+            return;
+        }
+        conn->out_sent += n;
+        conn->last_active = monotonic_time_seconds();
+    }
+    free(conn->out);
+    conn->out = NULL;
+    conn->out_length = conn->out_sent = 0;
+    state->served++;
+    if (conn->close_after_write) {
+        close_connection(state, slot);
+        return;
+    }
+    update_interest(state, slot, conn->peer_closed ? 0 : EPOLLIN);
+    process_input(state, slot);
+}
+
+/**
+ * @brief 由事件循环直接回复（不经过计算线程），用于协议错误和队列已满。
+ */
+static void reply_now(ServerState* state, int slot, int status, const char* message, bool keep_alive) {
+    char body[128];
+    int length = snprintf(body, sizeof(body), "{\"error\":\"%s\"}", message);
+    if (!set_response(&state->connections[slot], status, body, length, keep_alive)) {
+        close_connection(state, slot);
+        return;
+    }
+    flush_output(state, slot);
+}
+
+// --- 请求解析 ---
+
+/**
+ * @brief 在请求头中查找一个字段的值（不区分大小写）。
+ * @return const char* 值的起始位置（跳过空白），不存在时返回NULL。
+ */
+static const char* find_header(const char* headers, const char* end, const char* name, size_t* value_length) {
+    size_t name_length = strlen(name);
+    for (const char* line = headers; line < end;) {
+        const char* line_end = strstr(line, "\r\n");
+        if (!line_end || line_end > end) line_end = end;
+        if ((size_t)(line_end - line) > name_length && line[name_length] == ':' && strncasecmp(line, name, name_length) == 0) {
+            const char* value = line + name_length + 1;
+            while (value < line_end && (*value == ' ' || *value == '\t')) value++;
+            *value_length = line_end - value;
+            return value;
+        }
+        line = line_end + 2;
+    }
+    return NULL;
+}
+
+static char* copy_range(const char* begin, size_t length) {
+    char* s = (char*)malloc(length + 1);
+    if (!s) return NULL;
+    memcpy(s, begin, length);
+    s[length] = '\0';
+    return s;
+}
+
+/**
+ * @brief 从读缓冲区中解析一个完整的请求并提交给计算线程。
+ * @details 请求不完整时什么都不做；对端已关闭写方向时不会再有数据到达，直接关闭连接。
+ */
+static void process_input(ServerState* state, int slot) {
+    Connection* conn = &state->connections[slot];
+    if (conn->fd < 0 || conn->busy || conn->out) return;
+    if (conn->in_length == 0) {
+        if (conn->peer_closed) close_connection(state, slot);
+        return;
+    }
+
+    char* header_end = NULL;
+    for (size_t i = 3; i < conn->in_length; i++) {
+        if (conn->in[i] == '\n' && conn->in[i - 1] == '\r' && conn->in[i - 2] == '\n' && conn->in[i - 3] == '\r') {
+            header_end = conn->in + i + 1;
+            break;
+        }
+    }
+    if (!header_end) {
+        if (conn->in_length >= HTTP_MAX_HEADER) reply_now(state, slot, 431, "request header too large", false);
+        else if (conn->peer_closed) close_connection(state, slot);
+        return;
+    }
+    size_t header_length = header_end - conn->in;
+
+    // 请求行（头部中一定有 "\r\n\r\n"，下面的查找不会越过头部）：方法 请求目标 协议版本
+    char* line_end = strstr(conn->in, "\r\n");
+    char* method_end = line_end ? memchr(conn->in, ' ', line_end - conn->in) : NULL;
+    char* target = method_end ? method_end + 1 : NULL;
+    char* target_end = target ? memchr(target, ' ', line_end - target) : NULL;
+    if (!target_end || target[0] != '/') {
+        reply_now(state, slot, 400, "malformed request line", false);
+        return;
+    }
+    bool http10 = strncmp(target_end + 1, "HTTP/1.0", 8) == 0;
+    bool is_get = method_end - conn->in == 3 && memcmp(conn->in, "GET", 3) == 0;
+    bool is_post = method_end - conn->in == 4 && memcmp(conn->in, "POST", 4) == 0;
+
+    const char* headers = line_end + 2;
+    const char* headers_end = header_end - 2;
+    size_t value_length;
+    const char* value = find_header(headers, headers_end, "Connection", &value_length);
+    bool keep_alive = !http10;
+    if (value && value_length == 5 && strncasecmp(value, "close", 5) == 0) keep_alive = false;
+    if (value && value_length == 10 && strncasecmp(value, "keep-alive", 10) == 0) keep_alive = true;
+    if (conn->peer_closed) keep_alive = false; // 回复后关闭
+    size_t body_length = 0;
+    value = find_header(headers, headers_end, "Content-Length", &value_length);
+    if (value) body_length = strtoul(value, NULL, 10);
+    if (body_length > HTTP_MAX_BODY) {
+        reply_now(state, slot, 413, "request body too large", false);
+        return;
+    }
+    // 请求体尚未读完时保持读缓冲区不变，下次读到数据后重新解析
+    if (conn->in_length < header_length + body_length) {
+        if (conn->peer_closed) close_connection(state, slot);
+        return;
+    }
+    header_end[-1] = '\0'; // 头部以 "\r\n\r" 后的 '\0' 结尾，便于字符串处理
+
+    Job* job = NULL;
+    int status = 0;
+    const char* message = NULL;
+    if (!is_get && !is_post) {
+        status = 405;
+        message = "only GET and POST are supported";
+    } else {
+        // 参数来自URL中 '?' 之后的部分；POST请求使用请求体（application/x-www-form-urlencoded）
+        char* query = memchr(target, '?', target_end - target);
+        char* path_end = query ? query : target_end;
+        job = (Job*)calloc(1, sizeof(Job));
+        if (job) {
+            job->slot = slot;
+            job->generation = conn->generation;
+            job->keep_alive = keep_alive;
+            job->path = copy_range(target, path_end - target);
+            if (is_post) job->params = copy_range(header_end, body_length);
+            else job->params = query ? copy_range(query + 1, target_end - query - 1) : copy_range("", 0);
+        }
+        if (!job || !job->path || !job->params) {
+            free_job(job);
+            job = NULL;
+            status = 500;
+            message = "out of memory";
+        }
+    }
+
+    // 从读缓冲区中移除这个请求，保留其后已到达的数据（流水线请求）
+    size_t consumed = header_length + body_length;
+    memmove(conn->in, conn->in + consumed, conn->in_length - consumed);
+    conn->in_length -= consumed;
+
+    if (!job) {
+        reply_now(state, slot, status, message, keep_alive);
+        return;
+    }
+    pthread_mutex_lock(&state->mutex);
+    bool full = state->pending_count >= state->options->queue_capacity;
+    if (!full) {
+        if (state->pending_tail) state->pending_tail->next = job;
+        else state->pending_head = job;
+        state->pending_tail = job;
+        state->pending_count++;
+        pthread_cond_signal(&state->job_cond);
+    }
+    pthread_mutex_unlock(&state->mutex);
+    if (full) {
+        free_job(job);
+        reply_now(state, slot, 503, "server busy", keep_alive);
+        return;
+    }
+    conn->busy = true;
+    update_interest(state, slot, 0); // 计算期间不读取下一个请求
+}
+
+/**
+ * @brief 读取连接上的所有可读数据，然后尝试解析请求。
+ */
+static void read_input(ServerState* state, int slot) {
+    Connection* conn = &state->connections[slot];
+    for (;;) {
+        if (conn->in_capacity - conn->in_length < 4096) {
+            if (conn->in_capacity >= HTTP_MAX_HEADER + HTTP_MAX_BODY) break; // 已缓冲足够的数据，先处理
+            size_t capacity = conn->in_capacity ? conn->in_capacity * 2 : 8192;
+            char* in = (char*)realloc(conn->in, capacity);
+            if (!in) {
+                close_connection(state, slot);
+                return;
+            }
+            conn->in = in;
+            conn->in_capacity = capacity;
+        }
+        ssize_t n = recv(conn->fd, conn->in + conn->in_length, conn->in_capacity - conn->in_length - 1, 0);
+        if (n > 0) {
+            conn->in_length += n;
+            conn->last_active = monotonic_time_seconds();
+            continue;
+        }
+        if (n == 0) {
+            // 对端半关闭（例如发送请求后 shutdown(SHUT_WR)）：不再读取，但仍然回复已读到的完整请求
+            conn->peer_closed = true;
+            update_interest(state, slot, 0);
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        close_connection(state, slot); // 出错
+        return;
+    }
+    process_input(state, slot);
+}
+
+/**
+ * @brief 取出所有已完成的请求，把结果发送给仍然打开的连接。
+ */
+static void deliver_results(ServerState* state) {
+    uint64_t count;
+    ssize_t ignored = read(wake_fd, &count, sizeof(count));
+    (void)ignored;
+
+    pthread_mutex_lock(&state->mutex);
+    Job* job = state->done_head;
+    state->done_head = state->done_tail = NULL;
+    pthread_mutex_unlock(&state->mutex);
+
+    while (job) {
+        Job* next = job->next;
+        Connection* conn = &state->connections[job->slot];
+        if (conn->fd >= 0 && conn->generation == job->generation) {
+            conn->busy = false;
+            const char* oom = "{\"error\":\"out of memory\"}";
+            bool ok = job->body ? set_response(conn, job->status, job->body, job->body_length, job->keep_alive)
+                                : set_response(conn, 500, oom, strlen(oom), false);
+            if (ok) flush_output(state, job->slot);
+            else close_connection(state, job->slot);
+        }
+        free_job(job);
+        job = next;
+    }
+}
+
+/**
+ * @brief 关闭空闲超时的连接（不包括正在计算的连接）。
+ */
+static void close_idle_connections(ServerState* state, double now) {
+    double timeout = state->options->idle_timeout_ms / 1000.0;
+    if (timeout <= 0) return;
+    for (int slot = 0; slot < state->options->max_connections; slot++) {
+        Connection* conn = &state->connections[slot];
+        if (conn->fd >= 0 && !conn->busy && now - conn->last_active > timeout) close_connection(state, slot);
+    }
+}
+
+// --- 启动与停止 ---
+
+/**
+ * @brief 打开非阻塞的监听套接字。多进程模式下设置 SO_REUSEPORT，每个工作进程各自监听同一端口，
+ *        由内核按连接的四元组把新连接均匀分给各进程。
+ */
+static int open_listener(const HttpServerOptions* options) {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)options->port);
+    if (inet_pton(AF_INET, options->bind_address, &address.sin_addr) != 1) {
+        fprintf(stderr, "错误: 无效的监听地址 %s\n", options->bind_address);
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (options->process_count > 0) setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 512) != 0) {
+        fprintf(stderr, "错误: 无法监听 %s:%d (%s)\n", options->bind_address, options->port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+}
+
+static void free_job_list(Job* job) {
+    while (job) {
+        Job* next = job->next;
+        free_job(job);
+        job = next;
+    }
+}
+
+/**
+ * @brief 在当前进程中运行事件循环和计算线程，直到收到停止请求。
+ * @details 监听套接字和查询服务由调用者创建；多进程模式下每个工作进程各自调用一次。
+ */
+static int serve(QueryService* service, int listen_fd, const HttpServerOptions* options) {
+    ServerState state;
+    memset(&state, 0, sizeof(state));
+    state.service = service;
+    state.options = options;
+    state.epoll_fd = -1;
+    state.listen_fd = listen_fd;
+    pthread_mutex_init(&state.mutex, NULL);
+    pthread_cond_init(&state.job_cond, NULL);
+    int result = -1;
+
+    state.connections = (Connection*)calloc(options->max_connections, sizeof(Connection));
+    state.free_slots = (int*)malloc(options->max_connections * sizeof(int));
+    state.workers = (pthread_t*)calloc(options->worker_count, sizeof(pthread_t));
+    if (!state.connections || !state.free_slots || !state.workers) goto cleanup;
+    for (int slot = options->max_connections - 1; slot >= 0; slot--) {
+        state.connections[slot].fd = -1;
+        state.free_slots[state.free_count++] = slot;
+    }
+
+    wake_fd = eventfd(0, EFD_NONBLOCK);
+    state.epoll_fd = epoll_create1(0);
+    if (wake_fd < 0 || state.epoll_fd < 0) goto cleanup;
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = EVENT_LISTEN;
+    epoll_ctl(state.epoll_fd, EPOLL_CTL_ADD, state.listen_fd, &event);
+    event.data.u64 = EVENT_WAKE;
+    epoll_ctl(state.epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+
+    for (int i = 0; i < options->worker_count; i++) {
+        if (pthread_create(&state.workers[i], NULL, worker_main, &state) != 0) break;
+        state.worker_count++;
+    }
+    if (state.worker_count == 0) goto cleanup;
+
+    if (options->process_count <= 0) {
+        printf("服务已启动: http://%s:%d (计算线程 %d 个)\n", options->bind_address, options->port, state.worker_count);
+        fflush(stdout);
+    }
+
+    struct epoll_event events[EPOLL_BATCH];
+    double last_idle_check = monotonic_time_seconds();
+    while (!stop_requested) {
+        int n = epoll_wait(state.epoll_fd, events, EPOLL_BATCH, 1000);
+        if (n < 0 && errno != EINTR) break;
+        for (int i = 0; i < n; i++) {
+            uint64_t id = events[i].data.u64;
+            if (id == EVENT_LISTEN) {
+                accept_connections(&state);
+            } else if (id == EVENT_WAKE) {
+                deliver_results(&state);
+            } else {
+                int slot = (int)id;
+                if (state.connections[slot].fd < 0) continue;
+                if (events[i].events & (EPOLLERR | EPOLLHUP) && !(events[i].events & EPOLLIN)) close_connection(&state, slot);
+                else if (events[i].events & EPOLLOUT) flush_output(&state, slot);
+                else if (events[i].events & EPOLLIN) read_input(&state, slot);
+            }
+        }
+        double now = monotonic_time_seconds();
+        if (now - last_idle_check >= 1.0) {
+            close_idle_connections(&state, now);
+            last_idle_check = now;
+        }
+    }
+    result = 0;
+    if (options->process_count <= 0) printf("服务已停止，共处理 %lu 个请求。\n", state.served);
+    else printf("工作进程 %d 已停止，共处理 %lu 个请求。\n", (int)getpid(), state.served);
+
+cleanup:
+    // 丢弃尚未开始计算的请求，等待正在计算的请求结束
+    pthread_mutex_lock(&state.mutex);
+    state.stopping = true;
+    free_job_list(state.pending_head);
+    state.pending_head = state.pending_tail = NULL;
+    pthread_cond_broadcast(&state.job_cond);
+    pthread_mutex_unlock(&state.mutex);
+    for (int i = 0; i < state.worker_count; i++) pthread_join(state.workers[i], NULL);
+    free_job_list(state.done_head);
+
+    for (int slot = 0; state.connections && slot < options->max_connections; slot++) {
+        if (state.connections[slot].fd >= 0) close_connection(&state, slot);
+    }
+    if (state.epoll_fd >= 0) close(state.epoll_fd);
+    if (wake_fd >= 0) close(wake_fd);
+    wake_fd = -1;
+    free(state.connections);
+    free(state.free_slots);
+    free(state.workers);
+    pthread_mutex_destroy(&state.mutex);
+    pthread_cond_destroy(&state.job_cond);
+    return result;
+}
+
+// --- 多进程模式 ---
+
+/**
+ * @brief fork 出一个工作进程。子进程继承父进程已加载的网络、同城表和寻路引擎（只读，与父进程共享物理页），
+ *        打开自己的监听套接字，运行事件循环直到停止后退出。父进程意外退出时子进程收到 SIGTERM 并停止，
+ *        不会继续占用端口。
+ */
+static pid_t spawn_worker_process(QueryService* service, const HttpServerOptions* options) {
+    fflush(stdout);
+    fflush(stderr);
+    pid_t parent = getpid();
+    pid_t pid = fork();
+    if (pid == 0) {
+        // 父进程可能在 fork 与 prctl 之间退出，此时不会再收到信号，需自行检查
+        if (prctl(PR_SET_PDEATHSIG, SIGTERM) != 0 || getppid() != parent) _exit(1);
+        thread_pool_reset_default_after_fork();
+        int listen_fd = open_listener(options);
+        int result = listen_fd >= 0 ? serve(service, listen_fd, options) : -1;
+        fflush(stdout);
+        _exit(result == 0 ? 0 : 1);
+    }
+    if (pid < 0) fprintf(stderr, "错误: 无法创建工作进程 (%s)\n", strerror(errno));
+    return pid;
+}
+
+static void sleep_seconds(double seconds) {
+    struct timespec ts = { (time_t)seconds, (long)((seconds - (time_t)seconds) * 1e9) };
+    nanosleep(&ts, NULL);
+}
+
+/**
+ * @brief 父进程：启动 process_count 个工作进程并看护它们，异常退出的进程立即重新 fork，不重新加载数据。
+ *        收到停止请求后通知所有工作进程停止并等待它们退出。
+ */
+static int run_worker_processes(QueryService* service, const HttpServerOptions* options) {
+    int count = options->process_count;
+    pid_t* pids = (pid_t*)malloc(count * sizeof(pid_t));
+    double* started = (double*)malloc(count * sizeof(double));
+    if (!pids || !started) {
+        free(pids);
+        free(started);
+        return -1;
+    }
+    int running = 0;
+    for (int i = 0; i < count; i++) {
+        started[i] = monotonic_time_seconds();
+        pids[i] = spawn_worker_process(service, options);
+        if (pids[i] > 0) running++;
+    }
+    if (running == 0) {
+        free(pids);
+        free(started);
+        return -1;
+    }
+    printf("服务已启动: http://%s:%d (工作进程 %d 个，每个进程计算线程 %d 个)\n", options->bind_address, options->port, running,
+           options->worker_count);
+    fflush(stdout);
+
+    int restarts = 0;
+    while (!stop_requested) {
+        int status;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid == 0 || (pid < 0 && errno == EINTR)) {
+            sleep_seconds(0.1);
+            continue;
+        }
+        if (pid < 0) break;
+        int i = 0;
+        while (i < count && pids[i] != pid) i++;
+        if (i == count) continue;
+        pids[i] = -1;
+        if (stop_requested) break;
+        if (WIFSIGNALED(status)) fprintf(stderr, "警告: 工作进程 %d 被信号 %d 终止，正在重新启动\n", (int)pid, WTERMSIG(status));
+        else fprintf(stderr, "警告: 工作进程 %d 意外退出（状态 %d），正在重新启动\n", (int)pid, WEXITSTATUS(status));
+        // 刚启动就退出的进程稍等再重启，避免持续失败时不停地 fork
+        if (monotonic_time_seconds() - started[i] < 1.0) sleep_seconds(1.0);
+        started[i] = monotonic_time_seconds();
+        pids[i] = spawn_worker_process(service, options);
+        restarts++;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (pids[i] > 0) kill(pids[i], SIGTERM);
+    }
+    for (int i = 0; i < count; i++) {
+        while (pids[i] > 0 && waitpid(pids[i], NULL, 0) < 0 && errno == EINTR) {
+        }
+    }
+    printf("服务已停止，工作进程共重启 %d 次。\n", restarts);
+    free(pids);
+    free(started);
+    return 0;
+}
+
+int http_server_run(const TrafficNetwork* network, const HttpServerOptions* user_options) {
+    HttpServerOptions options;
+    if (user_options) options = *user_options;
+    else http_server_options_init(&options);
+    if (!options.bind_address) options.bind_address = "127.0.0.1";
+    if (options.max_connections <= 0) options.max_connections = 1024;
+    if (options.queue_capacity <= 0) options.queue_capacity = 256;
+    if (options.worker_count <= 0) options.worker_count = options.process_count > 0 ? 1 : thread_pool_get_size(thread_pool_get_default());
+    if (options.worker_count <= 0) options.worker_count = 1;
+
+    stop_requested = 0;
+    struct sigaction ignore_pipe;
+    memset(&ignore_pipe, 0, sizeof(ignore_pipe));
+    ignore_pipe.sa_handler = SIG_IGN;
+    sigemptyset(&ignore_pipe.sa_mask);
+    sigaction(SIGPIPE, &ignore_pipe, NULL);
+    // 查询服务（包括寻路引擎的预处理）只在父进程中创建一次，多进程模式下由所有工作进程共享
+    QueryService* service = query_service_create(network, options.request_timeout_ms);
+    // 多进程模式下父进程只用它检查端口可用，随即关闭，由工作进程各自监听
+    int listen_fd = service ? open_listener(&options) : -1;
+    int result = -1;
+    if (listen_fd >= 0 && options.process_count > 0) {
+        close(listen_fd);
+        result = run_worker_processes(service, &options);
+    } else if (listen_fd >= 0) {
+        result = serve(service, listen_fd, &options);
+        close(listen_fd);
+    }
+    query_service_destroy(service);
+    return result;
+}
@@ -3,13 +3,28 @@
  * @brief 程序的主入口和用户交互界面。
  * @details 负责初始化程序、处理用户输入、调用核心功能并最终清理资源。
  */
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 // 包含所有模块的头文件
+#include "assignment.h"
+#include "batch_pipeline.h"
+#include "centrality.h"
+#include "city_tables.h"
+#include "facility.h"
+#include "geofence.h"
 #include "graph.h"
+#include "http_server.h"
 #include "pathfinding.h"
+#include "reliability.h"
+#include "snapshot.h"
+#include "speed_profile.h"
+#include "timetable.h"
+#include "tsp_bnb.h"
+#include "vrp.h"
+#include "tour.h"
 #include "visualization.h"
 #include "types.h"
 #include "utils.h"
@@ -45,6 +60,128 @@ static void print_route_human_readable(const TrafficNetwork *network, const Rout
            path->total_distance, path->total_time, path->total_cost);
 }
 
+// 当前正在进行的长时间求解所使用的取消令牌，供 Ctrl+C 信号处理函数使用
+static CancelToken *g_active_token = NULL;
+// 开始求解前的 SIGINT 处理方式，求解结束后恢复
+static struct sigaction g_previous_sigint;
+
+/**
+ * @brief 用 sigaction 安装信号处理函数。处理期间屏蔽同一信号，不会像 signal() 那样在某些系统上被重置为默认处理。
+ *
+ * @param sig 信号。
+ * @param handler 处理函数。
+ * @param flags sa_flags，例如 SA_RESTART。
+ * @param previous 用于保存原来的处理方式，可为NULL。
+ */
+static void install_signal_handler(int sig, void (*handler)(int), int flags, struct sigaction *previous)
+{
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = flags;
+    if (sigaction(sig, &action, previous) != 0)
+    {
+        perror("警告: 无法安装信号处理函数");
+    }
+}
+
+/**
+ * @brief SIGINT 处理函数：取消当前的求解，而不是直接退出程序。
+ */
+static void handle_interrupt(int sig)
+{
+    (void)sig;
+    if (g_active_token)
+    {
+        cancel_token_cancel(g_active_token);
+    }
+}
+
+// 进度显示的状态，用于避免重复刷新同一个百分比
+typedef struct
+{
+    const char *stage;
+    int percent;
+} ProgressState;
+
+/**
+ * @brief 在同一行刷新显示求解进度。
+ * @details 只有阶段或百分比变化时才刷新，避免频繁输出。
+ */
+static void print_progress(const char *stage, double fraction, void *user_data)
+{
+    ProgressState *state = (ProgressState *)user_data;
+    int percent = (int)(fraction * 100.0);
+    if (state->stage && strcmp(stage, state->stage) == 0 && percent == state->percent)
+        return;
+    if (state->stage && strcmp(stage, state->stage) != 0)
+        printf("\n"); // 新阶段另起一行
+    state->stage = stage;
+    state->percent = percent;
+
+    const char *stage_cn = "计算中";
+    if (strcmp(stage, "cost_matrix") == 0)
+        stage_cn = "构建成本矩阵";
+    else if (strcmp(stage, "dp") == 0)
+        stage_cn = "动态规划求解";
+    else if (strcmp(stage, "branch_and_bound") == 0)
+        stage_cn = "分支定界搜索";
+    else if (strcmp(stage, "search") == 0)
+        stage_cn = "大邻域搜索";
+    else if (strcmp(stage, "legs") == 0)
+        stage_cn = "逐段寻路";
+    else if (strcmp(stage, "assignment") == 0)
+        stage_cn = "交通分配迭代";
+    else if (strcmp(stage, "sampling") == 0)
+        stage_cn = "蒙特卡洛抽样";
+    else if (strcmp(stage, "centrality") == 0)
+        stage_cn = "介数中心性";
+    else if (strcmp(stage, "facility") == 0)
+        stage_cn = "枢纽选址";
+    else if (strcmp(stage, "clusters") == 0)
+        stage_cn = "簇内求解";
+    else if (strcmp(stage, "cluster_order") == 0)
+        stage_cn = "簇间顺序";
+    else if (strcmp(stage, "boundaries") == 0)
+        stage_cn = "拼接处优化";
+    else if (strcmp(stage, "batch") == 0)
+        stage_cn = "批量路线规划";
+    printf("\r%s: %3d%%", stage_cn, percent);
+    fflush(stdout);
+}
+
+/**
+ * @brief 为一次长时间求解准备取消令牌和进度回调，并安装 Ctrl+C 处理函数。
+ */
+static void begin_interruptible_solve(SolveControl *control, CancelToken *token, ProgressState *progress)
+{
+    cancel_token_init(token);
+    progress->stage = NULL;
+    progress->percent = -1;
+    control->cancel_token = token;
+    control->on_progress = print_progress;
+    control->user_data = progress;
+    g_active_token = token;
+    // 被中断的系统调用自动重启，避免求解中的输出因 EINTR 丢失
+    install_signal_handler(SIGINT, handle_interrupt, SA_RESTART, &g_previous_sigint);
+    printf("(按 Ctrl+C 可取消计算)\n");
+}
+
+/**
+ * @brief 结束一次长时间求解：恢复求解前的 Ctrl+C 行为，并提示是否被取消。
+ */
+static void end_interruptible_solve(const CancelToken *token)
+{
+    sigaction(SIGINT, &g_previous_sigint, NULL);
+    g_active_token = NULL;
+    printf("\n");
+    if (cancel_token_is_cancelled(token))
+    {
+        printf("> 计算已取消。\n");
+    }
+}
+
 /**
  * @brief 处理单点路径规划的用户交互逻辑。
  * @param network 交通网络对象。
@@ -83,38 +220,88 @@ void handle_single_path_planning(const TrafficNetwork *network)
     free_route_path(path);
 }
 
+/**
+ * @brief 处理限时近似路径规划的用户交互逻辑。
+ * @details 适合需要快速响应的场景：在时间预算内返回成本不超过最优值 (1+ε) 倍的路线。
+ * @param network 交通网络对象。
+ */
+void handle_anytime_path_planning(const TrafficNetwork *network)
+{
+    char start_name[100], end_name[100];
+    printf("请输入起点地标: ");
+    scanf("%99s", start_name);
+    printf("请输入终点地标: ");
+    scanf("%99s", end_name);
+
+    int start_node_id = traffic_network_find_node_id_by_name(network, start_name);
+    int end_node_id = traffic_network_find_node_id_by_name(network, end_name);
+
+    if (start_node_id == -1 || end_node_id == -1)
+    {
+        printf("错误: 未找到输入的地标名称。\n");
+        return;
+    }
+
+    double time_w, cost_w, epsilon, budget_ms;
+    printf("请输入时间权重 (0.0-1.0): ");
+    scanf("%lf", &time_w);
+    printf("请输入成本权重 (0.0-1.0): ");
+    scanf("%lf", &cost_w);
+    printf("请输入允许的次优比例 epsilon (例如 0.2 表示不超过最优的1.2倍): ");
+    scanf("%lf", &epsilon);
+    printf("请输入时间预算 (毫秒): ");
+    scanf("%lf", &budget_ms);
+
+    double achieved_epsilon;
+    RoutePath *path = find_shortest_path_anytime(network, start_node_id, end_node_id, time_w, cost_w, epsilon, budget_ms, &achieved_epsilon);
+
+    print_route_human_readable(network, path);
+    if (path)
+    {
+        printf("> 结果保证不超过最优成本的 %.3f 倍。\n", 1.0 + achieved_epsilon);
+    }
+    generate_html_visualization(network, path);
+    free_route_path(path);
+}
+
 /**
  * @brief 处理TSP的用户交互逻辑。
  * @param network 交通网络对象。
  */
 void handle_tsp_planning(const TrafficNetwork *network)
 {
-    int node_ids[20];
-    int count = 0;
+    int *node_ids = NULL;
+    int count = 0, capacity = 0;
     char node_name[100];
 
-    printf("请输入要经过的地标列表 (起点为第一个, 输入 'done' 结束):\n");
-    while (count < 10)
+    printf("请输入要经过的地标列表 (起点为第一个, 超过%d个时使用分层分解求解, 输入 'done' 结束):\n", TSP_BNB_MAX_NODES);
+    while (1)
     {
         printf("地标 %d: ", count + 1);
-        scanf("%s", node_name);
-        if (strcmp(node_name, "done") == 0)
+        if (scanf("%99s", node_name) != 1 || strcmp(node_name, "done") == 0)
             break;
 
         int id = traffic_network_find_node_id_by_name(network, node_name);
-        if (id != -1)
+        if (id == -1)
         {
-            node_ids[count++] = id;
+            printf("未找到地标: %s\n", node_name);
+            continue;
         }
-        else
+        if (count == capacity)
         {
-            printf("未找到地标: %s\n", node_name);
+            capacity = capacity ? capacity * 2 : 16;
+            int *grown = (int *)realloc(node_ids, capacity * sizeof(int));
+            if (!grown)
+                break;
+            node_ids = grown;
         }
+        node_ids[count++] = id;
     }
 
     if (count < 2)
     {
         printf("错误: TSP需要至少2个地标。\n");
+        free(node_ids);
         return;
     }
 
@@ -124,12 +311,27 @@ void handle_tsp_planning(const TrafficNetwork *network)
     printf("请输入成本权重 (0.0-1.0): ");
     scanf("%lf", &cost_w);
 
-    printf("\n正在计算TSP路径，请稍候...\n");
-    RoutePath *path = solve_tsp(network, node_ids, count, time_w, cost_w);
+    printf("\n正在计算TSP路径...\n");
+    SolveControl control;
+    CancelToken token;
+    ProgressState progress;
+    begin_interruptible_solve(&control, &token, &progress);
+    bool is_optimal = false;
+    RoutePath *path = solve_tsp_exact(network, node_ids, count, time_w, cost_w, TSP_BNB_DEFAULT_TIME_LIMIT_MS, &is_optimal, NULL, &control);
+    end_interruptible_solve(&token);
 
     print_route_human_readable(network, path);
+    if (path && count > TSP_BNB_MAX_NODES)
+    {
+        printf("> 途经点较多，已分簇求解后拼接，结果不保证最优。\n");
+    }
+    else if (path && !is_optimal)
+    {
+        printf("> 已达到时间限制，结果为目前找到的最优可行解，未能证明最优。\n");
+    }
     generate_html_visualization(network, path);
     free_route_path(path);
+    free(node_ids);
 }
 
 /**
@@ -173,8 +375,13 @@ void handle_sequential_planning(const TrafficNetwork *network)
     printf("请输入成本权重 (0.0-1.0): ");
     scanf("%lf", &cost_w);
 
-    printf("\n正在计算顺序路径，请稍候...\n");
-    RoutePath *path = find_sequential_path(network, node_ids, count, time_w, cost_w);
+    printf("\n正在计算顺序路径...\n");
+    SolveControl control;
+    CancelToken token;
+    ProgressState progress;
+    begin_interruptible_solve(&control, &token, &progress);
+    RoutePath *path = find_sequential_path_ex(network, node_ids, count, time_w, cost_w, NULL, &control);
+    end_interruptible_solve(&token);
 
     print_route_human_readable(network, path);
     if (path)
@@ -184,65 +391,1014 @@ void handle_sequential_planning(const TrafficNetwork *network)
     free_route_path(path);
 }
 
-// 程序主函数
-int main()
+/**
+ * @brief 打印行程当前的环路顺序和成本。
+ */
+static void print_tour_state(const TrafficNetwork *network, const TourPlanner *tour)
 {
-    // 1. 创建并加载交通网络数据
-    // network对象现在是数据的唯一所有者
-    TrafficNetwork *network = traffic_network_create("data/nodes.csv");
-    if (!network)
+    int count = tour_planner_get_stop_count(tour);
+    if (count == 0)
     {
-        return 1; // 如果加载失败，程序退出
+        printf("> 行程为空。\n");
+        return;
+    }
+    int *order = (int *)malloc(count * sizeof(int));
+    if (!order)
+        return;
+    tour_planner_get_order(tour, order, count);
+    printf("> 当前环路:");
+    for (int i = 0; i < count; i++)
+    {
+        const Node *node = traffic_network_get_node_by_id(network, order[i]);
+        printf(" %s ->", node ? node->name : "未知");
+    }
+    const Node *start = traffic_network_get_node_by_id(network, order[0]);
+    printf(" %s\n", start ? start->name : "未知");
+    if (count >= 2)
+    {
+        printf("> 加权成本: %.4f (%s)\n", tour_planner_get_cost(tour),
+               tour_planner_is_optimal(tour) ? "精确最优" : "局部搜索近似");
     }
+    free(order);
+}
 
-    // 在Windows环境下，设置控制台代码页为UTF-8以正确显示中文
-#ifdef _WIN32
-    system("chcp 65001 > nul");
-#endif
+/**
+ * @brief 处理交互式行程编辑的用户交互逻辑。
+ * @details 每次增删途经点只增量修复环路，不重新求解整个TSP。
+ * @param network 交通网络对象。
+ */
+void handle_tour_editing(const TrafficNetwork *network)
+{
+    double time_w, cost_w;
+    printf("请输入时间权重 (0.0-1.0): ");
+    scanf("%lf", &time_w);
+    printf("请输入成本权重 (0.0-1.0): ");
+    scanf("%lf", &cost_w);
 
-    // 2. 主事件循环
-    int choice;
-    while (1)
+    TourPlanner *tour = tour_planner_create(network, time_w, cost_w);
+    if (!tour)
     {
-        printf("\n========== 交通网络路径规划系统 ==========\n");
-        printf("1. 单点路径规划\n");
-        printf("2. 多点旅行规划 (TSP)\n");
-        printf("3. 顺序路径规划\n");
-        printf("4. 退出\n");
-        printf("请选择功能: ");
+        printf("错误: 无法创建行程。\n");
+        return;
+    }
 
-        // 读取用户输入，并处理无效输入
-        if (scanf("%d", &choice) != 1)
+    printf("输入 '+地标' 增加途经点, '-地标' 删除途经点, 'done' 结束编辑 (第一个途经点为起点):\n");
+    char command[101];
+    while (1)
+    {
+        printf("编辑: ");
+        if (scanf("%100s", command) != 1 || strcmp(command, "done") == 0)
+            break;
+        if (command[0] != '+' && command[0] != '-')
         {
-            // 清空输入缓冲区，防止无限循环
-            while (getchar() != '\n')
-                ;
-            choice = 0; // 设为无效选项
+            printf("无效指令: %s\n", command);
+            continue;
         }
 
-        // 根据用户选择调用对应的处理函数
-        // 注意：network对象作为参数被传递下去
-        switch (choice)
+        int id = traffic_network_find_node_id_by_name(network, command + 1);
+        if (id == -1)
         {
-        case 1:
-            handle_single_path_planning(network);
-            break;
-        case 2:
-            handle_tsp_planning(network);
-            break;
-        case 3:
-            handle_sequential_planning(network);
+            printf("未找到地标: %s\n", command + 1);
+            continue;
+        }
+        bool ok = command[0] == '+' ? tour_planner_add_stop(tour, id) : tour_planner_remove_stop(tour, id);
+        if (!ok)
+        {
+            printf("操作失败: %s\n", command);
+            continue;
+        }
+        print_tour_state(network, tour);
+    }
+
+    RoutePath *path = tour_planner_build_route(tour);
+    print_route_human_readable(network, path);
+    generate_html_visualization(network, path);
+    free_route_path(path);
+    tour_planner_destroy(tour);
+}
+
+/**
+ * @brief 处理多人旅行规划的用户交互逻辑。
+ * @details 把途经点分配给多名旅行者，所有人从第一个地标出发并返回。
+ * @param network 交通网络对象。
+ */
+void handle_multi_traveller_planning(const TrafficNetwork *network)
+{
+    int node_ids[100];
+    int count = 0;
+    char node_name[100];
+
+    printf("请输入要经过的地标列表 (第一个为所有人的起点, 最多100个, 输入 'done' 结束):\n");
+    while (count < 100)
+    {
+        printf("地标 %d: ", count + 1);
+        scanf("%s", node_name);
+        if (strcmp(node_name, "done") == 0)
+            break;
+
+        int id = traffic_network_find_node_id_by_name(network, node_name);
+        if (id != -1)
+        {
+            node_ids[count++] = id;
+        }
+        else
+        {
+            printf("未找到地标: %s\n", node_name);
+        }
+    }
+
+    if (count < 2)
+    {
+        printf("错误: 多人旅行规划需要至少2个地标。\n");
+        return;
+    }
+
+    VrpOptions options;
+    vrp_default_options(&options);
+    int balance = 0;
+    printf("请输入旅行者人数: ");
+    scanf("%d", &options.num_travellers);
+    printf("请输入每人最多途经点数 (0表示不限): ");
+    scanf("%d", &options.max_stops_per_route);
+    printf("优化目标 (0: 总成本最低, 1: 最长行程最短): ");
+    scanf("%d", &balance);
+    options.objective = balance ? VRP_MINIMIZE_MAX_ROUTE : VRP_MINIMIZE_TOTAL;
+
+    double time_w, cost_w;
+    printf("请输入时间权重 (0.0-1.0): ");
+    scanf("%lf", &time_w);
+    printf("请输入成本权重 (0.0-1.0): ");
+    scanf("%lf", &cost_w);
+
+    printf("\n正在分配并规划各人的路线...\n");
+    SolveControl control;
+    CancelToken token;
+    ProgressState progress;
+    begin_interruptible_solve(&control, &token, &progress);
+    VrpResult *result = solve_vrp(network, node_ids, count, time_w, cost_w, &options, &control);
+    end_interruptible_solve(&token);
+
+    if (!result)
+    {
+        printf("\n> 未能完成多人旅行规划。\n");
+        return;
+    }
+    for (int r = 0; r < result->num_routes; r++)
+    {
+        printf("\n--- 旅行者 %d: %d 个途经点, 加权成本 %.4f ---\n", r + 1, result->stop_counts[r], result->route_costs[r]);
+        if (result->routes[r])
+        {
+            print_route_human_readable(network, result->routes[r]);
+        }
+    }
+    printf("\n> 总加权成本 %.4f, 最长行程 %.4f\n", result->total_cost, result->max_route_cost);
+    free_vrp_result(result);
+}
+
+/**
+ * @brief 处理按出发时间规划路径的用户交互逻辑。
+ * @details 驾车和公交的速度随出发时段变化（早晚高峰较慢），同一对地标在不同时间出发可能得到不同路线。
+ * @param network 交通网络对象。
+ * @param profiles 速度曲线集合。
+ */
+void handle_time_dependent_planning(const TrafficNetwork *network, const SpeedProfileSet *profiles)
+{
+    if (!profiles)
+    {
+        printf("错误: 未加载速度曲线文件 data/speed_profiles.csv。\n");
+        return;
+    }
+
+    char start_name[100], end_name[100];
+    printf("请输入起点地标: ");
+    scanf("%99s", start_name);
+    printf("请输入终点地标: ");
+    scanf("%99s", end_name);
+
+    int start_node_id = traffic_network_find_node_id_by_name(network, start_name);
+    int end_node_id = traffic_network_find_node_id_by_name(network, end_name);
+
+    if (start_node_id == -1 || end_node_id == -1)
+    {
+        printf("错误: 未找到输入的地标名称。\n");
+        return;
+    }
+
+    double depart_hour, time_w, cost_w;
+    printf("请输入出发时刻 (0-24, 例如 8.5 表示 8:30): ");
+    scanf("%lf", &depart_hour);
+    printf("请输入时间权重 (0.0-1.0): ");
+    scanf("%lf", &time_w);
+    printf("请输入成本权重 (0.0-1.0): ");
+    scanf("%lf", &cost_w);
+
+    RoutePath *path = find_shortest_path_td(network, profiles, start_node_id, end_node_id, time_w, cost_w, depart_hour, NULL);
+
+    print_route_human_readable(network, path);
+    if (path)
+    {
+        double arrival = depart_hour + path->total_time;
+        int day = (int)(arrival / 24.0);
+        double clock = arrival - day * 24.0;
+        printf("> 预计到达时刻: %02d:%02d", (int)clock, (int)((clock - (int)clock) * 60.0));
+        if (day > 0)
+        {
+            printf(" (+%d天)", day);
+        }
+        printf("\n");
+    }
+    generate_html_visualization(network, path);
+    free_route_path(path);
+}
+
+/**
+ * @brief 处理按时刻表规划行程的用户交互逻辑。
+ * @details 航班和高铁按班次时刻出行，同城接驳使用驾车或公交，输出最早到达的行程（含候车和换乘时间）。
+ * @param network 交通网络对象。
+ * @param timetable 航班和高铁时刻表。
+ */
+void handle_timetable_planning(const TrafficNetwork *network, const Timetable *timetable)
+{
+    if (!timetable)
+    {
+        printf("错误: 未加载时刻表文件 data/timetable.csv。\n");
+        return;
+    }
+
+    char start_name[100], end_name[100];
+    printf("请输入起点地标: ");
+    scanf("%99s", start_name);
+    printf("请输入终点地标: ");
+    scanf("%99s", end_name);
+
+    int start_node_id = traffic_network_find_node_id_by_name(network, start_name);
+    int end_node_id = traffic_network_find_node_id_by_name(network, end_name);
+
+    if (start_node_id == -1 || end_node_id == -1)
+    {
+        printf("错误: 未找到输入的地标名称。\n");
+        return;
+    }
+
+    double depart_hour;
+    printf("请输入出发时刻 (0-24, 例如 8.5 表示 8:30): ");
+    scanf("%lf", &depart_hour);
+
+    double arrival = 0.0;
+    RoutePath *path = timetable_earliest_arrival(timetable, network, start_node_id, end_node_id, depart_hour, &arrival);
+    if (!path)
+    {
+        printf("在时刻表范围内（次日24点前）无法到达。\n");
+        return;
+    }
+
+    print_route_human_readable(network, path);
+    int day = (int)(arrival / 24.0);
+    double clock = arrival - day * 24.0;
+    printf("> 最早到达时刻: %02d:%02d", (int)clock, (int)((clock - (int)clock) * 60.0 + 0.5));
+    if (day > 0)
+    {
+        printf(" (+%d天)", day);
+    }
+    printf("\n");
+    generate_html_visualization(network, path);
+    free_route_path(path);
+}
+
+/**
+ * @brief 处理交通事件（封闭站点、路段封闭或减速）的用户交互逻辑。
+ * @details 事件会影响之后的所有规划功能；已物化的最短路径树按变更日志增量修复。
+ * @param network 交通网络对象。
+ */
+void handle_incident_update(TrafficNetwork *network)
+{
+    int action;
+    printf("1. 封闭节点  2. 重新开放节点  3. 路段封闭/减速  4. 撤销所有事件\n");
+    printf("请选择操作: ");
+    if (scanf("%d", &action) != 1)
+    {
+        while (getchar() != '\n')
+            ;
+        printf("无效输入。\n");
+        return;
+    }
+
+    if (action == 4)
+    {
+        traffic_network_clear_incidents(network);
+        printf("已撤销所有交通事件（网络版本 %lu）。\n", traffic_network_get_version(network));
+        return;
+    }
+
+    char name[100];
+    printf("请输入%s地标: ", action == 3 ? "路段一端的" : "");
+    scanf("%99s", name);
+    int node_id = traffic_network_find_node_id_by_name(network, name);
+    if (node_id == -1)
+    {
+        printf("错误: 未找到输入的地标名称。\n");
+        return;
+    }
+
+    bool ok = false;
+    if (action == 1 || action == 2)
+    {
+        ok = traffic_network_set_node_enabled(network, node_id, action == 2);
+    }
+    else if (action == 3)
+    {
+        char other_name[100], mode_name[32];
+        double factor;
+        printf("请输入路段另一端的地标: ");
+        scanf("%99s", other_name);
+        printf("请输入交通方式 (driving/high_speed_rail/flight/bus): ");
+        scanf("%31s", mode_name);
+        printf("请输入通行时间倍数 (0 表示封闭, 1 表示恢复正常, 大于1 表示减速): ");
+        scanf("%lf", &factor);
+
+        int other_id = traffic_network_find_node_id_by_name(network, other_name);
+        int mode = mode_from_string(mode_name);
+        if (other_id == -1 || mode < 0 || factor < 0 || (factor > 0 && factor < 1))
+        {
+            printf("错误: 地标、交通方式或倍数无效。\n");
+            return;
+        }
+
+        // 事件对两个方向同时生效
+        ok = true;
+        for (int dir = 0; dir < 2; dir++)
+        {
+            int from = dir == 0 ? node_id : other_id;
+            int to = dir == 0 ? other_id : node_id;
+            ok = ok && traffic_network_set_edge_enabled(network, from, to, (TransportMode)mode, factor > 0);
+            if (factor > 0)
+            {
+                ok = ok && traffic_network_set_edge_time_factor(network, from, to, (TransportMode)mode, factor);
+            }
+        }
+    }
+    else
+    {
+        printf("无效输入。\n");
+        return;
+    }
+
+    if (ok)
+    {
+        printf("交通事件已生效（网络版本 %lu）。\n", traffic_network_get_version(network));
+    }
+    else
+    {
+        printf("错误: 交通事件更新失败。\n");
+    }
+}
+
+/**
+ * @brief 处理情景对比（假设封闭某个节点）的用户交互逻辑。
+ * @details 情景在覆盖网络上模拟，不修改实际网络；起点的最短路径树在实际网络上计算一次，
+ *          复制后增量修复到情景网络上。
+ * @param network 交通网络对象。
+ */
+void handle_scenario_comparison(const TrafficNetwork *network)
+{
+    char start_name[100], end_name[100], closed_name[100];
+    printf("请输入起点地标: ");
+    scanf("%99s", start_name);
+    printf("请输入终点地标: ");
+    scanf("%99s", end_name);
+    printf("请输入假设封闭的地标: ");
+    scanf("%99s", closed_name);
+
+    int start_node_id = traffic_network_find_node_id_by_name(network, start_name);
+    int end_node_id = traffic_network_find_node_id_by_name(network, end_name);
+    int closed_node_id = traffic_network_find_node_id_by_name(network, closed_name);
+    if (start_node_id == -1 || end_node_id == -1 || closed_node_id == -1)
+    {
+        printf("错误: 未找到输入的地标名称。\n");
+        return;
+    }
+
+    double time_w, cost_w;
+    printf("请输入时间权重 (0.0-1.0): ");
+    scanf("%lf", &time_w);
+    printf("请输入成本权重 (0.0-1.0): ");
+    scanf("%lf", &cost_w);
+
+    ShortestPathTree *tree = compute_shortest_path_tree(network, start_node_id, time_w, cost_w, NULL);
+    TrafficNetwork *scenario = traffic_network_create_overlay(network);
+    ShortestPathTree *scenario_tree = shortest_path_tree_clone(tree);
+    if (!tree || !scenario || !scenario_tree || !traffic_network_set_node_enabled(scenario, closed_node_id, false) ||
+        shortest_path_tree_repair(scenario, scenario_tree, NULL) < 0)
+    {
+        printf("错误: 情景计算失败。\n");
+        free_shortest_path_tree(scenario_tree);
+        traffic_network_destroy(scenario);
+        free_shortest_path_tree(tree);
+        return;
+    }
+
+    printf("\n[当前网络]");
+    RoutePath *path = shortest_path_tree_get_route(network, tree, end_node_id);
+    print_route_human_readable(network, path);
+    printf("\n[假设封闭 %s]", closed_name);
+    RoutePath *scenario_path = shortest_path_tree_get_route(scenario, scenario_tree, end_node_id);
+    print_route_human_readable(scenario, scenario_path);
+    if (path && scenario_path)
+    {
+        printf("> 时间变化: %+.2fh, 成本变化: %+.2f元\n", scenario_path->total_time - path->total_time,
+               scenario_path->total_cost - path->total_cost);
+    }
+    generate_html_visualization(scenario, scenario_path);
+
+    free_route_path(path);
+    free_route_path(scenario_path);
+    free_shortest_path_tree(scenario_tree);
+    traffic_network_destroy(scenario);
+    free_shortest_path_tree(tree);
+}
+
+/**
+ * @brief 处理交通分配（用户均衡）的用户交互逻辑。
+ * @details 从 data/od_demand.csv 读取起讫点需求，输出收敛情况和流量最大的路段。
+ * @param network 交通网络对象。
+ */
+void handle_traffic_assignment(const TrafficNetwork *network)
+{
+    double *demand = assignment_load_demand_csv(network, "data/od_demand.csv");
+    if (!demand)
+    {
+        printf("错误: 无法加载需求文件 data/od_demand.csv。\n");
+        return;
+    }
+
+    AssignmentOptions options;
+    assignment_default_options(&options);
+    printf("请输入时间权重 (0.0-1.0): ");
+    scanf("%lf", &options.time_weight);
+    printf("请输入成本权重 (0.0-1.0): ");
+    scanf("%lf", &options.cost_weight);
+
+    SolveControl control;
+    CancelToken token;
+    ProgressState progress;
+    begin_interruptible_solve(&control, &token, &progress);
+    AssignmentResult *result = solve_traffic_assignment(network, demand, &options, &control);
+    end_interruptible_solve(&token);
+    free(demand);
+    if (!result)
+    {
+        return;
+    }
+
+    printf("--- 交通分配结果 ---\n");
+    printf("迭代 %d 次, 相对间隙 %.2e (%s)\n", result->iterations, result->relative_gap, result->converged ? "已收敛" : "未收敛");
+    printf("总需求 %.0f 人次/小时, 不可达 %.0f, 总出行时间 %.1f 人·小时\n", result->total_demand, result->unassigned_demand,
+           result->total_travel_hours);
+    printf("流量最大的路段:\n");
+    for (int i = 0; i < result->link_count && i < 10; i++)
+    {
+        const AssignedLink *link = &result->links[i];
+        printf("  %s --(%s)--> %s: 流量 %.0f, 饱和度 %.2f, 时间 %.2fh (自由流 %.2fh)\n",
+               traffic_network_get_node_by_id(network, link->from_node_id)->name, mode_to_string_cn(link->mode),
+               traffic_network_get_node_by_id(network, link->to_node_id)->name, link->flow, link->saturation, link->congested_hours,
+               link->free_flow_hours);
+    }
+    free_assignment_result(result);
+}
+
+/**
+ * @brief 处理出行时间可靠性分析（蒙特卡洛抽样）的用户交互逻辑。
+ * @details 输出到达时刻的分位数，以及各条路线在多少样本中是最优的。
+ * @param network 交通网络对象。
+ */
+void handle_reliability_analysis(const TrafficNetwork *network)
+{
+    char start_name[100], end_name[100];
+    printf("请输入起点地标: ");
+    scanf("%99s", start_name);
+    printf("请输入终点地标: ");
+    scanf("%99s", end_name);
+    int start_node_id = traffic_network_find_node_id_by_name(network, start_name);
+    int end_node_id = traffic_network_find_node_id_by_name(network, end_name);
+    if (start_node_id == -1 || end_node_id == -1)
+    {
+        printf("错误: 未找到输入的地标名称。\n");
+        return;
+    }
+
+    ReliabilityOptions options;
+    reliability_default_options(&options);
+    double depart_hour;
+    printf("请输入出发时刻 (0-24, 例如 8.5 表示 8:30): ");
+    scanf("%lf", &depart_hour);
+    printf("请输入时间权重 (0.0-1.0): ");
+    scanf("%lf", &options.time_weight);
+    printf("请输入成本权重 (0.0-1.0): ");
+    scanf("%lf", &options.cost_weight);
+    printf("请输入样本数 (例如 10000): ");
+    scanf("%d", &options.sample_count);
+
+    SolveControl control;
+    CancelToken token;
+    ProgressState progress;
+    begin_interruptible_solve(&control, &token, &progress);
+    ReliabilityResult *result = analyze_route_reliability(network, start_node_id, end_node_id, &options, &control);
+    end_interruptible_solve(&token);
+    if (!result)
+    {
+        return;
+    }
+    if (result->reachable_count == 0)
+    {
+        printf("\n> 所有样本中终点均不可达。\n");
+        free_reliability_result(result);
+        return;
+    }
+
+    printf("--- 可靠性分析结果 (%d 个样本, %d 个不可达) ---\n", result->sample_count, result->unreachable_count);
+    printf("无扰动时用时 %.2fh, 平均用时 %.2fh, 平均花费 %.2f元\n", result->baseline_time_hours, result->mean_time_hours,
+           result->mean_cost_yuan);
+    const double percentiles[] = {50, 80, 90, 95};
+    for (int i = 0; i < 4; i++)
+    {
+        double arrival = depart_hour + reliability_time_percentile(result, percentiles[i]);
+        int minutes = (int)(arrival * 60.0 + 0.5);
+        printf("P%.0f 到达时刻: %s%02d:%02d\n", percentiles[i], minutes >= 24 * 60 ? "次日 " : "", minutes / 60 % 24, minutes % 60);
+    }
+    printf("最常成为最优的路线:\n");
+    for (int i = 0; i < result->route_count && i < 5; i++)
+    {
+        const ReliabilityRoute *route = &result->routes[i];
+        printf("  %5.1f%% (平均 %.2fh, %.0f元): %s", 100.0 * route->optimal_count / result->sample_count, route->mean_time_hours,
+               route->mean_cost_yuan, traffic_network_get_node_by_id(network, route->node_ids[0])->name);
+        for (int k = 1; k < route->node_count; k++)
+        {
+            printf(" -(%s)-> %s", mode_to_string_cn(route->modes[k - 1]),
+                   traffic_network_get_node_by_id(network, route->node_ids[k])->name);
+        }
+        printf("\n");
+    }
+    free_reliability_result(result);
+}
+
+/**
+ * @brief 处理枢纽介数中心性分析的用户交互逻辑。
+ * @details 完整结果写入 centrality_report.csv，屏幕上只列出介数最高的枢纽。
+ * @param network 交通网络对象。
+ */
+void handle_centrality_analysis(const TrafficNetwork *network)
+{
+    CentralityOptions options;
+    centrality_default_options(&options);
+    int scope;
+    printf("请输入时间权重 (0.0-1.0): ");
+    scanf("%lf", &options.time_weight);
+    printf("请输入成本权重 (0.0-1.0): ");
+    scanf("%lf", &options.cost_weight);
+    printf("统计范围 (1: 所有节点之间, 2: 仅机场和高铁站之间): ");
+    scanf("%d", &scope);
+    printf("抽样起点数 (0 表示精确计算): ");
+    scanf("%d", &options.sample_sources);
+    options.scope = scope == 2 ? CENTRALITY_HUB_NODES : CENTRALITY_ALL_NODES;
+
+    SolveControl control;
+    CancelToken token;
+    ProgressState progress;
+    begin_interruptible_solve(&control, &token, &progress);
+    CentralityResult *result = compute_betweenness_centrality(network, &options, &control);
+    end_interruptible_solve(&token);
+    if (!result)
+    {
+        return;
+    }
+
+    printf("--- 介数中心性 (%s, %d 个起讫点, 计算了 %d 个起点) ---\n", result->sampled ? "抽样估计" : "精确",
+           result->endpoint_count, result->source_count);
+    // 依次挑出介数最高的10个枢纽
+    char *shown = (char *)calloc(result->node_count, 1);
+    for (int rank = 0; shown && rank < 10; rank++)
+    {
+        int best = -1;
+        for (int v = 0; v < result->node_count; v++)
+        {
+            NodeType type = traffic_network_get_node_by_id(network, v)->type;
+            if (shown[v] || type == NODE_TYPE_LANDMARK)
+                continue;
+            if (best == -1 || result->betweenness[v] > result->betweenness[best])
+                best = v;
+        }
+        if (best == -1 || result->betweenness[best] <= 0)
+            break;
+        shown[best] = 1;
+        printf("  %2d. %s: 经过 %.0f 条最优路线 (占 %.2f%%)\n", rank + 1, traffic_network_get_node_by_id(network, best)->name,
+               result->betweenness[best], 100.0 * result->share[best]);
+    }
+    free(shown);
+    if (centrality_write_csv(network, result, "centrality_report.csv"))
+    {
+        printf("完整结果已写入 centrality_report.csv\n");
+    }
+    free_centrality_result(result);
+}
+
+/**
+ * @brief 处理枢纽选址的用户交互逻辑。
+ * @details 候选站址来自 data/hub_candidates.csv，需求来自 data/od_demand.csv。
+ * @param network 交通网络对象。
+ */
+void handle_facility_location(const TrafficNetwork *network)
+{
+    int candidate_count;
+    HubCandidate *candidates = facility_load_candidates_csv("data/hub_candidates.csv", &candidate_count);
+    double *demand = assignment_load_demand_csv(network, "data/od_demand.csv");
+    if (!candidates || !demand)
+    {
+        printf("错误: 无法加载候选站址 data/hub_candidates.csv 或需求文件 data/od_demand.csv。\n");
+        free(candidates);
+        free(demand);
+        return;
+    }
+
+    FacilityOptions options;
+    printf("请输入时间权重 (0.0-1.0): ");
+    scanf("%lf", &options.time_weight);
+    printf("请输入成本权重 (0.0-1.0): ");
+    scanf("%lf", &options.cost_weight);
+    printf("请输入要新建的枢纽数 (共 %d 个候选站址): ", candidate_count);
+    scanf("%d", &options.hub_count);
+
+    SolveControl control;
+    CancelToken token;
+    ProgressState progress;
+    begin_interruptible_solve(&control, &token, &progress);
+    FacilityResult *result = optimize_hub_locations(network, demand, candidates, candidate_count, &options, &control);
+    end_interruptible_solve(&token);
+    free(demand);
+    if (!result)
+    {
+        free(candidates);
+        return;
+    }
+
+    printf("--- 枢纽选址结果 (评估 %d 次) ---\n", result->evaluations);
+    for (int i = 0; i < result->chosen_count; i++)
+    {
+        const HubCandidate *hub = &candidates[result->chosen[i]];
+        printf("  %d. %s (%s, %s): 总成本减少 %.2f%%\n", i + 1, hub->name, hub->city_name,
+               hub->type == NODE_TYPE_AIRPORT ? "机场" : "高铁站", 100.0 * result->gains[i] / result->initial_objective);
+    }
+    if (result->chosen_count == 0)
+    {
+        printf("  没有能降低总出行成本的候选站址。\n");
+    }
+    else
+    {
+        printf("需求加权总成本: %.2f -> %.2f (减少 %.2f%%)\n", result->initial_objective, result->final_objective,
+               100.0 * (result->initial_objective - result->final_objective) / result->initial_objective);
+    }
+    free_facility_result(result);
+    free(candidates);
+}
+
+/**
+ * @brief 处理条件路径规划的用户交互逻辑。
+ * @details 可以限定允许使用的交通方式（例如不坐飞机），也可以按顺序输入多边形顶点的经纬度，
+ *          路线不会进入该区域，也不会有路段穿越该区域。
+ * @param network 交通网络对象。
+ */
+void handle_conditional_planning(const TrafficNetwork *network)
+{
+    char start_name[100], end_name[100];
+    printf("请输入起点地标: ");
+    scanf("%99s", start_name);
+    printf("请输入终点地标: ");
+    scanf("%99s", end_name);
+
+    int start_node_id = traffic_network_find_node_id_by_name(network, start_name);
+    int end_node_id = traffic_network_find_node_id_by_name(network, end_name);
+
+    if (start_node_id == -1 || end_node_id == -1)
+    {
+        printf("错误: 未找到输入的地标名称。\n");
+        return;
+    }
+
+    RouteQueryOptions options;
+    printf("请输入时间权重 (0.0-1.0): ");
+    scanf("%lf", &options.time_weight);
+    printf("请输入成本权重 (0.0-1.0): ");
+    scanf("%lf", &options.cost_weight);
+
+    char mode_names[100];
+    printf("请输入允许的交通方式 (driving,high_speed_rail,flight,bus 中的一个或多个，用逗号分隔；all 表示不限): ");
+    scanf("%99s", mode_names);
+    if (!mode_mask_from_string(mode_names, &options.allowed_modes))
+    {
+        printf("错误: 无法识别的交通方式。\n");
+        return;
+    }
+
+    int point_count;
+    printf("请输入规避区域的顶点数 (0 表示不规避，否则至少3个): ");
+    if (scanf("%d", &point_count) != 1 || point_count < 0 || (point_count > 0 && point_count < 3) || point_count > 100)
+    {
+        printf("错误: 顶点数应为0或在3到100之间。\n");
+        return;
+    }
+    GeoPoint points[100];
+    for (int i = 0; i < point_count; i++)
+    {
+        printf("请输入第 %d 个顶点的纬度和经度 (例如 28.2 112.9): ", i + 1);
+        scanf("%lf %lf", &points[i].latitude, &points[i].longitude);
+    }
+
+    options.avoid = NULL;
+    if (point_count > 0)
+    {
+        GeoPolygon polygon = {points, point_count};
+        options.avoid = geofence_acquire(network, &polygon, 1);
+        if (!options.avoid)
+        {
+            return;
+        }
+        printf("> 规避区域内有 %d 个节点。\n", options.avoid->blocked_node_count);
+    }
+
+    RoutePath *path = find_shortest_path_query(network, start_node_id, end_node_id, &options, NULL);
+    print_route_human_readable(network, path);
+    generate_html_visualization(network, path);
+    free_route_path(path);
+    geofence_release(options.avoid);
+}
+
+/**
+ * @brief 处理保存二进制快照的用户交互逻辑。
+ * @details 快照路径取自环境变量 TRAFFIC_SNAPSHOT，未设置时为 network.snapshot；
+ *          设置了 TRAFFIC_SNAPSHOT 时，下次启动直接从快照加载网络和同城表。
+ * @param network 交通网络对象。
+ * @param tables 同城全源最短路径表。
+ */
+void handle_snapshot_save(const TrafficNetwork *network, const CityTables *tables)
+{
+    const char *path = getenv("TRAFFIC_SNAPSHOT");
+    if (!path || !*path)
+    {
+        path = "network.snapshot";
+    }
+    if (snapshot_save(path, network, tables))
+    {
+        int city_count, exact_pairs, pairs;
+        city_tables_get_stats(tables, &city_count, &exact_pairs, &pairs);
+        printf("> 快照已保存到 %s（%d 个城市的同城表，%d/%d 个节点对可直接查表）。\n", path, city_count, exact_pairs, pairs);
+        printf("> 设置环境变量 TRAFFIC_SNAPSHOT=%s 后，启动时将直接加载该快照。\n", path);
+    }
+}
+
+/**
+ * @brief 服务模式下 SIGINT/SIGTERM 的处理函数：请求服务停止。
+ */
+static void handle_server_signal(int sig)
+{
+    (void)sig;
+    http_server_request_stop();
+}
+
+/**
+ * @brief 服务模式：解析命令行参数并运行 HTTP/JSON 查询服务，直到收到 SIGINT 或 SIGTERM。
+ * @details 用法: traffic_planner --serve [--bind 地址] [--port 端口] [--workers 计算线程数] [--processes 工作进程数]
+ * @return int 进程退出码。
+ */
+static int run_server_mode(const TrafficNetwork *network, int argc, char **argv)
+{
+    HttpServerOptions options;
+    http_server_options_init(&options);
+    for (int i = 2; i < argc; i++)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "--port") == 0)
+            options.port = atoi(argv[++i]);
+        else if (i + 1 < argc && strcmp(argv[i], "--bind") == 0)
+            options.bind_address = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "--workers") == 0)
+            options.worker_count = atoi(argv[++i]);
+        else if (i + 1 < argc && strcmp(argv[i], "--processes") == 0)
+            options.process_count = atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "用法: %s --serve [--bind 地址] [--port 端口] [--workers 计算线程数] [--processes 工作进程数]\n", argv[0]);
+            return 1;
+        }
+    }
+    // 不设置 SA_RESTART：信号到达时让 epoll_wait/waitpid 立即返回，以便及时检查停止标志
+    install_signal_handler(SIGINT, handle_server_signal, 0, NULL);
+    install_signal_handler(SIGTERM, handle_server_signal, 0, NULL);
+    return http_server_run(network, &options) == 0 ? 0 : 1;
+}
+
+/**
+ * @brief 批量模式：对输入文件中的每一条起终点查询规划路线，结果按输入顺序写入输出文件。
+ * @details 用法: traffic_planner --batch 输入文件 输出文件 [--workers 寻路线程数] [--queue 队列容量]
+ *          文件格式见 batch_pipeline.h。
+ * @return int 进程退出码。
+ */
+static int run_batch_mode(const TrafficNetwork *network, int argc, char **argv)
+{
+    BatchOptions options;
+    batch_options_init(&options);
+    bool valid = argc >= 4;
+    for (int i = 4; valid && i < argc; i++)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "--workers") == 0)
+            options.worker_count = atoi(argv[++i]);
+        else if (i + 1 < argc && strcmp(argv[i], "--queue") == 0)
+            options.queue_capacity = atoi(argv[++i]);
+        else
+            valid = false;
+    }
+    if (!valid)
+    {
+        fprintf(stderr, "用法: %s --batch 输入文件 输出文件 [--workers 寻路线程数] [--queue 队列容量]\n", argv[0]);
+        return 1;
+    }
+
+    SolveControl control;
+    CancelToken token;
+    ProgressState progress;
+    BatchStats stats;
+    begin_interruptible_solve(&control, &token, &progress);
+    bool ok = batch_route_file(network, argv[2], argv[3], &options, &control, &stats);
+    end_interruptible_solve(&token);
+    if (!ok && stats.query_count == 0)
+        return 1; // 文件无法打开等错误已经输出
+    printf("> 已写出 %ld 条查询（%ld 条规划成功）到 %s，用时 %.2f 秒", stats.query_count, stats.routed_count, argv[3],
+           stats.elapsed_seconds);
+    if (stats.elapsed_seconds > 0.0)
+        printf("，%.0f 条/秒", stats.query_count / stats.elapsed_seconds);
+    printf("。\n");
+    return ok ? 0 : 1;
+}
+
+// 程序主函数
+int main(int argc, char **argv)
+{
+    // 1. 创建并加载交通网络数据
+    // network对象现在是数据的唯一所有者；设置了 TRAFFIC_SNAPSHOT 时优先映射二进制快照，
+    // 同一台机器上的所有进程共享快照中的节点和同城表
+    CityTables *city_tables = NULL;
+    TrafficNetwork *network = NULL;
+    SnapshotMapping *snapshot_mapping = NULL;
+    const char *snapshot_path = getenv("TRAFFIC_SNAPSHOT");
+    if (snapshot_path && *snapshot_path)
+    {
+        network = snapshot_map(snapshot_path, &city_tables, &snapshot_mapping);
+    }
+    if (!network)
+    {
+        network = traffic_network_create("data/nodes.csv");
+    }
+    if (!network)
+    {
+        return 1; // 如果加载失败，程序退出
+    }
+    // 同城表：市内短途路段直接查表
+    if (!city_tables)
+    {
+        city_tables = city_tables_build(network, NULL, 0);
+    }
+    traffic_network_set_city_tables(network, city_tables);
+
+    // 服务模式：网络只加载一次，通过HTTP回答查询
+    if (argc > 1 && strcmp(argv[1], "--serve") == 0)
+    {
+        int status = run_server_mode(network, argc, argv);
+        traffic_network_set_city_tables(network, NULL);
+        city_tables_destroy(city_tables);
+        traffic_network_destroy(network);
+        snapshot_unmap(snapshot_mapping);
+        return status;
+    }
+
+    // 批量模式：从文件读取查询，结果写入文件
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0)
+    {
+        int status = run_batch_mode(network, argc, argv);
+        traffic_network_set_city_tables(network, NULL);
+        city_tables_destroy(city_tables);
+        traffic_network_destroy(network);
+        snapshot_unmap(snapshot_mapping);
+        return status;
+    }
+
+    // 速度曲线是可选的：加载失败时其余功能仍按固定速度工作
+    SpeedProfileSet *profiles = speed_profile_set_load(network, "data/speed_profiles.csv");
+    // 时刻表同样是可选的
+    Timetable *timetable = timetable_load(network, "data/timetable.csv");
+
+    // 在Windows环境下，设置控制台代码页为UTF-8以正确显示中文
+#ifdef _WIN32
+    system("chcp 65001 > nul");
+#endif
+
+    // 2. 主事件循环
+    int choice;
+    while (1)
+    {
+        printf("\n========== 交通网络路径规划系统 ==========\n");
+        printf("1. 单点路径规划\n");
+        printf("2. 多点旅行规划 (TSP)\n");
+        printf("3. 顺序路径规划\n");
+        printf("4. 退出\n");
+        printf("5. 限时近似路径规划\n");
+        printf("6. 交互式行程编辑 (增删途经点)\n");
+        printf("7. 多人旅行规划 (mTSP)\n");
+        printf("8. 按出发时间规划路径 (分时段车速)\n");
+        printf("9. 按时刻表规划 (航班/高铁)\n");
+        printf("10. 交通事件 (封闭/减速)\n");
+        printf("11. 情景对比 (假设封闭节点)\n");
+        printf("12. 交通分配 (用户均衡)\n");
+        printf("13. 出行时间可靠性分析 (蒙特卡洛)\n");
+        printf("14. 枢纽介数中心性分析\n");
+        printf("15. 枢纽选址 (新建机场/高铁站)\n");
+        printf("16. 条件路径规划 (限定交通方式/规避区域)\n");
+        printf("17. 保存二进制快照 (网络与同城表)\n");
+        printf("请选择功能: ");
+
+        // 读取用户输入，并处理无效输入
+        if (scanf("%d", &choice) != 1)
+        {
+            // 清空输入缓冲区，防止无限循环
+            while (getchar() != '\n')
+                ;
+            choice = 0; // 设为无效选项
+        }
+
+        // 根据用户选择调用对应的处理函数
+        // 注意：network对象作为参数被传递下去
+        switch (choice)
+        {
+        case 1:
+            handle_single_path_planning(network);
+            break;
+        case 2:
+            handle_tsp_planning(network);
+            break;
+        case 3:
+            handle_sequential_planning(network);
+            break;
+        case 4:
+            printf("感谢使用！\n");
+            goto end; // 跳转到清理步骤
+        case 5:
+            handle_anytime_path_planning(network);
+            break;
+        case 6:
+            handle_tour_editing(network);
+            break;
+        case 7:
+            handle_multi_traveller_planning(network);
+            break;
+        case 8:
+            handle_time_dependent_planning(network, profiles);
+            break;
+        case 9:
+            handle_timetable_planning(network, timetable);
+            break;
+        case 10:
+            handle_incident_update(network);
+            break;
+        case 11:
+            handle_scenario_comparison(network);
+            break;
+        case 12:
+            handle_traffic_assignment(network);
+            break;
+        case 13:
+            handle_reliability_analysis(network);
+            break;
+        case 14:
+            handle_centrality_analysis(network);
+            break;
+        case 15:
+            handle_facility_location(network);
+            break;
+        case 16:
+            handle_conditional_planning(network);
+            break;
+        case 17:
+            handle_snapshot_save(network, city_tables);
             break;
-        case 4:
-            printf("感谢使用！\n");
-            goto end; // 跳转到清理步骤
         default:
-            printf("无效输入，请输入1-4之间的数字。\n");
+            printf("无效输入，请输入1-17之间的数字。\n");
         }
     }
 
 end:
     // 3. 释放所有资源
+    geofence_cache_clear();
+    traffic_network_set_city_tables(network, NULL);
+    city_tables_destroy(city_tables);
+    timetable_destroy(timetable);
+    speed_profile_set_destroy(profiles);
     traffic_network_destroy(network);
+    snapshot_unmap(snapshot_mapping);
     return 0;
 }
\ No newline at end of file
@@ -3,10 +3,20 @@
  * @brief 实现了项目核心的寻路算法，包括Dijkstra、TSP和顺序路径规划。
  */
 #include "pathfinding.h"
+#include "city_tables.h"
 #include "distance.h"
+#include "hierarchical_tsp.h"
+#include "routing_engine.h"
+#include "solve_control.h"
+#include "speed_profile.h"
+#include "thread_pool.h"
+#include "tsp_bnb.h"
+#include "tsp_matrix.h"
+#include "utils.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <float.h>
+#include <pthread.h>
 #include <string.h>
 
 /**
@@ -24,6 +34,30 @@ static const struct {
     {40.0,  0.2}  // BUS: 假设市内公交/长途大巴的平均速度
 };
 
+/**
+ * @brief 市内交通（同城两节点之间）的速度和单位成本。
+ * @details 只有驾车和公交可以在同城内使用，其余交通方式的速度记为0。
+ */
+static const struct {
+    double speed_kmh;
+    double cost_per_km;
+} intra_city_attrs[TRANSPORT_MODE_COUNT] = {
+    {30.0, 1.5}, // DRIVING: 市内驾车速度更快，成本更高
+    {0.0,  0.0}, // HIGH_SPEED_RAIL: 不可用于同城
+    {0.0,  0.0}, // FLIGHT: 不可用于同城
+    {25.0, 0.3}  // BUS: 市内公交
+};
+
+// --- 数据归一化常量 ---
+// 为了让时间和花费有可比性，需要将它们归一化到相似的尺度(0-1)。
+// 这里估算一个理论上的最大时间和花费，作为归一化的分母。
+#define MAX_DIST_ESTIMATE 6000.0                        // 假设最大距离为6000公里
+#define MAX_TIME_ESTIMATE (MAX_DIST_ESTIMATE / 40.0)    // 按最慢的公交速度估算
+#define MAX_COST_ESTIMATE (MAX_DIST_ESTIMATE * 1.5)     // 按最贵的驾车成本估算
+
+// 随时可中断搜索中 ε 的下限，低于该值时直接进行一轮精确搜索
+#define ANYTIME_MIN_EPSILON 0.01
+
 /**
  * @brief 计算两个节点之间通过特定交通方式旅行的详细信息（时间、花费、可达性）。
  * @details 这是寻路算法中计算图中"边"的权重的核心辅助函数。
@@ -68,13 +102,8 @@ static TravelInfo calculate_travel_info(double distance_km, TransportMode mode,
     // 如果通过了规则检查，则设为可达并计算成本
     info.is_reachable = 1;
     if (is_intra_city) { // 市内交通有特定的速度和成本模型
-        if (mode == DRIVING) {
-            info.time_hours = distance_km / 30.0; // 市内驾车速度更快
-            info.cost_yuan = distance_km * 1.5;   // 市内驾车成本更高
-        } else { // 默认为公交
-            info.time_hours = distance_km / 25.0; // 市内公交速度
-            info.cost_yuan = distance_km * 0.3;   // 市内公交成本
-        }
+        info.time_hours = distance_km / intra_city_attrs[mode].speed_kmh;
+        info.cost_yuan = distance_km * intra_city_attrs[mode].cost_per_km;
     } else { // 城际交通
         info.time_hours = distance_km / transport_attrs[mode].speed_kmh;
         info.cost_yuan = distance_km * transport_attrs[mode].cost_per_km;
@@ -82,6 +111,37 @@ static TravelInfo calculate_travel_info(double distance_km, TransportMode mode,
     return info;
 }
 
+// 直达路段评估的实现
+TravelInfo evaluate_direct_leg(const TrafficNetwork* network, int from_node_id, int to_node_id, TransportMode mode) {
+    TravelInfo info;
+    info.is_reachable = 0;
+    const Node* from_node = traffic_network_get_node_by_id(network, from_node_id);
+    const Node* to_node = traffic_network_get_node_by_id(network, to_node_id);
+    if (!from_node || !to_node) return info;
+    double distance = calculate_distance(from_node->latitude, from_node->longitude, to_node->latitude, to_node->longitude);
+    if (distance <= 0.1) return info; // 与寻路算法一致，忽略距离过近或相同的节点
+    return calculate_travel_info(distance, mode, from_node, to_node);
+}
+
+// 一次评估所有交通方式的实现
+double evaluate_direct_legs(const TrafficNetwork* network, int from_node_id, int to_node_id, TravelInfo* legs) {
+    for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) legs[m].is_reachable = 0;
+    const Node* from_node = traffic_network_get_node_by_id(network, from_node_id);
+    const Node* to_node = traffic_network_get_node_by_id(network, to_node_id);
+    if (!from_node || !to_node) return -1.0;
+    double distance = calculate_distance(from_node->latitude, from_node->longitude, to_node->latitude, to_node->longitude);
+    if (distance <= 0.1) return distance;
+    for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) legs[m] = calculate_travel_info(distance, (TransportMode)m, from_node, to_node);
+    return distance;
+}
+
+// 路段加权成本的实现：时间和花费各自归一化后加权求和
+double calculate_weighted_leg_cost(double time_hours, double cost_yuan, double time_weight, double cost_weight) {
+    double normalized_time = time_hours / MAX_TIME_ESTIMATE;
+    double normalized_cost = cost_yuan / MAX_COST_ESTIMATE;
+    return normalized_time * time_weight + normalized_cost * cost_weight;
+}
+
 // 释放RoutePath对象及其所有段的内存
 void free_route_path(RoutePath* path) {
     if (!path) return;
@@ -94,297 +154,1033 @@ void free_route_path(RoutePath* path) {
     free(path);
 }
 
-// Dijkstra算法的实现
-RoutePath* find_shortest_path(const TrafficNetwork* network, int start_node_id, int end_node_id, double time_weight, double cost_weight) {
+/**
+ * @brief 单次搜索的参数。
+ * @details Dijkstra、A* 与加权A* 共用同一个搜索核心，仅启发式权重不同。
+ */
+typedef struct {
+    double time_weight;         // 时间权重
+    double cost_weight;         // 花费权重
+    double heuristic_weight;    // 启发式权重：0为Dijkstra，1为A*，大于1为加权A*
+    double deadline;            // 单调时钟截止时刻（秒），<=0 表示不限时
+    const SolveControl* control; // 调用者的取消令牌与进度回调，可为NULL
+    const SpeedProfileSet* profiles; // 随时段变化的速度曲线，NULL表示使用固定速度
+    double depart_hour;         // 从起点出发的时刻（小时），仅在 profiles 非NULL时使用
+    const GeofenceMask* avoid;  // 规避区域的排除位图，NULL表示不规避
+    TransportModeMask allowed_modes; // 允许的交通方式，0表示不限制
+    const bool* is_target;      // 无终点的搜索中需要确定成本的节点标记，NULL表示计算完整的树
+    int target_count;           // is_target 中标记的节点数，全部确定后停止搜索
+} SearchParams;
+
+/**
+ * @brief 搜索核心的返回状态。
+ */
+typedef enum {
+    SEARCH_UNREACHABLE = 0,     // 搜索结束但终点不可达
+    SEARCH_FOUND = 1,           // 已确定终点的路径
+    SEARCH_ABORTED = -1         // 截止时间已到或已被取消，搜索被中止
+} SearchStatus;
+
+/**
+ * @brief 计算启发式函数使用的"每公里最低加权成本"。
+ * @details 任意一条路段的加权成本都不低于 距离 × 该值，而路段距离之和又不小于
+ *          两端点之间的大圆距离，因此 h(v) = 距离(v, 终点) × 该值 是可采纳且一致的下界。
+ *          只统计允许使用的交通方式，排除飞机等高速方式后下界更紧，A* 扩展的节点更少。
+ * @param max_speed_factor 速度曲线的最大速度系数，固定速度时为1。
+ * @param modes 允许使用的交通方式列表。
+ */
+static double min_weighted_cost_per_km(double time_weight, double cost_weight, double max_speed_factor,
+                                       const TransportMode* modes, int mode_count) {
+    if (time_weight < 0 || cost_weight < 0) return 0.0; // 负权重下无法给出下界，退化为Dijkstra
+    double max_speed = 0.0;
+    double min_cost_per_km = DBL_MAX;
+    for (int i = 0; i < mode_count; i++) {
+        TransportMode m = modes[i];
+        if (transport_attrs[m].speed_kmh > max_speed) max_speed = transport_attrs[m].speed_kmh;
+        if (transport_attrs[m].cost_per_km < min_cost_per_km) min_cost_per_km = transport_attrs[m].cost_per_km;
+        if (intra_city_attrs[m].speed_kmh > max_speed) max_speed = intra_city_attrs[m].speed_kmh;
+        if (intra_city_attrs[m].speed_kmh > 0 && intra_city_attrs[m].cost_per_km < min_cost_per_km) {
+            min_cost_per_km = intra_city_attrs[m].cost_per_km;
+        }
+    }
+    return (1.0 / (max_speed * max_speed_factor)) / MAX_TIME_ESTIMATE * time_weight + min_cost_per_km / MAX_COST_ESTIMATE * cost_weight;
+}
+
+// 每公里加权成本下界的实现
+double weighted_cost_lower_bound_per_km(double time_weight, double cost_weight, TransportModeMask allowed_modes) {
+    TransportMode modes[TRANSPORT_MODE_COUNT];
+    int mode_count = mode_mask_expand(allowed_modes, modes);
+    return min_weighted_cost_per_km(time_weight, cost_weight, 1.0, modes, mode_count);
+}
+
+/**
+ * @brief 计算一条路段使用某种交通方式的加权边权，考虑速度曲线和交通事件。
+ *
+ * @param distance 两端点之间的距离（公里）。
+ * @param arrival_hours 从起点到达路段起点的累计时间（小时），用于速度曲线。
+ * @param hours 输出实际通行时间（小时）。
+ * @return double 加权成本；不可达时返回 DBL_MAX。
+ */
+static double edge_weight(const TrafficNetwork* network, const SearchParams* params, const Node* from_node, const Node* to_node,
+                          double distance, TransportMode mode, double arrival_hours, double* hours) {
+    TravelInfo travel = calculate_travel_info(distance, mode, from_node, to_node);
+    if (!travel.is_reachable) return DBL_MAX;
+
+    // 交通事件：被封闭的节点或路段不可用，减速的路段按倍数延长通行时间
+    double time_factor;
+    if (!traffic_network_get_edge_state(network, from_node->id, to_node->id, mode, &time_factor)) return DBL_MAX;
+
+    // 有速度曲线时，按到达起点的时刻出发，沿曲线积分得到实际通行时间
+    if (params->profiles) {
+        travel.time_hours = speed_profile_set_travel_time(params->profiles, from_node, to_node, mode, travel.time_hours,
+                                                          params->depart_hour + arrival_hours);
+    }
+    travel.time_hours *= time_factor;
+    *hours = travel.time_hours;
+    return calculate_weighted_leg_cost(travel.time_hours, travel.cost_yuan, params->time_weight, params->cost_weight);
+}
+
+/**
+ * @brief 查询规避区域的路段位图：路段 (u, v) 被排除时返回true。
+ */
+static bool geofence_blocks_edge(const GeofenceMask* mask, int u, int v) {
+    return (mask->edge_bits[(size_t)u * mask->row_bytes + (v >> 3)] >> (v & 7)) & 1;
+}
+
+/**
+ * @brief Dijkstra / A* / 加权A* 的统一搜索核心（线性扫描开放集）。
+ * @details 当 heuristic_weight = w ≥ 1 且启发式一致时，不重新打开已关闭节点的加权A*
+ *          找到的路径成本不超过最优值的 w 倍。
+ *          end_node_id 为 -1 时不设终点，计算完整的单源最短路径树（此时忽略启发式）。
+ *
+ * @param dijkstra_nodes 调用者提供的节点状态数组（长度为节点数），返回时保存搜索树。
+ * @param visited 调用者提供的关闭标记数组（长度为节点数）。
+ * @param heuristic 调用者提供的启发值缓存数组（长度为节点数）。
+ */
+static SearchStatus run_search(const TrafficNetwork* network, int start_node_id, int end_node_id, const SearchParams* params,
+                               DijkstraNode* dijkstra_nodes, bool* visited, double* heuristic) {
     int node_count = traffic_network_get_node_count(network);
-    if (start_node_id < 0 || start_node_id >= node_count || end_node_id < 0 || end_node_id >= node_count) return NULL;
+    const Node* end_node = traffic_network_get_node_by_id(network, end_node_id);
 
-    // --- 数据归一化准备 ---
-    // 为了让时间和花费有可比性，需要将它们归一化到相似的尺度(0-1)。
-    // 这里估算一个理论上的最大时间和花费，作为归一化的分母。
-    const double MAX_DIST_ESTIMATE = 6000.0;                    // 假设最大距离为6000公里 
-    const double MAX_TIME_ESTIMATE = MAX_DIST_ESTIMATE / 40.0;  // 按最慢的公交速度估算
-    const double MAX_COST_ESTIMATE = MAX_DIST_ESTIMATE * 1.5;   // 按最贵的驾车成本估算
+    // 被排除的交通方式在松弛时整体跳过，无需逐条路段判断
+    TransportMode modes[TRANSPORT_MODE_COUNT];
+    int mode_count = mode_mask_expand(params->allowed_modes, modes);
 
-    // --- Dijkstra算法初始化 ---
-    DijkstraNode* dijkstra_nodes = (DijkstraNode*)malloc(node_count * sizeof(DijkstraNode));
-    bool* visited = (bool*)calloc(node_count, sizeof(bool));
-    // 初始化所有节点的成本为无穷大，前驱为-1
+    // 初始化所有节点的成本为无穷大，前驱为-1，并预先计算启发值
+    double max_factor = speed_profile_set_get_max_factor(params->profiles);
+    double rate = (params->heuristic_weight > 0 && end_node)
+                      ? min_weighted_cost_per_km(params->time_weight, params->cost_weight, max_factor, modes, mode_count)
+                      : 0.0;
     for (int i = 0; i < node_count; i++) {
         dijkstra_nodes[i].cost = DBL_MAX;
         dijkstra_nodes[i].predecessor_node_id = -1;
+        dijkstra_nodes[i].arrival_hours = 0.0;
+        visited[i] = false;
+        heuristic[i] = 0.0;
+        if (rate > 0) {
+            const Node* n = traffic_network_get_node_by_id(network, i);
+            heuristic[i] = params->heuristic_weight * rate *
+                           calculate_distance(n->latitude, n->longitude, end_node->latitude, end_node->longitude);
+        }
     }
     dijkstra_nodes[start_node_id].cost = 0; // 起点的成本为0
+    int settled_targets = 0;
 
     // --- 主循环 ---
-    // 循环 node_count-1 次，或直到找到终点
     for (int i = 0; i < node_count; i++) {
-        // 1. 在所有未访问的节点中，找到当前成本最小的节点(u)
+        if (params->deadline > 0 && monotonic_time_seconds() >= params->deadline) return SEARCH_ABORTED;
+        if (i % SOLVE_CONTROL_CHECK_INTERVAL == 0 && solve_control_should_stop(params->control)) return SEARCH_ABORTED;
+
+        // 1. 在所有未访问的节点中，找到 f = g + w·h 最小的节点(u)
         int u = -1;
-        double min_cost = DBL_MAX;
+        double min_f = DBL_MAX;
         for (int j = 0; j < node_count; j++) {
-            if (!visited[j] && dijkstra_nodes[j].cost < min_cost) {
-                min_cost = dijkstra_nodes[j].cost;
-                    u = j;
-                }
+            if (!visited[j] && dijkstra_nodes[j].cost != DBL_MAX && dijkstra_nodes[j].cost + heuristic[j] < min_f) {
+                min_f = dijkstra_nodes[j].cost + heuristic[j];
+                u = j;
             }
+        }
 
         // 如果找不到可选节点(u=-1)或已到达终点，则结束搜索
-        if (u == -1 || u == end_node_id) break;
+        if (u == -1) return end_node_id < 0 ? SEARCH_FOUND : SEARCH_UNREACHABLE;
+        if (u == end_node_id) return SEARCH_FOUND;
+        if (params->is_target && params->is_target[u] && ++settled_targets == params->target_count) return SEARCH_FOUND;
         visited[u] = true; // 标记u为已访问
 
         // 2. "松弛"操作：用节点u来更新其所有邻居的成本
         const Node* from_node = traffic_network_get_node_by_id(network, u);
         for (int v = 0; v < node_count; v++) {
             if (visited[v]) continue; // 跳过已访问的邻居
-            
+            if (params->avoid && geofence_blocks_edge(params->avoid, u, v)) continue; // 穿过规避区域
+
             const Node* to_node = traffic_network_get_node_by_id(network, v);
             double distance = calculate_distance(from_node->latitude, from_node->longitude, to_node->latitude, to_node->longitude);
             if (distance <= 0.1) continue; // 忽略距离过近或相同的节点
 
-            // 尝试所有可能的交通方式
-            for (int mode_idx = 0; mode_idx < TRANSPORT_MODE_COUNT; mode_idx++) {
-                TravelInfo travel = calculate_travel_info(distance, (TransportMode)mode_idx, from_node, to_node);
-                if (travel.is_reachable) {
-                    // 计算加权成本
-                    double normalized_time = travel.time_hours / MAX_TIME_ESTIMATE;
-                    double normalized_cost = travel.cost_yuan / MAX_COST_ESTIMATE;
-                    double weighted_cost = normalized_time * time_weight + normalized_cost * cost_weight;
-
-                    // 如果通过u到达v的成本更低，则更新v的成本和前驱
-                    if (dijkstra_nodes[u].cost + weighted_cost < dijkstra_nodes[v].cost) {
-                        dijkstra_nodes[v].cost = dijkstra_nodes[u].cost + weighted_cost;
-                        dijkstra_nodes[v].predecessor_node_id = u;
-                        dijkstra_nodes[v].predecessor_mode = (TransportMode)mode_idx;
-                    }
+            // 尝试所有允许的交通方式
+            for (int k = 0; k < mode_count; k++) {
+                double hours;
+                double weighted_cost = edge_weight(network, params, from_node, to_node, distance, modes[k],
+                                                   dijkstra_nodes[u].arrival_hours, &hours);
+                if (weighted_cost == DBL_MAX) continue;
+
+                // 如果通过u到达v的成本更低，则更新v的成本和前驱
+                if (dijkstra_nodes[u].cost + weighted_cost < dijkstra_nodes[v].cost) {
+                    dijkstra_nodes[v].cost = dijkstra_nodes[u].cost + weighted_cost;
+                    dijkstra_nodes[v].predecessor_node_id = u;
+                    dijkstra_nodes[v].predecessor_mode = modes[k];
+                    dijkstra_nodes[v].arrival_hours = dijkstra_nodes[u].arrival_hours + hours;
                 }
             }
         }
     }
+    if (end_node_id < 0) return SEARCH_FOUND;
+    return dijkstra_nodes[end_node_id].cost != DBL_MAX ? SEARCH_FOUND : SEARCH_UNREACHABLE;
+}
 
-    // --- 路径重建 ---
+/**
+ * @brief 沿搜索树的前驱链从终点回溯到起点，构建 RoutePath。
+ * @return RoutePath* 新建的路径；终点不可达时返回NULL。
+ */
+static RoutePath* build_route_from_tree(const TrafficNetwork* network, const DijkstraNode* dijkstra_nodes, int start_node_id, int end_node_id) {
     // 如果终点的前驱仍然是-1，说明不可达
     if (dijkstra_nodes[end_node_id].predecessor_node_id == -1 && start_node_id != end_node_id) {
-        free(dijkstra_nodes);
-        free(visited);
         return NULL;
     }
 
     RoutePath* path = (RoutePath*)calloc(1, sizeof(RoutePath));
+    if (!path) return NULL;
     // 从终点开始，沿着前驱链条回溯到起点
     int current_node_id = end_node_id;
     while (current_node_id != start_node_id && dijkstra_nodes[current_node_id].predecessor_node_id != -1) {
         int pred_node_id = dijkstra_nodes[current_node_id].predecessor_node_id;
-        
+
         PathSegment* segment = (PathSegment*)malloc(sizeof(PathSegment));
         const Node* from = traffic_network_get_node_by_id(network, pred_node_id);
         const Node* to = traffic_network_get_node_by_id(network, current_node_id);
         double dist = calculate_distance(from->latitude, from->longitude, to->latitude, to->longitude);
         TravelInfo travel = calculate_travel_info(dist, dijkstra_nodes[current_node_id].predecessor_mode, from, to);
-        
+
         segment->from_node_id = pred_node_id;
         segment->to_node_id = current_node_id;
         segment->mode = dijkstra_nodes[current_node_id].predecessor_mode;
         segment->distance_km = dist;
-        segment->time_hours = travel.time_hours;
+        // 时间取自搜索树上的到达时刻之差，这样时间依赖搜索得到的路径也能给出实际通行时间
+        segment->time_hours = dijkstra_nodes[current_node_id].arrival_hours - dijkstra_nodes[pred_node_id].arrival_hours;
         segment->cost_yuan = travel.cost_yuan;
-        
+
         // 使用头插法构建路径段链表，这样回溯结束后顺序自然是正确的
         segment->next = path->segments_head;
         path->segments_head = segment;
-        
+
         // 累加总计
         path->total_distance += dist;
-        path->total_time += travel.time_hours;
+        path->total_time += segment->time_hours;
         path->total_cost += travel.cost_yuan;
         path->segment_count++;
-        
+
         current_node_id = pred_node_id; // 继续回溯
     }
+    return path;
+}
+
+// Dijkstra算法的实现
+RoutePath* find_shortest_path(const TrafficNetwork* network, int start_node_id, int end_node_id, double time_weight, double cost_weight) {
+    return find_shortest_path_ex(network, start_node_id, end_node_id, time_weight, cost_weight, NULL);
+}
+
+// 可中断的Dijkstra算法的实现
+RoutePath* find_shortest_path_ex(const TrafficNetwork* network, int start_node_id, int end_node_id, double time_weight, double cost_weight,
+                                 const SolveControl* control) {
+    int node_count = traffic_network_get_node_count(network);
+    if (start_node_id < 0 || start_node_id >= node_count || end_node_id < 0 || end_node_id >= node_count) return NULL;
+
+    // 同城的市内路段直接查表（表能证明其全网最优时）
+    RoutePath* local = city_tables_find_route(traffic_network_get_city_tables(network), network, start_node_id, end_node_id, time_weight,
+                                             cost_weight);
+    if (local) return local;
+
+    // --- Dijkstra算法初始化 ---
+    DijkstraNode* dijkstra_nodes = (DijkstraNode*)malloc(node_count * sizeof(DijkstraNode));
+    bool* visited = (bool*)malloc(node_count * sizeof(bool));
+    double* heuristic = (double*)malloc(node_count * sizeof(double));
+    if (!dijkstra_nodes || !visited || !heuristic) {
+        free(dijkstra_nodes);
+        free(visited);
+        free(heuristic);
+        return NULL;
+    }
+
+    SearchParams params = { time_weight, cost_weight, 0.0, 0.0, control };
+    RoutePath* path = NULL;
+    if (run_search(network, start_node_id, end_node_id, &params, dijkstra_nodes, visited, heuristic) != SEARCH_ABORTED) {
+        path = build_route_from_tree(network, dijkstra_nodes, start_node_id, end_node_id);
+    }
+
+    free(dijkstra_nodes);
+    free(visited);
+    free(heuristic);
+    return path;
+}
+
+// 加权A*（随时可中断）的实现
+RoutePath* find_shortest_path_anytime(const TrafficNetwork* network, int start_node_id, int end_node_id, double time_weight, double cost_weight,
+                                      double epsilon, double time_budget_ms, double* achieved_epsilon) {
+    if (achieved_epsilon) *achieved_epsilon = -1.0;
+    int node_count = traffic_network_get_node_count(network);
+    if (start_node_id < 0 || start_node_id >= node_count || end_node_id < 0 || end_node_id >= node_count) return NULL;
+    if (epsilon < 0) epsilon = 0;
+
+    DijkstraNode* dijkstra_nodes = (DijkstraNode*)malloc(node_count * sizeof(DijkstraNode));
+    bool* visited = (bool*)malloc(node_count * sizeof(bool));
+    double* heuristic = (double*)malloc(node_count * sizeof(double));
+    if (!dijkstra_nodes || !visited || !heuristic) {
+        free(dijkstra_nodes);
+        free(visited);
+        free(heuristic);
+        return NULL;
+    }
+
+    SearchParams params = { time_weight, cost_weight, 1.0 + epsilon, 0.0, NULL };
+    if (time_budget_ms > 0) params.deadline = monotonic_time_seconds() + time_budget_ms / 1000.0;
+
+    // 逐轮收紧 ε：每一轮都是一次完整的加权A*，结果不超过最优值的 (1+ε) 倍。
+    // 截止时间一到就停止，返回目前为止成本最低的路线。
+    RoutePath* best_path = NULL;
+    double best_cost = DBL_MAX;
+    double eps = epsilon;
+    while (1) {
+        params.heuristic_weight = 1.0 + eps;
+        SearchStatus status = run_search(network, start_node_id, end_node_id, &params, dijkstra_nodes, visited, heuristic);
+        if (status != SEARCH_FOUND) break; // 超时或不可达，更小的 ε 也不会有结果
+
+        if (dijkstra_nodes[end_node_id].cost < best_cost) {
+            free_route_path(best_path);
+            best_path = build_route_from_tree(network, dijkstra_nodes, start_node_id, end_node_id);
+            best_cost = dijkstra_nodes[end_node_id].cost;
+        }
+        if (achieved_epsilon) *achieved_epsilon = eps;
+        if (eps == 0.0) break; // 已得到最优解
+
+        eps = eps / 2.0;
+        if (eps < ANYTIME_MIN_EPSILON) eps = 0.0; // ε 足够小时直接做一轮精确搜索
+    }
+
+    free(dijkstra_nodes);
+    free(visited);
+    free(heuristic);
+    return best_path;
+}
+
+// 时间依赖A*的实现
+RoutePath* find_shortest_path_td(const TrafficNetwork* network, const SpeedProfileSet* profiles, int start_node_id, int end_node_id,
+                                 double time_weight, double cost_weight, double depart_hour, const SolveControl* control) {
+    int node_count = traffic_network_get_node_count(network);
+    if (start_node_id < 0 || start_node_id >= node_count || end_node_id < 0 || end_node_id >= node_count) return NULL;
+
+    DijkstraNode* dijkstra_nodes = (DijkstraNode*)malloc(node_count * sizeof(DijkstraNode));
+    bool* visited = (bool*)malloc(node_count * sizeof(bool));
+    double* heuristic = (double*)malloc(node_count * sizeof(double));
+    if (!dijkstra_nodes || !visited || !heuristic) {
+        free(dijkstra_nodes);
+        free(visited);
+        free(heuristic);
+        return NULL;
+    }
+
+    SearchParams params = { time_weight, cost_weight, 1.0, 0.0, control, profiles, depart_hour };
+    RoutePath* path = NULL;
+    if (run_search(network, start_node_id, end_node_id, &params, dijkstra_nodes, visited, heuristic) != SEARCH_ABORTED) {
+        path = build_route_from_tree(network, dijkstra_nodes, start_node_id, end_node_id);
+    }
 
     free(dijkstra_nodes);
     free(visited);
+    free(heuristic);
     return path;
 }
 
+// 按查询条件寻路的实现
+RoutePath* find_shortest_path_query(const TrafficNetwork* network, int start_node_id, int end_node_id, const RouteQueryOptions* options,
+                                    const SolveControl* control) {
+    int node_count = traffic_network_get_node_count(network);
+    if (!options || start_node_id < 0 || start_node_id >= node_count || end_node_id < 0 || end_node_id >= node_count) return NULL;
+    if (options->avoid) {
+        if (options->avoid->node_count != node_count) {
+            fprintf(stderr, "错误: 规避区域的位图与当前网络不匹配，请重新获取。\n");
+            return NULL;
+        }
+        if (geofence_blocks_node(options->avoid, start_node_id) || geofence_blocks_node(options->avoid, end_node_id)) {
+            fprintf(stderr, "错误: 起点或终点位于规避区域内。\n");
+            return NULL;
+        }
+    }
+    // 同城表只含市内的驾车和公交路段，没有规避区域且两者都允许时才能查表
+    TransportModeMask local_modes = TRANSPORT_MODE_BIT(DRIVING) | TRANSPORT_MODE_BIT(BUS);
+    if (!options->avoid && (options->allowed_modes == 0 || (options->allowed_modes & local_modes) == local_modes)) {
+        RoutePath* local = city_tables_find_route(traffic_network_get_city_tables(network), network, start_node_id, end_node_id,
+                                                  options->time_weight, options->cost_weight);
+        if (local) return local;
+    }
+
+    DijkstraNode* dijkstra_nodes = (DijkstraNode*)malloc(node_count * sizeof(DijkstraNode));
+    bool* visited = (bool*)malloc(node_count * sizeof(bool));
+    double* heuristic = (double*)malloc(node_count * sizeof(double));
+    if (!dijkstra_nodes || !visited || !heuristic) {
+        free(dijkstra_nodes);
+        free(visited);
+        free(heuristic);
+        return NULL;
+    }
+
+    SearchParams params = { options->time_weight, options->cost_weight, 1.0, 0.0, control };
+    params.avoid = options->avoid;
+    params.allowed_modes = options->allowed_modes;
+    RoutePath* path = NULL;
+    if (run_search(network, start_node_id, end_node_id, &params, dijkstra_nodes, visited, heuristic) != SEARCH_ABORTED) {
+        path = build_route_from_tree(network, dijkstra_nodes, start_node_id, end_node_id);
+    }
+
+    free(dijkstra_nodes);
+    free(visited);
+    free(heuristic);
+    return path;
+}
+
+// 一对多最短路径成本的实现
+bool find_shortest_path_costs(const TrafficNetwork* network, int source_node_id, const int* target_node_ids, int target_count,
+                              const RouteQueryOptions* options, const SolveControl* control, double* out_costs) {
+    int node_count = traffic_network_get_node_count(network);
+    if (!options || !out_costs || target_count < 0 || (target_count > 0 && !target_node_ids)) return false;
+    if (source_node_id < 0 || source_node_id >= node_count) return false;
+    if (options->avoid) {
+        if (options->avoid->node_count != node_count) {
+            fprintf(stderr, "错误: 规避区域的位图与当前网络不匹配，请重新获取。\n");
+            return false;
+        }
+        if (geofence_blocks_node(options->avoid, source_node_id)) return false;
+    }
+
+    DijkstraNode* dijkstra_nodes = (DijkstraNode*)malloc(node_count * sizeof(DijkstraNode));
+    bool* visited = (bool*)malloc(node_count * sizeof(bool));
+    double* heuristic = (double*)malloc(node_count * sizeof(double));
+    bool* is_target = (bool*)calloc(node_count, sizeof(bool));
+    if (!dijkstra_nodes || !visited || !heuristic || !is_target) {
+        free(dijkstra_nodes);
+        free(visited);
+        free(heuristic);
+        free(is_target);
+        return false;
+    }
+
+    // 只需确定各个终点的成本，全部确定后即可停止；无效的终点不参与计数
+    int distinct_targets = 0;
+    for (int k = 0; k < target_count; k++) {
+        int t = target_node_ids[k];
+        if (t >= 0 && t < node_count && !is_target[t]) {
+            is_target[t] = true;
+            distinct_targets++;
+        }
+    }
+
+    SearchParams params = { options->time_weight, options->cost_weight, 0.0, 0.0, control };
+    params.avoid = options->avoid;
+    params.allowed_modes = options->allowed_modes;
+    params.is_target = is_target;
+    params.target_count = distinct_targets;
+    bool ok = distinct_targets == 0 ||
+              run_search(network, source_node_id, -1, &params, dijkstra_nodes, visited, heuristic) != SEARCH_ABORTED;
+    for (int k = 0; ok && k < target_count; k++) {
+        int t = target_node_ids[k];
+        out_costs[k] = (t >= 0 && t < node_count) ? dijkstra_nodes[t].cost : DBL_MAX;
+    }
+
+    free(dijkstra_nodes);
+    free(visited);
+    free(heuristic);
+    free(is_target);
+    return ok;
+}
+
 /**
- * @brief 将一个路径(leg)拼接到另一个主路径(main_path)的前面。
- * @param main_path 主路径，拼接后它将包含两个路径的内容。
- * @param leg_to_prepend 要被拼接到前面的路径段。函数执行后，此路径容器将被释放。
+ * @brief 单源最短路径树：保存从一个起点到网络中所有节点的最短加权成本和前驱。
  */
-static void stitch_paths(RoutePath* main_path, RoutePath* leg_to_prepend) {
-    if (!leg_to_prepend || !leg_to_prepend->segments_head) {
-        free_route_path(leg_to_prepend);
-        return;
+struct ShortestPathTree {
+    int source_node_id;         // 起点
+    int node_count;             // 计算时网络的节点数
+    DijkstraNode* nodes;        // 每个节点的成本与前驱
+    double time_weight;         // 计算时使用的时间权重
+    double cost_weight;         // 计算时使用的花费权重
+    const TrafficNetwork* network; // 树与之一致的网络（仅用于比较，不会解引用）
+    unsigned long version;      // 树与之一致的网络版本号
+    bool needs_rebuild;         // 上一次修复被中断，下次必须完整重新计算
+    bool* visited;              // 重新计算时复用的工作区，首次使用时分配
+    double* heuristic;
+};
+
+// 单源最短路径树的计算
+ShortestPathTree* compute_shortest_path_tree(const TrafficNetwork* network, int source_node_id, double time_weight, double cost_weight,
+                                             const SolveControl* control) {
+    int node_count = traffic_network_get_node_count(network);
+    if (source_node_id < 0 || source_node_id >= node_count) return NULL;
+
+    ShortestPathTree* tree = (ShortestPathTree*)calloc(1, sizeof(ShortestPathTree));
+    bool* visited = (bool*)malloc(node_count * sizeof(bool));
+    double* heuristic = (double*)malloc(node_count * sizeof(double));
+    if (tree) tree->nodes = (DijkstraNode*)malloc(node_count * sizeof(DijkstraNode));
+    if (!tree || !tree->nodes || !visited || !heuristic) {
+        free_shortest_path_tree(tree);
+        free(visited);
+        free(heuristic);
+        return NULL;
     }
-    // 如果主路径为空，直接将新路径段赋给它
-    if (main_path->segments_head == NULL) {
-        main_path->segments_head = leg_to_prepend->segments_head;
-    } else {
-        // 找到新路径段的尾部
-        PathSegment* tail = leg_to_prepend->segments_head;
-            while (tail->next != NULL) tail = tail->next;
-        // 将尾部指向主路径的头部，完成拼接
-            tail->next = main_path->segments_head;
-            main_path->segments_head = leg_to_prepend->segments_head;
+    tree->source_node_id = source_node_id;
+    tree->node_count = node_count;
+    tree->time_weight = time_weight;
+    tree->cost_weight = cost_weight;
+    tree->network = network;
+    tree->version = traffic_network_get_version(network);
+
+    SearchParams params = { time_weight, cost_weight, 0.0, 0.0, control };
+    SearchStatus status = run_search(network, source_node_id, -1, &params, tree->nodes, visited, heuristic);
+    free(visited);
+    free(heuristic);
+    if (status == SEARCH_ABORTED) {
+        free_shortest_path_tree(tree);
+        return NULL;
     }
-    // 更新总计数据
-    main_path->segment_count += leg_to_prepend->segment_count;
-    main_path->total_cost += leg_to_prepend->total_cost;
-    main_path->total_time += leg_to_prepend->total_time;
-    main_path->total_distance += leg_to_prepend->total_distance;
-    
-    // 释放已被"掏空"的路径容器
-    leg_to_prepend->segments_head = NULL;
-    free_route_path(leg_to_prepend);
+    return tree;
 }
 
-// TSP求解实现
-RoutePath* solve_tsp(const TrafficNetwork* network, int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight) {
-    if (num_nodes <= 1) return NULL;
-    if (num_nodes > 10) { // 动态规划的复杂度是 O(n^2 * 2^n)，n较大时计算量巨大
-        fprintf(stderr, "TSP求解器目前仅支持最多10个节点。\n");
+double shortest_path_tree_get_cost(const ShortestPathTree* tree, int node_id) {
+    if (!tree || node_id < 0 || node_id >= tree->node_count) return DBL_MAX;
+    return tree->nodes[node_id].cost;
+}
+
+RoutePath* shortest_path_tree_get_route(const TrafficNetwork* network, const ShortestPathTree* tree, int target_node_id) {
+    if (!tree || target_node_id < 0 || target_node_id >= tree->node_count) return NULL;
+    if (tree->nodes[target_node_id].cost == DBL_MAX) return NULL;
+    return build_route_from_tree(network, tree->nodes, tree->source_node_id, target_node_id);
+}
+
+void free_shortest_path_tree(ShortestPathTree* tree) {
+    if (!tree) return;
+    free(tree->nodes);
+    free(tree->visited);
+    free(tree->heuristic);
+    free(tree);
+}
+
+// 原地重新计算最短路径树的实现
+bool shortest_path_tree_recompute(const TrafficNetwork* network, ShortestPathTree* tree, int source_node_id, const SolveControl* control) {
+    int node_count = traffic_network_get_node_count(network);
+    if (!tree || source_node_id < 0 || source_node_id >= node_count) return false;
+
+    // 工作区只在节点数变化时重新分配
+    if (node_count != tree->node_count || !tree->visited) {
+        DijkstraNode* nodes = (DijkstraNode*)realloc(tree->nodes, node_count * sizeof(DijkstraNode));
+        if (nodes) tree->nodes = nodes;
+        bool* visited = (bool*)realloc(tree->visited, node_count * sizeof(bool));
+        if (visited) tree->visited = visited;
+        double* heuristic = (double*)realloc(tree->heuristic, node_count * sizeof(double));
+        if (heuristic) tree->heuristic = heuristic;
+        if (!nodes || !visited || !heuristic) return false;
+        tree->node_count = node_count;
+    }
+
+    tree->source_node_id = source_node_id;
+    tree->network = network;
+    tree->version = traffic_network_get_version(network);
+    tree->needs_rebuild = false;
+
+    SearchParams params = { tree->time_weight, tree->cost_weight, 0.0, 0.0, control };
+    if (run_search(network, source_node_id, -1, &params, tree->nodes, tree->visited, tree->heuristic) == SEARCH_ABORTED) {
+        tree->needs_rebuild = true;
+        return false;
+    }
+    return true;
+}
+
+int shortest_path_tree_get_predecessor(const ShortestPathTree* tree, int node_id, TransportMode* mode) {
+    if (!tree || node_id < 0 || node_id >= tree->node_count) return -1;
+    if (mode) *mode = tree->nodes[node_id].predecessor_mode;
+    return tree->nodes[node_id].predecessor_node_id;
+}
+
+ShortestPathTree* shortest_path_tree_clone(const ShortestPathTree* tree) {
+    if (!tree) return NULL;
+    ShortestPathTree* copy = (ShortestPathTree*)malloc(sizeof(ShortestPathTree));
+    if (!copy) return NULL;
+    *copy = *tree;
+    copy->visited = NULL; // 工作区不共享
+    copy->heuristic = NULL;
+    copy->nodes = (DijkstraNode*)malloc(tree->node_count * sizeof(DijkstraNode));
+    if (!copy->nodes) {
+        free(copy);
         return NULL;
     }
-    int* node_ids = (int*)malloc(num_nodes * sizeof(int));
-    memcpy(node_ids, node_ids_to_visit, num_nodes * sizeof(int));
+    memcpy(copy->nodes, tree->nodes, tree->node_count * sizeof(DijkstraNode));
+    return copy;
+}
 
-    // 1. 构建成本矩阵：计算每两个待访问节点之间的最短加权路径成本
-    double** cost_matrix = (double**)malloc(num_nodes * sizeof(double*));
-    for (int i = 0; i < num_nodes; i++) {
-        cost_matrix[i] = (double*)malloc(num_nodes * sizeof(double));
-        for (int j = 0; j < num_nodes; j++) {
-            if (i == j) {
-                cost_matrix[i][j] = 0;
-            } else {
-                RoutePath* p = find_shortest_path(network, node_ids[i], node_ids[j], time_weight, cost_weight);
-                if (p && p->total_distance > 0) {
-                    double normalized_time = p->total_time / (6000.0/40.0);
-                    double normalized_cost = p->total_cost / (6000.0*1.5);
-                    cost_matrix[i][j] = normalized_time * time_weight + normalized_cost * cost_weight;
-                } else {
-                    cost_matrix[i][j] = DBL_MAX; // 不可达
-                }
-                free_route_path(p);
-            }
+/**
+ * @brief 用节点u到节点v的所有交通方式尝试松弛v。
+ * @return bool v的成本下降时返回true。
+ */
+static bool relax_tree_edge(const TrafficNetwork* network, const SearchParams* params, DijkstraNode* nodes, int u, int v) {
+    const Node* from_node = traffic_network_get_node_by_id(network, u);
+    const Node* to_node = traffic_network_get_node_by_id(network, v);
+    double distance = calculate_distance(from_node->latitude, from_node->longitude, to_node->latitude, to_node->longitude);
+    if (distance <= 0.1) return false; // 与搜索核心一致，忽略距离过近或相同的节点
+
+    bool improved = false;
+    for (int mode_idx = 0; mode_idx < TRANSPORT_MODE_COUNT; mode_idx++) {
+        double hours;
+        double weighted_cost = edge_weight(network, params, from_node, to_node, distance, (TransportMode)mode_idx, nodes[u].arrival_hours, &hours);
+        if (weighted_cost == DBL_MAX || nodes[u].cost + weighted_cost >= nodes[v].cost) continue;
+        nodes[v].cost = nodes[u].cost + weighted_cost;
+        nodes[v].predecessor_node_id = u;
+        nodes[v].predecessor_mode = (TransportMode)mode_idx;
+        nodes[v].arrival_hours = nodes[u].arrival_hours + hours;
+        improved = true;
+    }
+    return improved;
+}
+
+/**
+ * @brief 完整重新计算最短路径树。
+ */
+static bool rebuild_shortest_path_tree(const TrafficNetwork* network, ShortestPathTree* tree, const SearchParams* params) {
+    bool* visited = (bool*)malloc(tree->node_count * sizeof(bool));
+    double* heuristic = (double*)malloc(tree->node_count * sizeof(double));
+    bool ok = visited && heuristic &&
+              run_search(network, tree->source_node_id, -1, params, tree->nodes, visited, heuristic) != SEARCH_ABORTED;
+    free(visited);
+    free(heuristic);
+    return ok;
+}
+
+// 最短路径树增量修复的实现
+int shortest_path_tree_repair(const TrafficNetwork* network, ShortestPathTree* tree, const SolveControl* control) {
+    if (!network || !tree) return -1;
+    unsigned long version = traffic_network_get_version(network);
+    if (tree->network == network && tree->version == version && !tree->needs_rebuild) return 0;
+
+    // 变更日志只能用于同一个网络，或者从基础网络（创建覆盖网络时的版本）过渡到覆盖网络
+    bool same_lineage = tree->network == network ||
+                        (traffic_network_get_base(network) == tree->network && tree->version == traffic_network_get_base_version(network));
+    const NetworkChange* changes;
+    int change_count;
+    bool have_log = same_lineage && !tree->needs_rebuild && traffic_network_get_changes_since(network, tree->version, &changes, &change_count);
+
+    // 网络增加了节点时扩展树的数组，新节点以不可达状态加入，随后作为变更的节点被修复
+    int n = traffic_network_get_node_count(network);
+    if (n != tree->node_count) {
+        DijkstraNode* grown = (DijkstraNode*)realloc(tree->nodes, n * sizeof(DijkstraNode));
+        if (!grown) return -1;
+        tree->nodes = grown;
+        for (int v = tree->node_count; v < n; v++) {
+            grown[v].cost = DBL_MAX;
+            grown[v].predecessor_node_id = -1;
+            grown[v].predecessor_mode = DRIVING;
+            grown[v].arrival_hours = 0.0;
         }
+        if (n < tree->node_count) have_log = false; // 节点变少只能来自不相关的网络
+        tree->node_count = n;
     }
+    DijkstraNode* nodes = tree->nodes;
+    SearchParams params = { tree->time_weight, tree->cost_weight, 0.0, 0.0, control };
 
-    // 2. 动态规划求解
-    // dp_table[mask][i] 表示：经过mask所代表的城市子集，最终停在城市i的最低成本。
-    // mask是一个位掩码，例如 mask = 0...01011 表示访问了城市0, 1, 3。
-    int num_subsets = 1 << num_nodes;
-    double** dp_table = (double**)malloc(num_subsets * sizeof(double*));
-    int** path_table = (int**)malloc(num_subsets * sizeof(int*)); // 记录路径的前驱节点
-    for (int i = 0; i < num_subsets; i++) {
-        dp_table[i] = (double*)malloc(num_nodes * sizeof(double));
-        path_table[i] = (int*)malloc(num_nodes * sizeof(int));
-        for (int k = 0; k < num_nodes; k++) dp_table[i][k] = DBL_MAX;
-    }
-
-    dp_table[1][0] = 0; // 起点是城市0，只访问自己的成本是0 (mask=1)
-    for (int mask = 1; mask < num_subsets; mask++) {
-        for (int u = 0; u < num_nodes; u++) {
-            if (!(mask & (1 << u))) continue; // u不在当前子集中，跳过
-            if (dp_table[mask][u] == DBL_MAX) continue;
-
-            for (int v = 0; v < num_nodes; v++) {
-                if (!(mask & (1 << v))) { // v不在当前子集中，是下一个要访问的目标
-                    int next_mask = mask | (1 << v);
-                    if (dp_table[mask][u] + cost_matrix[u][v] < dp_table[next_mask][v]) {
-                        dp_table[next_mask][v] = dp_table[mask][u] + cost_matrix[u][v];
-                        path_table[next_mask][v] = u; // 记录v的前驱是u
+    double* old_cost = (double*)malloc(n * sizeof(double));
+    int* first_child = (int*)malloc(n * sizeof(int));
+    int* next_sibling = (int*)malloc(n * sizeof(int));
+    int* stack = (int*)malloc(n * sizeof(int));
+    bool* affected = (bool*)calloc(n, sizeof(bool));
+    bool* pending = (bool*)calloc(n, sizeof(bool));
+    int changed = -1;
+    if (!old_cost || !first_child || !next_sibling || !stack || !affected || !pending) goto cleanup;
+    for (int v = 0; v < n; v++) old_cost[v] = nodes[v].cost;
+
+    tree->needs_rebuild = true; // 修复完成前树处于中间状态
+    if (!have_log) {
+        if (!rebuild_shortest_path_tree(network, tree, &params)) goto cleanup;
+    } else {
+        // 1. 由前驱关系建立子节点链表，便于枚举子树
+        for (int v = 0; v < n; v++) first_child[v] = -1;
+        for (int v = 0; v < n; v++) {
+            int p = nodes[v].predecessor_node_id;
+            if (p >= 0) {
+                next_sibling[v] = first_child[p];
+                first_child[p] = v;
+            }
+        }
+
+        // 2. 标记失效的子树：变更的节点，以及被修改的树边的终点，连同它们的所有后代
+        int top = 0;
+        for (int c = 0; c < change_count; c++) {
+            const NetworkChange* change = &changes[c];
+            int root = -1;
+            if (change->to_node_id < 0) {
+                root = change->from_node_id;
+            } else if (nodes[change->to_node_id].predecessor_node_id == change->from_node_id &&
+                       (int)nodes[change->to_node_id].predecessor_mode == change->mode) {
+                root = change->to_node_id;
+            }
+            if (root < 0 || root >= n || affected[root]) continue;
+            affected[root] = true;
+            stack[top++] = root;
+            while (top > 0) {
+                int u = stack[--top];
+                for (int child = first_child[u]; child >= 0; child = next_sibling[child]) {
+                    if (!affected[child]) {
+                        affected[child] = true;
+                        stack[top++] = child;
                     }
                 }
             }
         }
-    }
 
-    // 3. 找到最优路径的终点
-    // 遍历所有可能的终点i，计算 (访问所有城市并停在i的成本 + 从i返回起点的成本) 的最小值
-    int final_mask = num_subsets - 1; // 访问了所有城市的掩码
-    double min_tour_cost = DBL_MAX;
-    int tour_end_city = -1;
-    for (int i = 1; i < num_nodes; i++) {
-        if (dp_table[final_mask][i] != DBL_MAX && cost_matrix[i][0] != DBL_MAX) {
-            if (dp_table[final_mask][i] + cost_matrix[i][0] < min_tour_cost) {
-                min_tour_cost = dp_table[final_mask][i] + cost_matrix[i][0];
-                tour_end_city = i;
+        // 3. 重置失效节点，再从未受影响的节点中为每个失效节点选择最优入边
+        for (int v = 0; v < n; v++) {
+            if (!affected[v]) continue;
+            nodes[v].cost = (v == tree->source_node_id) ? 0.0 : DBL_MAX;
+            nodes[v].predecessor_node_id = -1;
+            nodes[v].arrival_hours = 0.0;
+        }
+        for (int v = 0; v < n; v++) {
+            if (!affected[v]) continue;
+            if (v != tree->source_node_id) {
+                for (int u = 0; u < n; u++) {
+                    if (!affected[u] && nodes[u].cost != DBL_MAX) relax_tree_edge(network, &params, nodes, u, v);
+                }
+            }
+            pending[v] = nodes[v].cost != DBL_MAX;
+        }
+
+        // 4. 路段恢复或提速：成本可能下降的路段终点作为传播的种子
+        for (int c = 0; c < change_count; c++) {
+            const NetworkChange* change = &changes[c];
+            int u = change->from_node_id, v = change->to_node_id;
+            if (v < 0 || v == tree->source_node_id || u >= n || v >= n || nodes[u].cost == DBL_MAX) continue;
+            if (relax_tree_edge(network, &params, nodes, u, v)) pending[v] = true;
+        }
+
+        // 5. 按成本从小到大处理待传播的节点（只在受影响的范围内运行Dijkstra）
+        for (int iteration = 0;; iteration++) {
+            if (iteration % SOLVE_CONTROL_CHECK_INTERVAL == 0 && solve_control_should_stop(control)) goto cleanup;
+            int u = -1;
+            for (int j = 0; j < n; j++) {
+                if (pending[j] && (u == -1 || nodes[j].cost < nodes[u].cost)) u = j;
+            }
+            if (u == -1) break;
+            pending[u] = false;
+            for (int v = 0; v < n; v++) {
+                if (v != tree->source_node_id && relax_tree_edge(network, &params, nodes, u, v)) pending[v] = true;
             }
         }
     }
 
-    if (tour_end_city == -1) { /* 错误处理和内存释放 */ return NULL; }
+    changed = 0;
+    for (int v = 0; v < n; v++) {
+        if (nodes[v].cost != old_cost[v]) changed++;
+    }
+    tree->network = network;
+    tree->version = version;
+    tree->needs_rebuild = false;
 
-    // 4. 从终点回溯，重建完整路径
-    RoutePath* final_path = (RoutePath*)calloc(1, sizeof(RoutePath));
-    int current_city_idx = tour_end_city;
-    int current_mask = final_mask; 
-    // 先拼接上从最后一个城市返回起点的路段
-    stitch_paths(final_path, find_shortest_path(network, node_ids[tour_end_city], node_ids[0], time_weight, cost_weight));
-    while (current_city_idx != 0) {
-        int prev_city_idx = path_table[current_mask][current_city_idx];
-        // 拼接 (前一个城市 -> 当前城市) 的路段
-        stitch_paths(final_path, find_shortest_path(network, node_ids[prev_city_idx], node_ids[current_city_idx], time_weight, cost_weight));
-        current_mask ^= (1 << current_city_idx); // 从掩码中移除当前城市
-        current_city_idx = prev_city_idx;        // 回溯到前一个城市
+cleanup:
+    free(old_cost);
+    free(first_child);
+    free(next_sibling);
+    free(stack);
+    free(affected);
+    free(pending);
+    return changed;
+}
+
+/**
+ * @brief 将一个路径(leg)拼接到另一个主路径(main_path)的尾部。
+ * @param main_path 主路径，拼接后它将包含两个路径的内容。
+ * @param leg_to_append 要被拼接到尾部的路径。函数执行后，此路径容器将被释放。
+ */
+static void append_path(RoutePath* main_path, RoutePath* leg_to_append) {
+    if (!leg_to_append || !leg_to_append->segments_head) {
+        free_route_path(leg_to_append);
+        return;
+    }
+    // 找到主路径的尾部，将新路径段接在后面
+    PathSegment** tail = &main_path->segments_head;
+    while (*tail) tail = &(*tail)->next;
+    *tail = leg_to_append->segments_head;
+
+    // 更新总计数据
+    main_path->segment_count += leg_to_append->segment_count;
+    main_path->total_cost += leg_to_append->total_cost;
+    main_path->total_time += leg_to_append->total_time;
+    main_path->total_distance += leg_to_append->total_distance;
+
+    // 释放已被"掏空"的路径容器
+    leg_to_append->segments_head = NULL;
+    free_route_path(leg_to_append);
+}
+
+// TSP求解实现
+RoutePath* solve_tsp(const TrafficNetwork* network, int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight) {
+    return solve_tsp_ex(network, node_ids_to_visit, num_nodes, time_weight, cost_weight, NULL);
+}
+
+// 可中断的TSP求解实现
+RoutePath* solve_tsp_ex(const TrafficNetwork* network, int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight,
+                        const SolveControl* control) {
+    return solve_tsp_exact(network, node_ids_to_visit, num_nodes, time_weight, cost_weight, TSP_BNB_DEFAULT_TIME_LIMIT_MS, NULL, NULL, control);
+}
+
+// 带时间限制的TSP精确求解实现
+RoutePath* solve_tsp_exact(const TrafficNetwork* network, int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight,
+                           double time_limit_ms, bool* is_optimal, const RoutingEngine* engine, const SolveControl* control) {
+    if (is_optimal) *is_optimal = false;
+    if (num_nodes <= 1) return NULL;
+    if (num_nodes > TSP_BNB_MAX_NODES) {
+        // 超出64位访问掩码，且分支定界在更大规模上难以在合理时间内结束，改用分层分解（不保证最优）
+        HierarchicalTspOptions options;
+        hierarchical_tsp_default_options(&options);
+        options.engine = engine;
+        return solve_tsp_hierarchical(network, node_ids_to_visit, num_nodes, time_weight, cost_weight, &options, control);
+    }
+
+    // 成本矩阵需要 n 次一对多查询；调用者没有提供引擎时由选择器按网络规模挑选
+    RoutingEngine* owned_engine = NULL;
+    if (!engine) {
+        RoutingWorkload workload = { ROUTING_ONE_TO_MANY, num_nodes, 0 };
+        engine = owned_engine = routing_engine_create(routing_engine_select(network, &workload), network);
+    }
+    RouteQueryOptions options = { time_weight, cost_weight, NULL, 0 };
+    double* cost_matrix = (double*)malloc(num_nodes * num_nodes * sizeof(double));
+    int* order = (int*)malloc(num_nodes * sizeof(int));
+    HeldKarpTable* table = held_karp_table_create();
+    RoutePath* final_path = NULL;
+    if (!engine || !cost_matrix || !order || !table) goto cleanup;
+
+    // 1. 构建成本矩阵：从每个待访问节点做一次一对多查询，得到矩阵的一整行
+    for (int i = 0; i < num_nodes; i++) {
+        double* row = &cost_matrix[i * num_nodes];
+        if (!routing_engine_one_to_many(engine, node_ids_to_visit[i], node_ids_to_visit, num_nodes, &options, control, row)) {
+            goto cleanup; // 被取消或节点无效
+        }
+        row[i] = 0.0;
+        solve_control_report_progress(control, "cost_matrix", (double)(i + 1) / num_nodes);
+    }
+
+    if (num_nodes <= HELD_KARP_MAX_NODES) {
+        // 2. 动态规划求解：逐个加入节点，每一层只计算包含新节点的子集
+        for (int k = 0; k < num_nodes; k++) {
+            if (!held_karp_table_extend(table, cost_matrix, num_nodes, control)) goto cleanup;
+            solve_control_report_progress(control, "dp", (double)((2 << k) - 1) / ((1 << num_nodes) - 1));
+        }
+
+        // 3. 找到最优环路
+        if (held_karp_table_best_tour(table, cost_matrix, num_nodes, order) == DBL_MAX) goto cleanup; // 无解
+        if (is_optimal) *is_optimal = true;
+    } else {
+        // 2-3. 动态规划的复杂度是 O(n^2 * 2^n)，点数较多时改用分支定界
+        if (tsp_branch_and_bound(cost_matrix, num_nodes, num_nodes, order, time_limit_ms, control, is_optimal) == DBL_MAX) goto cleanup;
+    }
+
+    // 4. 按环路顺序查询并拼接各路段（只需 n 次点到点查询）
+    final_path = (RoutePath*)calloc(1, sizeof(RoutePath));
+    for (int p = 0; p < num_nodes && final_path; p++) {
+        int from = node_ids_to_visit[order[p]];
+        int to = node_ids_to_visit[order[(p + 1) % num_nodes]];
+        RoutePath* leg = routing_engine_query(engine, from, to, &options, control);
+        if (!leg && from != to) { // 在拼接过程中被取消
+            free_route_path(final_path);
+            final_path = NULL;
+            break;
+        }
+        append_path(final_path, leg);
     }
 
+cleanup:
     // 释放所有动态分配的内存
-    for (int i = 0; i < num_nodes; ++i) free(cost_matrix[i]);
+    routing_engine_destroy(owned_engine);
     free(cost_matrix);
-    for (int i = 0; i < num_subsets; ++i) { free(dp_table[i]); free(path_table[i]); }
-    free(dp_table);
-    free(path_table);
-    free(node_ids);
+    free(order);
+    held_karp_table_destroy(table);
 
     return final_path;
 }
 
 // 顺序路径规划实现
 RoutePath* find_sequential_path(const TrafficNetwork* network, int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight) {
+    return find_sequential_path_ex(network, node_ids_to_visit, num_nodes, time_weight, cost_weight, NULL, NULL);
+}
+
+/**
+ * @brief 并行计算顺序路径各路段时共享的上下文。
+ */
+typedef struct {
+    const TrafficNetwork* network;
+    const int* leg_from;            // 每个去重后路段的起点
+    const int* leg_to;              // 每个去重后路段的终点
+    RoutePath** leg_paths;          // 每个去重后路段的结果
+    int num_legs;                   // 去重后的路段数
+    const RoutingEngine* engine;    // 各线程共享的寻路引擎
+    RouteQueryOptions options;
+    const SolveControl* control;
+    pthread_mutex_t progress_mutex; // 串行化进度回调
+    int completed_legs;             // 已完成的路段数（受 progress_mutex 保护）
+} SequentialLegsContext;
+
+/**
+ * @brief parallel_for 的任务项：计算一个去重后的路段。
+ */
+static void compute_sequential_leg(int index, int worker_id, void* context) {
+    (void)worker_id;
+    SequentialLegsContext* ctx = (SequentialLegsContext*)context;
+    if (solve_control_should_stop(ctx->control)) return;
+
+    ctx->leg_paths[index] = routing_engine_query(ctx->engine, ctx->leg_from[index], ctx->leg_to[index], &ctx->options, ctx->control);
+
+    pthread_mutex_lock(&ctx->progress_mutex);
+    ctx->completed_legs++;
+    solve_control_report_progress(ctx->control, "legs", (double)ctx->completed_legs / ctx->num_legs);
+    pthread_mutex_unlock(&ctx->progress_mutex);
+}
+
+/**
+ * @brief 深拷贝一条路径（包括所有路径段）。
+ * @return RoutePath* 新路径，内存分配失败时返回NULL。
+ */
+static RoutePath* copy_route_path(const RoutePath* source) {
+    RoutePath* copy = (RoutePath*)calloc(1, sizeof(RoutePath));
+    if (!copy) return NULL;
+    *copy = *source;
+    copy->segments_head = NULL;
+
+    PathSegment** tail = &copy->segments_head;
+    for (const PathSegment* seg = source->segments_head; seg; seg = seg->next) {
+        PathSegment* new_seg = (PathSegment*)malloc(sizeof(PathSegment));
+        if (!new_seg) {
+            free_route_path(copy);
+            return NULL;
+        }
+        *new_seg = *seg;
+        new_seg->next = NULL;
+        *tail = new_seg;
+        tail = &new_seg->next;
+    }
+    return copy;
+}
+
+// 可中断的顺序路径规划实现
+RoutePath* find_sequential_path_ex(const TrafficNetwork* network, int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight,
+                                   const RoutingEngine* engine, const SolveControl* control) {
     if (num_nodes < 2) return NULL; 
 
+    int num_requested = num_nodes - 1;
+    int* leg_from = (int*)malloc(num_requested * sizeof(int));
+    int* leg_to = (int*)malloc(num_requested * sizeof(int));
+    int* leg_of_request = (int*)malloc(num_requested * sizeof(int)); // 第i段对应的去重后路段
+    RoutePath** leg_paths = (RoutePath**)calloc(num_requested, sizeof(RoutePath*));
     RoutePath* final_path = (RoutePath*)calloc(1, sizeof(RoutePath));
-    if (!final_path) return NULL;
+    if (!leg_from || !leg_to || !leg_of_request || !leg_paths || !final_path) {
+        free(leg_from);
+        free(leg_to);
+        free(leg_of_request);
+        free(leg_paths);
+        free(final_path);
+        return NULL;
+    }
 
-    // 遍历所有需要连接的路段
-    for (int i = 0; i < num_nodes - 1; i++) {
-        int start_node_id = node_ids_to_visit[i];
-        int end_node_id = node_ids_to_visit[i+1];
+    // 1. 对路段去重：同一个 (起点, 终点) 在行程中出现多次时只计算一次
+    int num_legs = 0;
+    for (int i = 0; i < num_requested; i++) {
+        int from = node_ids_to_visit[i];
+        int to = node_ids_to_visit[i + 1];
+        int found = -1;
+        for (int k = 0; k < num_legs; k++) {
+            if (leg_from[k] == from && leg_to[k] == to) {
+                found = k;
+                break;
+            }
+        }
+        if (found == -1) {
+            found = num_legs++;
+            leg_from[found] = from;
+            leg_to[found] = to;
+        }
+        leg_of_request[i] = found;
+    }
+
+    // 2. 调用者没有提供引擎时按路段数选择，在线程池上并行计算所有去重后的路段
+    RoutingEngine* owned_engine = NULL;
+    if (!engine) {
+        RoutingWorkload workload = { ROUTING_POINT_TO_POINT, num_legs, 0 };
+        engine = owned_engine = routing_engine_create(routing_engine_select(network, &workload), network);
+    }
+    SequentialLegsContext ctx;
+    ctx.network = network;
+    ctx.leg_from = leg_from;
+    ctx.leg_to = leg_to;
+    ctx.leg_paths = leg_paths;
+    ctx.num_legs = num_legs;
+    ctx.engine = engine;
+    ctx.options.time_weight = time_weight;
+    ctx.options.cost_weight = cost_weight;
+    ctx.options.avoid = NULL;
+    ctx.options.allowed_modes = 0;
+    ctx.control = control;
+    ctx.completed_legs = 0;
+    pthread_mutex_init(&ctx.progress_mutex, NULL);
+    if (engine) thread_pool_parallel_for(thread_pool_get_default(), num_legs, compute_sequential_leg, &ctx);
+    pthread_mutex_destroy(&ctx.progress_mutex);
+    routing_engine_destroy(owned_engine);
 
-        // 查找当前路段的最短路径
-        RoutePath* leg_path = find_shortest_path(network, start_node_id, end_node_id, time_weight, cost_weight);
+    // 3. 按请求顺序拼接各路段
+    // 已被取消：静默放弃，由调用者通过令牌区分取消与无解
+    bool failed = !engine || solve_control_should_stop(control);
+    PathSegment** tail = &final_path->segments_head;
+    for (int i = 0; i < num_requested && !failed; i++) {
+        const RoutePath* leg_path = leg_paths[leg_of_request[i]];
 
         // 如果任何一段路径无法找到，则整个规划失败
         if (!leg_path || !leg_path->segments_head) {
-            const Node* start_node = traffic_network_get_node_by_id(network, start_node_id);
-            const Node* end_node = traffic_network_get_node_by_id(network, end_node_id);
+            const Node* start_node = traffic_network_get_node_by_id(network, node_ids_to_visit[i]);
+            const Node* end_node = traffic_network_get_node_by_id(network, node_ids_to_visit[i + 1]);
             fprintf(stderr, "错误: 无法找到从 %s 到 %s 的路径。\n", start_node ? start_node->name : "未知", end_node ? end_node->name : "未知");
-            free_route_path(final_path);
-            free_route_path(leg_path);
-            return NULL;
+            failed = true;
+            break;
         }
 
-        // 简单地将找到的路段拼接到最终路径的尾部
-        // 注意：这里的实现比 stitch_paths 简单，但对于顺序拼接是足够的
-        PathSegment* tail = final_path->segments_head;
-        if (!tail) {
-            final_path->segments_head = leg_path->segments_head;
-        } else {
-            while (tail->next) tail = tail->next;
-            tail->next = leg_path->segments_head;
+        // 重复出现的路段需要拷贝一份，保证最终路径中的每个路径段都是独立分配的
+        RoutePath* copy = copy_route_path(leg_path);
+        if (!copy) {
+            failed = true;
+            break;
         }
-        
+
+        // 将路段拼接到最终路径的尾部
+        *tail = copy->segments_head;
+        while (*tail) tail = &(*tail)->next;
+
         // 累加总计
-        final_path->segment_count += leg_path->segment_count;
-        final_path->total_cost += leg_path->total_cost;
-        final_path->total_distance += leg_path->total_distance;
-        final_path->total_time += leg_path->total_time;
+        final_path->segment_count += copy->segment_count;
+        final_path->total_cost += copy->total_cost;
+        final_path->total_distance += copy->total_distance;
+        final_path->total_time += copy->total_time;
 
-        leg_path->segments_head = NULL;
-        free_route_path(leg_path);
+        copy->segments_head = NULL;
+        free_route_path(copy);
     }
 
+    for (int k = 0; k < num_legs; k++) free_route_path(leg_paths[k]);
+    free(leg_paths);
+    free(leg_from);
+    free(leg_to);
+    free(leg_of_request);
+    if (failed) {
+        free_route_path(final_path);
+        return NULL;
+    }
     return final_path;
-} 
\ No newline at end of file
+}
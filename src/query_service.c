@@ -0,0 +1,567 @@
+/**
+ * @file query_service.c
+ * @brief 实现了查询层：URL参数解析、节点名称解析、寻路调用与JSON序列化。
+ */
+#include "query_service.h"
+#include "pathfinding.h"
+#include "routing_engine.h"
+#include "solve_control.h"
+#include "tsp_bnb.h"
+#include "utils.h"
+#include <float.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 顺序路径和成本矩阵请求的最大节点数
+#define QUERY_MAX_NODES 64
+
+// TSP请求的最大节点数；超过 TSP_BNB_MAX_NODES 时分层求解，不保证最优
+#define QUERY_MAX_TSP_NODES 1024
+
+// 单个参数值解码后的最大长度
+#define QUERY_MAX_VALUE 4096
+
+/**
+ * @brief 一次正在进行的路线计算。条件相同的并发请求等待同一次计算，共享其结果。
+ */
+typedef struct RouteFlight {
+    int from;
+    int to;
+    double time_weight;
+    double cost_weight;
+    TransportModeMask allowed_modes;
+    unsigned long version;      // 计算时的网络版本号
+    int refs;                   // 领头请求和等待者的数目，最后一个离开的负责释放
+    bool done;
+    int status;                 // 完成后：HTTP状态码
+    char* body;                 // 完成后不再修改的响应体，NULL表示领头请求内存不足
+    size_t length;
+    struct RouteFlight* next;
+} RouteFlight;
+
+struct QueryService {
+    const TrafficNetwork* network;
+    RoutingEngine* engine;      // 服务期间所有点到点和一对多查询共用的寻路引擎
+    double timeout_ms;
+
+    pthread_mutex_t flight_mutex; // 保护下面三个字段
+    pthread_cond_t flight_cond;   // 任一计算完成时广播
+    RouteFlight* flights;         // 尚未完成的路线计算
+    unsigned long coalesced;      // 直接共享了其他请求结果的请求数
+};
+
+/**
+ * @brief 自动增长的文本缓冲区，用于拼接JSON。
+ */
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    bool failed;                // 内存分配失败后不再追加
+} TextBuffer;
+
+static void text_reserve(TextBuffer* text, size_t extra) {
+    if (text->failed || text->length + extra + 1 <= text->capacity) return;
+    size_t capacity = text->capacity ? text->capacity : 256;
+    while (capacity < text->length + extra + 1) capacity *= 2;
+    char* data = (char*)realloc(text->data, capacity);
+    if (!data) {
+        text->failed = true;
+        return;
+    }
+    text->data = data;
+    text->capacity = capacity;
+}
+
+static void text_append(TextBuffer* text, const char* s, size_t n) {
+    text_reserve(text, n);
+    if (text->failed) return;
+    memcpy(text->data + text->length, s, n);
+    text->length += n;
+    text->data[text->length] = '\0';
+}
+
+static void text_printf(TextBuffer* text, const char* format, ...) {
+    char small[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (n < 0) return;
+    if ((size_t)n < sizeof(small)) {
+        text_append(text, small, n);
+        return;
+    }
+    text_reserve(text, n);
+    if (text->failed) return;
+    va_start(args, format);
+    vsnprintf(text->data + text->length, n + 1, format, args);
+    va_end(args);
+    text->length += n;
+}
+
+/**
+ * @brief 追加一个JSON字符串（带引号，转义引号、反斜杠和控制字符）。
+ */
+static void text_json_string(TextBuffer* text, const char* s) {
+    text_append(text, "\"", 1);
+    for (const unsigned char* p = (const unsigned char*)s; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            char escaped[2] = { '\\', (char)*p };
+            text_append(text, escaped, 2);
+        } else if (*p < 0x20) {
+            text_printf(text, "\\u%04x", *p);
+        } else {
+            text_append(text, (const char*)p, 1);
+        }
+    }
+    text_append(text, "\"", 1);
+}
+
+/**
+ * @brief 输出错误响应体，返回状态码本身以便直接 return。
+ */
+static int error_response(TextBuffer* text, int status, const char* message) {
+    text->length = 0;
+    text_append(text, "{\"error\":", 9);
+    text_json_string(text, message);
+    text_append(text, "}", 1);
+    return status;
+}
+
+// --- 参数解析 ---
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief URL解码 [begin, end) 到 out（'+' 表示空格）。
+ * @return bool 结果超过 size-1 字节或编码无效时返回false。
+ */
+static bool url_decode(const char* begin, const char* end, char* out, size_t size) {
+    size_t n = 0;
+    for (const char* p = begin; p < end; p++) {
+        if (n + 1 >= size) return false;
+        if (*p == '+') {
+            out[n++] = ' ';
+        } else if (*p == '%') {
+            if (end - p < 3 || hex_value(p[1]) < 0 || hex_value(p[2]) < 0) return false;
+            out[n++] = (char)(hex_value(p[1]) * 16 + hex_value(p[2]));
+            p += 2;
+        } else {
+            out[n++] = *p;
+        }
+    }
+    out[n] = '\0';
+    return true;
+}
+
+/**
+ * @brief 查找参数 key 的值并解码到 out。
+ * @return int 找到返回1，不存在返回0，值无效或过长返回-1。
+ */
+static int param_get(const char* params, const char* key, char* out, size_t size) {
+    size_t key_length = strlen(key);
+    for (const char* p = params; p && *p;) {
+        const char* end = strchr(p, '&');
+        if (!end) end = p + strlen(p);
+        const char* eq = memchr(p, '=', end - p);
+        const char* name_end = eq ? eq : end;
+        if ((size_t)(name_end - p) == key_length && memcmp(p, key, key_length) == 0) {
+            if (!eq) {
+                out[0] = '\0';
+                return 1;
+            }
+            return url_decode(eq + 1, end, out, size) ? 1 : -1;
+        }
+        p = *end ? end + 1 : end;
+    }
+    return 0;
+}
+
+/**
+ * @brief 读取一个数值参数，不存在时使用默认值。
+ * @return bool 值不是合法的数字时返回false。
+ */
+static bool param_get_double(const char* params, const char* key, double default_value, double* out) {
+    char value[64];
+    int found = param_get(params, key, value, sizeof(value));
+    if (found == 0) {
+        *out = default_value;
+        return true;
+    }
+    if (found < 0 || value[0] == '\0') return false;
+    char* end;
+    *out = strtod(value, &end);
+    return *end == '\0';
+}
+
+/**
+ * @brief 把名称或ID解析为节点ID：先按名称查找，找不到且全是数字时按ID解释。
+ */
+static int resolve_node(const TrafficNetwork* network, const char* name) {
+    int id = traffic_network_find_node_id_by_name(network, name);
+    if (id >= 0 || name[0] == '\0' || strspn(name, "0123456789") != strlen(name) || strlen(name) > 9) return id;
+    id = atoi(name);
+    return id < traffic_network_get_node_count(network) ? id : -1;
+}
+
+/**
+ * @brief 解析逗号分隔的节点列表。
+ * @return int 节点数；出错时输出错误响应并返回负的状态码。
+ */
+static int parse_node_list(const TrafficNetwork* network, const char* params, int* ids, int max_nodes, TextBuffer* text) {
+    char value[QUERY_MAX_VALUE];
+    int found = param_get(params, "nodes", value, sizeof(value));
+    if (found <= 0) return -error_response(text, 400, "缺少参数 nodes");
+    int count = 0;
+    for (char* name = value; name;) {
+        char* comma = strchr(name, ',');
+        if (comma) *comma = '\0';
+        if (count >= max_nodes) return -error_response(text, 400, "节点数超过上限");
+        ids[count] = resolve_node(network, name);
+        if (ids[count] < 0) {
+            char message[QUERY_MAX_VALUE + 32];
+            snprintf(message, sizeof(message), "未找到地标: %s", name);
+            return -error_response(text, 400, message);
+        }
+        count++;
+        name = comma ? comma + 1 : NULL;
+    }
+    return count;
+}
+
+/**
+ * @brief 解析权重参数（默认各0.5）和可选的交通方式限定。
+ * @return int 成功返回0；出错时输出错误响应并返回状态码。
+ */
+static int parse_weights(const char* params, RouteQueryOptions* options, TextBuffer* text) {
+    memset(options, 0, sizeof(*options));
+    if (!param_get_double(params, "time_weight", 0.5, &options->time_weight) ||
+        !param_get_double(params, "cost_weight", 0.5, &options->cost_weight)) {
+        return error_response(text, 400, "权重必须是数字");
+    }
+    char modes[256];
+    int found = param_get(params, "modes", modes, sizeof(modes));
+    if (found < 0 || (found > 0 && !mode_mask_from_string(modes, &options->allowed_modes))) {
+        return error_response(text, 400, "无效的交通方式");
+    }
+    return 0;
+}
+
+// --- 结果序列化 ---
+
+static void write_route(TextBuffer* text, const TrafficNetwork* network, const RoutePath* path) {
+    text_printf(text, "\"total_distance_km\":%.6f,\"total_time_hours\":%.6f,\"total_cost_yuan\":%.2f,\"segments\":[", path->total_distance,
+                path->total_time, path->total_cost);
+    for (const PathSegment* seg = path->segments_head; seg; seg = seg->next) {
+        text_append(text, seg == path->segments_head ? "{\"from\":" : ",{\"from\":", seg == path->segments_head ? 8 : 9);
+        text_json_string(text, traffic_network_get_node_by_id(network, seg->from_node_id)->name);
+        text_append(text, ",\"to\":", 6);
+        text_json_string(text, traffic_network_get_node_by_id(network, seg->to_node_id)->name);
+        text_printf(text, ",\"mode\":\"%s\",\"distance_km\":%.6f,\"time_hours\":%.6f,\"cost_yuan\":%.2f}", mode_to_string(seg->mode),
+                    seg->distance_km, seg->time_hours, seg->cost_yuan);
+    }
+    text_append(text, "]", 1);
+}
+
+/**
+ * @brief 求解失败时区分超时与无解。
+ */
+static int failure_response(TextBuffer* text, const CancelToken* token, const char* message) {
+    if (cancel_token_is_cancelled(token)) return error_response(text, 504, "计算超时");
+    return error_response(text, 404, message);
+}
+
+// --- 相同路线请求的合并 ---
+
+/**
+ * @brief 加入条件相同的进行中计算；没有时登记一个新的计算，由调用者（领头请求）负责完成。
+ * @return RouteFlight* 计算记录，内存不足时返回NULL（调用者独立计算）。
+ */
+static RouteFlight* join_flight(QueryService* service, int from, int to, const RouteQueryOptions* options, bool* is_leader) {
+    unsigned long version = traffic_network_get_version(service->network);
+    pthread_mutex_lock(&service->flight_mutex);
+    RouteFlight* flight = service->flights;
+    while (flight && !(flight->from == from && flight->to == to && flight->time_weight == options->time_weight &&
+                       flight->cost_weight == options->cost_weight && flight->allowed_modes == options->allowed_modes &&
+                       flight->version == version)) {
+        flight = flight->next;
+    }
+    if (flight) {
+        flight->refs++;
+        service->coalesced++;
+        *is_leader = false;
+    } else if ((flight = (RouteFlight*)calloc(1, sizeof(RouteFlight))) != NULL) {
+        flight->from = from;
+        flight->to = to;
+        flight->time_weight = options->time_weight;
+        flight->cost_weight = options->cost_weight;
+        flight->allowed_modes = options->allowed_modes;
+        flight->version = version;
+        flight->refs = 1;
+        flight->next = service->flights;
+        service->flights = flight;
+        *is_leader = true;
+    }
+    pthread_mutex_unlock(&service->flight_mutex);
+    return flight;
+}
+
+/**
+ * @brief 领头请求发布结果：保存响应体的副本，从进行中列表摘除（之后到达的请求重新计算），唤醒等待者。
+ */
+static void complete_flight(QueryService* service, RouteFlight* flight, int status, const TextBuffer* text) {
+    char* body = text->failed ? NULL : (char*)malloc(text->length + 1);
+    if (body) memcpy(body, text->data, text->length + 1);
+    pthread_mutex_lock(&service->flight_mutex);
+    for (RouteFlight** link = &service->flights; *link; link = &(*link)->next) {
+        if (*link == flight) {
+            *link = flight->next;
+            break;
+        }
+    }
+    flight->status = status;
+    flight->body = body;
+    flight->length = body ? text->length : 0;
+    flight->done = true;
+    pthread_cond_broadcast(&service->flight_cond);
+    pthread_mutex_unlock(&service->flight_mutex);
+}
+
+/**
+ * @brief 等待者：等待领头请求完成，把共享的结果复制到自己的响应中。
+ * @details 等待时不单独计时：领头请求受同样的计算时限约束，并且开始得更早。
+ *          但领头请求超时的时候，晚到的等待者自己的时限可能还没到，这时不共享超时结果，由调用者重新计算。
+ * @return int HTTP状态码；返回0表示需要重新计算，响应保持为空。
+ */
+static int await_flight(QueryService* service, RouteFlight* flight, const CancelToken* token, TextBuffer* text) {
+    pthread_mutex_lock(&service->flight_mutex);
+    while (!flight->done) pthread_cond_wait(&service->flight_cond, &service->flight_mutex);
+    pthread_mutex_unlock(&service->flight_mutex);
+    if (flight->status == 504 && !cancel_token_is_cancelled(token)) return 0;
+    // 完成后的结果不再修改，可以在锁外读取
+    if (flight->body) text_append(text, flight->body, flight->length);
+    else text->failed = true;
+    return flight->status;
+}
+
+static void release_flight(QueryService* service, RouteFlight* flight) {
+    pthread_mutex_lock(&service->flight_mutex);
+    bool last = --flight->refs == 0;
+    pthread_mutex_unlock(&service->flight_mutex);
+    if (last) {
+        free(flight->body);
+        free(flight);
+    }
+}
+
+// --- 各请求的处理函数 ---
+
+/**
+ * @brief 计算一条路线并输出响应体。
+ */
+static int compute_route(QueryService* service, int from, int to, const RouteQueryOptions* options, const SolveControl* control,
+                         TextBuffer* text) {
+    RoutePath* path = routing_engine_query(service->engine, from, to, options, control);
+    if (!path) return failure_response(text, control->cancel_token, "无法找到路径");
+    text_append(text, "{\"from\":", 8);
+    text_json_string(text, traffic_network_get_node_by_id(service->network, from)->name);
+    text_append(text, ",\"to\":", 6);
+    text_json_string(text, traffic_network_get_node_by_id(service->network, to)->name);
+    text_append(text, ",", 1);
+    write_route(text, service->network, path);
+    text_append(text, "}", 1);
+    free_route_path(path);
+    return 200;
+}
+
+static int handle_route(QueryService* service, const char* params, const SolveControl* control, TextBuffer* text) {
+    char from_name[QUERY_MAX_VALUE], to_name[QUERY_MAX_VALUE];
+    if (param_get(params, "from", from_name, sizeof(from_name)) <= 0 ||
+        param_get(params, "to", to_name, sizeof(to_name)) <= 0) {
+        return error_response(text, 400, "缺少参数 from 或 to");
+    }
+    RouteQueryOptions options;
+    int status = parse_weights(params, &options, text);
+    if (status != 0) return status;
+    int from = resolve_node(service->network, from_name);
+    int to = resolve_node(service->network, to_name);
+    if (from < 0 || to < 0) return error_response(text, 400, "未找到地标");
+
+    // 高峰时大量客户端几乎同时查询同一条路线：只计算一次，其余请求等待并共享结果。
+    // 领头请求超时而本请求还有剩余时间时重新加入：同时重试的等待者仍然合并为一次计算
+    do {
+        bool is_leader = false;
+        RouteFlight* flight = join_flight(service, from, to, &options, &is_leader);
+        if (!flight) return compute_route(service, from, to, &options, control, text);
+        if (is_leader) {
+            status = compute_route(service, from, to, &options, control, text);
+            complete_flight(service, flight, status, text);
+        } else {
+            status = await_flight(service, flight, control->cancel_token, text);
+        }
+        release_flight(service, flight);
+    } while (status == 0);
+    return status;
+}
+
+static int handle_tsp(QueryService* service, const char* params, const SolveControl* control, TextBuffer* text) {
+    int* ids = (int*)malloc(QUERY_MAX_TSP_NODES * sizeof(int));
+    if (!ids) return error_response(text, 500, "内存不足");
+    int count = parse_node_list(service->network, params, ids, QUERY_MAX_TSP_NODES, text);
+    RouteQueryOptions options;
+    double time_limit_ms;
+    int status = 0;
+    if (count < 0) {
+        status = -count;
+    } else if (count < 2) {
+        status = error_response(text, 400, "TSP需要至少2个地标");
+    } else if ((status = parse_weights(params, &options, text)) == 0 &&
+               !param_get_double(params, "time_limit_ms", TSP_BNB_DEFAULT_TIME_LIMIT_MS, &time_limit_ms)) {
+        status = error_response(text, 400, "time_limit_ms 必须是数字");
+    }
+    if (status != 0) {
+        free(ids);
+        return status;
+    }
+
+    bool is_optimal = false;
+    RoutePath* path = solve_tsp_exact(service->network, ids, count, options.time_weight, options.cost_weight, time_limit_ms, &is_optimal,
+                                      service->engine, control);
+    free(ids);
+    if (!path) return failure_response(text, control->cancel_token, "无法找到TSP路径");
+    text_printf(text, "{\"optimal\":%s,", is_optimal ? "true" : "false");
+    write_route(text, service->network, path);
+    text_append(text, "}", 1);
+    free_route_path(path);
+    return 200;
+}
+
+static int handle_sequential(QueryService* service, const char* params, const SolveControl* control, TextBuffer* text) {
+    int ids[QUERY_MAX_NODES];
+    int count = parse_node_list(service->network, params, ids, QUERY_MAX_NODES, text);
+    if (count < 0) return -count;
+    if (count < 2) return error_response(text, 400, "顺序路径规划需要至少2个地标");
+    RouteQueryOptions options;
+    int status = parse_weights(params, &options, text);
+    if (status != 0) return status;
+
+    RoutePath* path = find_sequential_path_ex(service->network, ids, count, options.time_weight, options.cost_weight, service->engine,
+                                              control);
+    if (!path) return failure_response(text, control->cancel_token, "无法找到顺序路径");
+    text_append(text, "{", 1);
+    write_route(text, service->network, path);
+    text_append(text, "}", 1);
+    free_route_path(path);
+    return 200;
+}
+
+static int handle_matrix(QueryService* service, const char* params, const SolveControl* control, TextBuffer* text) {
+    int ids[QUERY_MAX_NODES];
+    int count = parse_node_list(service->network, params, ids, QUERY_MAX_NODES, text);
+    if (count < 0) return -count;
+    RouteQueryOptions options;
+    int status = parse_weights(params, &options, text);
+    if (status != 0) return status;
+
+    double row[QUERY_MAX_NODES];
+    text_append(text, "{\"nodes\":[", 10);
+    for (int i = 0; i < count; i++) {
+        if (i > 0) text_append(text, ",", 1);
+        text_json_string(text, traffic_network_get_node_by_id(service->network, ids[i])->name);
+    }
+    text_append(text, "],\"costs\":[", 11);
+    for (int i = 0; i < count; i++) {
+        if (!routing_engine_one_to_many(service->engine, ids[i], ids, count, &options, control, row)) {
+            return failure_response(text, control->cancel_token, "无法计算成本矩阵");
+        }
+        text_append(text, i > 0 ? ",[" : "[", i > 0 ? 2 : 1);
+        for (int j = 0; j < count; j++) {
+            if (j > 0) text_append(text, ",", 1);
+            if (row[j] == DBL_MAX) text_append(text, "null", 4);
+            else text_printf(text, "%.9g", row[j]);
+        }
+        text_append(text, "]", 1);
+    }
+    text_append(text, "]}", 2);
+    return 200;
+}
+
+// --- 公共接口 ---
+
+QueryService* query_service_create(const TrafficNetwork* network, double timeout_ms) {
+    if (!network) return NULL;
+    QueryService* service = (QueryService*)calloc(1, sizeof(QueryService));
+    if (!service) return NULL;
+    service->network = network;
+    service->timeout_ms = timeout_ms > 0 ? timeout_ms : QUERY_SERVICE_DEFAULT_TIMEOUT_MS;
+    pthread_mutex_init(&service->flight_mutex, NULL);
+    pthread_cond_init(&service->flight_cond, NULL);
+
+    // 服务会处理大量查询，预处理一次的开销可以忽略
+    RoutingWorkload workload = { ROUTING_POINT_TO_POINT, 1 << 20, 0 };
+    service->engine = routing_engine_create(routing_engine_select(network, &workload), network);
+    if (!service->engine) {
+        query_service_destroy(service);
+        return NULL;
+    }
+    return service;
+}
+
+int query_service_handle(QueryService* service, const char* path, const char* params, char** out_json, size_t* out_length) {
+    TextBuffer text = { NULL, 0, 0, false };
+    CancelToken token;
+    cancel_token_init(&token);
+    cancel_token_set_deadline(&token, service->timeout_ms);
+    SolveControl control = { &token, NULL, NULL };
+
+    int status;
+    if (strcmp(path, "/route") == 0) {
+        status = handle_route(service, params, &control, &text);
+    } else if (strcmp(path, "/tsp") == 0) {
+        status = handle_tsp(service, params, &control, &text);
+    } else if (strcmp(path, "/sequential") == 0) {
+        status = handle_sequential(service, params, &control, &text);
+    } else if (strcmp(path, "/matrix") == 0) {
+        status = handle_matrix(service, params, &control, &text);
+    } else if (strcmp(path, "/health") == 0) {
+        pthread_mutex_lock(&service->flight_mutex);
+        unsigned long coalesced = service->coalesced;
+        pthread_mutex_unlock(&service->flight_mutex);
+        text_printf(&text, "{\"status\":\"ok\",\"nodes\":%d,\"engine\":\"%s\",\"coalesced\":%lu}",
+                    traffic_network_get_node_count(service->network), routing_engine_get_name(service->engine), coalesced);
+        status = 200;
+    } else {
+        status = error_response(&text, 404, "未知的请求路径");
+    }
+
+    if (text.failed) {
+        free(text.data);
+        *out_json = NULL;
+        *out_length = 0;
+        return 500;
+    }
+    *out_json = text.data;
+    *out_length = text.length;
+    return status;
+}
+
+const RoutingEngine* query_service_get_engine(const QueryService* service) {
+    return service ? service->engine : NULL;
+}
+
+void query_service_destroy(QueryService* service) {
+    if (!service) return;
+    routing_engine_destroy(service->engine);
+    pthread_mutex_destroy(&service->flight_mutex);
+    pthread_cond_destroy(&service->flight_cond);
+    free(service);
+}
@@ -0,0 +1,513 @@
+/**
+ * @file reliability.c
+ * @brief 实现了基于蒙特卡洛抽样的出行时间可靠性分析。
+ */
+#include "reliability.h"
+#include "csr_engine.h"
+#include "pathfinding.h"
+#include "thread_pool.h"
+#include "utils.h"
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 分位数表的大小：路段扰动由随机数的高10位直接查表得到
+#define QUANTILE_BITS 10
+#define QUANTILE_TABLE_SIZE (1 << QUANTILE_BITS)
+// 每个并行任务处理的样本数
+#define SAMPLES_PER_TASK 64
+// splitmix64 的步长
+#define GOLDEN_GAMMA 0x9E3779B97F4A7C15ULL
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/**
+ * @brief 所有样本共享的预处理数据。路段使用压缩邻接表（见 csr_engine.h）的编号。
+ */
+typedef struct {
+    const TrafficNetwork* network;
+    const ReliabilityOptions* options;
+    const SolveControl* control;
+    int node_count;
+    int start;
+    int end;
+
+    CsrLinkTable* links;        // 可用路段；link_hours、link_yuan 为未扰动的用时（含交通事件减速）和花费
+    TransportMode modes[TRANSPORT_MODE_COUNT]; // 允许的交通方式
+    int mode_count;
+    bool use_heap;              // 开放集使用二叉堆还是线性扫描
+    double time_coefficient;    // 加权成本 = 用时 × time_coefficient + 花费 × money_coefficient
+    double money_coefficient;
+
+    double link_factor_table[TRANSPORT_MODE_COUNT][QUANTILE_TABLE_SIZE]; // 路段时间倍数的分位数
+    double delay_table[TRANSPORT_MODE_COUNT][QUANTILE_TABLE_SIZE];       // 延误时长的分位数
+
+    // 每个样本的结果
+    double* sample_time;        // 不可达时为-1
+    double* sample_money;
+    uint64_t* route_hash;
+
+    int worker_count;
+    struct SampleWorkspace* workspaces;
+    pthread_mutex_t progress_mutex; // 串行化进度回调
+    int completed_tasks;            // 已完成的任务数（受 progress_mutex 保护）
+    int task_count;
+} ReliabilityContext;
+
+/**
+ * @brief 每个工作线程复用的寻路工作区。
+ */
+typedef struct SampleWorkspace {
+    double* dist;               // 加权成本
+    double* hours;              // 扰动后的累计用时
+    double* money;              // 扰动后的累计花费
+    int* pred_link;             // 到达该节点所用的路段，-1表示没有
+    int* pred_node;
+    char* settled;
+    CsrOpenSet open;            // 以 dist 为键的开放集
+    int* route;                 // 回溯路线用的缓冲区
+} SampleWorkspace;
+
+/**
+ * @brief splitmix64 的混合函数。
+ */
+static uint64_t mix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief 计数器式随机数：同一个 (key, index) 总是得到同一个值，因此样本之间、线程之间互不依赖。
+ */
+static uint64_t stream_random(uint64_t key, uint64_t index) {
+    return mix64(key + (index + 1) * GOLDEN_GAMMA);
+}
+
+/**
+ * @brief 把64位随机数转换为 (0, 1) 内的均匀分布。
+ */
+static double to_unit(uint64_t bits) {
+    return ((double)(bits >> 11) + 0.5) / 9007199254740992.0;
+}
+
+/**
+ * @brief 均值为1的对数正态倍数 exp(σz - σ²/2)。
+ */
+static double lognormal_factor(double sigma, double z) {
+    return exp(sigma * z - 0.5 * sigma * sigma);
+}
+
+/**
+ * @brief 标准正态分布的分位数，对 Φ(z) = p 二分求解。
+ */
+static double normal_quantile(double p) {
+    double lo = -10.0, hi = 10.0;
+    for (int i = 0; i < 64; i++) {
+        double mid = 0.5 * (lo + hi);
+        if (0.5 * erfc(-mid / sqrt(2.0)) < p) lo = mid;
+        else hi = mid;
+    }
+    return 0.5 * (lo + hi);
+}
+
+/**
+ * @brief 构建分位数表：路段时间倍数（对数正态）和延误时长（以一定概率发生的指数分布）。
+ */
+static void build_quantile_tables(ReliabilityContext* ctx) {
+    for (int i = 0; i < QUANTILE_TABLE_SIZE; i++) {
+        double q = (i + 0.5) / QUANTILE_TABLE_SIZE;
+        double z = normal_quantile(q);
+        for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+            const ModeUncertainty* u = &ctx->options->uncertainty[m];
+            ctx->link_factor_table[m][i] = lognormal_factor(u->link_time_sigma, z);
+            double p = u->delay_probability;
+            ctx->delay_table[m][i] = (p > 0 && q > 1.0 - p) ? -u->mean_delay_hours * log((1.0 - q) / p) : 0.0;
+        }
+    }
+}
+
+/**
+ * @brief 构建可用路段表：使用寻路引擎共享的压缩邻接表，搜索时只访问允许的交通方式所在的行。
+ */
+static bool build_links(ReliabilityContext* ctx) {
+    ctx->links = csr_link_table_build(ctx->network);
+    if (!ctx->links) return false;
+    ctx->mode_count = mode_mask_expand(ctx->options->allowed_modes, ctx->modes);
+    ctx->use_heap = csr_link_table_prefers_heap(ctx->links, ctx->options->allowed_modes);
+    return true;
+}
+
+/**
+ * @brief 求解一个样本的最短路径。
+ *
+ * @param sample 样本序号；为-1时不加扰动。
+ * @return bool 终点可达返回true，结果留在工作区中。
+ */
+static bool solve_sample(const ReliabilityContext* ctx, SampleWorkspace* ws, int sample) {
+    int n = ctx->node_count;
+    const ReliabilityOptions* options = ctx->options;
+    const CsrLinkTable* links = ctx->links;
+    uint64_t key = mix64(options->seed + (uint64_t)(sample + 1) * GOLDEN_GAMMA);
+
+    // 每种交通方式的整体倍数（Box-Muller 变换得到两个独立的正态变量）
+    double mode_time[TRANSPORT_MODE_COUNT], mode_money[TRANSPORT_MODE_COUNT];
+    for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+        mode_time[m] = 1.0;
+        mode_money[m] = 1.0;
+        if (sample < 0) continue;
+        double r = sqrt(-2.0 * log(to_unit(stream_random(key, (uint64_t)links->link_count + 2 * m))));
+        double theta = 2.0 * M_PI * to_unit(stream_random(key, (uint64_t)links->link_count + 2 * m + 1));
+        mode_time[m] = lognormal_factor(options->uncertainty[m].time_sigma, r * cos(theta));
+        mode_money[m] = lognormal_factor(options->uncertainty[m].cost_sigma, r * sin(theta));
+    }
+
+    for (int i = 0; i < n; i++) {
+        ws->dist[i] = DBL_MAX;
+        ws->pred_link[i] = -1;
+        ws->settled[i] = 0;
+    }
+    csr_open_set_clear(&ws->open);
+    ws->dist[ctx->start] = 0.0;
+    ws->hours[ctx->start] = 0.0;
+    ws->money[ctx->start] = 0.0;
+    csr_open_set_push(&ws->open, ctx->start);
+
+    // 压缩邻接表上的 Dijkstra，终点出队即停止
+    for (;;) {
+        int u = csr_open_set_pop(&ws->open);
+        if (u == -1) return false;
+        if (u == ctx->end) return true;
+        ws->settled[u] = 1;
+
+        for (int i = 0; i < ctx->mode_count; i++) {
+            TransportMode m = ctx->modes[i];
+            int row = u * TRANSPORT_MODE_COUNT + m;
+            for (int k = links->row_start[row]; k < links->row_start[row + 1]; k++) {
+                int v = links->link_to[k];
+                if (ws->settled[v]) continue;
+                double hours = links->link_hours[k] * mode_time[m];
+                if (sample >= 0) {
+                    uint64_t bits = stream_random(key, (uint64_t)k);
+                    hours = hours * ctx->link_factor_table[m][bits >> (64 - QUANTILE_BITS)] +
+                            ctx->delay_table[m][(bits >> (64 - 2 * QUANTILE_BITS)) & (QUANTILE_TABLE_SIZE - 1)];
+                }
+                double money = links->link_yuan[k] * mode_money[m];
+                double d = ws->dist[u] + hours * ctx->time_coefficient + money * ctx->money_coefficient;
+                if (d < ws->dist[v]) {
+                    ws->dist[v] = d;
+                    ws->hours[v] = ws->hours[u] + hours;
+                    ws->money[v] = ws->money[u] + money;
+                    ws->pred_link[v] = k;
+                    ws->pred_node[v] = u;
+                    csr_open_set_push(&ws->open, v);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief 工作区中到达节点 v 所用路段的交通方式。
+ */
+static TransportMode pred_mode(const ReliabilityContext* ctx, const SampleWorkspace* ws, int v) {
+    return csr_link_table_get_mode(ctx->links, ws->pred_node[v], ws->pred_link[v]);
+}
+
+/**
+ * @brief 沿前驱回溯工作区中的路线，写入 ws->route（从终点到起点），返回节点数。
+ */
+static int trace_route(const ReliabilityContext* ctx, const SampleWorkspace* ws) {
+    int count = 0;
+    for (int v = ctx->end; v != ctx->start; v = ws->pred_node[v]) ws->route[count++] = v;
+    ws->route[count++] = ctx->start;
+    return count;
+}
+
+/**
+ * @brief 路线的 FNV-1a 哈希，同时区分途经节点和每段的交通方式。
+ */
+static uint64_t hash_route(const ReliabilityContext* ctx, const SampleWorkspace* ws, int count) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (int i = 0; i < count; i++) {
+        int v = ws->route[i];
+        uint64_t step = (uint64_t)v * TRANSPORT_MODE_COUNT + (i + 1 < count ? (uint64_t)pred_mode(ctx, ws, v) : 0);
+        h = (h ^ step) * 0x100000001B3ULL;
+    }
+    return h;
+}
+
+/**
+ * @brief parallel_for 的任务项：求解一批连续的样本。
+ */
+static void run_sample_batch(int index, int worker_id, void* context) {
+    ReliabilityContext* ctx = (ReliabilityContext*)context;
+    if (solve_control_should_stop(ctx->control)) return;
+    SampleWorkspace* ws = &ctx->workspaces[worker_id];
+
+    int first = index * SAMPLES_PER_TASK;
+    int last = first + SAMPLES_PER_TASK;
+    if (last > ctx->options->sample_count) last = ctx->options->sample_count;
+    for (int s = first; s < last; s++) {
+        if (!solve_sample(ctx, ws, s)) {
+            ctx->sample_time[s] = -1.0;
+            continue;
+        }
+        ctx->sample_time[s] = ws->hours[ctx->end];
+        ctx->sample_money[s] = ws->money[ctx->end];
+        ctx->route_hash[s] = hash_route(ctx, ws, trace_route(ctx, ws));
+    }
+
+    pthread_mutex_lock(&ctx->progress_mutex);
+    ctx->completed_tasks++;
+    solve_control_report_progress(ctx->control, "sampling", (double)ctx->completed_tasks / ctx->task_count);
+    pthread_mutex_unlock(&ctx->progress_mutex);
+}
+
+static bool workspace_init(SampleWorkspace* ws, int n, bool use_heap) {
+    ws->dist = (double*)malloc(n * sizeof(double));
+    ws->hours = (double*)malloc(n * sizeof(double));
+    ws->money = (double*)malloc(n * sizeof(double));
+    ws->pred_link = (int*)malloc(n * sizeof(int));
+    ws->pred_node = (int*)malloc(n * sizeof(int));
+    ws->settled = (char*)malloc(n);
+    ws->route = (int*)malloc(n * sizeof(int));
+    bool open_ok = csr_open_set_init(&ws->open, n, ws->dist, use_heap);
+    return ws->dist && ws->hours && ws->money && ws->pred_link && ws->pred_node && ws->settled && ws->route && open_ok;
+}
+
+static void workspace_free(SampleWorkspace* ws) {
+    free(ws->dist);
+    free(ws->hours);
+    free(ws->money);
+    free(ws->pred_link);
+    free(ws->pred_node);
+    free(ws->settled);
+    free(ws->route);
+    csr_open_set_free(&ws->open);
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief 一个可达样本及其路线哈希，用于把同一路线的样本排在一起。
+ */
+typedef struct {
+    uint64_t route_hash;
+    int sample;
+} SampleRef;
+
+/**
+ * @brief 按 (路线哈希, 样本序号) 排序，使同一路线的样本相邻、且首个样本确定。
+ */
+static int compare_samples_by_route(const void* a, const void* b) {
+    const SampleRef* x = (const SampleRef*)a;
+    const SampleRef* y = (const SampleRef*)b;
+    if (x->route_hash != y->route_hash) return x->route_hash < y->route_hash ? -1 : 1;
+    return (x->sample > y->sample) - (x->sample < y->sample);
+}
+
+static int compare_routes(const void* a, const void* b) {
+    const ReliabilityRoute* x = (const ReliabilityRoute*)a;
+    const ReliabilityRoute* y = (const ReliabilityRoute*)b;
+    if (x->optimal_count != y->optimal_count) return y->optimal_count - x->optimal_count;
+    return (x->mean_time_hours > y->mean_time_hours) - (x->mean_time_hours < y->mean_time_hours);
+}
+
+/**
+ * @brief 汇总每条路线的出现次数和平均值。路线的节点序列通过重新求解它的第一个样本得到。
+ */
+static bool collect_routes(ReliabilityContext* ctx, ReliabilityResult* result, SampleRef* order) {
+    qsort(order, result->reachable_count, sizeof(SampleRef), compare_samples_by_route);
+
+    int distinct = 0;
+    for (int i = 0; i < result->reachable_count; i++) {
+        if (i == 0 || order[i].route_hash != order[i - 1].route_hash) distinct++;
+    }
+    result->routes = (ReliabilityRoute*)calloc(distinct + 1, sizeof(ReliabilityRoute));
+    if (!result->routes) return false;
+
+    SampleWorkspace* ws = &ctx->workspaces[0];
+    for (int i = 0; i < result->reachable_count;) {
+        int j = i;
+        ReliabilityRoute* route = &result->routes[result->route_count++];
+        while (j < result->reachable_count && order[j].route_hash == order[i].route_hash) {
+            route->mean_time_hours += ctx->sample_time[order[j].sample];
+            route->mean_cost_yuan += ctx->sample_money[order[j].sample];
+            j++;
+        }
+        route->optimal_count = j - i;
+        route->mean_time_hours /= route->optimal_count;
+        route->mean_cost_yuan /= route->optimal_count;
+
+        solve_sample(ctx, ws, order[i].sample);
+        int count = trace_route(ctx, ws);
+        route->node_ids = (int*)malloc(count * sizeof(int));
+        route->modes = (TransportMode*)malloc(count * sizeof(TransportMode));
+        if (!route->node_ids || !route->modes) return false;
+        route->node_count = count;
+        for (int k = 0; k < count; k++) {
+            int v = ws->route[count - 1 - k];
+            route->node_ids[k] = v;
+            if (k > 0) route->modes[k - 1] = pred_mode(ctx, ws, v);
+        }
+        i = j;
+    }
+    qsort(result->routes, result->route_count, sizeof(ReliabilityRoute), compare_routes);
+    return true;
+}
+
+void reliability_default_options(ReliabilityOptions* options) {
+    if (!options) return;
+    memset(options, 0, sizeof(*options));
+    options->time_weight = 1.0;
+    options->cost_weight = 0.0;
+    options->sample_count = 1000;
+    options->seed = 20240601;
+    options->allowed_modes = TRANSPORT_MODE_ALL;
+    options->uncertainty[DRIVING] = (ModeUncertainty){0.15, 0.10, 0.05, 0.0, 0.0};
+    options->uncertainty[HIGH_SPEED_RAIL] = (ModeUncertainty){0.03, 0.02, 0.0, 0.05, 0.3};
+    options->uncertainty[FLIGHT] = (ModeUncertainty){0.05, 0.05, 0.25, 0.25, 1.0};
+    options->uncertainty[BUS] = (ModeUncertainty){0.20, 0.10, 0.02, 0.05, 0.5};
+}
+
+// 可靠性分析的实现
+ReliabilityResult* analyze_route_reliability(const TrafficNetwork* network, int start_node_id, int end_node_id,
+                                             const ReliabilityOptions* options, const SolveControl* control) {
+    if (!network) return NULL;
+    int n = traffic_network_get_node_count(network);
+    if (start_node_id < 0 || start_node_id >= n || end_node_id < 0 || end_node_id >= n || start_node_id == end_node_id) {
+        fprintf(stderr, "错误: 可靠性分析的起点或终点无效。\n");
+        return NULL;
+    }
+    ReliabilityOptions defaults;
+    if (!options) {
+        reliability_default_options(&defaults);
+        options = &defaults;
+    }
+    if (options->sample_count <= 0) {
+        fprintf(stderr, "错误: 可靠性分析的样本数必须大于0。\n");
+        return NULL;
+    }
+    for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+        const ModeUncertainty* u = &options->uncertainty[m];
+        if (u->time_sigma < 0 || u->link_time_sigma < 0 || u->cost_sigma < 0 || u->delay_probability < 0 ||
+            u->delay_probability > 1 || u->mean_delay_hours < 0) {
+            fprintf(stderr, "错误: 可靠性分析的不确定性参数无效。\n");
+            return NULL;
+        }
+    }
+
+    ReliabilityContext* ctx = (ReliabilityContext*)calloc(1, sizeof(ReliabilityContext));
+    ReliabilityResult* result = (ReliabilityResult*)calloc(1, sizeof(ReliabilityResult));
+    SampleRef* order = (SampleRef*)malloc(options->sample_count * sizeof(SampleRef));
+    if (!ctx || !result || !order) {
+        free(ctx);
+        free(result);
+        free(order);
+        return NULL;
+    }
+    ctx->network = network;
+    ctx->options = options;
+    ctx->control = control;
+    ctx->node_count = n;
+    ctx->start = start_node_id;
+    ctx->end = end_node_id;
+    ctx->task_count = (options->sample_count + SAMPLES_PER_TASK - 1) / SAMPLES_PER_TASK;
+    int pool_size = thread_pool_get_size(thread_pool_get_default());
+    ctx->worker_count = pool_size > 0 ? pool_size : 1;
+    pthread_mutex_init(&ctx->progress_mutex, NULL);
+
+    ctx->sample_time = (double*)malloc(options->sample_count * sizeof(double));
+    ctx->sample_money = (double*)malloc(options->sample_count * sizeof(double));
+    ctx->route_hash = (uint64_t*)malloc(options->sample_count * sizeof(uint64_t));
+    ctx->workspaces = (SampleWorkspace*)calloc(ctx->worker_count, sizeof(SampleWorkspace));
+    bool ok = ctx->sample_time && ctx->sample_money && ctx->route_hash && ctx->workspaces && build_links(ctx);
+    for (int w = 0; ok && w < ctx->worker_count; w++) ok = workspace_init(&ctx->workspaces[w], n, ctx->use_heap);
+    if (!ok) goto fail;
+    build_quantile_tables(ctx);
+    // 加权成本对用时和花费是线性的，预先求出系数，避免在最内层循环里调用
+    ctx->time_coefficient = calculate_weighted_leg_cost(1.0, 0.0, options->time_weight, options->cost_weight);
+    ctx->money_coefficient = calculate_weighted_leg_cost(0.0, 1.0, options->time_weight, options->cost_weight);
+
+    // 不加扰动的基准路线
+    result->sample_count = options->sample_count;
+    result->baseline_time_hours = solve_sample(ctx, &ctx->workspaces[0], -1) ? ctx->workspaces[0].hours[end_node_id] : -1.0;
+
+    thread_pool_parallel_for(thread_pool_get_default(), ctx->task_count, run_sample_batch, ctx);
+    if (solve_control_should_stop(control)) goto fail;
+
+    // 汇总：排序后的用时和花费、平均值、各路线的出现次数
+    result->sample_times = (double*)malloc((options->sample_count + 1) * sizeof(double));
+    result->sample_costs = (double*)malloc((options->sample_count + 1) * sizeof(double));
+    if (!result->sample_times || !result->sample_costs) goto fail;
+    for (int s = 0; s < options->sample_count; s++) {
+        if (ctx->sample_time[s] < 0) {
+            result->unreachable_count++;
+            continue;
+        }
+        int r = result->reachable_count++;
+        order[r].sample = s;
+        order[r].route_hash = ctx->route_hash[s];
+        result->sample_times[r] = ctx->sample_time[s];
+        result->sample_costs[r] = ctx->sample_money[s];
+        result->mean_time_hours += ctx->sample_time[s];
+        result->mean_cost_yuan += ctx->sample_money[s];
+    }
+    if (result->reachable_count > 0) {
+        result->mean_time_hours /= result->reachable_count;
+        result->mean_cost_yuan /= result->reachable_count;
+    }
+    qsort(result->sample_times, result->reachable_count, sizeof(double), compare_doubles);
+    qsort(result->sample_costs, result->reachable_count, sizeof(double), compare_doubles);
+    if (!collect_routes(ctx, result, order)) goto fail;
+    goto cleanup;
+
+fail:
+    free_reliability_result(result);
+    result = NULL;
+
+cleanup:
+    for (int w = 0; ctx->workspaces && w < ctx->worker_count; w++) workspace_free(&ctx->workspaces[w]);
+    free(ctx->workspaces);
+    csr_link_table_free(ctx->links);
+    free(ctx->sample_time);
+    free(ctx->sample_money);
+    free(ctx->route_hash);
+    pthread_mutex_destroy(&ctx->progress_mutex);
+    free(ctx);
+    free(order);
+    return result;
+}
+
+double reliability_time_percentile(const ReliabilityResult* result, double percentile) {
+    if (!result || result->reachable_count == 0) return -1.0;
+    if (percentile < 0) percentile = 0;
+    if (percentile > 100) percentile = 100;
+    // 在相邻两个样本之间线性插值
+    double rank = percentile / 100.0 * (result->reachable_count - 1);
+    int lo = (int)rank;
+    int hi = lo + 1 < result->reachable_count ? lo + 1 : lo;
+    return result->sample_times[lo] + (rank - lo) * (result->sample_times[hi] - result->sample_times[lo]);
+}
+
+void free_reliability_result(ReliabilityResult* result) {
+    if (!result) return;
+    for (int i = 0; i < result->route_count; i++) {
+        free(result->routes[i].node_ids);
+        free(result->routes[i].modes);
+    }
+    free(result->routes);
+    free(result->sample_times);
+    free(result->sample_costs);
+    free(result);
+}
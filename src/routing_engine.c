@@ -0,0 +1,201 @@
+/**
+ * @file routing_engine.c
+ * @brief 实现了寻路引擎的注册表、自动选择器和引擎实例，以及在隐式完全图上搜索的 "astar" 引擎。
+ */
+#include "routing_engine.h"
+#include "csr_engine.h"
+#include "utils.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 注册表容量
+#define ROUTING_ENGINE_MAX 16
+
+// 估计网络稠密程度时抽样的节点对数
+#define DENSITY_SAMPLE_PAIRS 256
+
+// 压缩邻接表的预处理约等于隐式图上的这么多次查询（两者都与节点数的平方成正比），查询更少时不做预处理
+#define CSR_BREAK_EVEN_POINT_TO_POINT 8
+#define CSR_BREAK_EVEN_ONE_TO_MANY 3
+
+/**
+ * @brief 引擎实例。
+ */
+struct RoutingEngine {
+    const RoutingEngineVTable* vtable;
+    const TrafficNetwork* network;
+    void* state;                // prepare 输出的私有状态
+};
+
+// --- "astar"：直接在隐式完全图上搜索，没有预处理 ---
+
+static bool astar_prepare(const TrafficNetwork* network, void** state) {
+    (void)network;
+    *state = NULL;
+    return true;
+}
+
+static RoutePath* astar_query(void* state, const TrafficNetwork* network, int start_node_id, int end_node_id, const RouteQueryOptions* options,
+                              const SolveControl* control) {
+    (void)state;
+    return find_shortest_path_query(network, start_node_id, end_node_id, options, control);
+}
+
+static bool astar_one_to_many(void* state, const TrafficNetwork* network, int source_node_id, const int* target_node_ids, int target_count,
+                              const RouteQueryOptions* options, const SolveControl* control, double* out_costs) {
+    (void)state;
+    return find_shortest_path_costs(network, source_node_id, target_node_ids, target_count, options, control, out_costs);
+}
+
+static void astar_free(void* state) {
+    (void)state;
+}
+
+static const RoutingEngineVTable astar_engine = {
+    "astar",
+    "隐式完全图上的A*，无需预处理，适合一次性查询",
+    astar_prepare,
+    astar_query,
+    astar_one_to_many,
+    astar_free,
+};
+
+// --- 注册表 ---
+
+static const RoutingEngineVTable* registry[ROUTING_ENGINE_MAX] = { &astar_engine, &csr_linear_engine, &csr_heap_engine };
+static int registry_count = 3;
+static const RoutingEngineVTable* override_engine; // routing_engine_set_override() 指定的引擎
+
+bool routing_engine_register(const RoutingEngineVTable* vtable) {
+    if (!vtable || !vtable->name || !vtable->prepare || !vtable->query || !vtable->one_to_many || !vtable->free_state) return false;
+    if (routing_engine_find(vtable->name)) {
+        fprintf(stderr, "错误: 寻路引擎 %s 已注册。\n", vtable->name);
+        return false;
+    }
+    if (registry_count >= ROUTING_ENGINE_MAX) {
+        fprintf(stderr, "错误: 寻路引擎注册表已满。\n");
+        return false;
+    }
+    registry[registry_count++] = vtable;
+    return true;
+}
+
+int routing_engine_count(void) {
+    return registry_count;
+}
+
+const RoutingEngineVTable* routing_engine_get(int index) {
+    return (index >= 0 && index < registry_count) ? registry[index] : NULL;
+}
+
+const RoutingEngineVTable* routing_engine_find(const char* name) {
+    if (!name) return NULL;
+    for (int i = 0; i < registry_count; i++) {
+        if (strcmp(registry[i]->name, name) == 0) return registry[i];
+    }
+    return NULL;
+}
+
+bool routing_engine_set_override(const char* name) {
+    if (!name) {
+        override_engine = NULL;
+        return true;
+    }
+    const RoutingEngineVTable* vtable = routing_engine_find(name);
+    if (!vtable) {
+        fprintf(stderr, "错误: 未知的寻路引擎 %s。\n", name);
+        return false;
+    }
+    override_engine = vtable;
+    return true;
+}
+
+// --- 自动选择 ---
+
+/**
+ * @brief 抽样估计每个节点使用允许的交通方式可以直达的路段数（平均出度）。
+ * @details 节点对按固定步长选取，结果可复现。
+ */
+static double estimate_average_degree(const TrafficNetwork* network, TransportModeMask allowed_modes) {
+    int n = traffic_network_get_node_count(network);
+    if (n < 2) return 0.0;
+    TransportMode modes[TRANSPORT_MODE_COUNT];
+    int mode_count = mode_mask_expand(allowed_modes, modes);
+
+    long long total_pairs = (long long)n * (n - 1);
+    long long step = total_pairs / DENSITY_SAMPLE_PAIRS;
+    if (step < 1) step = 1;
+    int samples = 0, links = 0;
+    for (long long p = 0; p < total_pairs; p += step) {
+        int u = (int)(p / (n - 1));
+        int v = (int)(p % (n - 1));
+        if (v >= u) v++; // 跳过 u 自身
+        for (int k = 0; k < mode_count; k++) {
+            if (evaluate_direct_leg(network, u, v, modes[k]).is_reachable) links++;
+        }
+        samples++;
+    }
+    return (double)links / samples * (n - 1);
+}
+
+// 选择器的实现
+const RoutingEngineVTable* routing_engine_select(const TrafficNetwork* network, const RoutingWorkload* workload) {
+    if (override_engine) return override_engine;
+    const char* env = getenv("TRAFFIC_ENGINE");
+    if (env && *env) {
+        const RoutingEngineVTable* vtable = routing_engine_find(env);
+        if (vtable) return vtable;
+    }
+
+    // 查询很少时预处理不划算
+    if (!workload) return &astar_engine;
+    int break_even = workload->kind == ROUTING_ONE_TO_MANY ? CSR_BREAK_EVEN_ONE_TO_MANY : CSR_BREAK_EVEN_POINT_TO_POINT;
+    if (workload->query_count < break_even) return &astar_engine;
+
+    // 批量查询：预处理一次，每次查询都省去距离和交通规则的计算
+    int n = traffic_network_get_node_count(network);
+    double degree = estimate_average_degree(network, workload->allowed_modes);
+    return (n > 1 && degree * log2((double)n) < n) ? &csr_heap_engine : &csr_linear_engine;
+}
+
+// --- 引擎实例 ---
+
+RoutingEngine* routing_engine_create(const RoutingEngineVTable* vtable, const TrafficNetwork* network) {
+    if (!network) return NULL;
+    if (!vtable) vtable = routing_engine_select(network, NULL);
+    RoutingEngine* engine = (RoutingEngine*)calloc(1, sizeof(RoutingEngine));
+    if (!engine) return NULL;
+    engine->vtable = vtable;
+    engine->network = network;
+    if (!vtable->prepare(network, &engine->state)) {
+        fprintf(stderr, "错误: 寻路引擎 %s 预处理失败。\n", vtable->name);
+        free(engine);
+        return NULL;
+    }
+    return engine;
+}
+
+const char* routing_engine_get_name(const RoutingEngine* engine) {
+    return engine ? engine->vtable->name : NULL;
+}
+
+RoutePath* routing_engine_query(const RoutingEngine* engine, int start_node_id, int end_node_id, const RouteQueryOptions* options,
+                                const SolveControl* control) {
+    if (!engine) return NULL;
+    return engine->vtable->query(engine->state, engine->network, start_node_id, end_node_id, options, control);
+}
+
+bool routing_engine_one_to_many(const RoutingEngine* engine, int source_node_id, const int* target_node_ids, int target_count,
+                                const RouteQueryOptions* options, const SolveControl* control, double* out_costs) {
+    if (!engine) return false;
+    return engine->vtable->one_to_many(engine->state, engine->network, source_node_id, target_node_ids, target_count, options, control,
+                                       out_costs);
+}
+
+void routing_engine_destroy(RoutingEngine* engine) {
+    if (!engine) return;
+    engine->vtable->free_state(engine->state);
+    free(engine);
+}
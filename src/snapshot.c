@@ -0,0 +1,202 @@
+/**
+ * @file snapshot.c
+ * @brief 实现了二进制快照的保存与加载。
+ */
+#include "snapshot.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SNAPSHOT_MAGIC "TRAFSNAP"
+#define SNAPSHOT_FORMAT_VERSION 1
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+
+/**
+ * @brief 快照文件头。其后依次是节点数组、城市数组（各自补齐到8字节）和可选的同城表。
+ */
+typedef struct {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t byte_order;        // 按本机字节序写入 SNAPSHOT_BYTE_ORDER，用于识别字节序不同的文件
+    uint32_t node_size;         // sizeof(Node)
+    uint32_t city_size;         // sizeof(CityMeta)
+    int32_t node_count;
+    int32_t city_count;
+    uint64_t tables_offset;     // 同城表在文件中的偏移，0表示没有
+} SnapshotHeader;
+
+struct SnapshotMapping {
+    void* base;
+    size_t size;
+};
+
+static size_t padded_size(size_t size) {
+    return (size + 7) / 8 * 8;
+}
+
+static bool write_block(FILE* fp, const void* data, size_t size) {
+    static const char zeros[8] = {0};
+    size_t padding = padded_size(size) - size;
+    return fwrite(data, 1, size, fp) == size && (padding == 0 || fwrite(zeros, 1, padding, fp) == padding);
+}
+
+// 快照保存的实现
+bool snapshot_save(const char* path, const TrafficNetwork* network, const CityTables* tables) {
+    if (!path || !network) return false;
+    // 先写临时文件再改名替换：正在映射旧快照的进程继续使用旧文件，不会读到写了一半的数据
+    size_t path_length = strlen(path);
+    char* temp_path = (char*)malloc(path_length + 5);
+    if (!temp_path) return false;
+    memcpy(temp_path, path, path_length);
+    memcpy(temp_path + path_length, ".tmp", 5);
+    FILE* fp = fopen(temp_path, "wb");
+    if (!fp) {
+        fprintf(stderr, "错误: 无法写入快照 %s (错误码: %d)\n", path, errno);
+        free(temp_path);
+        return false;
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.format_version = SNAPSHOT_FORMAT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.node_size = sizeof(Node);
+    header.city_size = sizeof(CityMeta);
+    header.node_count = network->node_count;
+    header.city_count = network->city_count;
+    if (tables) {
+        header.tables_offset = padded_size(sizeof(header)) + padded_size(network->node_count * sizeof(Node)) +
+                               padded_size(network->city_count * sizeof(CityMeta));
+    }
+
+    bool ok = write_block(fp, &header, sizeof(header)) && write_block(fp, network->nodes, network->node_count * sizeof(Node)) &&
+              write_block(fp, network->cities, network->city_count * sizeof(CityMeta)) &&
+              (!tables || city_tables_write(tables, fp));
+    if (fclose(fp) != 0) ok = false;
+    if (ok && rename(temp_path, path) != 0) ok = false;
+    if (!ok) {
+        fprintf(stderr, "错误: 写入快照 %s 失败\n", path);
+        remove(temp_path);
+    }
+    free(temp_path);
+    return ok;
+}
+
+/**
+ * @brief 检查快照头部是否由本程序在同一平台上写出。
+ */
+static bool check_header(const SnapshotHeader* header, const char* path) {
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 || header->format_version != SNAPSHOT_FORMAT_VERSION ||
+        header->byte_order != SNAPSHOT_BYTE_ORDER || header->node_size != sizeof(Node) || header->city_size != sizeof(CityMeta) ||
+        header->node_count <= 0 || header->city_count <= 0) {
+        fprintf(stderr, "错误: %s 不是本程序可用的快照文件\n", path);
+        return false;
+    }
+    return true;
+}
+
+// 快照加载的实现
+TrafficNetwork* snapshot_load(const char* path, CityTables** out_tables) {
+    if (out_tables) *out_tables = NULL;
+    if (!path) return NULL;
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "错误：无法打开快照 %s (错误码: %d)\n", path, errno);
+        return NULL;
+    }
+
+    SnapshotHeader header;
+    if (fread(&header, 1, sizeof(header), fp) != sizeof(header) || !check_header(&header, path)) {
+        fclose(fp);
+        return NULL;
+    }
+
+    Node* nodes = (Node*)malloc(padded_size(header.node_count * sizeof(Node)));
+    CityMeta* cities = (CityMeta*)malloc(padded_size(header.city_count * sizeof(CityMeta)));
+    TrafficNetwork* network = NULL;
+    if (nodes && cities && fseek(fp, (long)padded_size(sizeof(header)), SEEK_SET) == 0 &&
+        fread(nodes, 1, padded_size(header.node_count * sizeof(Node)), fp) == padded_size(header.node_count * sizeof(Node)) &&
+        fread(cities, 1, padded_size(header.city_count * sizeof(CityMeta)), fp) == padded_size(header.city_count * sizeof(CityMeta))) {
+        network = traffic_network_create_from_arrays(nodes, header.node_count, cities, header.city_count);
+    } else {
+        fprintf(stderr, "错误: 快照 %s 数据不完整\n", path);
+    }
+    free(nodes);
+    free(cities);
+
+    // 同城表读取失败时仍返回网络，调用者可以重新构建表
+    if (network && header.tables_offset && out_tables && fseek(fp, (long)header.tables_offset, SEEK_SET) == 0) {
+        *out_tables = city_tables_read(fp, network);
+    }
+    fclose(fp);
+    if (network) {
+        printf("成功加载快照: %d 个城市, %d 个节点\n", network->city_count, network->node_count);
+    }
+    return network;
+}
+
+// 快照映射的实现
+TrafficNetwork* snapshot_map(const char* path, CityTables** out_tables, SnapshotMapping** out_mapping) {
+    if (out_tables) *out_tables = NULL;
+    if (out_mapping) *out_mapping = NULL;
+    if (!path || !out_mapping) return NULL;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "错误：无法打开快照 %s (错误码: %d)\n", path, errno);
+        return NULL;
+    }
+    struct stat st;
+    void* base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(SnapshotHeader)) {
+        base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd); // 映射在关闭文件后仍然有效
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "错误: 无法映射快照 %s\n", path);
+        return NULL;
+    }
+    size_t size = (size_t)st.st_size;
+
+    // 映射的起始地址按页对齐，文件中各数组又按8字节对齐，因此可以直接当作结构体数组使用
+    const SnapshotHeader* header = (const SnapshotHeader*)base;
+    size_t nodes_offset = padded_size(sizeof(SnapshotHeader));
+    size_t cities_offset = nodes_offset + padded_size(header->node_count * sizeof(Node));
+    TrafficNetwork* network = NULL;
+    if (check_header(header, path)) {
+        if (cities_offset + padded_size(header->city_count * sizeof(CityMeta)) <= size) {
+            network = traffic_network_wrap_arrays((const Node*)((const char*)base + nodes_offset), header->node_count,
+                                                  (const CityMeta*)((const char*)base + cities_offset), header->city_count);
+        } else {
+            fprintf(stderr, "错误: 快照 %s 数据不完整\n", path);
+        }
+    }
+    SnapshotMapping* mapping = network ? (SnapshotMapping*)malloc(sizeof(SnapshotMapping)) : NULL;
+    if (!mapping) {
+        traffic_network_destroy(network);
+        munmap(base, size);
+        return NULL;
+    }
+    mapping->base = base;
+    mapping->size = size;
+
+    // 同城表无效时仍返回网络，调用者可以重新构建表
+    if (header->tables_offset && header->tables_offset % 8 == 0 && header->tables_offset < size && out_tables) {
+        *out_tables = city_tables_map((const char*)base + header->tables_offset, size - header->tables_offset, network);
+    }
+    *out_mapping = mapping;
+    printf("成功映射快照: %d 个城市, %d 个节点\n", network->city_count, network->node_count);
+    return network;
+}
+
+void snapshot_unmap(SnapshotMapping* mapping) {
+    if (!mapping) return;
+    munmap(mapping->base, mapping->size);
+    free(mapping);
+}
@@ -0,0 +1,40 @@
+/**
+ * @file solve_control.c
+ * @brief 实现了长时间求解使用的取消令牌和进度报告。
+ */
+#include "solve_control.h"
+#include "utils.h"
+#include <stddef.h>
+
+void cancel_token_init(CancelToken* token) {
+    if (!token) return;
+    token->cancelled = 0;
+    token->deadline = 0.0;
+}
+
+void cancel_token_cancel(CancelToken* token) {
+    if (!token) return;
+    // 使用原子写入，保证其它线程中的求解循环能及时看到取消请求
+    __atomic_store_n(&token->cancelled, 1, __ATOMIC_RELEASE);
+}
+
+void cancel_token_set_deadline(CancelToken* token, double timeout_ms) {
+    if (!token) return;
+    token->deadline = timeout_ms > 0 ? monotonic_time_seconds() + timeout_ms / 1000.0 : 0.0;
+}
+
+bool cancel_token_is_cancelled(const CancelToken* token) {
+    if (!token) return false;
+    if (__atomic_load_n(&token->cancelled, __ATOMIC_ACQUIRE)) return true;
+    return token->deadline > 0 && monotonic_time_seconds() >= token->deadline;
+}
+
+bool solve_control_should_stop(const SolveControl* control) {
+    return control != NULL && cancel_token_is_cancelled(control->cancel_token);
+}
+
+void solve_control_report_progress(const SolveControl* control, const char* stage, double fraction) {
+    if (control && control->on_progress) {
+        control->on_progress(stage, fraction, control->user_data);
+    }
+}
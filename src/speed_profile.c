@@ -0,0 +1,242 @@
+/**
+ * @file speed_profile.c
+ * @brief 实现了分段线性速度曲线的加载、查找和通行时间积分。
+ */
+#include "speed_profile.h"
+#include "utils.h"
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 曲线键中表示 "所有城市的默认市内曲线" 和 "城际曲线" 的特殊城市ID
+#define PROFILE_CITY_DEFAULT -1
+#define PROFILE_CITY_INTERCITY -2
+
+// 速度系数的合法上限，防止配置错误导致启发式过于宽松
+#define MAX_SPEED_FACTOR 10.0
+
+struct SpeedProfileSet {
+    int city_count;             // 加载时网络的城市数
+    SpeedProfile* profiles;     // 所有曲线
+    int* profile_cities;        // 每条曲线的城市键（城市ID或上面的特殊值）
+    TransportMode* profile_modes; // 每条曲线的交通方式
+    int profile_count;
+    int profile_capacity;
+    short* index;               // index[c * TRANSPORT_MODE_COUNT + m]：城市c（c = city_count 表示城际）的曲线下标，-1表示没有
+    double max_factor;          // 所有曲线的最大速度系数（不小于1）
+};
+
+/**
+ * @brief 找到或新建 (城市键, 交通方式) 对应的曲线。
+ */
+static SpeedProfile* get_or_add_profile(SpeedProfileSet* set, int city_key, TransportMode mode) {
+    for (int i = 0; i < set->profile_count; i++) {
+        if (set->profile_cities[i] == city_key && set->profile_modes[i] == mode) return &set->profiles[i];
+    }
+    if (set->profile_count >= set->profile_capacity) {
+        int new_capacity = set->profile_capacity ? set->profile_capacity * 2 : 16;
+        SpeedProfile* profiles = (SpeedProfile*)realloc(set->profiles, new_capacity * sizeof(SpeedProfile));
+        if (profiles) set->profiles = profiles;
+        int* cities = (int*)realloc(set->profile_cities, new_capacity * sizeof(int));
+        if (cities) set->profile_cities = cities;
+        TransportMode* modes = (TransportMode*)realloc(set->profile_modes, new_capacity * sizeof(TransportMode));
+        if (modes) set->profile_modes = modes;
+        if (!profiles || !cities || !modes) return NULL;
+        set->profile_capacity = new_capacity;
+    }
+    SpeedProfile* profile = &set->profiles[set->profile_count];
+    memset(profile, 0, sizeof(SpeedProfile));
+    set->profile_cities[set->profile_count] = city_key;
+    set->profile_modes[set->profile_count] = mode;
+    set->profile_count++;
+    return profile;
+}
+
+/**
+ * @brief 曲线的断点全部读入后，补上周期哨兵并预计算斜率、整天积分和整点分段索引。
+ */
+static void finalize_profile(SpeedProfile* p) {
+    int n = p->count;
+    p->hours[n] = p->hours[0] + 24.0f;
+    p->factors[n] = p->factors[0];
+    p->day_integral = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float width = p->hours[i + 1] - p->hours[i];
+        p->slopes[i] = (p->factors[i + 1] - p->factors[i]) / width;
+        p->day_integral += 0.5f * (p->factors[i] + p->factors[i + 1]) * width;
+    }
+    int seg = 0;
+    for (int k = 0; k < 24; k++) {
+        float t = p->hours[0] + (float)k;
+        while (seg + 1 < n && p->hours[seg + 1] <= t) seg++;
+        p->hour_segment[k] = (unsigned char)seg;
+    }
+}
+
+// 加载速度曲线的实现
+SpeedProfileSet* speed_profile_set_load(const TrafficNetwork* network, const char* csv_path) {
+    if (!network || !csv_path) return NULL;
+    FILE* fp = fopen(csv_path, "rb");
+    if (!fp) {
+        fprintf(stderr, "错误：无法打开文件 %s (错误码: %d)\n", csv_path, errno);
+        return NULL;
+    }
+
+    SpeedProfileSet* set = (SpeedProfileSet*)calloc(1, sizeof(SpeedProfileSet));
+    if (!set) {
+        fclose(fp);
+        return NULL;
+    }
+    set->city_count = network->city_count;
+    set->max_factor = 1.0;
+
+    char line[256];
+    int line_no = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), fp)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line_no == 1 || line[0] == '\0') continue; // 跳过表头和空行
+
+        char* city_name = strtok(line, ",");
+        char* mode_name = strtok(NULL, ",");
+        char* hour_str = strtok(NULL, ",");
+        char* factor_str = strtok(NULL, ",");
+        if (!city_name || !mode_name || !hour_str || !factor_str) {
+            fprintf(stderr, "错误: %s 第%d行格式错误。\n", csv_path, line_no);
+            ok = false;
+            break;
+        }
+
+        int city_key = PROFILE_CITY_DEFAULT;
+        if (strcmp(city_name, "intercity") == 0) {
+            city_key = PROFILE_CITY_INTERCITY;
+        } else if (strcmp(city_name, "*") != 0) {
+            city_key = -3;
+            for (int c = 0; c < network->city_count; c++) {
+                if (strcmp(network->cities[c].city_name, city_name) == 0) city_key = c;
+            }
+            if (city_key == -3) {
+                fprintf(stderr, "警告: %s 第%d行的城市 %s 不存在，已忽略。\n", csv_path, line_no, city_name);
+                continue;
+            }
+        }
+
+        int mode = mode_from_string(mode_name);
+        double hour = atof(hour_str);
+        double factor = atof(factor_str);
+        if (mode < 0 || hour < 0 || hour >= 24 || factor <= 0 || factor > MAX_SPEED_FACTOR) {
+            fprintf(stderr, "错误: %s 第%d行的交通方式、时刻或速度系数无效。\n", csv_path, line_no);
+            ok = false;
+            break;
+        }
+
+        SpeedProfile* profile = get_or_add_profile(set, city_key, (TransportMode)mode);
+        if (!profile) {
+            ok = false;
+            break;
+        }
+        if (profile->count >= SPEED_PROFILE_MAX_BREAKPOINTS || (profile->count > 0 && hour <= profile->hours[profile->count - 1])) {
+            fprintf(stderr, "错误: %s 第%d行：断点过多或时刻没有严格递增。\n", csv_path, line_no);
+            ok = false;
+            break;
+        }
+        profile->hours[profile->count] = (float)hour;
+        profile->factors[profile->count] = (float)factor;
+        profile->count++;
+        if (factor > set->max_factor) set->max_factor = factor;
+    }
+    fclose(fp);
+
+    // 构建 (城市, 交通方式) → 曲线 的稠密查找表，城市没有单独定义时回退到默认曲线
+    if (ok) {
+        set->index = (short*)malloc((set->city_count + 1) * TRANSPORT_MODE_COUNT * sizeof(short));
+        ok = set->index != NULL;
+    }
+    if (!ok) {
+        speed_profile_set_destroy(set);
+        return NULL;
+    }
+    for (int i = 0; i < set->profile_count; i++) finalize_profile(&set->profiles[i]);
+    for (int c = 0; c <= set->city_count; c++) {
+        for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+            short own = -1, fallback = -1;
+            for (int i = 0; i < set->profile_count; i++) {
+                if (set->profile_modes[i] != (TransportMode)m) continue;
+                int key = set->profile_cities[i];
+                if (c == set->city_count ? key == PROFILE_CITY_INTERCITY : key == c) own = (short)i;
+                if (c < set->city_count && key == PROFILE_CITY_DEFAULT) fallback = (short)i;
+            }
+            set->index[c * TRANSPORT_MODE_COUNT + m] = own >= 0 ? own : fallback;
+        }
+    }
+    return set;
+}
+
+void speed_profile_set_destroy(SpeedProfileSet* set) {
+    if (!set) return;
+    free(set->profiles);
+    free(set->profile_cities);
+    free(set->profile_modes);
+    free(set->index);
+    free(set);
+}
+
+const SpeedProfile* speed_profile_set_lookup(const SpeedProfileSet* set, const Node* from_node, const Node* to_node, TransportMode mode) {
+    if (!set || !from_node || !to_node) return NULL;
+    int city = from_node->city_id == to_node->city_id ? from_node->city_id : set->city_count;
+    if (city < 0 || city > set->city_count) return NULL;
+    short i = set->index[city * TRANSPORT_MODE_COUNT + mode];
+    return i >= 0 ? &set->profiles[i] : NULL;
+}
+
+double speed_profile_set_get_max_factor(const SpeedProfileSet* set) {
+    return set ? set->max_factor : 1.0;
+}
+
+// 通行时间积分的实现
+double speed_profile_travel_time(const SpeedProfile* p, double free_flow_hours, double depart_hour) {
+    if (!p || p->count == 0 || free_flow_hours <= 0) return free_flow_hours;
+
+    // 把出发时刻折算到 [hours[0], hours[0] + 24)
+    double t = fmod(depart_hour - p->hours[0], 24.0);
+    if (t < 0) t += 24.0;
+    if (t >= 24.0) t = 0.0; // 浮点舍入
+    int seg = p->hour_segment[(int)t];
+    t += p->hours[0];
+    while (seg + 1 < p->count && p->hours[seg + 1] <= t) seg++;
+
+    // 需要的速度系数积分等于自由流时间；先跳过整天
+    double remaining = free_flow_hours;
+    double elapsed = 0.0;
+    if (remaining >= p->day_integral) {
+        double days = floor(remaining / p->day_integral);
+        remaining -= days * p->day_integral;
+        elapsed += days * 24.0;
+    }
+
+    // 逐段积分：段内 f(t) 线性，走完 remaining 所需的时间 τ 满足 f0·τ + s·τ²/2 = remaining
+    while (1) {
+        double f0 = p->factors[seg] + p->slopes[seg] * (t - p->hours[seg]);
+        double width = p->hours[seg + 1] - t;
+        double covered = 0.5 * (f0 + p->factors[seg + 1]) * width;
+        if (covered >= remaining) {
+            // 求根公式的有理化形式，斜率为0时同样成立且没有相消误差
+            return elapsed + 2.0 * remaining / (f0 + sqrt(f0 * f0 + 2.0 * p->slopes[seg] * remaining));
+        }
+        remaining -= covered;
+        elapsed += width;
+        t = p->hours[seg + 1];
+        if (++seg == p->count) {
+            seg = 0;
+            t -= 24.0;
+        }
+    }
+}
+
+double speed_profile_set_travel_time(const SpeedProfileSet* set, const Node* from_node, const Node* to_node, TransportMode mode,
+                                     double free_flow_hours, double depart_hour) {
+    return speed_profile_travel_time(speed_profile_set_lookup(set, from_node, to_node, mode), free_flow_hours, depart_hour);
+}
@@ -0,0 +1,94 @@
+/**
+ * @file spsc_ring.c
+ * @brief 实现了单生产者、单消费者的无锁环形队列。
+ * @details head 和 tail 是单调递增的计数，下标为计数对容量取模（容量为2的幂）；tail - head 即队列长度。
+ *          生产者以 release 语义发布 tail，消费者以 acquire 语义读取 tail 后才读取槽位，反之亦然。
+ */
+#include "spsc_ring.h"
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+
+// 假定的缓存行大小，head 和 tail 分开放置以避免伪共享
+#define CACHE_LINE 64
+
+// 等待时先自旋 SPIN_LIMIT 次，再让出CPU YIELD_LIMIT 次，之后每次重试前休眠 IDLE_SLEEP_NS，
+// 避免在下游长时间计算时空转占满一个核心
+#define SPIN_LIMIT 64
+#define YIELD_LIMIT 1024
+#define IDLE_SLEEP_NS 50000
+
+struct SpscRing {
+    void** slots;
+    size_t mask;                // 容量 - 1
+    char pad0[CACHE_LINE];
+    size_t head;                // 消费者的读位置，只由消费者写
+    size_t cached_tail;         // 消费者上次看到的 tail，减少对生产者缓存行的读取
+    char pad1[CACHE_LINE];
+    size_t tail;                // 生产者的写位置，只由生产者写
+    size_t cached_head;         // 生产者上次看到的 head
+    char pad2[CACHE_LINE];
+};
+
+SpscRing* spsc_ring_create(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size *= 2;
+    SpscRing* ring = (SpscRing*)calloc(1, sizeof(SpscRing));
+    if (!ring) return NULL;
+    ring->slots = (void**)malloc(size * sizeof(void*));
+    if (!ring->slots) {
+        free(ring);
+        return NULL;
+    }
+    ring->mask = size - 1;
+    return ring;
+}
+
+void spsc_ring_destroy(SpscRing* ring) {
+    if (!ring) return;
+    free(ring->slots);
+    free(ring);
+}
+
+bool spsc_ring_try_push(SpscRing* ring, void* item) {
+    size_t tail = ring->tail;
+    if (tail - ring->cached_head > ring->mask) {
+        ring->cached_head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (tail - ring->cached_head > ring->mask) return false;
+    }
+    ring->slots[tail & ring->mask] = item;
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool spsc_ring_try_pop(SpscRing* ring, void** item) {
+    size_t head = ring->head;
+    if (head == ring->cached_tail) {
+        ring->cached_tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if (head == ring->cached_tail) return false;
+    }
+    *item = ring->slots[head & ring->mask];
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static void backoff(int attempt) {
+    if (attempt < SPIN_LIMIT) return;
+    if (attempt < YIELD_LIMIT) {
+        sched_yield();
+        return;
+    }
+    struct timespec ts = { 0, IDLE_SLEEP_NS };
+    nanosleep(&ts, NULL);
+}
+
+// 重试次数增加到 YIELD_LIMIT 后不再增加，长时间等待也不会溢出
+void spsc_ring_push(SpscRing* ring, void* item) {
+    for (int attempt = 0; !spsc_ring_try_push(ring, item); attempt += attempt < YIELD_LIMIT) backoff(attempt);
+}
+
+void* spsc_ring_pop(SpscRing* ring) {
+    void* item = NULL;
+    for (int attempt = 0; !spsc_ring_try_pop(ring, &item); attempt += attempt < YIELD_LIMIT) backoff(attempt);
+    return item;
+}
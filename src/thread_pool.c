@@ -0,0 +1,212 @@
+/**
+ * @file thread_pool.c
+ * @brief 实现了基于 pthread 的固定大小线程池和 parallel_for。
+ * @details 每次 parallel_for 调用对应一个 "作业"，作业挂在线程池的作业链表上，
+ *          空闲的工作线程逐个领取其中的任务项。所有共享状态都由一把互斥锁保护，
+ *          任务项本身（一次完整的寻路）远比加锁开销大，因此这里不追求无锁。
+ */
+#include "thread_pool.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * @brief 一次 parallel_for 调用对应的作业。
+ */
+typedef struct ParallelJob {
+    int count;                  // 任务项总数
+    int next_index;             // 下一个待领取的任务项
+    int done_count;             // 已完成的任务项数
+    ParallelForFunc func;       // 任务项处理函数
+    void* context;              // 处理函数的上下文
+    struct ParallelJob* next;   // 作业链表中的下一个作业
+} ParallelJob;
+
+struct ThreadPool {
+    pthread_mutex_t mutex;      // 保护下面所有字段
+    pthread_cond_t work_cond;   // 有新任务项或需要退出时通知工作线程
+    pthread_cond_t done_cond;   // 有作业完成时通知等待者
+    ParallelJob* jobs;          // 仍有未领取任务项的作业链表
+    int shutdown;               // 非0表示线程池正在销毁
+    int num_threads;            // 工作线程数量
+    pthread_t* threads;         // 工作线程句柄数组
+};
+
+/**
+ * @brief 工作线程的启动参数。
+ */
+typedef struct {
+    ThreadPool* pool;
+    int worker_id;
+} WorkerArgs;
+
+// 当前线程所属的线程池及其编号；非工作线程中为NULL和-1
+static __thread ThreadPool* tls_pool = NULL;
+static __thread int tls_worker_id = -1;
+
+static ThreadPool* g_default_pool = NULL;
+static pthread_once_t g_default_pool_once = PTHREAD_ONCE_INIT;
+static pid_t g_default_pool_owner;     // 创建默认线程池的进程
+
+/**
+ * @brief 从作业中领取一个任务项（调用时必须持有锁）。
+ * @details 作业的最后一个任务项被领取后，将其从作业链表中摘除。
+ * @return int 领取到的下标，作业已无剩余任务项时返回-1。
+ */
+static int claim_item_locked(ThreadPool* pool, ParallelJob* job) {
+    if (job->next_index >= job->count) return -1;
+    int index = job->next_index++;
+    if (job->next_index == job->count) {
+        ParallelJob** link = &pool->jobs;
+        while (*link && *link != job) link = &(*link)->next;
+        if (*link) *link = job->next;
+    }
+    return index;
+}
+
+/**
+ * @brief 执行一个任务项并登记完成（调用时必须持有锁，执行期间会临时释放锁）。
+ */
+static void run_item_locked(ThreadPool* pool, ParallelJob* job, int index, int worker_id) {
+    pthread_mutex_unlock(&pool->mutex);
+    job->func(index, worker_id, job->context);
+    pthread_mutex_lock(&pool->mutex);
+    if (++job->done_count == job->count) {
+        pthread_cond_broadcast(&pool->done_cond);
+    }
+}
+
+/**
+ * @brief 工作线程主循环：反复领取并执行任务项，直到线程池销毁。
+ */
+static void* worker_main(void* arg) {
+    WorkerArgs args = *(WorkerArgs*)arg;
+    free(arg);
+    ThreadPool* pool = args.pool;
+    tls_pool = pool;
+    tls_worker_id = args.worker_id;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (1) {
+        while (!pool->jobs && !pool->shutdown) {
+            pthread_cond_wait(&pool->work_cond, &pool->mutex);
+        }
+        if (!pool->jobs && pool->shutdown) break;
+
+        ParallelJob* job = pool->jobs;
+        int index = claim_item_locked(pool, job);
+        run_item_locked(pool, job, index, args.worker_id);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+ThreadPool* thread_pool_create(int num_threads) {
+    if (num_threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cpus > 0 ? (int)cpus : 1;
+    }
+
+    ThreadPool* pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+    pool->threads = (pthread_t*)calloc(num_threads, sizeof(pthread_t));
+    if (!pool->threads) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    for (int i = 0; i < num_threads; i++) {
+        WorkerArgs* args = (WorkerArgs*)malloc(sizeof(WorkerArgs));
+        if (args) {
+            args->pool = pool;
+            args->worker_id = i;
+        }
+        if (!args || pthread_create(&pool->threads[i], NULL, worker_main, args) != 0) {
+            free(args);
+            if (i == 0) {
+                thread_pool_destroy(pool);
+                return NULL;
+            }
+            // 保留已启动的线程，线程池以较少的线程继续工作
+            fprintf(stderr, "警告: 仅创建了 %d/%d 个工作线程\n", i, num_threads);
+            break;
+        }
+        pool->num_threads = i + 1;
+    }
+    return pool;
+}
+
+void thread_pool_destroy(ThreadPool* pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < pool->num_threads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    free(pool->threads);
+    free(pool);
+}
+
+int thread_pool_get_size(const ThreadPool* pool) {
+    return pool ? pool->num_threads : 0;
+}
+
+/**
+ * @brief 创建默认线程池（仅由 pthread_once 调用一次）。
+ */
+static void create_default_pool(void) {
+    const char* env = getenv("TRAFFIC_THREADS");
+    int num_threads = env ? atoi(env) : 0;
+    g_default_pool = thread_pool_create(num_threads);
+    g_default_pool_owner = getpid();
+}
+
+ThreadPool* thread_pool_get_default(void) {
+    pthread_once(&g_default_pool_once, create_default_pool);
+    return g_default_pool;
+}
+
+void thread_pool_reset_default_after_fork(void) {
+    if (!g_default_pool || g_default_pool_owner == getpid()) return;
+    create_default_pool();
+}
+
+void thread_pool_parallel_for(ThreadPool* pool, int count, ParallelForFunc func, void* context) {
+    if (count <= 0) return;
+    if (!pool) {
+        for (int i = 0; i < count; i++) func(i, 0, context);
+        return;
+    }
+
+    ParallelJob job = { count, 0, 0, func, context, NULL };
+
+    pthread_mutex_lock(&pool->mutex);
+    // 追加到作业链表尾部，先提交的作业先被执行
+    ParallelJob** link = &pool->jobs;
+    while (*link) link = &(*link)->next;
+    *link = &job;
+    pthread_cond_broadcast(&pool->work_cond);
+
+    // 嵌套调用：当前工作线程自己也领取本作业的任务项，避免所有线程都在等待而死锁
+    if (tls_pool == pool) {
+        int index;
+        while ((index = claim_item_locked(pool, &job)) >= 0) {
+            run_item_locked(pool, &job, index, tls_worker_id);
+        }
+    }
+
+    while (job.done_count < job.count) {
+        pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
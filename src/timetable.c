@@ -0,0 +1,453 @@
+/**
+ * @file timetable.c
+ * @brief 实现了时刻表的加载和连接扫描算法（CSA）最早到达查询。
+ */
+#include "timetable.h"
+#include "distance.h"
+#include "pathfinding.h"
+#include "utils.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 一天的分钟数；时刻表展开为连续两天
+#define MINUTES_PER_DAY 1440
+#define UNROLLED_DAYS 2
+
+// 每个班次展开的份数：除展开的各天发车的班次外，还有前一天发车、午夜后仍在运行的班次
+#define TRIP_COPIES (UNROLLED_DAYS + 1)
+
+// 换乘其它班次时需要预留的时间（分钟）
+#define AIRPORT_TRANSFER_MINUTES 45
+#define HSR_TRANSFER_MINUTES 10
+
+// 班次编号的最大长度
+#define TRIP_ID_MAX_LEN 32
+
+/**
+ * @brief 一条连接：某个班次从一站出发、到达下一站的一段。
+ */
+typedef struct {
+    int dep_node;           // 出发节点
+    int arr_node;           // 到达节点
+    int dep_time;           // 出发时刻（分钟，从第一天零点起算）
+    int arr_time;           // 到达时刻（分钟）
+    int trip;               // 班次下标（展开后每天发车的班次下标不同）
+    float fare;             // 票价（元）
+    unsigned char mode;     // 交通方式
+    unsigned char overnight; // 加载时：1表示次日才出发、折回当天的连接，属于前一天发车的班次
+} Connection;
+
+/**
+ * @brief 查询时每个节点的到达方式，用于回溯行程。
+ */
+typedef struct {
+    int enter;              // 上车的连接下标，-1表示从起点直接换乘到达
+    int exit;               // 下车的连接下标
+    int footpath;           // 下车后使用的换乘路段下标，-1表示没有换乘
+    int footpath_from;      // 换乘路段的起点
+} JourneyStep;
+
+struct Timetable {
+    int node_count;
+    Connection* connections;    // 按出发时刻排序的连接（展开为两天）
+    int connection_count;       // 展开后的连接数
+    int trip_count;             // 展开后的班次数
+
+    // 同城换乘路段，按起点压缩存储：起点 v 的路段为 [offsets[v], offsets[v+1])
+    int* footpath_offsets;
+    int* footpath_targets;
+    int* footpath_minutes;
+    float* footpath_fares;
+    unsigned char* footpath_modes;
+};
+
+/**
+ * @brief 解析 `HH:MM` 或 `HH:MM:SS` 格式的时刻。
+ * @return int 分钟数；格式错误时返回-1。
+ */
+static int parse_time(const char* text) {
+    int h = 0, m = 0, s = 0;
+    int fields = sscanf(text, "%d:%d:%d", &h, &m, &s);
+    if (fields < 2 || h < 0 || m < 0 || m >= 60 || s < 0 || s >= 60) return -1;
+    return h * 60 + m + (s > 0 ? 1 : 0); // 秒向上取整，保证不会提前到达
+}
+
+static unsigned int hash_string(const char* s) {
+    unsigned int h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief 加载时用于把班次编号映射为下标的开放寻址哈希表。
+ */
+typedef struct {
+    char (*names)[TRIP_ID_MAX_LEN];
+    int* slots;             // 槽位中存放班次下标，-1表示空
+    int capacity;           // 槽位数（2的幂）
+    int count;
+} TripIndex;
+
+static int trip_index_lookup(TripIndex* index, const char* name) {
+    if (index->count * 2 >= index->capacity) {
+        int new_capacity = index->capacity ? index->capacity * 2 : 256;
+        int* slots = (int*)malloc(new_capacity * sizeof(int));
+        char (*names)[TRIP_ID_MAX_LEN] = realloc(index->names, (new_capacity / 2) * sizeof(*names));
+        if (names) index->names = names;
+        if (!slots || !names) {
+            free(slots);
+            return -1;
+        }
+        for (int i = 0; i < new_capacity; i++) slots[i] = -1;
+        for (int t = 0; t < index->count; t++) {
+            unsigned int h = hash_string(index->names[t]) & (new_capacity - 1);
+            while (slots[h] >= 0) h = (h + 1) & (new_capacity - 1);
+            slots[h] = t;
+        }
+        free(index->slots);
+        index->slots = slots;
+        index->capacity = new_capacity;
+    }
+    unsigned int h = hash_string(name) & (index->capacity - 1);
+    while (index->slots[h] >= 0) {
+        if (strcmp(index->names[index->slots[h]], name) == 0) return index->slots[h];
+        h = (h + 1) & (index->capacity - 1);
+    }
+    snprintf(index->names[index->count], TRIP_ID_MAX_LEN, "%s", name);
+    index->slots[h] = index->count;
+    return index->count++;
+}
+
+static int compare_connections(const void* a, const void* b) {
+    const Connection* lhs = (const Connection*)a;
+    const Connection* rhs = (const Connection*)b;
+    if (lhs->dep_time != rhs->dep_time) return lhs->dep_time < rhs->dep_time ? -1 : 1;
+    if (lhs->arr_time != rhs->arr_time) return lhs->arr_time < rhs->arr_time ? -1 : 1;
+    return 0;
+}
+
+/**
+ * @brief 构建同城换乘路段：同城任意两个节点之间，驾车和公交直达中较快的一种。
+ */
+static bool build_footpaths(Timetable* tt, const TrafficNetwork* network) {
+    int n = tt->node_count;
+    tt->footpath_offsets = (int*)calloc(n + 1, sizeof(int));
+    if (!tt->footpath_offsets) return false;
+
+    // 第一遍计数，第二遍填充
+    for (int pass = 0; pass < 2; pass++) {
+        int total = 0;
+        for (int u = 0; u < n; u++) {
+            if (pass == 1 && tt->footpath_offsets[u] != total) return false;
+            const Node* from = traffic_network_get_node_by_id(network, u);
+            for (int v = 0; v < n; v++) {
+                const Node* to = traffic_network_get_node_by_id(network, v);
+                if (u == v || from->city_id != to->city_id) continue;
+                TravelInfo best;
+                best.is_reachable = 0;
+                TransportMode best_mode = DRIVING;
+                TransportMode modes[2] = { DRIVING, BUS };
+                for (int k = 0; k < 2; k++) {
+                    TravelInfo info = evaluate_direct_leg(network, u, v, modes[k]);
+                    if (info.is_reachable && (!best.is_reachable || info.time_hours < best.time_hours)) {
+                        best = info;
+                        best_mode = modes[k];
+                    }
+                }
+                if (!best.is_reachable) continue;
+                if (pass == 1) {
+                    tt->footpath_targets[total] = v;
+                    tt->footpath_minutes[total] = (int)(best.time_hours * 60.0 + 0.999); // 向上取整
+                    tt->footpath_fares[total] = (float)best.cost_yuan;
+                    tt->footpath_modes[total] = (unsigned char)best_mode;
+                }
+                total++;
+            }
+            if (pass == 0) tt->footpath_offsets[u + 1] = total;
+        }
+        if (pass == 0) {
+            tt->footpath_targets = (int*)malloc((total + 1) * sizeof(int));
+            tt->footpath_minutes = (int*)malloc((total + 1) * sizeof(int));
+            tt->footpath_fares = (float*)malloc((total + 1) * sizeof(float));
+            tt->footpath_modes = (unsigned char*)malloc(total + 1);
+            if (!tt->footpath_targets || !tt->footpath_minutes || !tt->footpath_fares || !tt->footpath_modes) return false;
+        }
+    }
+    return true;
+}
+
+// 加载时刻表的实现
+Timetable* timetable_load(const TrafficNetwork* network, const char* csv_path) {
+    if (!network || !csv_path) return NULL;
+    FILE* fp = fopen(csv_path, "rb");
+    if (!fp) {
+        fprintf(stderr, "错误：无法打开文件 %s (错误码: %d)\n", csv_path, errno);
+        return NULL;
+    }
+
+    Timetable* tt = (Timetable*)calloc(1, sizeof(Timetable));
+    TripIndex trips = { NULL, NULL, 0, 0 };
+    Connection* day = NULL;
+    int count = 0, capacity = 0;
+    bool ok = tt != NULL;
+
+    char line[512];
+    int line_no = 0;
+    while (ok && fgets(line, sizeof(line), fp)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line_no == 1 || line[0] == '\0') continue; // 跳过表头和空行
+
+        char* fields[7];
+        int nf = 0;
+        for (char* tok = strtok(line, ","); tok && nf < 7; tok = strtok(NULL, ",")) fields[nf++] = tok;
+        if (nf < 7) {
+            fprintf(stderr, "错误: %s 第%d行格式错误。\n", csv_path, line_no);
+            ok = false;
+            break;
+        }
+
+        Connection c;
+        c.mode = (unsigned char)mode_from_string(fields[1]);
+        c.dep_node = traffic_network_find_node_id_by_name(network, fields[2]);
+        c.arr_node = traffic_network_find_node_id_by_name(network, fields[3]);
+        c.dep_time = parse_time(fields[4]);
+        c.arr_time = parse_time(fields[5]);
+        c.fare = (float)atof(fields[6]);
+        if (mode_from_string(fields[1]) < 0 || c.dep_node < 0 || c.arr_node < 0 || c.dep_node == c.arr_node ||
+            c.dep_time < 0 || c.dep_time >= 2 * MINUTES_PER_DAY || c.arr_time <= c.dep_time || c.fare < 0) {
+            fprintf(stderr, "错误: %s 第%d行的交通方式、节点、时刻或票价无效。\n", csv_path, line_no);
+            ok = false;
+            break;
+        }
+        // 次日才出发的连接折回当天，但仍属于前一天发车的那一趟班次
+        c.overnight = c.dep_time >= MINUTES_PER_DAY;
+        if (c.overnight) c.dep_time -= MINUTES_PER_DAY, c.arr_time -= MINUTES_PER_DAY;
+        c.trip = trip_index_lookup(&trips, fields[0]);
+        if (c.trip < 0) {
+            ok = false;
+            break;
+        }
+
+        if (count >= capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            Connection* grown = (Connection*)realloc(day, capacity * sizeof(Connection));
+            if (!grown) {
+                ok = false;
+                break;
+            }
+            day = grown;
+        }
+        day[count++] = c;
+    }
+    fclose(fp);
+
+    if (ok && count == 0) {
+        fprintf(stderr, "错误: 时刻表 %s 中没有任何连接。\n", csv_path);
+        ok = false;
+    }
+    if (ok) {
+        // 展开为连续两天，并按出发时刻排序成一个连续数组。第 d 天的连接属于第 d 天发车的班次（副本 d+1），
+        // 折回的连接属于第 d-1 天发车的班次（副本 d），这样过夜的列车在午夜前后是同一个班次，乘客可以留在车上
+        tt->node_count = traffic_network_get_node_count(network);
+        tt->trip_count = trips.count * TRIP_COPIES;
+        tt->connection_count = count * UNROLLED_DAYS;
+        tt->connections = (Connection*)malloc(tt->connection_count * sizeof(Connection));
+        ok = tt->connections != NULL;
+        for (int d = 0; ok && d < UNROLLED_DAYS; d++) {
+            for (int i = 0; i < count; i++) {
+                Connection c = day[i];
+                c.dep_time += d * MINUTES_PER_DAY;
+                c.arr_time += d * MINUTES_PER_DAY;
+                c.trip += (d + 1 - c.overnight) * trips.count;
+                tt->connections[d * count + i] = c;
+            }
+        }
+        if (ok) qsort(tt->connections, tt->connection_count, sizeof(Connection), compare_connections);
+        ok = ok && build_footpaths(tt, network);
+    }
+
+    free(day);
+    free(trips.names);
+    free(trips.slots);
+    if (!ok) {
+        timetable_destroy(tt);
+        return NULL;
+    }
+    return tt;
+}
+
+void timetable_destroy(Timetable* timetable) {
+    if (!timetable) return;
+    free(timetable->connections);
+    free(timetable->footpath_offsets);
+    free(timetable->footpath_targets);
+    free(timetable->footpath_minutes);
+    free(timetable->footpath_fares);
+    free(timetable->footpath_modes);
+    free(timetable);
+}
+
+int timetable_get_connection_count(const Timetable* timetable) {
+    return timetable ? timetable->connection_count / UNROLLED_DAYS : 0;
+}
+
+/**
+ * @brief 在某个节点换乘其它班次时需要预留的时间。
+ */
+static int transfer_minutes(const TrafficNetwork* network, int node_id) {
+    const Node* node = traffic_network_get_node_by_id(network, node_id);
+    if (!node) return 0;
+    if (node->type == NODE_TYPE_AIRPORT) return AIRPORT_TRANSFER_MINUTES;
+    if (node->type == NODE_TYPE_HSR_STATION) return HSR_TRANSFER_MINUTES;
+    return 0;
+}
+
+/**
+ * @brief 在路径头部插入一个路段。
+ */
+static bool prepend_segment(const TrafficNetwork* network, RoutePath* path, int from, int to, TransportMode mode, double hours, double fare) {
+    PathSegment* segment = (PathSegment*)malloc(sizeof(PathSegment));
+    if (!segment) return false;
+    const Node* a = traffic_network_get_node_by_id(network, from);
+    const Node* b = traffic_network_get_node_by_id(network, to);
+    segment->from_node_id = from;
+    segment->to_node_id = to;
+    segment->mode = mode;
+    segment->distance_km = calculate_distance(a->latitude, a->longitude, b->latitude, b->longitude);
+    segment->time_hours = hours;
+    segment->cost_yuan = fare;
+    segment->next = path->segments_head;
+    path->segments_head = segment;
+    path->segment_count++;
+    path->total_distance += segment->distance_km;
+    path->total_cost += fare;
+    return true;
+}
+
+/**
+ * @brief 沿到达方式回溯，构建完整行程。
+ */
+static RoutePath* build_journey(const Timetable* tt, const TrafficNetwork* network, const JourneyStep* journey, int start, int end) {
+    RoutePath* path = (RoutePath*)calloc(1, sizeof(RoutePath));
+    if (!path) return NULL;
+    int v = end;
+    for (int guard = 0; v != start && guard < 2 * tt->node_count; guard++) {
+        const JourneyStep* step = &journey[v];
+        if (step->footpath >= 0) {
+            int f = step->footpath;
+            prepend_segment(network, path, step->footpath_from, v, (TransportMode)tt->footpath_modes[f],
+                            tt->footpath_minutes[f] / 60.0, tt->footpath_fares[f]);
+        }
+        if (step->exit < 0) {
+            v = step->footpath_from; // 从起点直接换乘到达
+            continue;
+        }
+        // 同一班次从上车到下车的各段连接（在数组中按出发时刻排列），倒序插入
+        int trip = tt->connections[step->enter].trip;
+        for (int i = step->exit; i >= step->enter; i--) {
+            const Connection* c = &tt->connections[i];
+            if (c->trip != trip) continue;
+            prepend_segment(network, path, c->dep_node, c->arr_node, (TransportMode)c->mode, (c->arr_time - c->dep_time) / 60.0, c->fare);
+        }
+        v = tt->connections[step->enter].dep_node;
+    }
+    return path;
+}
+
+// 连接扫描算法最早到达查询的实现
+RoutePath* timetable_earliest_arrival(const Timetable* timetable, const TrafficNetwork* network, int start_node_id, int end_node_id,
+                                      double depart_hour, double* arrival_hour) {
+    const Timetable* tt = timetable;
+    if (!tt || !network || start_node_id < 0 || start_node_id >= tt->node_count || end_node_id < 0 || end_node_id >= tt->node_count) {
+        return NULL;
+    }
+    if (depart_hour < 0 || depart_hour >= 24) depart_hour = 0;
+    int t0 = (int)(depart_hour * 60.0 + 0.999);
+
+    int* arrival = (int*)malloc(tt->node_count * sizeof(int));
+    JourneyStep* journey = (JourneyStep*)malloc(tt->node_count * sizeof(JourneyStep));
+    int* boarding = (int*)malloc(tt->trip_count * sizeof(int));
+    int* transfer = (int*)malloc(tt->node_count * sizeof(int));
+    bool* usable = (bool*)malloc(tt->node_count * sizeof(bool));
+    RoutePath* path = NULL;
+    if (!arrival || !journey || !boarding || !transfer || !usable) goto cleanup;
+
+    for (int v = 0; v < tt->node_count; v++) {
+        arrival[v] = INT_MAX;
+        transfer[v] = transfer_minutes(network, v);
+        usable[v] = traffic_network_is_node_enabled(network, v); // 被封闭的站点不能上下车
+    }
+    for (int t = 0; t < tt->trip_count; t++) boarding[t] = -1;
+
+    // 从起点出发，以及从起点经同城换乘路段到达的节点
+    arrival[start_node_id] = t0;
+    for (int f = tt->footpath_offsets[start_node_id]; f < tt->footpath_offsets[start_node_id + 1]; f++) {
+        int v = tt->footpath_targets[f];
+        if (!usable[v]) continue;
+        arrival[v] = t0 + tt->footpath_minutes[f];
+        journey[v].enter = journey[v].exit = -1;
+        journey[v].footpath = f;
+        journey[v].footpath_from = start_node_id;
+    }
+
+    // 二分查找第一条不早于出发时刻的连接
+    int lo = 0, hi = tt->connection_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (tt->connections[mid].dep_time < t0) lo = mid + 1;
+        else hi = mid;
+    }
+
+    // 按出发时刻顺序扫描一遍所有连接
+    for (int i = lo; i < tt->connection_count; i++) {
+        const Connection* c = &tt->connections[i];
+        if (arrival[end_node_id] <= c->dep_time) break; // 之后的连接不可能更早到达终点
+
+        if (boarding[c->trip] < 0) {
+            // 不在该班次上：必须提前到达出发节点并留出换乘时间
+            if (!usable[c->dep_node] || arrival[c->dep_node] == INT_MAX || arrival[c->dep_node] + transfer[c->dep_node] > c->dep_time) continue;
+            boarding[c->trip] = i;
+        }
+        if (!usable[c->arr_node] || c->arr_time >= arrival[c->arr_node]) continue; // 经停封闭站点时可以留在车上
+
+        arrival[c->arr_node] = c->arr_time;
+        journey[c->arr_node].enter = boarding[c->trip];
+        journey[c->arr_node].exit = i;
+        journey[c->arr_node].footpath = -1;
+        journey[c->arr_node].footpath_from = c->arr_node;
+
+        // 下车后的同城换乘
+        for (int f = tt->footpath_offsets[c->arr_node]; f < tt->footpath_offsets[c->arr_node + 1]; f++) {
+            int v = tt->footpath_targets[f];
+            int t = c->arr_time + tt->footpath_minutes[f];
+            if (usable[v] && t < arrival[v]) {
+                arrival[v] = t;
+                journey[v].enter = boarding[c->trip];
+                journey[v].exit = i;
+                journey[v].footpath = f;
+                journey[v].footpath_from = c->arr_node;
+            }
+        }
+    }
+
+    if (arrival[end_node_id] != INT_MAX && end_node_id != start_node_id) {
+        path = build_journey(tt, network, journey, start_node_id, end_node_id);
+        if (path) path->total_time = (arrival[end_node_id] - t0) / 60.0; // 含候车和换乘时间
+        if (arrival_hour) *arrival_hour = arrival[end_node_id] / 60.0;
+    }
+
+cleanup:
+    free(arrival);
+    free(journey);
+    free(boarding);
+    free(transfer);
+    free(usable);
+    return path;
+}
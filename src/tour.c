@@ -0,0 +1,334 @@
+/**
+ * @file tour.c
+ * @brief 实现了可增量编辑的环游行程：增删途经点时只计算新的矩阵行列，并局部修复环路。
+ */
+#include "tour.h"
+#include "pathfinding.h"
+#include "thread_pool.h"
+#include "tsp_matrix.h"
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 途经点数组的初始容量
+#define TOUR_INITIAL_CAPACITY 8
+
+struct TourPlanner {
+    const TrafficNetwork* network;  // 所属的交通网络
+    double time_weight;             // 时间权重
+    double cost_weight;             // 花费权重
+
+    int count;                      // 途经点数量
+    int capacity;                   // 下面各数组的容量，也是成本矩阵的行跨度
+    int* node_ids;                  // 途经点编号 → 节点ID，0号途经点是起点
+    ShortestPathTree** trees;       // 每个途经点出发的最短路径树
+    double* cost_matrix;            // cost_matrix[i * capacity + j]：途经点i到j的加权成本
+
+    int* order;                     // 当前环路（途经点编号），长度等于 count
+    double tour_cost;               // 当前环路的总成本
+    bool is_optimal;                // 当前环路是否为精确最优解
+    HeldKarpTable* exact;           // 精确求解用的动态规划表；其点数等于 count 时与矩阵同步
+    unsigned long network_version;  // 树和矩阵与之一致的网络版本号
+};
+
+TourPlanner* tour_planner_create(const TrafficNetwork* network, double time_weight, double cost_weight) {
+    TourPlanner* tour = (TourPlanner*)calloc(1, sizeof(TourPlanner));
+    if (!tour) return NULL;
+    tour->network = network;
+    tour->time_weight = time_weight;
+    tour->cost_weight = cost_weight;
+    tour->tour_cost = DBL_MAX;
+    tour->network_version = traffic_network_get_version(network);
+    tour->exact = held_karp_table_create();
+    if (!tour->exact) {
+        free(tour);
+        return NULL;
+    }
+    return tour;
+}
+
+void tour_planner_destroy(TourPlanner* tour) {
+    if (!tour) return;
+    for (int i = 0; i < tour->count; i++) free_shortest_path_tree(tour->trees[i]);
+    free(tour->trees);
+    free(tour->node_ids);
+    free(tour->cost_matrix);
+    free(tour->order);
+    held_karp_table_destroy(tour->exact);
+    free(tour);
+}
+
+/**
+ * @brief 确保各数组至少能容纳 needed 个途经点，扩容时按新的行跨度搬移成本矩阵。
+ */
+static bool ensure_capacity(TourPlanner* tour, int needed) {
+    if (needed <= tour->capacity) return true;
+    int new_capacity = tour->capacity ? tour->capacity * 2 : TOUR_INITIAL_CAPACITY;
+    while (new_capacity < needed) new_capacity *= 2;
+
+    int* node_ids = (int*)realloc(tour->node_ids, new_capacity * sizeof(int));
+    if (!node_ids) return false;
+    tour->node_ids = node_ids;
+    ShortestPathTree** trees = (ShortestPathTree**)realloc(tour->trees, new_capacity * sizeof(ShortestPathTree*));
+    if (!trees) return false;
+    tour->trees = trees;
+    int* order = (int*)realloc(tour->order, new_capacity * sizeof(int));
+    if (!order) return false;
+    tour->order = order;
+
+    double* matrix = (double*)malloc((size_t)new_capacity * new_capacity * sizeof(double));
+    if (!matrix) return false;
+    for (int i = 0; i < tour->count; i++) {
+        memcpy(&matrix[i * new_capacity], &tour->cost_matrix[i * tour->capacity], tour->count * sizeof(double));
+    }
+    free(tour->cost_matrix);
+    tour->cost_matrix = matrix;
+    tour->capacity = new_capacity;
+    return true;
+}
+
+/**
+ * @brief 在当前的成本矩阵上从头构建Held-Karp表。
+ */
+static void rebuild_exact_table(TourPlanner* tour) {
+    held_karp_table_clear(tour->exact);
+    for (int k = 0; k < tour->count; k++) {
+        held_karp_table_extend(tour->exact, tour->cost_matrix, tour->capacity, NULL);
+    }
+}
+
+/**
+ * @brief 用Held-Karp表中的最优环路替换当前环路。
+ * @return bool 存在可行环路时返回true。
+ */
+static bool take_exact_tour(TourPlanner* tour) {
+    double cost = held_karp_table_best_tour(tour->exact, tour->cost_matrix, tour->capacity, tour->order);
+    if (cost == DBL_MAX) return false;
+    tour->tour_cost = cost;
+    tour->is_optimal = true;
+    return true;
+}
+
+/**
+ * @brief 使用局部搜索改进当前环路，并刷新环路成本。
+ */
+static void improve_heuristic_tour(TourPlanner* tour) {
+    tsp_improve_tour(tour->cost_matrix, tour->capacity, tour->order, tour->count);
+    tour->tour_cost = tsp_tour_cost(tour->cost_matrix, tour->capacity, tour->order, tour->count);
+    tour->is_optimal = false;
+}
+
+bool tour_planner_add_stop(TourPlanner* tour, int node_id) {
+    if (!tour || !traffic_network_get_node_by_id(tour->network, node_id)) return false;
+    if (tour_planner_sync(tour) < 0) return false;
+    for (int i = 0; i < tour->count; i++) {
+        if (tour->node_ids[i] == node_id) return true; // 已在行程中
+    }
+    if (!ensure_capacity(tour, tour->count + 1)) return false;
+
+    // 新点的最短路径树给出矩阵的新行；已有点的树给出新列，无需额外搜索
+    ShortestPathTree* tree = compute_shortest_path_tree(tour->network, node_id, tour->time_weight, tour->cost_weight, NULL);
+    if (!tree) return false;
+
+    int k = tour->count;
+    int stride = tour->capacity;
+    tour->node_ids[k] = node_id;
+    tour->trees[k] = tree;
+    for (int i = 0; i < k; i++) {
+        tour->cost_matrix[k * stride + i] = shortest_path_tree_get_cost(tree, tour->node_ids[i]);
+        tour->cost_matrix[i * stride + k] = shortest_path_tree_get_cost(tour->trees[i], node_id);
+    }
+    tour->cost_matrix[k * stride + k] = 0.0;
+    int previous_len = tour->count;
+    tour->count = k + 1;
+
+    if (tour->count <= HELD_KARP_MAX_NODES) {
+        // 精确修复：只计算包含新点的子集
+        if (held_karp_table_get_size(tour->exact) == k) {
+            held_karp_table_extend(tour->exact, tour->cost_matrix, stride, NULL);
+        } else {
+            rebuild_exact_table(tour);
+        }
+        if (take_exact_tour(tour)) return true;
+    } else {
+        held_karp_table_clear(tour->exact); // 点数超出精确范围，表不再与矩阵同步
+    }
+
+    // 启发式修复：把新点插入当前环路最廉价的位置，再做局部搜索
+    tsp_cheapest_insertion(tour->cost_matrix, stride, tour->order, &previous_len, k);
+    improve_heuristic_tour(tour);
+    return true;
+}
+
+bool tour_planner_remove_stop(TourPlanner* tour, int node_id) {
+    if (!tour) return false;
+    int index = -1;
+    for (int i = 0; i < tour->count; i++) {
+        if (tour->node_ids[i] == node_id) {
+            index = i;
+            break;
+        }
+    }
+    if (index == -1) return false;
+    if (tour_planner_sync(tour) < 0) return false;
+
+    int n = tour->count;
+    int stride = tour->capacity;
+    free_shortest_path_tree(tour->trees[index]);
+
+    // 1. 删除途经点，并原地删除成本矩阵的对应行列
+    memmove(&tour->node_ids[index], &tour->node_ids[index + 1], (n - index - 1) * sizeof(int));
+    memmove(&tour->trees[index], &tour->trees[index + 1], (n - index - 1) * sizeof(ShortestPathTree*));
+    for (int i = 0, new_i = 0; i < n; i++) {
+        if (i == index) continue;
+        for (int j = 0, new_j = 0; j < n; j++) {
+            if (j == index) continue;
+            tour->cost_matrix[new_i * stride + new_j] = tour->cost_matrix[i * stride + j];
+            new_j++;
+        }
+        new_i++;
+    }
+
+    // 2. 从当前环路中摘除该点，其后的编号减一，并把新的0号点旋转到首位
+    int len = 0;
+    int start_pos = 0;
+    for (int p = 0; p < n; p++) {
+        int stop = tour->order[p];
+        if (stop == index) continue;
+        tour->order[len] = stop > index ? stop - 1 : stop;
+        if (tour->order[len] == 0) start_pos = len;
+        len++;
+    }
+    if (start_pos != 0 && len > 0) {
+        int* rotated = (int*)malloc(len * sizeof(int));
+        if (rotated) {
+            for (int p = 0; p < len; p++) rotated[p] = tour->order[(start_pos + p) % len];
+            memcpy(tour->order, rotated, len * sizeof(int));
+            free(rotated);
+        }
+    }
+    tour->count = n - 1;
+
+    if (tour->count == 0) {
+        held_karp_table_clear(tour->exact);
+        tour->tour_cost = DBL_MAX;
+        tour->is_optimal = false;
+        return true;
+    }
+
+    // 3. 修复环路
+    if (tour->count <= HELD_KARP_MAX_NODES) {
+        // 精确修复：表与矩阵同步且删除的不是起点时，所有不含该点的子集都可以直接保留
+        if (held_karp_table_get_size(tour->exact) == n && index > 0) {
+            held_karp_table_remove(tour->exact, index);
+        } else {
+            rebuild_exact_table(tour);
+        }
+        if (take_exact_tour(tour)) return true;
+    }
+    improve_heuristic_tour(tour);
+    return true;
+}
+
+int tour_planner_get_stop_count(const TourPlanner* tour) {
+    return tour ? tour->count : 0;
+}
+
+int tour_planner_get_order(const TourPlanner* tour, int* out_node_ids, int capacity) {
+    if (!tour || !out_node_ids) return 0;
+    int n = tour->count < capacity ? tour->count : capacity;
+    for (int p = 0; p < n; p++) out_node_ids[p] = tour->node_ids[tour->order[p]];
+    return n;
+}
+
+double tour_planner_get_cost(const TourPlanner* tour) {
+    return tour ? tour->tour_cost : DBL_MAX;
+}
+
+bool tour_planner_is_optimal(const TourPlanner* tour) {
+    return tour ? tour->is_optimal : false;
+}
+
+RoutePath* tour_planner_build_route(const TourPlanner* tour) {
+    if (!tour || tour->count < 2 || tour->tour_cost == DBL_MAX) return NULL;
+
+    RoutePath* route = (RoutePath*)calloc(1, sizeof(RoutePath));
+    if (!route) return NULL;
+    PathSegment** tail = &route->segments_head;
+    for (int p = 0; p < tour->count; p++) {
+        int from = tour->order[p];
+        int to = tour->order[(p + 1) % tour->count];
+        RoutePath* leg = shortest_path_tree_get_route(tour->network, tour->trees[from], tour->node_ids[to]);
+        if (!leg) {
+            free_route_path(route);
+            return NULL;
+        }
+
+        // 将路段拼接到路径尾部并累加总计
+        *tail = leg->segments_head;
+        while (*tail) tail = &(*tail)->next;
+        route->segment_count += leg->segment_count;
+        route->total_cost += leg->total_cost;
+        route->total_distance += leg->total_distance;
+        route->total_time += leg->total_time;
+
+        leg->segments_head = NULL;
+        free_route_path(leg);
+    }
+    return route;
+}
+
+/**
+ * @brief 并行修复最短路径树时共享的上下文。
+ */
+typedef struct {
+    const TrafficNetwork* network;
+    ShortestPathTree** trees;
+    int failed;                     // 任一棵树修复失败时置1（原子写入）
+} RepairContext;
+
+/**
+ * @brief parallel_for 的任务项：修复一棵最短路径树。
+ */
+static void repair_tree(int index, int worker_id, void* context) {
+    (void)worker_id;
+    RepairContext* ctx = (RepairContext*)context;
+    if (shortest_path_tree_repair(ctx->network, ctx->trees[index], NULL) < 0) __atomic_store_n(&ctx->failed, 1, __ATOMIC_RELAXED);
+}
+
+int tour_planner_sync(TourPlanner* tour) {
+    if (!tour) return -1;
+    unsigned long version = traffic_network_get_version(tour->network);
+    if (tour->network_version == version) return 0;
+
+    // 1. 增量修复每个途经点的最短路径树
+    RepairContext ctx = { tour->network, tour->trees, 0 };
+    thread_pool_parallel_for(thread_pool_get_default(), tour->count, repair_tree, &ctx);
+    if (ctx.failed) return -1;
+    tour->network_version = version;
+
+    // 2. 只更新成本发生变化的矩阵元素
+    int n = tour->count;
+    int stride = tour->capacity;
+    int changed = 0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i == j) continue;
+            double cost = shortest_path_tree_get_cost(tour->trees[i], tour->node_ids[j]);
+            if (cost != tour->cost_matrix[i * stride + j]) {
+                tour->cost_matrix[i * stride + j] = cost;
+                changed++;
+            }
+        }
+    }
+    if (changed == 0 || n < 2) return changed;
+
+    // 3. 重新求解环路：精确范围内动态规划表的所有子集都可能受影响，只能重建
+    if (n <= HELD_KARP_MAX_NODES) {
+        rebuild_exact_table(tour);
+        if (take_exact_tour(tour)) return changed;
+    }
+    improve_heuristic_tour(tour);
+    return changed;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file traffic_planner.c
+ * @brief 实现了共享库的公共接口：把不透明句柄和调用方缓冲区转换为内部模块的调用。
+ */
+#include "traffic_planner.h"
+#include "city_tables.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include "query_service.h"
+#include "routing_engine.h"
+#include "snapshot.h"
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 公共接口中的交通方式取值必须与内部的 TransportMode 一致，路段和位集合才能直接转换
+typedef char traffic_planner_mode_values_match[(TRAFFIC_PLANNER_MODE_DRIVING == (int)DRIVING && TRAFFIC_PLANNER_MODE_HIGH_SPEED_RAIL == (int)HIGH_SPEED_RAIL &&
+                                                TRAFFIC_PLANNER_MODE_FLIGHT == (int)FLIGHT && TRAFFIC_PLANNER_MODE_BUS == (int)BUS && (int)TRANSPORT_MODE_COUNT == 4)
+                                                   ? 1
+                                                   : -1];
+
+struct TrafficPlanner {
+    TrafficNetwork* network;
+    CityTables* tables;         // 同城表，只交给本规划器自己的网络使用
+    QueryService* service;      // JSON查询，同时提供长期使用的寻路引擎
+    SnapshotMapping* mapping;   // 从快照打开时网络和同城表引用的映射，否则为NULL
+};
+
+struct TrafficPlannerRoute {
+    double total_distance;
+    double total_time;
+    double total_cost;
+    int segment_count;
+    TrafficPlannerSegment segments[];
+};
+
+/**
+ * @brief 为已加载的网络补齐同城表和查询服务，失败时释放网络、表和映射。
+ */
+static TrafficPlannerStatus finish_open(TrafficNetwork* network, CityTables* tables, SnapshotMapping* mapping, TrafficPlanner** out_planner) {
+    TrafficPlanner* planner = (TrafficPlanner*)calloc(1, sizeof(TrafficPlanner));
+    if (!tables) tables = city_tables_build(network, NULL, 0);
+    QueryService* service = planner ? query_service_create(network, 0) : NULL;
+    if (!service) {
+        free(planner);
+        city_tables_destroy(tables);
+        traffic_network_destroy(network);
+        snapshot_unmap(mapping);
+        return TRAFFIC_PLANNER_ERROR_OUT_OF_MEMORY;
+    }
+    planner->network = network;
+    planner->tables = tables;
+    planner->service = service;
+    planner->mapping = mapping;
+    // 同城表属于本规划器的网络：关闭其他规划器不会影响本规划器上正在进行的查询
+    traffic_network_set_city_tables(network, tables);
+    *out_planner = planner;
+    return TRAFFIC_PLANNER_OK;
+}
+
+static bool valid_node(const TrafficPlanner* planner, int node_id) {
+    return planner && node_id >= 0 && node_id < traffic_network_get_node_count(planner->network);
+}
+
+static RouteQueryOptions make_options(double time_weight, double cost_weight, unsigned int allowed_modes) {
+    RouteQueryOptions options = { time_weight, cost_weight, NULL, (TransportModeMask)allowed_modes & TRANSPORT_MODE_ALL };
+    return options;
+}
+
+// --- 公共接口 ---
+
+unsigned int traffic_planner_version(void) {
+    return ((unsigned int)TRAFFIC_PLANNER_VERSION_MAJOR << 16) | TRAFFIC_PLANNER_VERSION_MINOR;
+}
+
+TrafficPlannerStatus traffic_planner_open(const char* nodes_csv_path, TrafficPlanner** out_planner) {
+    if (!out_planner) return TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT;
+    *out_planner = NULL;
+    if (!nodes_csv_path) return TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT;
+    TrafficNetwork* network = traffic_network_create(nodes_csv_path);
+    if (!network) return TRAFFIC_PLANNER_ERROR_LOAD_FAILED;
+    return finish_open(network, NULL, NULL, out_planner);
+}
+
+TrafficPlannerStatus traffic_planner_open_snapshot(const char* snapshot_path, TrafficPlanner** out_planner) {
+    if (!out_planner) return TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT;
+    *out_planner = NULL;
+    if (!snapshot_path) return TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT;
+    CityTables* tables = NULL;
+    SnapshotMapping* mapping = NULL;
+    TrafficNetwork* network = snapshot_map(snapshot_path, &tables, &mapping);
+    if (!network) return TRAFFIC_PLANNER_ERROR_LOAD_FAILED;
+    return finish_open(network, tables, mapping, out_planner);
+}
+
+void traffic_planner_close(TrafficPlanner* planner) {
+    if (!planner) return;
+    query_service_destroy(planner->service);
+    city_tables_destroy(planner->tables);
+    traffic_network_destroy(planner->network);
+    snapshot_unmap(planner->mapping);
+    free(planner);
+}
+
+int traffic_planner_node_count(const TrafficPlanner* planner) {
+    return planner ? traffic_network_get_node_count(planner->network) : 0;
+}
+
+int traffic_planner_find_node(const TrafficPlanner* planner, const char* name) {
+    if (!planner || !name) return -1;
+    return traffic_network_find_node_id_by_name(planner->network, name);
+}
+
+size_t traffic_planner_node_name(const TrafficPlanner* planner, int node_id, char* buffer, size_t size) {
+    if (buffer && size > 0) buffer[0] = '\0';
+    if (!valid_node(planner, node_id)) return 0;
+    const char* name = traffic_network_get_node_by_id(planner->network, node_id)->name;
+    size_t length = strlen(name);
+    if (buffer && size > 0) {
+        size_t copied = length < size - 1 ? length : size - 1;
+        memcpy(buffer, name, copied);
+        buffer[copied] = '\0';
+    }
+    return length;
+}
+
+TrafficPlannerStatus traffic_planner_route(const TrafficPlanner* planner, int from_node_id, int to_node_id, double time_weight,
+                                           double cost_weight, unsigned int allowed_modes, TrafficPlannerRoute** out_route) {
+    if (!out_route) return TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT;
+    *out_route = NULL;
+    if (!valid_node(planner, from_node_id) || !valid_node(planner, to_node_id)) return TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT;
+
+    RouteQueryOptions options = make_options(time_weight, cost_weight, allowed_modes);
+    RoutePath* path = routing_engine_query(query_service_get_engine(planner->service), from_node_id, to_node_id, &options, NULL);
+    if (!path) return TRAFFIC_PLANNER_ERROR_NO_ROUTE;
+
+    TrafficPlannerRoute* route = (TrafficPlannerRoute*)malloc(sizeof(TrafficPlannerRoute) + path->segment_count * sizeof(TrafficPlannerSegment));
+    if (!route) {
+        free_route_path(path);
+        return TRAFFIC_PLANNER_ERROR_OUT_OF_MEMORY;
+    }
+    route->total_distance = path->total_distance;
+    route->total_time = path->total_time;
+    route->total_cost = path->total_cost;
+    route->segment_count = 0;
+    for (const PathSegment* seg = path->segments_head; seg && route->segment_count < path->segment_count; seg = seg->next) {
+        TrafficPlannerSegment* out = &route->segments[route->segment_count++];
+        out->from_node_id = seg->from_node_id;
+        out->to_node_id = seg->to_node_id;
+        out->mode = (int)seg->mode;
+        out->distance_km = seg->distance_km;
+        out->time_hours = seg->time_hours;
+        out->cost_yuan = seg->cost_yuan;
+    }
+    free_route_path(path);
+    *out_route = route;
+    return TRAFFIC_PLANNER_OK;
+}
+
+void traffic_planner_route_totals(const TrafficPlannerRoute* route, double* distance_km, double* time_hours, double* cost_yuan) {
+    if (distance_km) *distance_km = route ? route->total_distance : 0.0;
+    if (time_hours) *time_hours = route ? route->total_time : 0.0;
+    if (cost_yuan) *cost_yuan = route ? route->total_cost : 0.0;
+}
+
+int traffic_planner_route_segment_count(const TrafficPlannerRoute* route) {
+    return route ? route->segment_count : 0;
+}
+
+int traffic_planner_route_get_segments(const TrafficPlannerRoute* route, TrafficPlannerSegment* segments, int capacity) {
+    if (!route || !segments || capacity <= 0) return 0;
+    int count = route->segment_count < capacity ? route->segment_count : capacity;
+    memcpy(segments, route->segments, count * sizeof(TrafficPlannerSegment));
+    return count;
+}
+
+void traffic_planner_route_free(TrafficPlannerRoute* route) {
+    free(route);
+}
+
+TrafficPlannerStatus traffic_planner_cost_matrix(const TrafficPlanner* planner, const int* node_ids, int count, double time_weight,
+                                                 double cost_weight, unsigned int allowed_modes, double* out_costs) {
+    if (!planner || !node_ids || count <= 0 || !out_costs) return TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT;
+    for (int i = 0; i < count; i++) {
+        if (!valid_node(planner, node_ids[i])) return TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT;
+    }
+    RouteQueryOptions options = make_options(time_weight, cost_weight, allowed_modes);
+    const RoutingEngine* engine = query_service_get_engine(planner->service);
+    for (int i = 0; i < count; i++) {
+        double* row = out_costs + (size_t)i * count;
+        if (!routing_engine_one_to_many(engine, node_ids[i], node_ids, count, &options, NULL, row)) {
+            return TRAFFIC_PLANNER_ERROR_OUT_OF_MEMORY;
+        }
+        for (int j = 0; j < count; j++) {
+            if (row[j] == DBL_MAX) row[j] = -1.0;
+        }
+    }
+    return TRAFFIC_PLANNER_OK;
+}
+
+TrafficPlannerStatus traffic_planner_query_json(TrafficPlanner* planner, const char* path, const char* params, char** out_json,
+                                                size_t* out_length, int* out_http_status) {
+    if (!out_json) return TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT;
+    *out_json = NULL;
+    if (!planner || !path) return TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT;
+    size_t length = 0;
+    int status = query_service_handle(planner->service, path, params, out_json, &length);
+    if (!*out_json) return TRAFFIC_PLANNER_ERROR_OUT_OF_MEMORY;
+    if (out_length) *out_length = length;
+    if (out_http_status) *out_http_status = status;
+    return TRAFFIC_PLANNER_OK;
+}
+
+void traffic_planner_string_free(char* text) {
+    free(text);
+}
@@ -0,0 +1,458 @@
+/**
+ * @file tsp_bnb.c
+ * @brief 实现了基于 Held-Karp 1-tree 下界与次梯度优化的并行分支定界TSP求解器。
+ */
+#include "tsp_bnb.h"
+#include "thread_pool.h"
+#include "tsp_matrix.h"
+#include "utils.h"
+#include <float.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 下界计算中用于代替 DBL_MAX 的不可达惩罚值（降低不可用边的成本不会破坏下界的正确性）
+#define UNREACHABLE_PENALTY 1e9
+
+// 剪枝容差：下界不低于 "当前最优 - 容差" 时剪枝
+#define PRUNE_EPSILON 1e-9
+
+// 次梯度优化的最大迭代次数（乘以点数）
+#define SUBGRADIENT_ITERATIONS_PER_NODE 50
+
+// 次梯度步长系数的下限，低于该值时停止迭代
+#define SUBGRADIENT_MIN_LAMBDA 1e-6
+
+/**
+ * @brief 并行搜索的一个子问题：从起点出发的一个固定前缀。
+ */
+typedef struct {
+    int path[3];            // 前缀中的点（path[0] 总是0）
+    int depth;              // 前缀长度
+    double fixed_cost;      // 前缀路径的成本
+    double bound;           // 该子问题的下界
+} BnbSubproblem;
+
+/**
+ * @brief 各线程共享的求解上下文。
+ */
+typedef struct {
+    const double* cost;
+    int stride;
+    int n;
+    double* sym;                // n × n 对称化成本矩阵（不可达替换为惩罚值）
+    double* pi;                 // 根节点次梯度优化得到的拉格朗日乘子
+
+    BnbSubproblem* subproblems;
+    int subproblem_count;
+
+    pthread_mutex_t mutex;      // 保护当前最优解的更新和进度回调
+    double best_cost;           // 当前最优解的成本（读取时使用原子操作）
+    int* best_order;            // 当前最优解的访问顺序
+    int completed;              // 已完成的子问题数
+    int stopped;                // 非0表示超时或被取消，所有线程尽快退出
+
+    double deadline;            // 单调时钟的截止时间（秒），0表示不限时
+    const SolveControl* control;
+} BnbContext;
+
+/**
+ * @brief 每个子问题搜索时使用的工作区。
+ */
+typedef struct {
+    int* path;              // 当前路径
+    int* children;          // children[depth * n + k]：第depth层的候选点
+    double* child_bounds;   // 候选点对应的下界
+    int* tree_nodes;        // 最小生成树计算使用的点集
+    double* keys;           // Prim算法的键值
+    int checks;             // 距离上次检查超时/取消以来扩展的节点数
+} BnbWorkspace;
+
+static double load_best(BnbContext* ctx) {
+    double value;
+    __atomic_load(&ctx->best_cost, &value, __ATOMIC_ACQUIRE);
+    return value;
+}
+
+static bool is_stopped(BnbContext* ctx) {
+    return __atomic_load_n(&ctx->stopped, __ATOMIC_ACQUIRE) != 0;
+}
+
+/**
+ * @brief 定期检查超时和取消，触发时通知所有线程停止。
+ */
+static bool check_stop(BnbContext* ctx, BnbWorkspace* ws) {
+    if (++ws->checks < SOLVE_CONTROL_CHECK_INTERVAL) return is_stopped(ctx);
+    ws->checks = 0;
+    if ((ctx->deadline > 0 && monotonic_time_seconds() > ctx->deadline) || solve_control_should_stop(ctx->control)) {
+        __atomic_store_n(&ctx->stopped, 1, __ATOMIC_RELEASE);
+    }
+    return is_stopped(ctx);
+}
+
+/**
+ * @brief 尝试用一条完整环路更新当前最优解。
+ */
+static void offer_tour(BnbContext* ctx, const int* order, double total) {
+    if (total >= load_best(ctx)) return;
+    pthread_mutex_lock(&ctx->mutex);
+    if (total < ctx->best_cost) {
+        memcpy(ctx->best_order, order, ctx->n * sizeof(int));
+        __atomic_store(&ctx->best_cost, &total, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&ctx->mutex);
+}
+
+static double reduced_cost(const BnbContext* ctx, int i, int j) {
+    return ctx->sym[i * ctx->n + j] + ctx->pi[i] + ctx->pi[j];
+}
+
+/**
+ * @brief 计算一个部分路径的下界。
+ * @details 剩余部分是一条从路径末端 last 经过所有未访问点 U 回到起点的哈密顿路径。去掉它与 last 和
+ *          起点相连的两条边后，剩下的是 U 上的一棵生成树，因此（与 1-tree 同理）
+ *          路径成本 ≥ MST_π(U) + min π边(last, U) + min π边(0, U) − π[last] − π[0] − 2 Σ π[U]。
+ */
+static double partial_bound(const BnbContext* ctx, BnbWorkspace* ws, uint64_t visited, int last, double fixed_cost) {
+    int n = ctx->n;
+    int* nodes = ws->tree_nodes;
+    double* keys = ws->keys;
+    int m = 0;
+    double penalty = -ctx->pi[last] - ctx->pi[0];
+    double to_last = DBL_MAX, to_start = DBL_MAX;
+    for (int v = 1; v < n; v++) {
+        if (visited >> v & 1) continue;
+        nodes[m++] = v;
+        penalty -= 2.0 * ctx->pi[v];
+        double c = reduced_cost(ctx, last, v);
+        if (c < to_last) to_last = c;
+        c = reduced_cost(ctx, 0, v);
+        if (c < to_start) to_start = c;
+    }
+    if (m == 0) return fixed_cost + ctx->sym[last * n]; // 只剩回到起点的一段
+
+    // Prim算法：nodes[0..k) 已在树中，其余点的键值为到树的最小 π 修正成本
+    double total = to_last + to_start;
+    for (int i = 1; i < m; i++) keys[i] = reduced_cost(ctx, nodes[0], nodes[i]);
+    for (int k = 1; k < m; k++) {
+        int best = k;
+        for (int i = k + 1; i < m; i++) {
+            if (keys[i] < keys[best]) best = i;
+        }
+        total += keys[best];
+        int tmp_node = nodes[k]; nodes[k] = nodes[best]; nodes[best] = tmp_node;
+        double tmp_key = keys[k]; keys[k] = keys[best]; keys[best] = tmp_key;
+        for (int i = k + 1; i < m; i++) {
+            double c = reduced_cost(ctx, nodes[k], nodes[i]);
+            if (c < keys[i]) keys[i] = c;
+        }
+    }
+    return fixed_cost + total + penalty;
+}
+
+/**
+ * @brief 在根节点上计算 π 修正的 1-tree：点1..n-1上的最小生成树，再加上点0的两条最便宜的边。
+ * @param degree 输出参数，每个点在 1-tree 中的度数。
+ * @return double 1-tree 下界 L(π) = 1-tree 的 π 修正成本 − 2 Σ π。
+ */
+static double one_tree_bound(const BnbContext* ctx, int* degree, int* parent, double* keys, bool* in_tree) {
+    int n = ctx->n;
+    for (int v = 0; v < n; v++) {
+        degree[v] = 0;
+        in_tree[v] = false;
+        keys[v] = DBL_MAX;
+        parent[v] = -1;
+    }
+    double total = 0.0;
+    keys[1] = 0.0;
+    for (int k = 1; k < n; k++) {
+        int u = -1;
+        for (int v = 1; v < n; v++) {
+            if (!in_tree[v] && (u == -1 || keys[v] < keys[u])) u = v;
+        }
+        in_tree[u] = true;
+        if (parent[u] != -1) {
+            total += keys[u];
+            degree[u]++;
+            degree[parent[u]]++;
+        }
+        for (int v = 1; v < n; v++) {
+            double c = reduced_cost(ctx, u, v);
+            if (!in_tree[v] && c < keys[v]) {
+                keys[v] = c;
+                parent[v] = u;
+            }
+        }
+    }
+
+    int first = -1, second = -1;
+    for (int v = 1; v < n; v++) {
+        double c = reduced_cost(ctx, 0, v);
+        if (first == -1 || c < reduced_cost(ctx, 0, first)) {
+            second = first;
+            first = v;
+        } else if (second == -1 || c < reduced_cost(ctx, 0, second)) {
+            second = v;
+        }
+    }
+    total += reduced_cost(ctx, 0, first) + reduced_cost(ctx, 0, second);
+    degree[0] = 2;
+    degree[first]++;
+    degree[second]++;
+
+    double pi_sum = 0.0;
+    for (int v = 0; v < n; v++) pi_sum += ctx->pi[v];
+    return total - 2.0 * pi_sum;
+}
+
+/**
+ * @brief 次梯度优化：调整 π 使 1-tree 下界最大，结束后 ctx->pi 为取得最大下界的乘子。
+ * @return double 得到的最大 1-tree 下界。
+ */
+static double optimize_multipliers(BnbContext* ctx, double upper_bound) {
+    int n = ctx->n;
+    int* degree = (int*)malloc(n * sizeof(int));
+    int* parent = (int*)malloc(n * sizeof(int));
+    double* keys = (double*)malloc(n * sizeof(double));
+    bool* in_tree = (bool*)malloc(n * sizeof(bool));
+    double* best_pi = (double*)malloc(n * sizeof(double));
+    double best_bound = -DBL_MAX;
+    if (!degree || !parent || !keys || !in_tree || !best_pi) goto cleanup;
+
+    memset(ctx->pi, 0, n * sizeof(double));
+    memcpy(best_pi, ctx->pi, n * sizeof(double));
+    double lambda = 2.0;
+    int stale = 0;
+    for (int iter = 0; iter < SUBGRADIENT_ITERATIONS_PER_NODE * n && lambda > SUBGRADIENT_MIN_LAMBDA; iter++) {
+        double bound = one_tree_bound(ctx, degree, parent, keys, in_tree);
+        if (bound > best_bound + PRUNE_EPSILON) {
+            best_bound = bound;
+            memcpy(best_pi, ctx->pi, n * sizeof(double));
+            stale = 0;
+        } else if (++stale >= n / 2 + 1) { // 长时间没有改进时减小步长
+            lambda *= 0.5;
+            stale = 0;
+        }
+        if (best_bound >= upper_bound - PRUNE_EPSILON) break; // 已经证明初始解最优
+
+        double norm = 0.0;
+        for (int v = 0; v < n; v++) norm += (double)(degree[v] - 2) * (degree[v] - 2);
+        if (norm == 0.0) break; // 1-tree 恰好是一条环路，下界已经是该对称问题的最优值
+
+        double step = lambda * (upper_bound - bound) / norm;
+        for (int v = 0; v < n; v++) ctx->pi[v] += step * (degree[v] - 2);
+    }
+    memcpy(ctx->pi, best_pi, n * sizeof(double));
+
+cleanup:
+    free(degree);
+    free(parent);
+    free(keys);
+    free(in_tree);
+    free(best_pi);
+    return best_bound;
+}
+
+/**
+ * @brief 深度优先搜索：扩展当前路径，按下界从小到大尝试候选点。
+ */
+static void search(BnbContext* ctx, BnbWorkspace* ws, int depth, uint64_t visited, double fixed_cost) {
+    int n = ctx->n;
+    if (check_stop(ctx, ws)) return;
+
+    int last = ws->path[depth - 1];
+    if (depth == n) {
+        double back = ctx->cost[last * ctx->stride];
+        if (back != DBL_MAX) offer_tour(ctx, ws->path, fixed_cost + back);
+        return;
+    }
+
+    // 计算每个候选点的下界，并按下界插入排序
+    int* children = ws->children + depth * n;
+    double* bounds = ws->child_bounds + depth * n;
+    int count = 0;
+    double best = load_best(ctx);
+    for (int v = 1; v < n; v++) {
+        if (visited >> v & 1) continue;
+        double c = ctx->cost[last * ctx->stride + v];
+        if (c == DBL_MAX) continue;
+        double bound = partial_bound(ctx, ws, visited | ((uint64_t)1 << v), v, fixed_cost + c);
+        if (bound >= best - PRUNE_EPSILON) continue;
+        int k = count++;
+        while (k > 0 && bounds[k - 1] > bound) {
+            bounds[k] = bounds[k - 1];
+            children[k] = children[k - 1];
+            k--;
+        }
+        bounds[k] = bound;
+        children[k] = v;
+    }
+
+    for (int k = 0; k < count; k++) {
+        if (bounds[k] >= load_best(ctx) - PRUNE_EPSILON) break; // 之后的候选点下界更大
+        int v = children[k];
+        ws->path[depth] = v;
+        search(ctx, ws, depth + 1, visited | ((uint64_t)1 << v), fixed_cost + ctx->cost[last * ctx->stride + v]);
+        if (is_stopped(ctx)) return;
+    }
+}
+
+static bool workspace_init(BnbWorkspace* ws, int n) {
+    memset(ws, 0, sizeof(BnbWorkspace));
+    ws->path = (int*)malloc(n * sizeof(int));
+    ws->children = (int*)malloc(n * n * sizeof(int));
+    ws->child_bounds = (double*)malloc(n * n * sizeof(double));
+    ws->tree_nodes = (int*)malloc(n * sizeof(int));
+    ws->keys = (double*)malloc(n * sizeof(double));
+    return ws->path && ws->children && ws->child_bounds && ws->tree_nodes && ws->keys;
+}
+
+static void workspace_free(BnbWorkspace* ws) {
+    free(ws->path);
+    free(ws->children);
+    free(ws->child_bounds);
+    free(ws->tree_nodes);
+    free(ws->keys);
+}
+
+/**
+ * @brief parallel_for 的任务项：搜索一个前缀子问题。
+ */
+static void search_subproblem(int index, int worker_id, void* context) {
+    (void)worker_id;
+    BnbContext* ctx = (BnbContext*)context;
+    const BnbSubproblem* sub = &ctx->subproblems[index];
+    BnbWorkspace ws;
+    memset(&ws, 0, sizeof(ws));
+
+    if (!is_stopped(ctx) && sub->bound < load_best(ctx) - PRUNE_EPSILON && workspace_init(&ws, ctx->n)) {
+        uint64_t visited = 0;
+        for (int i = 0; i < sub->depth; i++) {
+            ws.path[i] = sub->path[i];
+            visited |= (uint64_t)1 << sub->path[i];
+        }
+        search(ctx, &ws, sub->depth, visited, sub->fixed_cost);
+    }
+    workspace_free(&ws);
+
+    pthread_mutex_lock(&ctx->mutex);
+    ctx->completed++;
+    solve_control_report_progress(ctx->control, "branch_and_bound", (double)ctx->completed / ctx->subproblem_count);
+    pthread_mutex_unlock(&ctx->mutex);
+}
+
+static int compare_subproblems(const void* a, const void* b) {
+    double lhs = ((const BnbSubproblem*)a)->bound;
+    double rhs = ((const BnbSubproblem*)b)->bound;
+    return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+/**
+ * @brief 向子问题列表追加一个前缀，并计算其下界。
+ */
+static void add_subproblem(BnbContext* ctx, BnbWorkspace* ws, const int* path, int depth, double fixed_cost) {
+    BnbSubproblem* sub = &ctx->subproblems[ctx->subproblem_count++];
+    uint64_t visited = 0;
+    for (int i = 0; i < depth; i++) {
+        sub->path[i] = path[i];
+        visited |= (uint64_t)1 << path[i];
+    }
+    sub->depth = depth;
+    sub->fixed_cost = fixed_cost;
+    sub->bound = partial_bound(ctx, ws, visited, path[depth - 1], fixed_cost);
+}
+
+/**
+ * @brief 枚举深度为2（点数较少时为1）的所有前缀作为并行子问题，并按下界排序，
+ *        下界小的子问题先搜索，更快找到好的解。
+ */
+static bool build_subproblems(BnbContext* ctx) {
+    int n = ctx->n;
+    bool two_levels = n >= 5;
+    BnbWorkspace ws;
+    ctx->subproblems = (BnbSubproblem*)malloc((n - 1) * (two_levels ? n - 2 : 1) * sizeof(BnbSubproblem));
+    if (!ctx->subproblems) return false;
+    if (!workspace_init(&ws, n)) {
+        workspace_free(&ws);
+        return false;
+    }
+
+    ctx->subproblem_count = 0;
+    for (int a = 1; a < n; a++) {
+        double ca = ctx->cost[a];
+        if (ca == DBL_MAX) continue;
+        if (!two_levels) {
+            int path[2] = { 0, a };
+            add_subproblem(ctx, &ws, path, 2, ca);
+            continue;
+        }
+        for (int b = 1; b < n; b++) {
+            double cb = ctx->cost[a * ctx->stride + b];
+            if (b == a || cb == DBL_MAX) continue;
+            int path[3] = { 0, a, b };
+            add_subproblem(ctx, &ws, path, 3, ca + cb);
+        }
+    }
+    workspace_free(&ws);
+    qsort(ctx->subproblems, ctx->subproblem_count, sizeof(BnbSubproblem), compare_subproblems);
+    return true;
+}
+
+double tsp_branch_and_bound(const double* cost, int stride, int n, int* out_order, double time_limit_ms,
+                            const SolveControl* control, bool* is_optimal) {
+    if (is_optimal) *is_optimal = false;
+    if (!cost || !out_order || n <= 0 || n > TSP_BNB_MAX_NODES) return DBL_MAX;
+    if (n <= 3) return tsp_solve_matrix(cost, stride, n, out_order, is_optimal); // 点数很少时动态规划即为精确解
+
+    BnbContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.cost = cost;
+    ctx.stride = stride;
+    ctx.n = n;
+    ctx.control = control;
+    ctx.deadline = time_limit_ms > 0 ? monotonic_time_seconds() + time_limit_ms / 1000.0 : 0.0;
+    ctx.sym = (double*)malloc(n * n * sizeof(double));
+    ctx.pi = (double*)calloc(n, sizeof(double));
+    ctx.best_order = (int*)malloc(n * sizeof(int));
+    pthread_mutex_init(&ctx.mutex, NULL);
+    double result = DBL_MAX;
+    if (!ctx.sym || !ctx.pi || !ctx.best_order) goto cleanup;
+
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            double forward = cost[i * stride + j];
+            double backward = cost[j * stride + i];
+            double c = forward < backward ? forward : backward;
+            ctx.sym[i * n + j] = c == DBL_MAX ? UNREACHABLE_PENALTY : c;
+        }
+    }
+
+    // 1. 启发式初始解作为上界
+    ctx.best_cost = tsp_solve_matrix(cost, stride, n, ctx.best_order, NULL);
+
+    // 2. 根节点次梯度优化；初始上界不可行时用一个足够大的值作为步长参考
+    double reference = ctx.best_cost != DBL_MAX ? ctx.best_cost : UNREACHABLE_PENALTY * n;
+    double root_bound = optimize_multipliers(&ctx, reference);
+
+    // 3. 根节点下界已经达到上界时无需搜索
+    if (root_bound < ctx.best_cost - PRUNE_EPSILON) {
+        if (!build_subproblems(&ctx)) goto cleanup;
+        thread_pool_parallel_for(thread_pool_get_default(), ctx.subproblem_count, search_subproblem, &ctx);
+    }
+
+    if (solve_control_should_stop(control)) goto cleanup; // 被取消
+    if (ctx.best_cost != DBL_MAX) {
+        memcpy(out_order, ctx.best_order, n * sizeof(int));
+        result = ctx.best_cost;
+        if (is_optimal) *is_optimal = !ctx.stopped;
+    }
+
+cleanup:
+    pthread_mutex_destroy(&ctx.mutex);
+    free(ctx.sym);
+    free(ctx.pi);
+    free(ctx.best_order);
+    free(ctx.subproblems);
+    return result;
+}
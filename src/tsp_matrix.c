@@ -0,0 +1,336 @@
+/**
+ * @file tsp_matrix.c
+ * @brief 实现了基于成本矩阵的TSP算法：可增量扩展的Held-Karp动态规划，以及最廉价插入和局部搜索。
+ */
+#include "tsp_matrix.h"
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 局部搜索中用于代替 DBL_MAX 的不可达惩罚值，避免无穷大参与加减运算
+#define UNREACHABLE_PENALTY 1e9
+
+// 局部搜索接受改进的最小幅度，防止浮点误差导致的无限循环
+#define IMPROVEMENT_EPSILON 1e-12
+
+// Or-opt 移动的最大片段长度
+#define OR_OPT_MAX_SEGMENT 3
+
+struct HeldKarpTable {
+    int size;               // 当前包含的点数
+    double* dp;             // dp[mask * HELD_KARP_MAX_NODES + v]：访问mask中的点并停在v的最低成本
+    signed char* parent;    // 与dp对应的前驱点，-1表示没有前驱
+};
+
+HeldKarpTable* held_karp_table_create(void) {
+    HeldKarpTable* table = (HeldKarpTable*)calloc(1, sizeof(HeldKarpTable));
+    if (!table) return NULL;
+    size_t entries = ((size_t)1 << HELD_KARP_MAX_NODES) * HELD_KARP_MAX_NODES;
+    table->dp = (double*)malloc(entries * sizeof(double));
+    table->parent = (signed char*)malloc(entries * sizeof(signed char));
+    if (!table->dp || !table->parent) {
+        held_karp_table_destroy(table);
+        return NULL;
+    }
+    return table;
+}
+
+void held_karp_table_destroy(HeldKarpTable* table) {
+    if (!table) return;
+    free(table->dp);
+    free(table->parent);
+    free(table);
+}
+
+int held_karp_table_get_size(const HeldKarpTable* table) {
+    return table ? table->size : 0;
+}
+
+void held_karp_table_clear(HeldKarpTable* table) {
+    if (table) table->size = 0;
+}
+
+bool held_karp_table_extend(HeldKarpTable* table, const double* cost, int stride, const SolveControl* control) {
+    if (!table || table->size >= HELD_KARP_MAX_NODES) return false;
+    const int M = HELD_KARP_MAX_NODES;
+    int k = table->size; // 新点的编号
+
+    if (k == 0) {
+        // 起点是0号点，只访问自己的成本是0 (mask=1)
+        table->dp[1 * M + 0] = 0.0;
+        table->parent[1 * M + 0] = -1;
+        table->size = 1;
+        return true;
+    }
+
+    // 只计算包含新点k的子集，即 mask ∈ [2^k, 2^(k+1))。按升序计算，
+    // dp[mask][v] = min_u dp[mask \ {v}][u] + cost[u][v]，其中 mask \ {v} 要么不含k（旧结果），
+    // 要么比mask小（本轮已计算）。
+    int first_mask = 1 << k;
+    int end_mask = 1 << (k + 1);
+    for (int mask = first_mask; mask < end_mask; mask++) {
+        if ((mask - first_mask) % SOLVE_CONTROL_CHECK_INTERVAL == 0 && solve_control_should_stop(control)) return false;
+        double* row = &table->dp[(size_t)mask * M];
+        signed char* parent_row = &table->parent[(size_t)mask * M];
+        for (int v = 0; v <= k; v++) {
+            row[v] = DBL_MAX;
+            parent_row[v] = -1;
+        }
+        if (!(mask & 1)) continue; // 所有路线都从0号点出发
+
+        for (int v = 1; v <= k; v++) {
+            if (!(mask & (1 << v))) continue;
+            int prev_mask = mask ^ (1 << v);
+            const double* prev_row = &table->dp[(size_t)prev_mask * M];
+            for (int u = 0; u <= k; u++) {
+                if (!(prev_mask & (1 << u)) || prev_row[u] == DBL_MAX) continue;
+                double edge = cost[u * stride + v];
+                if (edge == DBL_MAX) continue;
+                if (prev_row[u] + edge < row[v]) {
+                    row[v] = prev_row[u] + edge;
+                    parent_row[v] = (signed char)u;
+                }
+            }
+        }
+    }
+    table->size = k + 1;
+    return true;
+}
+
+bool held_karp_table_remove(HeldKarpTable* table, int index) {
+    if (!table || index <= 0 || index >= table->size) return false;
+    const int M = HELD_KARP_MAX_NODES;
+    int n = table->size;
+    int low_mask = (1 << index) - 1;
+
+    // 新子集 m' 对应的旧子集是在第index位插入一个0。旧子集编号总是不小于新编号，
+    // 因此按升序原地搬移不会覆盖尚未读取的数据。
+    for (int new_mask = 0; new_mask < (1 << (n - 1)); new_mask++) {
+        int old_mask = (new_mask & low_mask) | ((new_mask & ~low_mask) << 1);
+        for (int new_v = 0; new_v < n - 1; new_v++) {
+            int old_v = new_v < index ? new_v : new_v + 1;
+            size_t from = (size_t)old_mask * M + old_v;
+            size_t to = (size_t)new_mask * M + new_v;
+            int p = table->parent[from];
+            table->dp[to] = table->dp[from];
+            table->parent[to] = (signed char)(p > index ? p - 1 : p);
+        }
+    }
+    table->size = n - 1;
+    return true;
+}
+
+double held_karp_table_best_tour(const HeldKarpTable* table, const double* cost, int stride, int* out_order) {
+    if (!table || table->size == 0) return DBL_MAX;
+    const int M = HELD_KARP_MAX_NODES;
+    int n = table->size;
+    if (n == 1) {
+        out_order[0] = 0;
+        return 0.0;
+    }
+
+    // 遍历所有可能的终点v，计算 (访问所有点并停在v的成本 + 从v返回起点的成本) 的最小值
+    int full_mask = (1 << n) - 1;
+    double best = DBL_MAX;
+    int tour_end = -1;
+    for (int v = 1; v < n; v++) {
+        double dp = table->dp[(size_t)full_mask * M + v];
+        double back = cost[v * stride + 0];
+        if (dp == DBL_MAX || back == DBL_MAX) continue;
+        if (dp + back < best) {
+            best = dp + back;
+            tour_end = v;
+        }
+    }
+    if (tour_end == -1) return DBL_MAX;
+
+    // 从终点沿前驱回溯
+    int mask = full_mask;
+    int current = tour_end;
+    for (int pos = n - 1; pos >= 1; pos--) {
+        out_order[pos] = current;
+        int prev = table->parent[(size_t)mask * M + current];
+        mask ^= (1 << current);
+        current = prev;
+    }
+    out_order[0] = 0;
+    return best;
+}
+
+/**
+ * @brief 读取成本矩阵中的一条边，不可达时返回惩罚值。
+ */
+static double edge_cost(const double* cost, int stride, int from, int to) {
+    double c = cost[from * stride + to];
+    return c == DBL_MAX ? UNREACHABLE_PENALTY : c;
+}
+
+double tsp_tour_cost(const double* cost, int stride, const int* order, int len) {
+    double total = 0.0;
+    for (int i = 0; i < len && len > 1; i++) {
+        double c = cost[order[i] * stride + order[(i + 1) % len]];
+        if (c == DBL_MAX) return DBL_MAX;
+        total += c;
+    }
+    return total;
+}
+
+void tsp_cheapest_insertion(const double* cost, int stride, int* order, int* len, int new_index) {
+    int n = *len;
+    if (n == 0) {
+        order[0] = new_index;
+        *len = 1;
+        return;
+    }
+
+    // 找到插入后成本增加最少的边 (order[p], order[p+1])
+    int best_pos = 0;
+    double best_delta = DBL_MAX;
+    for (int p = 0; p < n; p++) {
+        int a = order[p];
+        int b = order[(p + 1) % n];
+        double delta = edge_cost(cost, stride, a, new_index) + edge_cost(cost, stride, new_index, b) -
+                       (n > 1 ? edge_cost(cost, stride, a, b) : 0.0);
+        if (delta < best_delta) {
+            best_delta = delta;
+            best_pos = p;
+        }
+    }
+    memmove(&order[best_pos + 2], &order[best_pos + 1], (n - best_pos - 1) * sizeof(int));
+    order[best_pos + 1] = new_index;
+    *len = n + 1;
+}
+
+/**
+ * @brief 计算沿环路方向和逆方向的前缀成本和，用于 O(1) 计算 2-opt 的增量。
+ * @details forward[t] = Σ_{k<t} cost(order[k], order[k+1])，backward[t] = Σ_{k<t} cost(order[k+1], order[k])。
+ */
+static void compute_prefix_costs(const double* cost, int stride, const int* order, int len, double* forward, double* backward) {
+    forward[0] = 0.0;
+    backward[0] = 0.0;
+    for (int t = 0; t + 1 < len; t++) {
+        forward[t + 1] = forward[t] + edge_cost(cost, stride, order[t], order[t + 1]);
+        backward[t + 1] = backward[t] + edge_cost(cost, stride, order[t + 1], order[t]);
+    }
+}
+
+/**
+ * @brief 执行一次首次改进的 2-opt 扫描：反转片段 order[i..j]。
+ * @details 环路模式下最后一个点之后接回 order[0]；路径模式下 order[len-1] 是固定的终点，不参与反转。
+ * @return bool 找到并应用了一次改进时返回true。
+ */
+static bool two_opt_pass(const double* cost, int stride, int* order, int len, bool closed, double* forward, double* backward) {
+    compute_prefix_costs(cost, stride, order, len, forward, backward);
+    int last_movable = closed ? len - 1 : len - 2;
+    for (int i = 1; i < last_movable; i++) {
+        int prev = order[i - 1];
+        for (int j = i + 1; j <= last_movable; j++) {
+            int next = order[(j + 1) % len];
+            double delta = edge_cost(cost, stride, prev, order[j]) + edge_cost(cost, stride, order[i], next) -
+                           edge_cost(cost, stride, prev, order[i]) - edge_cost(cost, stride, order[j], next) +
+                           (backward[j] - backward[i]) - (forward[j] - forward[i]);
+            if (delta < -IMPROVEMENT_EPSILON) {
+                for (int a = i, b = j; a < b; a++, b--) {
+                    int tmp = order[a];
+                    order[a] = order[b];
+                    order[b] = tmp;
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 执行一次首次改进的 Or-opt 扫描：把长度为1到3的片段（不反转）移动到另一条边上。
+ * @details 环路模式下最后一个点之后接回 order[0]；路径模式下 order[len-1] 是固定的终点。
+ * @return bool 找到并应用了一次改进时返回true。
+ */
+static bool or_opt_pass(const double* cost, int stride, int* order, int len, bool closed, int* scratch) {
+    int last_movable = closed ? len - 1 : len - 2;
+    int num_edges = closed ? len : len - 1;
+    for (int seg_len = 1; seg_len <= OR_OPT_MAX_SEGMENT && seg_len < last_movable; seg_len++) {
+        for (int i = 1; i + seg_len - 1 <= last_movable; i++) {
+            int p = order[i - 1];
+            int s = order[i];
+            int e = order[i + seg_len - 1];
+            int q = order[(i + seg_len) % len];
+            double removal_gain = edge_cost(cost, stride, p, s) + edge_cost(cost, stride, e, q) - edge_cost(cost, stride, p, q);
+
+            for (int j = 0; j < num_edges; j++) {
+                if (j >= i - 1 && j <= i + seg_len - 1) continue; // 插入边不能与片段相邻
+                int a = order[j];
+                int b = order[(j + 1) % len];
+                double delta = edge_cost(cost, stride, a, s) + edge_cost(cost, stride, e, b) - edge_cost(cost, stride, a, b) - removal_gain;
+                if (delta < -IMPROVEMENT_EPSILON) {
+                    // 先取出片段，再把它放到 a 之后
+                    int n = 0;
+                    for (int k = 0; k < len; k++) {
+                        if (k >= i && k < i + seg_len) continue;
+                        scratch[n++] = order[k];
+                        if (k == j) {
+                            for (int t = 0; t < seg_len; t++) scratch[n++] = order[i + t];
+                        }
+                    }
+                    memcpy(order, scratch, len * sizeof(int));
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 交替执行 2-opt 和 Or-opt，直到两种邻域都找不到更优的解。
+ */
+static void improve_order(const double* cost, int stride, int* order, int len, bool closed) {
+    double* forward = (double*)malloc(len * sizeof(double));
+    double* backward = (double*)malloc(len * sizeof(double));
+    int* scratch = (int*)malloc(len * sizeof(int));
+    if (forward && backward && scratch) {
+        while (two_opt_pass(cost, stride, order, len, closed, forward, backward) ||
+               or_opt_pass(cost, stride, order, len, closed, scratch)) {
+            // 持续改进
+        }
+    }
+    free(forward);
+    free(backward);
+    free(scratch);
+}
+
+void tsp_improve_tour(const double* cost, int stride, int* order, int len) {
+    if (len < 3) return;
+    improve_order(cost, stride, order, len, true);
+}
+
+void tsp_improve_path(const double* cost, int stride, int* order, int len) {
+    if (len < 4) return; // 至少要有两个可移动的中间点
+    improve_order(cost, stride, order, len, false);
+}
+
+double tsp_solve_matrix(const double* cost, int stride, int n, int* out_order, bool* is_optimal) {
+    if (is_optimal) *is_optimal = false;
+    if (n <= 0) return DBL_MAX;
+
+    if (n <= HELD_KARP_MAX_NODES) {
+        HeldKarpTable* table = held_karp_table_create();
+        double best = DBL_MAX;
+        if (table) {
+            for (int k = 0; k < n; k++) held_karp_table_extend(table, cost, stride, NULL);
+            best = held_karp_table_best_tour(table, cost, stride, out_order);
+            held_karp_table_destroy(table);
+        }
+        if (best != DBL_MAX) {
+            if (is_optimal) *is_optimal = true;
+            return best;
+        }
+    }
+
+    // 点数较多（或精确解不可行）：逐个做最廉价插入，再做局部搜索
+    int len = 0;
+    for (int k = 0; k < n; k++) tsp_cheapest_insertion(cost, stride, out_order, &len, k);
+    tsp_improve_tour(cost, stride, out_order, n);
+    return tsp_tour_cost(cost, stride, out_order, n);
+}
@@ -1,4 +1,6 @@
 #include "utils.h"
+#include <string.h>
+#include <time.h>
 
 // mode_to_string 函数的实现
 const char* mode_to_string(TransportMode mode) {
@@ -20,4 +22,56 @@ const char* mode_to_string_cn(TransportMode mode) {
         case BUS: return "公交";
         default: return "未知";
     }
-} 
\ No newline at end of file
+} 
+
+// mode_from_string 函数的实现
+int mode_from_string(const char* name) {
+    if (!name) return -1;
+    for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+        if (strcmp(name, mode_to_string((TransportMode)m)) == 0) return m;
+    }
+    return -1;
+}
+
+// mode_mask_from_string 函数的实现
+bool mode_mask_from_string(const char* names, TransportModeMask* mask) {
+    if (!names || !mask) return false;
+    TransportModeMask result = 0;
+    // 每个逗号之后都必须还有一个名称：空列表、开头、结尾或连续的逗号都视为错误
+    for (const char* p = names;; p++) {
+        const char* end = strchr(p, ',');
+        size_t length = end ? (size_t)(end - p) : strlen(p);
+        char name[32];
+        if (length == 0 || length >= sizeof(name)) return false;
+        memcpy(name, p, length);
+        name[length] = '\0';
+        if (strcmp(name, "all") == 0) {
+            result |= TRANSPORT_MODE_ALL;
+        } else {
+            int mode = mode_from_string(name);
+            if (mode < 0) return false;
+            result |= TRANSPORT_MODE_BIT(mode);
+        }
+        if (!end) break;
+        p = end;
+    }
+    *mask = result;
+    return true;
+}
+
+// mode_mask_expand 函数的实现
+int mode_mask_expand(TransportModeMask mask, TransportMode* modes) {
+    if (mask == 0) mask = TRANSPORT_MODE_ALL;
+    int count = 0;
+    for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+        if (mask & TRANSPORT_MODE_BIT(m)) modes[count++] = (TransportMode)m;
+    }
+    return count;
+}
+
+// monotonic_time_seconds 函数的实现
+double monotonic_time_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
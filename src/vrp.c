@@ -0,0 +1,641 @@
+/**
+ * @file vrp.c
+ * @brief 实现了多旅行者路径规划的并行大邻域搜索。
+ */
+#include "vrp.h"
+#include "pathfinding.h"
+#include "thread_pool.h"
+#include "tsp_matrix.h"
+#include "utils.h"
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 均衡目标下总成本的次要权重，用于在最长路线相同的解之间选择总成本更低的
+#define BALANCE_TIE_WEIGHT 1e-3
+
+// 每隔多少次迭代与共享最优解同步一次并报告进度
+#define SYNC_INTERVAL 100
+
+// 每次破坏最多移除的途经点数
+#define MAX_DESTROY 30
+
+// 破坏时最多移除的途经点比例
+#define DESTROY_FRACTION 0.4
+
+// 按排序选择被移除点时的随机化指数，越大越偏向排在前面的点
+#define SELECTION_POWER 3.0
+
+// 模拟退火的初始温度（相对初始目标值）和最终温度（相对初始温度）
+#define INITIAL_TEMPERATURE_RATIO 0.01
+#define FINAL_TEMPERATURE_RATIO 0.001
+
+// 判断改进的最小幅度，避免浮点误差
+#define IMPROVEMENT_EPSILON 1e-12
+
+/**
+ * @brief 一个完整的分配方案。每条路线都以起点（0号点）开头。
+ */
+typedef struct {
+    int* stops;         // stops[r * n + k]：第r条路线的第k个点，k=0 固定为起点
+    int* lengths;       // 每条路线的点数（含起点），只含起点表示该旅行者不出行
+    double* costs;      // 每条路线的环路成本
+} Solution;
+
+/**
+ * @brief 所有搜索线程共享的上下文。
+ */
+typedef struct {
+    const double* cost;         // n × n 成本矩阵
+    int n;                      // 点数（含起点）
+    int m;                      // 旅行者数量
+    int capacity;               // 每条路线最多的途经点数（不含起点）
+    VrpObjective objective;
+    int iterations;
+    unsigned int seed;
+    double start_time;
+    double deadline;            // 0表示不限时
+    const SolveControl* control;
+
+    pthread_mutex_t mutex;      // 保护共享最优解、迭代计数和进度回调
+    Solution best;
+    double best_objective;
+    long long completed_iterations;
+    long long total_iterations;
+} VrpContext;
+
+/**
+ * @brief 构建成本矩阵时共享的上下文。
+ */
+typedef struct {
+    const TrafficNetwork* network;
+    const int* stop_nodes;
+    int n;
+    double* cost;
+    double time_weight;
+    double cost_weight;
+    const SolveControl* control;
+    pthread_mutex_t mutex;
+    int completed;
+    int failed;
+} VrpMatrixContext;
+
+/**
+ * @brief 一个插入位置。
+ */
+typedef struct {
+    int route;
+    int pos;
+    double delta;       // 该路线成本的增量
+    double score;       // 插入后的目标值
+} Insertion;
+
+void vrp_default_options(VrpOptions* options) {
+    if (!options) return;
+    options->num_travellers = 2;
+    options->max_stops_per_route = 0;
+    options->objective = VRP_MINIMIZE_TOTAL;
+    options->num_threads = 0;
+    options->iterations = 2000;
+    options->time_limit_ms = 10000.0;
+    options->seed = 12345u;
+}
+
+/**
+ * @brief xorshift32 伪随机数生成器。
+ */
+static unsigned int next_random(unsigned int* state) {
+    unsigned int x = *state ? *state : 0x9E3779B9u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * @brief 返回 [0, 1) 内的均匀随机数。
+ */
+static double next_uniform(unsigned int* state) {
+    return next_random(state) / 4294967296.0;
+}
+
+static bool solution_init(const VrpContext* ctx, Solution* sol) {
+    sol->stops = (int*)malloc(ctx->m * ctx->n * sizeof(int));
+    sol->lengths = (int*)malloc(ctx->m * sizeof(int));
+    sol->costs = (double*)malloc(ctx->m * sizeof(double));
+    if (!sol->stops || !sol->lengths || !sol->costs) return false;
+    for (int r = 0; r < ctx->m; r++) {
+        sol->stops[r * ctx->n] = 0;
+        sol->lengths[r] = 1;
+        sol->costs[r] = 0.0;
+    }
+    return true;
+}
+
+static void solution_free(Solution* sol) {
+    free(sol->stops);
+    free(sol->lengths);
+    free(sol->costs);
+}
+
+static void solution_copy(const VrpContext* ctx, Solution* dst, const Solution* src) {
+    memcpy(dst->stops, src->stops, ctx->m * ctx->n * sizeof(int));
+    memcpy(dst->lengths, src->lengths, ctx->m * sizeof(int));
+    memcpy(dst->costs, src->costs, ctx->m * sizeof(double));
+}
+
+static double route_cost(const VrpContext* ctx, const Solution* sol, int r) {
+    if (sol->lengths[r] <= 1) return 0.0;
+    return tsp_tour_cost(ctx->cost, ctx->n, sol->stops + r * ctx->n, sol->lengths[r]);
+}
+
+/**
+ * @brief 计算方案的目标值。
+ */
+static double objective_value(const VrpContext* ctx, const Solution* sol) {
+    double total = 0.0, longest = 0.0;
+    for (int r = 0; r < ctx->m; r++) {
+        if (sol->costs[r] == DBL_MAX) return DBL_MAX;
+        total += sol->costs[r];
+        if (sol->costs[r] > longest) longest = sol->costs[r];
+    }
+    return ctx->objective == VRP_MINIMIZE_MAX_ROUTE ? longest + BALANCE_TIE_WEIGHT * total : total;
+}
+
+/**
+ * @brief 为一个点找到插入后目标值最低的位置，以及在另一条路线上的次优位置（用于后悔值）。
+ * @return bool 存在可行位置时返回true。
+ */
+static bool find_insertion(const VrpContext* ctx, const Solution* sol, int v, Insertion* best, Insertion* second) {
+    const double* cost = ctx->cost;
+    int n = ctx->n;
+    double total = 0.0, top1 = 0.0, top2 = 0.0;
+    int top1_route = -1;
+    for (int r = 0; r < ctx->m; r++) {
+        total += sol->costs[r];
+        if (top1_route == -1 || sol->costs[r] > top1) {
+            top2 = top1;
+            top1 = sol->costs[r];
+            top1_route = r;
+        } else if (sol->costs[r] > top2) {
+            top2 = sol->costs[r];
+        }
+    }
+
+    best->route = second->route = -1;
+    best->score = second->score = DBL_MAX;
+    for (int r = 0; r < ctx->m; r++) {
+        int len = sol->lengths[r];
+        if (len - 1 >= ctx->capacity) continue;
+        const int* route = sol->stops + r * n;
+        double route_delta = DBL_MAX;
+        int route_pos = -1;
+        for (int p = 1; p <= len; p++) {
+            int a = route[p - 1];
+            int b = route[p % len];
+            double to = cost[a * n + v], back = cost[v * n + b];
+            if (to == DBL_MAX || back == DBL_MAX) continue;
+            double delta = to + back - cost[a * n + b];
+            if (delta < route_delta) {
+                route_delta = delta;
+                route_pos = p;
+            }
+        }
+        if (route_pos < 0) continue;
+
+        double score;
+        if (ctx->objective == VRP_MINIMIZE_MAX_ROUTE) {
+            double others = (r == top1_route) ? top2 : top1;
+            double updated = sol->costs[r] + route_delta;
+            score = (updated > others ? updated : others) + BALANCE_TIE_WEIGHT * (total + route_delta);
+        } else {
+            score = total + route_delta;
+        }
+        if (score < best->score) {
+            *second = *best;
+            best->route = r;
+            best->pos = route_pos;
+            best->delta = route_delta;
+            best->score = score;
+        } else if (score < second->score) {
+            second->route = r;
+            second->pos = route_pos;
+            second->delta = route_delta;
+            second->score = score;
+        }
+    }
+    return best->route >= 0;
+}
+
+static void insert_stop(const VrpContext* ctx, Solution* sol, const Insertion* at, int v) {
+    int* route = sol->stops + at->route * ctx->n;
+    int len = sol->lengths[at->route];
+    memmove(route + at->pos + 1, route + at->pos, (len - at->pos) * sizeof(int));
+    route[at->pos] = v;
+    sol->lengths[at->route]++;
+    sol->costs[at->route] += at->delta;
+}
+
+/**
+ * @brief 从方案中移除一个点。
+ */
+static void remove_stop(const VrpContext* ctx, Solution* sol, int v, bool* touched) {
+    for (int r = 0; r < ctx->m; r++) {
+        int* route = sol->stops + r * ctx->n;
+        int len = sol->lengths[r];
+        for (int p = 1; p < len; p++) {
+            if (route[p] != v) continue;
+            memmove(route + p, route + p + 1, (len - p - 1) * sizeof(int));
+            sol->lengths[r]--;
+            sol->costs[r] = route_cost(ctx, sol, r);
+            touched[r] = true;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 后悔值插入：每次插入 "最优与次优位置之差" 最大的点，避免把难以安置的点留到最后。
+ */
+static bool repair_regret(const VrpContext* ctx, Solution* sol, int* pending, int count, bool* touched) {
+    while (count > 0) {
+        int chosen = -1;
+        double chosen_regret = -1.0;
+        Insertion chosen_at;
+        for (int i = 0; i < count; i++) {
+            Insertion best, second;
+            if (!find_insertion(ctx, sol, pending[i], &best, &second)) return false;
+            double regret = second.route < 0 ? DBL_MAX : second.score - best.score;
+            if (chosen < 0 || regret > chosen_regret || (regret == chosen_regret && best.score < chosen_at.score)) {
+                chosen = i;
+                chosen_regret = regret;
+                chosen_at = best;
+            }
+        }
+        insert_stop(ctx, sol, &chosen_at, pending[chosen]);
+        touched[chosen_at.route] = true;
+        pending[chosen] = pending[--count];
+    }
+    return true;
+}
+
+/**
+ * @brief 贪心插入：按随机顺序把每个点插入到当前最优的位置。
+ */
+static bool repair_greedy(const VrpContext* ctx, Solution* sol, int* pending, int count, bool* touched, unsigned int* rng) {
+    for (int i = count - 1; i > 0; i--) {
+        int j = next_random(rng) % (i + 1);
+        int tmp = pending[i]; pending[i] = pending[j]; pending[j] = tmp;
+    }
+    for (int i = 0; i < count; i++) {
+        Insertion best, second;
+        if (!find_insertion(ctx, sol, pending[i], &best, &second)) return false;
+        insert_stop(ctx, sol, &best, pending[i]);
+        touched[best.route] = true;
+    }
+    return true;
+}
+
+/**
+ * @brief 排序用的键值对。
+ */
+typedef struct {
+    double key;
+    int stop;
+} RankedStop;
+
+static int compare_ranked(const void* a, const void* b) {
+    double lhs = ((const RankedStop*)a)->key;
+    double rhs = ((const RankedStop*)b)->key;
+    return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+/**
+ * @brief 破坏：随机选择一种移除方式（随机、最差、相关），移除若干个点。
+ * @details 三种方式都先给每个点一个键值并排序，再以偏向前端的随机方式逐个选出被移除的点。
+ *          - 随机移除：键值为随机数；
+ *          - 最差移除：键值为负的节省量（移除后路线成本下降越多越靠前）；
+ *          - 相关移除：键值为到一个随机种子点的成本，一次移除彼此接近的一组点，便于在路线之间交换。
+ * @return int 被移除的点数，被移除的点写入 removed。
+ */
+static int destroy(const VrpContext* ctx, Solution* sol, int* removed, RankedStop* ranked, bool* touched, unsigned int* rng) {
+    const double* cost = ctx->cost;
+    int n = ctx->n;
+    int limit = (int)((n - 1) * DESTROY_FRACTION);
+    if (limit > MAX_DESTROY) limit = MAX_DESTROY;
+    if (limit < 1) limit = 1;
+    int q = 1 + next_random(rng) % limit;
+    int op = next_random(rng) % 3;
+    int seed_stop = 1 + next_random(rng) % (n - 1);
+
+    int count = 0;
+    for (int r = 0; r < ctx->m; r++) {
+        const int* route = sol->stops + r * n;
+        int len = sol->lengths[r];
+        for (int p = 1; p < len; p++) {
+            int v = route[p];
+            double key;
+            if (op == 0) {
+                key = next_uniform(rng);
+            } else if (op == 1) {
+                int a = route[p - 1], b = route[(p + 1) % len];
+                key = -(cost[a * n + v] + cost[v * n + b] - cost[a * n + b]);
+            } else {
+                double forward = cost[seed_stop * n + v], backward = cost[v * n + seed_stop];
+                key = v == seed_stop ? -1.0 : (forward < backward ? forward : backward);
+            }
+            ranked[count].key = key;
+            ranked[count].stop = v;
+            count++;
+        }
+    }
+    qsort(ranked, count, sizeof(RankedStop), compare_ranked);
+
+    if (q > count) q = count;
+    for (int i = 0; i < q; i++) {
+        int idx = (int)(pow(next_uniform(rng), SELECTION_POWER) * count);
+        removed[i] = ranked[idx].stop;
+        memmove(ranked + idx, ranked + idx + 1, (count - idx - 1) * sizeof(RankedStop));
+        count--;
+        remove_stop(ctx, sol, removed[i], touched);
+    }
+    return q;
+}
+
+/**
+ * @brief 用 2-opt/Or-opt 改进被修改过的路线。
+ */
+static void improve_touched(const VrpContext* ctx, Solution* sol, const bool* touched) {
+    for (int r = 0; r < ctx->m; r++) {
+        if (!touched[r]) continue;
+        tsp_improve_tour(ctx->cost, ctx->n, sol->stops + r * ctx->n, sol->lengths[r]);
+        sol->costs[r] = route_cost(ctx, sol, r);
+    }
+}
+
+static bool should_stop(const VrpContext* ctx) {
+    return (ctx->deadline > 0 && monotonic_time_seconds() > ctx->deadline) || solve_control_should_stop(ctx->control);
+}
+
+/**
+ * @brief parallel_for 的任务项：一个独立的大邻域搜索线程。
+ */
+static void search_thread(int index, int worker_id, void* context) {
+    (void)worker_id;
+    VrpContext* ctx = (VrpContext*)context;
+    unsigned int rng = ctx->seed ^ (0x9E3779B9u * (unsigned int)(index + 1));
+    Solution current, candidate;
+    memset(&current, 0, sizeof(current));
+    memset(&candidate, 0, sizeof(candidate));
+    int* removed = (int*)malloc(ctx->n * sizeof(int));
+    RankedStop* ranked = (RankedStop*)malloc(ctx->n * sizeof(RankedStop));
+    bool* touched = (bool*)malloc(ctx->m * sizeof(bool));
+    if (!removed || !ranked || !touched || !solution_init(ctx, &current) || !solution_init(ctx, &candidate)) goto cleanup;
+
+    pthread_mutex_lock(&ctx->mutex);
+    solution_copy(ctx, &current, &ctx->best);
+    double current_objective = ctx->best_objective;
+    pthread_mutex_unlock(&ctx->mutex);
+
+    double initial_temperature = INITIAL_TEMPERATURE_RATIO * current_objective;
+    for (int it = 0; it < ctx->iterations; it++) {
+        if (should_stop(ctx)) break;
+
+        // 破坏并修复当前解的一个副本
+        solution_copy(ctx, &candidate, &current);
+        memset(touched, 0, ctx->m * sizeof(bool));
+        int count = destroy(ctx, &candidate, removed, ranked, touched, &rng);
+        bool repaired = (next_random(&rng) & 1) ? repair_regret(ctx, &candidate, removed, count, touched)
+                                                : repair_greedy(ctx, &candidate, removed, count, touched, &rng);
+        if (repaired) {
+            improve_touched(ctx, &candidate, touched);
+            double objective = objective_value(ctx, &candidate);
+
+            // 比共享最优解更好时立即发布
+            pthread_mutex_lock(&ctx->mutex);
+            if (objective < ctx->best_objective - IMPROVEMENT_EPSILON) {
+                solution_copy(ctx, &ctx->best, &candidate);
+                ctx->best_objective = objective;
+            }
+            pthread_mutex_unlock(&ctx->mutex);
+
+            // 模拟退火接受准则，温度按迭代进度几何下降
+            double temperature = initial_temperature * pow(FINAL_TEMPERATURE_RATIO, (double)it / ctx->iterations);
+            bool accept = objective < current_objective - IMPROVEMENT_EPSILON ||
+                          (temperature > 0 && objective != DBL_MAX && next_uniform(&rng) < exp((current_objective - objective) / temperature));
+            if (accept) {
+                Solution tmp = current;
+                current = candidate;
+                candidate = tmp;
+                current_objective = objective;
+            }
+        }
+
+        // 定期同步：共享最优解明显更好时从它重新出发，并报告进度
+        if ((it + 1) % SYNC_INTERVAL == 0 || it + 1 == ctx->iterations) {
+            pthread_mutex_lock(&ctx->mutex);
+            if (ctx->best_objective < current_objective - IMPROVEMENT_EPSILON) {
+                solution_copy(ctx, &current, &ctx->best);
+                current_objective = ctx->best_objective;
+            }
+            ctx->completed_iterations += (it + 1) % SYNC_INTERVAL == 0 ? SYNC_INTERVAL : (it + 1) % SYNC_INTERVAL;
+            double fraction = (double)ctx->completed_iterations / ctx->total_iterations;
+            if (ctx->deadline > 0) {
+                double elapsed = (monotonic_time_seconds() - ctx->start_time) / (ctx->deadline - ctx->start_time);
+                if (elapsed > fraction) fraction = elapsed < 1.0 ? elapsed : 1.0;
+            }
+            solve_control_report_progress(ctx->control, "search", fraction);
+            pthread_mutex_unlock(&ctx->mutex);
+        }
+    }
+
+cleanup:
+    solution_free(&current);
+    solution_free(&candidate);
+    free(removed);
+    free(ranked);
+    free(touched);
+}
+
+/**
+ * @brief parallel_for 的任务项：计算成本矩阵的一行。
+ */
+static void compute_matrix_row(int index, int worker_id, void* context) {
+    (void)worker_id;
+    VrpMatrixContext* ctx = (VrpMatrixContext*)context;
+    ShortestPathTree* tree = solve_control_should_stop(ctx->control) ? NULL :
+        compute_shortest_path_tree(ctx->network, ctx->stop_nodes[index], ctx->time_weight, ctx->cost_weight, ctx->control);
+    for (int j = 0; j < ctx->n && tree; j++) {
+        ctx->cost[index * ctx->n + j] = (index == j) ? 0.0 : shortest_path_tree_get_cost(tree, ctx->stop_nodes[j]);
+    }
+    free_shortest_path_tree(tree);
+
+    pthread_mutex_lock(&ctx->mutex);
+    if (!tree) ctx->failed = 1;
+    ctx->completed++;
+    solve_control_report_progress(ctx->control, "cost_matrix", (double)ctx->completed / ctx->n);
+    pthread_mutex_unlock(&ctx->mutex);
+}
+
+/**
+ * @brief 把最优方案转换为结果，并计算每名旅行者的完整路线。
+ */
+static VrpResult* build_result(const TrafficNetwork* network, const VrpContext* ctx, const int* stop_nodes,
+                               double time_weight, double cost_weight) {
+    VrpResult* result = (VrpResult*)calloc(1, sizeof(VrpResult));
+    if (!result) return NULL;
+    int m = ctx->m, n = ctx->n;
+    result->num_routes = m;
+    result->stop_ids = (int**)calloc(m, sizeof(int*));
+    result->stop_counts = (int*)calloc(m, sizeof(int));
+    result->routes = (RoutePath**)calloc(m, sizeof(RoutePath*));
+    result->route_costs = (double*)calloc(m, sizeof(double));
+    int* sequence = (int*)malloc((n + 1) * sizeof(int));
+    if (!result->stop_ids || !result->stop_counts || !result->routes || !result->route_costs || !sequence) goto fail;
+
+    // 路段的进度由本函数按路线汇总报告，内部调用只传递取消令牌
+    SolveControl legs_control = { ctx->control ? ctx->control->cancel_token : NULL, NULL, NULL };
+    for (int r = 0; r < m; r++) {
+        const int* route = ctx->best.stops + r * n;
+        int len = ctx->best.lengths[r];
+        result->route_costs[r] = ctx->best.costs[r];
+        result->total_cost += ctx->best.costs[r];
+        if (ctx->best.costs[r] > result->max_route_cost) result->max_route_cost = ctx->best.costs[r];
+        if (len <= 1) continue;
+
+        result->stop_counts[r] = len - 1;
+        result->stop_ids[r] = (int*)malloc((len - 1) * sizeof(int));
+        if (!result->stop_ids[r]) goto fail;
+        for (int p = 0; p < len; p++) {
+            sequence[p] = stop_nodes[route[p]];
+            if (p > 0) result->stop_ids[r][p - 1] = stop_nodes[route[p]];
+        }
+        sequence[len] = stop_nodes[0];
+        result->routes[r] = find_sequential_path_ex(network, sequence, len + 1, time_weight, cost_weight, NULL, &legs_control);
+        if (!result->routes[r]) goto fail;
+        solve_control_report_progress(ctx->control, "legs", (double)(r + 1) / m);
+    }
+    free(sequence);
+    return result;
+
+fail:
+    free(sequence);
+    free_vrp_result(result);
+    return NULL;
+}
+
+// 多旅行者路径规划的实现
+VrpResult* solve_vrp(const TrafficNetwork* network, const int* node_ids_to_visit, int num_nodes, double time_weight, double cost_weight,
+                     const VrpOptions* options, const SolveControl* control) {
+    if (!network || !node_ids_to_visit || num_nodes <= 1) return NULL;
+    VrpOptions defaults;
+    if (!options) {
+        vrp_default_options(&defaults);
+        options = &defaults;
+    }
+    if (options->num_travellers < 1 || options->iterations < 0) {
+        fprintf(stderr, "错误: 旅行者数量至少为1，迭代次数不能为负。\n");
+        return NULL;
+    }
+
+    // 去掉重复的途经点（起点始终在最前面）
+    int* stop_nodes = (int*)malloc(num_nodes * sizeof(int));
+    if (!stop_nodes) return NULL;
+    int n = 0;
+    for (int i = 0; i < num_nodes; i++) {
+        if (!traffic_network_get_node_by_id(network, node_ids_to_visit[i])) {
+            fprintf(stderr, "错误: 无效的节点ID %d。\n", node_ids_to_visit[i]);
+            free(stop_nodes);
+            return NULL;
+        }
+        bool duplicate = false;
+        for (int j = 0; j < n && !duplicate; j++) duplicate = stop_nodes[j] == node_ids_to_visit[i];
+        if (!duplicate) stop_nodes[n++] = node_ids_to_visit[i];
+    }
+    int capacity = options->max_stops_per_route > 0 ? options->max_stops_per_route : n - 1;
+    if (n < 2 || (long long)capacity * options->num_travellers < n - 1) {
+        if (n >= 2) fprintf(stderr, "错误: %d名旅行者每人最多%d个途经点，无法覆盖全部%d个途经点。\n", options->num_travellers, capacity, n - 1);
+        free(stop_nodes);
+        return NULL;
+    }
+
+    VrpContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.n = n;
+    ctx.m = options->num_travellers;
+    ctx.capacity = capacity;
+    ctx.objective = options->objective;
+    ctx.iterations = options->iterations;
+    ctx.seed = options->seed;
+    ctx.control = control;
+    pthread_mutex_init(&ctx.mutex, NULL);
+
+    VrpMatrixContext matrix_ctx;
+    memset(&matrix_ctx, 0, sizeof(matrix_ctx));
+    matrix_ctx.network = network;
+    matrix_ctx.stop_nodes = stop_nodes;
+    matrix_ctx.n = n;
+    matrix_ctx.time_weight = time_weight;
+    matrix_ctx.cost_weight = cost_weight;
+    matrix_ctx.control = control;
+    matrix_ctx.cost = (double*)malloc(n * n * sizeof(double));
+    pthread_mutex_init(&matrix_ctx.mutex, NULL);
+    ctx.cost = matrix_ctx.cost;
+
+    int* pending = (int*)malloc(n * sizeof(int));
+    bool* touched = (bool*)calloc(ctx.m, sizeof(bool));
+    VrpResult* result = NULL;
+    if (!matrix_ctx.cost || !pending || !touched || !solution_init(&ctx, &ctx.best)) goto cleanup;
+
+    // 1. 并行构建成本矩阵
+    thread_pool_parallel_for(thread_pool_get_default(), n, compute_matrix_row, &matrix_ctx);
+    if (matrix_ctx.failed || solve_control_should_stop(control)) goto cleanup;
+
+    // 2. 用后悔值插入构造初始解
+    for (int i = 1; i < n; i++) pending[i - 1] = i;
+    if (!repair_regret(&ctx, &ctx.best, pending, n - 1, touched)) {
+        fprintf(stderr, "错误: 找不到覆盖所有途经点的可行分配。\n");
+        goto cleanup;
+    }
+    improve_touched(&ctx, &ctx.best, touched);
+    ctx.best_objective = objective_value(&ctx, &ctx.best);
+
+    // 3. 多个独立线程并行做大邻域搜索，共享最优解
+    int threads = options->num_threads > 0 ? options->num_threads : thread_pool_get_size(thread_pool_get_default());
+    if (threads < 1) threads = 1;
+    ctx.start_time = monotonic_time_seconds();
+    ctx.deadline = options->time_limit_ms > 0 ? ctx.start_time + options->time_limit_ms / 1000.0 : 0.0;
+    ctx.total_iterations = (long long)threads * ctx.iterations;
+    if (n > 2 && ctx.iterations > 0) thread_pool_parallel_for(thread_pool_get_default(), threads, search_thread, &ctx);
+    if (solve_control_should_stop(control)) goto cleanup;
+
+    // 4. 计算每名旅行者的完整路线
+    result = build_result(network, &ctx, stop_nodes, time_weight, cost_weight);
+
+cleanup:
+    pthread_mutex_destroy(&ctx.mutex);
+    pthread_mutex_destroy(&matrix_ctx.mutex);
+    solution_free(&ctx.best);
+    free(matrix_ctx.cost);
+    free(pending);
+    free(touched);
+    free(stop_nodes);
+    return result;
+}
+
+void free_vrp_result(VrpResult* result) {
+    if (!result) return;
+    for (int r = 0; r < result->num_routes; r++) {
+        if (result->stop_ids) free(result->stop_ids[r]);
+        if (result->routes) free_route_path(result->routes[r]);
+    }
+    free(result->stop_ids);
+    free(result->stop_counts);
+    free(result->routes);
+    free(result->route_costs);
+    free(result);
+}
@@ -0,0 +1,27 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+/**
+ * @file check.h
+ * @brief 自动检查程序（tests/test_*.c）共用的断言宏。
+ * @details 检查失败时打印文件名、行号和条件并记录失败，继续执行后面的检查；
+ *          main() 最后返回 CHECK_RESULT()，有任何失败时为非0。检查程序在项目根目录下运行，可以直接读取 data/ 中的文件。
+ */
+
+static int check_failures = 0;
+
+#define CHECK(cond)                                                                  \
+    do {                                                                             \
+        if (!(cond)) {                                                               \
+            fprintf(stderr, "%s:%d: 检查失败: %s\n", __FILE__, __LINE__, #cond);      \
+            check_failures++;                                                        \
+        }                                                                            \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) CHECK(((actual) - (expected)) <= (tolerance) && ((expected) - (actual)) <= (tolerance))
+
+#define CHECK_RESULT() (check_failures == 0 ? (printf("全部检查通过\n"), 0) : (fprintf(stderr, "%d 项检查失败\n", check_failures), 1))
+
+#endif // CHECK_H
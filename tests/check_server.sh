@@ -0,0 +1,123 @@
+#!/bin/sh
+# 服务模式的自动检查：启动 --serve，用压测工具的校验模式（loadgen -v）检查各接口的状态码和响应内容。
+# 之后从二进制快照启动多进程服务，杀掉一个工作进程后检查服务仍然可用，再检查父进程被杀后工作进程随之退出。
+# 用法: tests/check_server.sh 程序路径 压测工具路径，端口可用环境变量 CHECK_PORT 指定（默认18080，多进程服务使用下一个端口）。
+
+PLANNER=${1:-bin/traffic_planner}
+LOADGEN=${2:-bin/loadgen}
+PORT=${CHECK_PORT:-18080}
+
+"$PLANNER" --serve --port "$PORT" --workers 2 >/dev/null 2>&1 &
+SERVER_PID=$!
+SNAPSHOT=
+trap 'kill $SERVER_PID 2>/dev/null; wait $SERVER_PID 2>/dev/null; [ -n "$SNAPSHOT" ] && rm -f "$SNAPSHOT"' EXIT
+
+# 等待服务开始监听
+wait_for_server() {
+    tries=0
+    until "$LOADGEN" -p "$PORT" -c 1 -d 0.1 -v /health >/dev/null 2>&1; do
+        tries=$((tries + 1))
+        if [ $tries -ge 50 ] || ! kill -0 $SERVER_PID 2>/dev/null; then
+            echo "错误: 服务没有在端口 $PORT 上启动" >&2
+            exit 1
+        fi
+        sleep 0.1
+    done
+}
+wait_for_server
+
+FAILED=0
+LOADGEN_FLAGS=
+
+# 用法: expect 状态码 响应中应包含的子串 连接数 请求路径...，变量 LOADGEN_FLAGS 是传给压测工具的其他选项
+expect() {
+    status=$1
+    substring=$2
+    connections=$3
+    shift 3
+    if "$LOADGEN" -p "$PORT" -c "$connections" -d 0.5 -v $LOADGEN_FLAGS -e "$status" -m "$substring" "$@" >/dev/null; then
+        echo "通过: $* -> $status"
+    else
+        echo "失败: $* 应返回 $status 且包含 $substring" >&2
+        FAILED=1
+    fi
+}
+
+expect 200 '"status":"ok"' 1 '/health'
+expect 200 '"segments":[{' 4 '/route?from=0&to=3' '/route?from=3&to=0&time_weight=1&cost_weight=0'
+expect 200 '"mode":"driving"' 1 '/route?from=0&to=3&modes=driving'
+expect 200 '"optimal":true' 2 '/tsp?nodes=0,3,7,12'
+# 超过分支定界上限的TSP分层求解
+expect 200 '"optimal":false' 1 '/tsp?nodes=0,2,4,6,8,10,12,14,16,18,20,22,24,26,28,30,32,34,36,38,40,42,44,46,48,50,52,54,56,58,60,62,64,66,68,70,72,74,76,78,80,82,84,86,88,90,92,94,96,98,100,102,104,106,108,110,112,114,116,118'
+expect 200 '"segments":[{' 2 '/sequential?nodes=0,3,7'
+expect 200 '"costs":[[0,' 2 '/matrix?nodes=0,3,7'
+expect 400 '"error"' 1 '/route?from=0&to=99999' '/route?from=0' '/tsp?nodes=0'
+expect 404 '"error"' 1 '/no_such_endpoint'
+# 许多连接同时请求同一条路线：合并后的每个响应都必须完整
+expect 200 '"total_cost_yuan":' 16 '/route?from=5&to=40'
+# 客户端发送完请求后半关闭写方向：服务仍然回复，回复后关闭连接
+LOADGEN_FLAGS=-s
+expect 200 '"status":"ok"' 2 '/health'
+expect 200 '"segments":[{' 1 '/route?from=0&to=3'
+LOADGEN_FLAGS=
+
+# 从二进制快照启动两个工作进程
+kill $SERVER_PID 2>/dev/null
+wait $SERVER_PID 2>/dev/null
+SNAPSHOT=${TMPDIR:-/tmp}/check_server_$$.snapshot
+printf '17\n4\n' | TRAFFIC_SNAPSHOT="$SNAPSHOT" "$PLANNER" >/dev/null 2>&1
+if [ ! -s "$SNAPSHOT" ]; then
+    echo "错误: 无法保存快照 $SNAPSHOT" >&2
+    exit 1
+fi
+PORT=$((PORT + 1))
+TRAFFIC_SNAPSHOT="$SNAPSHOT" "$PLANNER" --serve --port "$PORT" --workers 1 --processes 2 >/dev/null 2>&1 &
+SERVER_PID=$!
+wait_for_server
+expect 200 '"segments":[{' 4 '/route?from=0&to=3' '/route?from=3&to=0&time_weight=1&cost_weight=0'
+
+# 一个工作进程崩溃后父进程重新启动它，各接口仍然可用
+VICTIM=$(pgrep -P $SERVER_PID | head -n 1)
+if [ -z "$VICTIM" ]; then
+    echo "失败: 找不到工作进程" >&2
+    FAILED=1
+else
+    kill -SEGV "$VICTIM"
+    tries=0
+    until [ "$(pgrep -P $SERVER_PID | grep -cvx "$VICTIM")" -ge 2 ] || [ $tries -ge 50 ]; do
+        tries=$((tries + 1))
+        sleep 0.1
+    done
+    if [ $tries -ge 50 ]; then
+        echo "失败: 工作进程崩溃后没有被重新启动" >&2
+        FAILED=1
+    fi
+fi
+expect 200 '"status":"ok"' 2 '/health'
+expect 200 '"segments":[{' 4 '/route?from=0&to=3' '/route?from=3&to=0&time_weight=1&cost_weight=0'
+expect 200 '"costs":[[0,' 2 '/matrix?nodes=0,3,7'
+
+# 父进程被强制杀掉后工作进程也退出，不再占用端口
+WORKERS=$(pgrep -P $SERVER_PID)
+kill -KILL $SERVER_PID
+wait $SERVER_PID 2>/dev/null
+tries=0
+for worker in $WORKERS; do
+    while kill -0 "$worker" 2>/dev/null && [ $tries -lt 50 ]; do
+        tries=$((tries + 1))
+        sleep 0.1
+    done
+done
+if [ $tries -ge 50 ]; then
+    echo "失败: 父进程退出后工作进程仍在运行" >&2
+    kill $WORKERS 2>/dev/null
+    FAILED=1
+else
+    echo "通过: 父进程退出后工作进程随之退出"
+fi
+
+if [ $FAILED -ne 0 ]; then
+    echo "服务检查失败" >&2
+    exit 1
+fi
+echo "服务检查全部通过"
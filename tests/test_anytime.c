@@ -0,0 +1,94 @@
+/**
+ * @file test_anytime.c
+ * @brief 检查随时可中断的加权A*：任何时间预算下返回的路线都满足报告的 (1+ε) 次优界，不限时时得到与Dijkstra相同的最优解。
+ */
+#include "check.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include <stdlib.h>
+
+#define PAIR_COUNT 15
+
+static double path_cost(const RoutePath* path, double time_weight, double cost_weight) {
+    return calculate_weighted_leg_cost(path->total_time, path->total_cost, time_weight, cost_weight);
+}
+
+/**
+ * @brief 实际满足的次优界只能是初始 ε 逐轮减半得到的值，或者已经收紧到0。
+ */
+static bool is_halving_of(double achieved, double epsilon) {
+    if (achieved == 0.0) return true;
+    for (double e = epsilon; e > 0.0; e /= 2.0) {
+        if (achieved == e) return true;
+    }
+    return false;
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+    int n = traffic_network_get_node_count(network);
+
+    const double epsilons[] = { 0.0, 0.25, 1.0, 3.0 };
+    const double weights[][2] = { { 0.5, 0.5 }, { 1.0, 0.0 } };
+    int suboptimal_results = 0; // 因时间预算耗尽而返回的、成本确实高于最优值的结果数
+    for (size_t w = 0; w < sizeof(weights) / sizeof(weights[0]); w++) {
+        double tw = weights[w][0], cw = weights[w][1];
+        for (int p = 0; p < PAIR_COUNT; p++) {
+            int start = (p * 53 + 7) % n, end = (p * 97 + 61) % n;
+            RoutePath* exact = find_shortest_path(network, start, end, tw, cw);
+            CHECK(exact != NULL);
+            if (!exact) continue;
+            double optimal = path_cost(exact, tw, cw);
+            free_route_path(exact);
+
+            for (size_t e = 0; e < sizeof(epsilons) / sizeof(epsilons[0]); e++) {
+                double epsilon = epsilons[e];
+
+                // 不限时：一定收紧到 ε=0，成本等于Dijkstra的最优值
+                double achieved = -2.0;
+                RoutePath* path = find_shortest_path_anytime(network, start, end, tw, cw, epsilon, 0.0, &achieved);
+                CHECK(path != NULL);
+                CHECK(achieved == 0.0);
+                if (path) CHECK_NEAR(path_cost(path, tw, cw), optimal, 1e-9);
+                free_route_path(path);
+
+                // 逐步放宽时间预算：第一轮完成前返回NULL，之后的结果都满足报告的次优界
+                for (double budget = 0.005; budget < 50.0; budget *= 1.6) {
+                    achieved = -2.0;
+                    path = find_shortest_path_anytime(network, start, end, tw, cw, epsilon, budget, &achieved);
+                    if (!path) {
+                        CHECK(achieved == -1.0);
+                        continue;
+                    }
+                    CHECK(achieved >= 0.0 && achieved <= epsilon);
+                    CHECK(is_halving_of(achieved, epsilon));
+                    CHECK(path_cost(path, tw, cw) <= (1.0 + achieved) * optimal + 1e-9);
+                    CHECK(path_cost(path, tw, cw) >= optimal - 1e-9);
+                    if (path_cost(path, tw, cw) > optimal + 1e-9) suboptimal_results++;
+                    free_route_path(path);
+                    if (achieved == 0.0) break;
+                }
+            }
+        }
+    }
+    // 预算刚够第一轮（ε 最大）时确实会返回次优路线，否则上面的次优界检查就形同虚设
+    CHECK(suboptimal_results > 0);
+
+    // 负的 ε 按0处理；不可达、节点无效时返回NULL且次优界为 -1
+    double achieved = -2.0;
+    RoutePath* path = find_shortest_path_anytime(network, 0, 3, 0.5, 0.5, -1.0, 0.0, &achieved);
+    CHECK(path != NULL);
+    CHECK(achieved == 0.0);
+    free_route_path(path);
+    CHECK(traffic_network_set_node_enabled(network, 3, false));
+    CHECK(find_shortest_path_anytime(network, 0, 3, 0.5, 0.5, 1.0, 0.0, &achieved) == NULL);
+    CHECK(achieved == -1.0);
+    traffic_network_clear_incidents(network);
+    CHECK(find_shortest_path_anytime(network, 0, n, 0.5, 0.5, 1.0, 0.0, &achieved) == NULL);
+    CHECK(achieved == -1.0);
+
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
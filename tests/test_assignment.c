@@ -0,0 +1,49 @@
+/**
+ * @file test_assignment.c
+ * @brief 检查交通分配：样例需求全部分配、收敛，并且每个节点的流量守恒。
+ */
+#include "check.h"
+#include "assignment.h"
+#include "graph.h"
+#include <math.h>
+#include <stdlib.h>
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+    double* demand = assignment_load_demand_csv(network, "data/od_demand.csv");
+    CHECK(demand != NULL);
+    if (!demand) return CHECK_RESULT();
+
+    AssignmentResult* result = solve_traffic_assignment(network, demand, NULL, NULL);
+    CHECK(result != NULL);
+    if (result) {
+        CHECK(result->converged);
+        CHECK(result->unassigned_demand == 0.0);
+
+        // 每个节点：流入 - 流出 = 以它为终点的需求 - 以它为起点的需求
+        int n = traffic_network_get_node_count(network);
+        double* balance = (double*)calloc(n, sizeof(double));
+        if (balance) {
+            for (int i = 0; i < result->link_count; i++) {
+                balance[result->links[i].to_node_id] += result->links[i].flow;
+                balance[result->links[i].from_node_id] -= result->links[i].flow;
+            }
+            for (int o = 0; o < n; o++) {
+                for (int d = 0; d < n; d++) {
+                    if (o == d) continue;
+                    balance[d] -= demand[(size_t)o * n + d];
+                    balance[o] += demand[(size_t)o * n + d];
+                }
+            }
+            for (int v = 0; v < n; v++) CHECK(fabs(balance[v]) < 1e-6 * result->total_demand);
+            free(balance);
+        }
+        free_assignment_result(result);
+    }
+
+    free(demand);
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,176 @@
+/**
+ * @file test_batch_pipeline.c
+ * @brief 检查批量路线规划：多个寻路线程、容量为1的队列下，输出的行序和每行结果都与逐条串行查询相同。
+ */
+#include "batch_pipeline.h"
+#include "check.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include "routing_engine.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INPUT_PATH "bin/tests/batch_input.csv"
+#define OUTPUT_PATH "bin/tests/batch_output.csv"
+#define GENERATED_QUERIES 60
+
+/**
+ * @brief 输入中的一条查询及其期望的状态；status 为NULL时由串行查询决定（ok 或 no_route）。
+ */
+typedef struct {
+    const char* line;
+    const char* from_text;
+    const char* to_text;
+    const char* status;
+} FixtureLine;
+
+static const FixtureLine fixture[] = {
+    { "# 注释行", NULL, NULL, NULL },
+    { "0,3", "0", "3", NULL },
+    { "", NULL, NULL, NULL },
+    { "郑州东站,武汉站,1,0", "郑州东站", "武汉站", NULL },
+    { "   ", NULL, NULL, NULL },
+    { " 武汉站 , 长沙南站 ,0.3,0.7,driving;bus", "武汉站", "长沙南站", NULL },
+    { "0,3,0.5,0.5,flight", "0", "3", NULL },
+    { "0,3,abc,0.5", "0", "3", "invalid" },
+    { "0,3,-1,0.5", "0", "3", "invalid" },
+    { "0,3,0.5", "0", "3", "invalid" },
+    { "0,3,0.5,0.5,walking", "0", "3", "invalid" },
+    { "0", "0", "", "invalid" },
+    { "不存在的地标,0", "不存在的地标", "0", "unknown_node" },
+    { "0,99999", "0", "99999", "unknown_node" },
+};
+
+/**
+ * @brief 按批量输出的格式写出一条查询的期望结果：串行地用同一种引擎逐条查询。
+ */
+static void format_expected(char* buffer, size_t size, const TrafficNetwork* network, const RoutingEngine* engine, long line_number,
+                            const char* line, const char* from_text, const char* to_text, const char* status) {
+    if (status) {
+        snprintf(buffer, size, "%ld,%s,%s,%s,,,,", line_number, from_text, to_text, status);
+        return;
+    }
+    // 与批量输入相同的解析：起点,终点[,时间权重,花费权重[,交通方式]]
+    char copy[256];
+    snprintf(copy, sizeof(copy), "%s", line);
+    char* fields[5];
+    int count = 0;
+    for (char* field = strtok(copy, ","); field && count < 5; field = strtok(NULL, ",")) fields[count++] = field;
+    RouteQueryOptions options = { 0.5, 0.5, NULL, 0 };
+    if (count >= 4) {
+        options.time_weight = atof(fields[2]);
+        options.cost_weight = atof(fields[3]);
+    }
+    if (count == 5) {
+        for (char* c = fields[4]; *c; c++) {
+            if (*c == ';') *c = ',';
+        }
+        CHECK(mode_mask_from_string(fields[4], &options.allowed_modes));
+    }
+    int from = traffic_network_find_node_id_by_name(network, from_text);
+    int to = traffic_network_find_node_id_by_name(network, to_text);
+    if (from < 0) from = atoi(from_text);
+    if (to < 0) to = atoi(to_text);
+
+    const char* from_name = traffic_network_get_node_by_id(network, from)->name;
+    const char* to_name = traffic_network_get_node_by_id(network, to)->name;
+    RoutePath* path = routing_engine_query(engine, from, to, &options, NULL);
+    if (!path) {
+        snprintf(buffer, size, "%ld,%s,%s,no_route,,,,", line_number, from_name, to_name);
+        return;
+    }
+    int length = snprintf(buffer, size, "%ld,%s,%s,ok,%.2f,%.2f,%.2f,%s", line_number, from_name, to_name, path->total_distance,
+                          path->total_time, path->total_cost, from_name);
+    for (const PathSegment* seg = path->segments_head; seg && length < (int)size; seg = seg->next) {
+        length += snprintf(buffer + length, size - length, " -%s-> %s", mode_to_string(seg->mode),
+                           traffic_network_get_node_by_id(network, seg->to_node_id)->name);
+    }
+    free_route_path(path);
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+    int n = traffic_network_get_node_count(network);
+
+    // 固定的各类输入行，之后是不同交通方式限定的普通查询
+    static const char* mode_lists[] = { NULL, "driving;bus", "high_speed_rail;flight" };
+    char generated[GENERATED_QUERIES][64];
+    char generated_from[GENERATED_QUERIES][16], generated_to[GENERATED_QUERIES][16];
+    FILE* input = fopen(INPUT_PATH, "w");
+    CHECK(input != NULL);
+    if (!input) return CHECK_RESULT();
+    int fixture_count = (int)(sizeof(fixture) / sizeof(fixture[0]));
+    for (int i = 0; i < fixture_count; i++) fprintf(input, "%s\n", fixture[i].line);
+    for (int i = 0; i < GENERATED_QUERIES; i++) {
+        snprintf(generated_from[i], sizeof(generated_from[i]), "%d", (i * 7) % n);
+        snprintf(generated_to[i], sizeof(generated_to[i]), "%d", (i * 13 + 5) % n);
+        const char* modes = mode_lists[i % 3];
+        if (modes) snprintf(generated[i], sizeof(generated[i]), "%s,%s,0.5,0.5,%s", generated_from[i], generated_to[i], modes);
+        else snprintf(generated[i], sizeof(generated[i]), "%s,%s", generated_from[i], generated_to[i]);
+        fprintf(input, "%s\n", generated[i]);
+    }
+    fclose(input);
+
+    // 批量规划与串行查询使用同一种引擎，并列最优时选出的路线也相同
+    CHECK(routing_engine_set_override("csr_linear"));
+    BatchOptions options;
+    batch_options_init(&options);
+    options.worker_count = 3;
+    options.queue_capacity = 1;
+    BatchStats stats;
+    CHECK(batch_route_file(network, INPUT_PATH, OUTPUT_PATH, &options, NULL, &stats));
+    RoutingEngine* engine = routing_engine_create(routing_engine_find("csr_linear"), network);
+    CHECK(engine != NULL);
+    routing_engine_set_override(NULL);
+    if (!engine) return CHECK_RESULT();
+
+    FILE* output = fopen(OUTPUT_PATH, "r");
+    CHECK(output != NULL);
+    if (!output) return CHECK_RESULT();
+    char actual[4096], expected[4096];
+    CHECK(fgets(actual, sizeof(actual), output) != NULL);
+    CHECK(strcmp(actual, "line,from,to,status,distance_km,time_hours,cost_yuan,route\n") == 0);
+
+    long line_number = 0, query_count = 0, routed_count = 0;
+    for (int i = 0; i < fixture_count + GENERATED_QUERIES; i++) {
+        line_number++;
+        const FixtureLine* fixed = i < fixture_count ? &fixture[i] : NULL;
+        if (fixed && !fixed->from_text) continue; // 空行和注释不输出
+        int g = i - fixture_count;
+        if (fixed) {
+            format_expected(expected, sizeof(expected), network, engine, line_number, fixed->line, fixed->from_text, fixed->to_text,
+                            fixed->status);
+        } else {
+            format_expected(expected, sizeof(expected), network, engine, line_number, generated[g], generated_from[g], generated_to[g], NULL);
+        }
+        query_count++;
+        if (strstr(expected, ",ok,")) routed_count++;
+        if (!fgets(actual, sizeof(actual), output)) {
+            CHECK(!"输出的行数少于查询数");
+            break;
+        }
+        actual[strcspn(actual, "\n")] = '\0';
+        if (strcmp(actual, expected) != 0) {
+            fprintf(stderr, "第 %ld 行\n  期望: %s\n  实际: %s\n", line_number, expected, actual);
+            CHECK(strcmp(actual, expected) == 0);
+        }
+    }
+    CHECK(fgets(actual, sizeof(actual), output) == NULL);
+    fclose(output);
+    CHECK(stats.query_count == query_count);
+    CHECK(stats.routed_count == routed_count);
+    CHECK(routed_count > 0 && routed_count < query_count);
+
+    // 输入文件不存在
+    CHECK(!batch_route_file(network, "bin/tests/no_such_input.csv", OUTPUT_PATH, &options, NULL, NULL));
+
+    remove(INPUT_PATH);
+    remove(OUTPUT_PATH);
+    routing_engine_destroy(engine);
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,183 @@
+/**
+ * @file test_centrality.c
+ * @brief 检查介数中心性：小网络上与按定义穷举的结果相同，限定交通方式时只在允许的路段上搜索，相同种子的抽样估计可以复现。
+ */
+#include "centrality.h"
+#include "check.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SUBGRAPH_PATH "bin/tests/centrality_nodes.csv"
+#define MAX_SUBGRAPH_NODES 16
+
+static bool same_cost(double a, double b) {
+    return fabs(a - b) <= 1e-9 * fmax(fabs(a), fabs(b));
+}
+
+/**
+ * @brief 按定义计算介数：先求全源最短距离和最短路径条数（并列的多条直达路段分别计数），
+ *        再对每个起讫点对 (s, t) 累加 σ(s, v)·σ(v, t)/σ(s, t)，v 位于某条最短路径上。
+ */
+static void brute_force_betweenness(const TrafficNetwork* network, const CentralityOptions* options, double* betweenness) {
+    int n = traffic_network_get_node_count(network);
+    static double weight[MAX_SUBGRAPH_NODES][MAX_SUBGRAPH_NODES], dist[MAX_SUBGRAPH_NODES][MAX_SUBGRAPH_NODES];
+    static double links[MAX_SUBGRAPH_NODES][MAX_SUBGRAPH_NODES], sigma[MAX_SUBGRAPH_NODES][MAX_SUBGRAPH_NODES];
+    for (int u = 0; u < n; u++) {
+        for (int v = 0; v < n; v++) {
+            weight[u][v] = DBL_MAX;
+            links[u][v] = 0.0;
+            for (int m = 0; u != v && m < TRANSPORT_MODE_COUNT; m++) {
+                if (!(options->allowed_modes & TRANSPORT_MODE_BIT(m))) continue;
+                TravelInfo info = evaluate_direct_leg(network, u, v, (TransportMode)m);
+                if (!info.is_reachable) continue;
+                double w = calculate_weighted_leg_cost(info.time_hours, info.cost_yuan, options->time_weight, options->cost_weight);
+                if (weight[u][v] != DBL_MAX && same_cost(w, weight[u][v])) {
+                    links[u][v] += 1.0;
+                } else if (w < weight[u][v]) {
+                    weight[u][v] = w;
+                    links[u][v] = 1.0;
+                }
+            }
+            dist[u][v] = u == v ? 0.0 : weight[u][v];
+        }
+    }
+    for (int k = 0; k < n; k++) {
+        for (int u = 0; u < n; u++) {
+            for (int v = 0; v < n; v++) {
+                if (dist[u][k] != DBL_MAX && dist[k][v] != DBL_MAX && dist[u][k] + dist[k][v] < dist[u][v]) dist[u][v] = dist[u][k] + dist[k][v];
+            }
+        }
+    }
+    // 最短路径条数：按到起点的距离从近到远，累加所有位于最短路径上的最后一段
+    for (int s = 0; s < n; s++) {
+        int order[MAX_SUBGRAPH_NODES];
+        for (int i = 0; i < n; i++) order[i] = i;
+        for (int i = 1; i < n; i++) {
+            for (int j = i; j > 0 && dist[s][order[j]] < dist[s][order[j - 1]]; j--) {
+                int t = order[j];
+                order[j] = order[j - 1];
+                order[j - 1] = t;
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            int t = order[i];
+            sigma[s][t] = t == s ? 1.0 : 0.0;
+            if (t == s || dist[s][t] == DBL_MAX) continue;
+            for (int j = 0; j < i; j++) {
+                int u = order[j];
+                if (weight[u][t] != DBL_MAX && dist[s][u] != DBL_MAX && same_cost(dist[s][u] + weight[u][t], dist[s][t])) {
+                    sigma[s][t] += sigma[s][u] * links[u][t];
+                }
+            }
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        betweenness[v] = 0.0;
+        for (int s = 0; s < n; s++) {
+            for (int t = 0; t < n; t++) {
+                if (s == v || t == v || s == t || dist[s][t] == DBL_MAX || dist[s][v] == DBL_MAX || dist[v][t] == DBL_MAX) continue;
+                if (same_cost(dist[s][v] + dist[v][t], dist[s][t])) betweenness[v] += sigma[s][v] * sigma[v][t] / sigma[s][t];
+            }
+        }
+    }
+}
+
+/**
+ * @brief 从 data/nodes.csv 中取出几个城市的节点，写成一个小网络的节点文件。
+ */
+static bool write_subgraph(void) {
+    static const char* cities[] = { "北京,", "郑州,", "武汉,", "长沙,", "上海," };
+    FILE* in = fopen("data/nodes.csv", "r");
+    FILE* out = fopen(SUBGRAPH_PATH, "w");
+    bool ok = in && out;
+    char line[512];
+    for (int row = 0; ok && fgets(line, sizeof(line), in); row++) {
+        bool keep = row == 0;
+        for (size_t c = 0; c < sizeof(cities) / sizeof(cities[0]); c++) {
+            if (strncmp(line, cities[c], strlen(cities[c])) == 0) keep = true;
+        }
+        if (keep) fputs(line, out);
+    }
+    if (in) fclose(in);
+    if (out && fclose(out) != 0) ok = false;
+    return ok;
+}
+
+/**
+ * @brief 在小网络上比较 Brandes 算法与按定义穷举的结果。
+ * @return bool 是否有节点的介数大于0（即确实有最优路线经过中间节点）。
+ */
+static bool check_against_brute_force(const TrafficNetwork* network, double time_weight, double cost_weight, TransportModeMask modes) {
+    CentralityOptions options;
+    centrality_default_options(&options);
+    options.time_weight = time_weight;
+    options.cost_weight = cost_weight;
+    options.allowed_modes = modes;
+    CentralityResult* result = compute_betweenness_centrality(network, &options, NULL);
+    CHECK(result != NULL);
+    if (!result) return false;
+    double expected[MAX_SUBGRAPH_NODES];
+    brute_force_betweenness(network, &options, expected);
+    bool nonzero = false;
+    for (int v = 0; v < result->node_count; v++) {
+        CHECK_NEAR(result->betweenness[v], expected[v], 1e-6);
+        if (expected[v] > 0.0) nonzero = true;
+    }
+    free_centrality_result(result);
+    return nonzero;
+}
+
+int main(void) {
+    CHECK(write_subgraph());
+    TrafficNetwork* subgraph = traffic_network_create(SUBGRAPH_PATH);
+    CHECK(subgraph != NULL);
+    if (subgraph) {
+        CHECK(traffic_network_get_node_count(subgraph) == 15);
+        CHECK(check_against_brute_force(subgraph, 1.0, 0.0, TRANSPORT_MODE_ALL));
+        check_against_brute_force(subgraph, 0.5, 0.5, TRANSPORT_MODE_ALL);
+        check_against_brute_force(subgraph, 0.0, 1.0, TRANSPORT_MODE_ALL);
+        CHECK(check_against_brute_force(subgraph, 1.0, 0.0, TRANSPORT_MODE_ALL & ~TRANSPORT_MODE_BIT(FLIGHT)));
+        traffic_network_destroy(subgraph);
+    }
+    remove(SUBGRAPH_PATH);
+
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+    int node_count = traffic_network_get_node_count(network);
+
+    // 只坐飞机：非机场节点没有可用路段，介数为0
+    CentralityOptions options;
+    centrality_default_options(&options);
+    options.allowed_modes = TRANSPORT_MODE_BIT(FLIGHT);
+    CentralityResult* result = compute_betweenness_centrality(network, &options, NULL);
+    CHECK(result != NULL);
+    if (result) {
+        for (int v = 0; v < node_count; v++) {
+            CHECK(result->betweenness[v] >= 0.0);
+            if (traffic_network_get_node_by_id(network, v)->type != NODE_TYPE_AIRPORT) CHECK(result->betweenness[v] == 0.0);
+        }
+        free_centrality_result(result);
+    }
+
+    // 相同种子的抽样结果相同
+    centrality_default_options(&options);
+    options.sample_sources = 20;
+    options.seed = 7;
+    CentralityResult* first = compute_betweenness_centrality(network, &options, NULL);
+    CentralityResult* second = compute_betweenness_centrality(network, &options, NULL);
+    CHECK(first != NULL && second != NULL);
+    if (first && second) {
+        CHECK(first->sampled && first->source_count == 20);
+        for (int v = 0; v < node_count; v++) CHECK_NEAR(first->betweenness[v], second->betweenness[v], 1e-9);
+    }
+    free_centrality_result(first);
+    free_centrality_result(second);
+
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
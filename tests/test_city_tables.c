@@ -0,0 +1,85 @@
+/**
+ * @file test_city_tables.c
+ * @brief 检查同城表：所有同城节点对在各组权重下，查表与不查表的寻路结果成本相同，并且查表确实命中。
+ */
+#include "check.h"
+#include "city_tables.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include <math.h>
+
+static const WeightProfile profiles[] = { { 1.0, 0.0 }, { 0.0, 1.0 }, { 0.5, 0.5 }, { 0.3, 0.7 }, { 0.8, 0.2 } };
+#define PROFILE_COUNT ((int)(sizeof(profiles) / sizeof(profiles[0])))
+
+/**
+ * @brief 按一组权重计算路线的加权成本，没有路线时为无穷大。
+ */
+static double weighted_cost(const RoutePath* path, const WeightProfile* profile) {
+    return path ? profile->time_weight * path->total_time + profile->cost_weight * path->total_cost : INFINITY;
+}
+
+/**
+ * @brief 比较网络上全部同城节点对查表与不查表的结果，返回成本不一致的数目；hits 输出直接查表命中的次数。
+ */
+static int count_mismatches(TrafficNetwork* network, const CityTables* tables, int* hits) {
+    int n = traffic_network_get_node_count(network);
+    int mismatches = 0;
+    *hits = 0;
+    for (int from = 0; from < n; from++) {
+        for (int to = 0; to < n; to++) {
+            if (from == to || network->nodes[from].city_id != network->nodes[to].city_id) continue;
+            for (int p = 0; p < PROFILE_COUNT; p++) {
+                const WeightProfile* profile = &profiles[p];
+                RoutePath* direct = city_tables_find_route(tables, network, from, to, profile->time_weight, profile->cost_weight);
+                if (direct) (*hits)++;
+                traffic_network_set_city_tables(network, tables);
+                RoutePath* with_tables = find_shortest_path(network, from, to, profile->time_weight, profile->cost_weight);
+                traffic_network_set_city_tables(network, NULL);
+                RoutePath* searched = find_shortest_path(network, from, to, profile->time_weight, profile->cost_weight);
+                double expected = weighted_cost(searched, profile);
+                if (fabs(weighted_cost(with_tables, profile) - expected) > 1e-9 ||
+                    (direct && fabs(weighted_cost(direct, profile) - expected) > 1e-9)) {
+                    fprintf(stderr, "不一致: %d -> %d, 权重 %.1f/%.1f\n", from, to, profile->time_weight, profile->cost_weight);
+                    mismatches++;
+                }
+                free_route_path(direct);
+                free_route_path(with_tables);
+                free_route_path(searched);
+            }
+        }
+    }
+    return mismatches;
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+
+    // 五组权重各建一张表：每组权重都直接查表
+    CityTables* tables = city_tables_build(network, profiles, PROFILE_COUNT);
+    CHECK(tables != NULL);
+    int hits = 0;
+    CHECK(count_mismatches(network, tables, &hits) == 0);
+    CHECK(hits > 0);
+    city_tables_destroy(tables);
+
+    // 默认的三组权重：与表中权重都不成比例的两组回退到搜索，结果同样一致
+    tables = city_tables_build(network, NULL, 0);
+    CHECK(tables != NULL);
+    CHECK(count_mismatches(network, tables, &hits) == 0);
+    CHECK(hits > 0);
+    CHECK(city_tables_find_route(tables, network, 0, 1, 0.3, 0.7) == NULL);
+
+    // 有交通事件时不再查表
+    int count = 0, exact = 0, pairs = 0;
+    city_tables_get_stats(tables, &count, &exact, &pairs);
+    CHECK(count == network->city_count && exact > 0 && exact <= pairs);
+    CHECK(traffic_network_set_node_enabled(network, 2, false));
+    CHECK(city_tables_find_route(tables, network, 0, 1, 0.5, 0.5) == NULL);
+    traffic_network_clear_incidents(network);
+    city_tables_destroy(tables);
+
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,109 @@
+/**
+ * @file test_facility.c
+ * @brief 检查枢纽选址：CELF 惰性贪心与每轮在加入枢纽的网络上重新计算全部最短路径的朴素贪心选出相同的枢纽，目标函数相同。
+ */
+#include "assignment.h"
+#include "check.h"
+#include "facility.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include <float.h>
+#include <stdlib.h>
+
+#define CANDIDATE_COUNT 6
+#define HUB_COUNT 3
+#define UNREACHABLE_COST 10.0 // 与 facility.c 中不可达起讫点对的成本相同
+
+/**
+ * @brief 直接计算网络上的需求加权总成本：每个有需求的起点做一次完整的 Dijkstra。
+ */
+static double objective(const TrafficNetwork* network, const double* demand, int base_count) {
+    double total = 0.0;
+    for (int s = 0; s < base_count; s++) {
+        ShortestPathTree* tree = NULL;
+        for (int t = 0; t < base_count; t++) {
+            double trips = demand[s * base_count + t];
+            if (trips <= 0.0 || s == t) continue;
+            if (!tree) tree = compute_shortest_path_tree(network, s, 0.5, 0.5, NULL);
+            double d = shortest_path_tree_get_cost(tree, t);
+            total += trips * (d == DBL_MAX ? UNREACHABLE_COST : d);
+        }
+        free_shortest_path_tree(tree);
+    }
+    return total;
+}
+
+/**
+ * @brief 朴素贪心：每轮把每个未选的候选站址加入网络，重新计算目标函数，选出总成本最低的一个。
+ */
+static int naive_greedy(const TrafficNetwork* network, const double* demand, const HubCandidate* candidates, int* chosen,
+                        double* objectives) {
+    int base_count = traffic_network_get_node_count(network);
+    TrafficNetwork* planning = traffic_network_create_overlay(network);
+    bool used[CANDIDATE_COUNT] = { false };
+    double current = objective(planning, demand, base_count);
+    int count = 0;
+    for (int round = 0; round < HUB_COUNT; round++) {
+        int best = -1;
+        double best_objective = current;
+        for (int c = 0; c < CANDIDATE_COUNT; c++) {
+            if (used[c]) continue;
+            TrafficNetwork* scenario = traffic_network_create_overlay(planning);
+            const HubCandidate* h = &candidates[c];
+            if (traffic_network_add_node(scenario, h->city_name, h->type, h->name, h->latitude, h->longitude) >= 0) {
+                double value = objective(scenario, demand, base_count);
+                if (value < best_objective - 1e-9) {
+                    best_objective = value;
+                    best = c;
+                }
+            }
+            traffic_network_destroy(scenario);
+        }
+        if (best < 0) break;
+        const HubCandidate* h = &candidates[best];
+        traffic_network_add_node(planning, h->city_name, h->type, h->name, h->latitude, h->longitude);
+        used[best] = true;
+        chosen[count] = best;
+        objectives[count++] = current = best_objective;
+    }
+    traffic_network_destroy(planning);
+    return count;
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    int total_candidates = 0;
+    HubCandidate* candidates = facility_load_candidates_csv("data/hub_candidates.csv", &total_candidates);
+    double* demand = network ? assignment_load_demand_csv(network, "data/od_demand.csv") : NULL;
+    CHECK(network != NULL && candidates != NULL && demand != NULL);
+    CHECK(total_candidates >= CANDIDATE_COUNT);
+    if (!network || !candidates || !demand || total_candidates < CANDIDATE_COUNT) return CHECK_RESULT();
+
+    int base_count = traffic_network_get_node_count(network);
+    FacilityOptions options = { 0.5, 0.5, HUB_COUNT };
+    FacilityResult* result = optimize_hub_locations(network, demand, candidates, CANDIDATE_COUNT, &options, NULL);
+    CHECK(result != NULL);
+    if (result) {
+        int chosen[HUB_COUNT];
+        double objectives[HUB_COUNT];
+        int count = naive_greedy(network, demand, candidates, chosen, objectives);
+        CHECK(count > 0);
+        CHECK_NEAR(result->initial_objective, objective(network, demand, base_count), 1e-6);
+        CHECK(result->chosen_count == count);
+        double value = result->initial_objective;
+        for (int i = 0; i < count && i < result->chosen_count; i++) {
+            CHECK(result->chosen[i] == chosen[i]);
+            value -= result->gains[i];
+            CHECK_NEAR(value, objectives[i], 1e-6);
+        }
+        CHECK_NEAR(result->final_objective, value, 1e-6);
+        CHECK(result->evaluations <= CANDIDATE_COUNT * HUB_COUNT);
+        free_facility_result(result);
+    }
+    CHECK(traffic_network_get_node_count(network) == base_count); // 传入的网络不被修改
+
+    free(demand);
+    free(candidates);
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,137 @@
+/**
+ * @file test_geofence.c
+ * @brief 检查规避区域：绕开一个城市的路线不进入也不穿越区域；位图缓存的命中、淘汰和清空不影响仍被引用的位图。
+ */
+#include "check.h"
+#include "geofence.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include <string.h>
+#include <stdlib.h>
+
+#define OTHER_POLYGON_COUNT 10 // 多于缓存容量
+
+// 包围武汉三个节点（黄鹤楼、天河国际机场、武汉站）的矩形，向西延伸到郑州与长沙之间的连线
+static const GeoPoint wuhan_box[] = { { 30.30, 112.80 }, { 30.30, 114.80 }, { 31.00, 114.80 }, { 31.00, 112.80 } };
+
+static bool edge_blocked(const GeofenceMask* mask, int from, int to) {
+    return (mask->edge_bits[(size_t)from * mask->row_bytes + (to >> 3)] >> (to & 7)) & 1;
+}
+
+/**
+ * @brief 其他用于填满缓存的多边形：远离所有节点的小三角形，第 i 个各不相同。
+ */
+static void make_other_polygon(GeoPoint* points, int i) {
+    points[0] = (GeoPoint){ -10.0 - i, 10.0 };
+    points[1] = (GeoPoint){ -10.0 - i, 11.0 };
+    points[2] = (GeoPoint){ -11.0 - i, 10.5 };
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+    int n = traffic_network_get_node_count(network);
+    int wuhan_station = traffic_network_find_node_id_by_name(network, "武汉站");
+    int zhengzhou = traffic_network_find_node_id_by_name(network, "郑州东站");
+    int changsha = traffic_network_find_node_id_by_name(network, "长沙南站");
+    CHECK(wuhan_station >= 0 && zhengzhou >= 0 && changsha >= 0);
+
+    GeoPolygon polygon = { wuhan_box, 4 };
+    const GeofenceMask* mask = geofence_acquire(network, &polygon, 1);
+    CHECK(mask != NULL);
+    if (!mask) return CHECK_RESULT();
+    CHECK(mask->node_count == n && mask->blocked_node_count == 3);
+    for (int v = 0; v < n; v++) {
+        const Node* node = traffic_network_get_node_by_id(network, v);
+        CHECK(geofence_blocks_node(mask, v) == (strcmp(node->name, "黄鹤楼") == 0 || strcmp(node->name, "天河国际机场") == 0 ||
+                                               strcmp(node->name, "武汉站") == 0));
+    }
+
+    // 郑州东站到长沙南站的最短路线穿过区域；规避后路线不进入也不穿越区域，成本不低于不规避时
+    RouteQueryOptions options = { 1.0, 0.0, NULL, 0 };
+    RoutePath* direct = find_shortest_path_query(network, zhengzhou, changsha, &options, NULL);
+    CHECK(direct != NULL);
+    bool crosses = false;
+    for (const PathSegment* seg = direct ? direct->segments_head : NULL; seg; seg = seg->next) {
+        if (geofence_blocks_node(mask, seg->to_node_id) || edge_blocked(mask, seg->from_node_id, seg->to_node_id)) crosses = true;
+    }
+    CHECK(crosses);
+    options.avoid = mask;
+    RoutePath* detour = find_shortest_path_query(network, zhengzhou, changsha, &options, NULL);
+    CHECK(detour != NULL);
+    if (direct && detour) {
+        CHECK(detour->total_time > direct->total_time);
+        int at = zhengzhou;
+        for (const PathSegment* seg = detour->segments_head; seg; seg = seg->next) {
+            CHECK(seg->from_node_id == at);
+            CHECK(!geofence_blocks_node(mask, seg->to_node_id));
+            CHECK(!edge_blocked(mask, seg->from_node_id, seg->to_node_id));
+            at = seg->to_node_id;
+        }
+        CHECK(at == changsha);
+    }
+    free_route_path(direct);
+    free_route_path(detour);
+    // 起点位于区域内
+    CHECK(find_shortest_path_query(network, wuhan_station, changsha, &options, NULL) == NULL);
+
+    // 位图与网络不匹配（覆盖网络增加了节点）
+    TrafficNetwork* overlay = traffic_network_create_overlay(network);
+    CHECK(overlay != NULL && traffic_network_add_node(overlay, "武汉", NODE_TYPE_LANDMARK, "测试新地标", 30.58, 114.30) == n);
+    CHECK(find_shortest_path_query(overlay, zhengzhou, changsha, &options, NULL) == NULL);
+    traffic_network_destroy(overlay);
+
+    // 缓存命中：相同顶点（即使在不同的数组中）得到同一个位图
+    GeoPoint copy[4];
+    memcpy(copy, wuhan_box, sizeof(copy));
+    GeoPolygon same = { copy, 4 };
+    const GeofenceMask* again = geofence_acquire(network, &same, 1);
+    CHECK(again == mask);
+    geofence_release(again);
+
+    // 缓存被其他多边形填满并淘汰：仍被引用的位图保持有效，之后仍然命中
+    GeoPoint others[OTHER_POLYGON_COUNT][3];
+    for (int i = 0; i < OTHER_POLYGON_COUNT; i++) {
+        make_other_polygon(others[i], i);
+        GeoPolygon other = { others[i], 3 };
+        const GeofenceMask* other_mask = geofence_acquire(network, &other, 1);
+        CHECK(other_mask != NULL && other_mask != mask && other_mask->blocked_node_count == 0);
+        geofence_release(other_mask);
+    }
+    CHECK(mask->blocked_node_count == 3 && geofence_blocks_node(mask, wuhan_station));
+    again = geofence_acquire(network, &same, 1);
+    CHECK(again == mask);
+    geofence_release(again);
+
+    // 所有缓存位置都被引用：新的位图不进入缓存，最后一次释放时销毁
+    const GeofenceMask* held[OTHER_POLYGON_COUNT];
+    for (int i = 0; i < OTHER_POLYGON_COUNT; i++) {
+        GeoPolygon other = { others[i], 3 };
+        held[i] = geofence_acquire(network, &other, 1);
+        CHECK(held[i] != NULL);
+    }
+    for (int i = 0; i < OTHER_POLYGON_COUNT; i++) {
+        GeoPolygon other = { others[i], 3 };
+        const GeofenceMask* second = geofence_acquire(network, &other, 1);
+        CHECK(second != NULL && second->blocked_node_count == 0);
+        geofence_release(second);
+        geofence_release(held[i]);
+    }
+
+    // 清空缓存只释放没有被引用的位图
+    geofence_cache_clear();
+    CHECK(mask->blocked_node_count == 3 && geofence_blocks_node(mask, wuhan_station));
+    again = geofence_acquire(network, &polygon, 1);
+    CHECK(again == mask);
+    geofence_release(again);
+    geofence_release(mask);
+    geofence_cache_clear();
+
+    // 顶点不足
+    GeoPolygon degenerate = { wuhan_box, 2 };
+    CHECK(geofence_acquire(network, &degenerate, 1) == NULL);
+
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
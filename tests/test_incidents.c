@@ -0,0 +1,74 @@
+/**
+ * @file test_incidents.c
+ * @brief 检查交通事件：倍数的取值范围，以及增量修复后的最短路径树与完整重新计算一致（包括从基础网络过渡到覆盖网络）。
+ */
+#include "check.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include <float.h>
+
+/**
+ * @brief 比较修复后的树和在当前网络上重新计算的树。
+ */
+static void check_repaired(const TrafficNetwork* network, ShortestPathTree* tree, int source) {
+    CHECK(shortest_path_tree_repair(network, tree, NULL) >= 0);
+    ShortestPathTree* fresh = compute_shortest_path_tree(network, source, 0.5, 0.5, NULL);
+    CHECK(fresh != NULL);
+    if (!fresh) return;
+    for (int v = 0; v < traffic_network_get_node_count(network); v++) {
+        double repaired = shortest_path_tree_get_cost(tree, v);
+        double expected = shortest_path_tree_get_cost(fresh, v);
+        if (expected == DBL_MAX) CHECK(repaired == DBL_MAX);
+        else CHECK_NEAR(repaired, expected, 1e-9);
+    }
+    free_shortest_path_tree(fresh);
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+
+    // 只允许减速，提速会使寻路的直线距离下界失效
+    CHECK(!traffic_network_set_edge_time_factor(network, 0, 3, DRIVING, 0.5));
+    CHECK(!traffic_network_set_edge_time_factor(network, 0, 3, DRIVING, 0.0));
+    CHECK(traffic_network_set_edge_time_factor(network, 0, 3, DRIVING, 1.0));
+
+    int source = 0, target = 3;
+    ShortestPathTree* tree = compute_shortest_path_tree(network, source, 0.5, 0.5, NULL);
+    CHECK(tree != NULL);
+    RoutePath* route = tree ? shortest_path_tree_get_route(network, tree, target) : NULL;
+    CHECK(route != NULL);
+    if (route) {
+        // 最优路线的每一段减速，第一段封闭
+        for (const PathSegment* seg = route->segments_head; seg; seg = seg->next) {
+            CHECK(traffic_network_set_edge_time_factor(network, seg->from_node_id, seg->to_node_id, seg->mode, 3.0));
+        }
+        check_repaired(network, tree, source);
+        const PathSegment* first = route->segments_head;
+        CHECK(traffic_network_set_edge_enabled(network, first->from_node_id, first->to_node_id, first->mode, false));
+        check_repaired(network, tree, source);
+
+        // 封闭中转节点，再全部恢复
+        CHECK(traffic_network_set_node_enabled(network, first->to_node_id, false));
+        check_repaired(network, tree, source);
+        traffic_network_clear_incidents(network);
+        check_repaired(network, tree, source);
+
+        // 覆盖网络上的事件不影响基础网络；基础网络上的树可以按覆盖网络的变更日志修复
+        TrafficNetwork* overlay = traffic_network_create_overlay(network);
+        CHECK(overlay != NULL);
+        if (overlay) {
+            CHECK(traffic_network_get_base_version(overlay) == traffic_network_get_version(network));
+            CHECK(traffic_network_set_edge_enabled(overlay, first->from_node_id, first->to_node_id, first->mode, false));
+            CHECK(traffic_network_has_incidents(overlay));
+            CHECK(!traffic_network_has_incidents(network));
+            check_repaired(overlay, tree, source);
+            traffic_network_destroy(overlay);
+        }
+        free_route_path(route);
+    }
+    free_shortest_path_tree(tree);
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
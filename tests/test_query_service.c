@@ -0,0 +1,143 @@
+/**
+ * @file test_query_service.c
+ * @brief 检查查询服务合并相同的路线请求：并发请求得到完全相同的响应且确实只计算一次，超时的请求不会无限重试。
+ */
+#include "check.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include "query_service.h"
+#include "routing_engine.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CLIENT_COUNT 8
+
+static QueryService* slow_service = NULL; // 慢速引擎等待其上的请求合并
+static int slow_query_count = 0;
+
+/**
+ * @brief 从 /health 的响应中读出被合并的请求数。
+ */
+static unsigned long coalesced_count(QueryService* service) {
+    char* body = NULL;
+    size_t length = 0;
+    unsigned long count = 0;
+    if (query_service_handle(service, "/health", "", &body, &length) == 200 && body) {
+        const char* field = strstr(body, "\"coalesced\":");
+        if (field) count = strtoul(field + strlen("\"coalesced\":"), NULL, 10);
+    }
+    free(body);
+    return count;
+}
+
+/**
+ * @brief 测试用引擎：领头请求先等到其余请求都加入合并（最多等2秒），再按普通搜索计算。
+ */
+static RoutePath* slow_query(void* state, const TrafficNetwork* network, int start_node_id, int end_node_id,
+                             const RouteQueryOptions* options, const SolveControl* control) {
+    (void)state;
+    __atomic_add_fetch(&slow_query_count, 1, __ATOMIC_SEQ_CST);
+    struct timespec pause = { 0, 1000000 };
+    for (int i = 0; i < 2000 && coalesced_count(slow_service) < CLIENT_COUNT - 1; i++) nanosleep(&pause, NULL);
+    return find_shortest_path_query(network, start_node_id, end_node_id, options, control);
+}
+
+static bool slow_prepare(const TrafficNetwork* network, void** state) {
+    (void)network;
+    *state = NULL;
+    return true;
+}
+
+static bool slow_one_to_many(void* state, const TrafficNetwork* network, int source_node_id, const int* target_node_ids, int target_count,
+                             const RouteQueryOptions* options, const SolveControl* control, double* out_costs) {
+    (void)state;
+    return find_shortest_path_costs(network, source_node_id, target_node_ids, target_count, options, control, out_costs);
+}
+
+static void slow_free_state(void* state) {
+    (void)state;
+}
+
+static const RoutingEngineVTable slow_engine = { "test_slow_leader", "等待请求合并后再计算", slow_prepare, slow_query,
+                                                 slow_one_to_many, slow_free_state };
+
+typedef struct {
+    QueryService* service;
+    int status;
+    char* body;
+    size_t length;
+} Client;
+
+static void* run_client(void* arg) {
+    Client* client = (Client*)arg;
+    client->status = query_service_handle(client->service, "/route", "from=5&to=40", &client->body, &client->length);
+    return NULL;
+}
+
+/**
+ * @brief 多个线程同时发出同一个请求，返回成功的线程数；所有响应的状态码和内容必须相同。
+ */
+static int run_clients(QueryService* service, int expected_status) {
+    Client clients[CLIENT_COUNT];
+    pthread_t threads[CLIENT_COUNT];
+    memset(clients, 0, sizeof(clients));
+    for (int i = 0; i < CLIENT_COUNT; i++) {
+        clients[i].service = service;
+        CHECK(pthread_create(&threads[i], NULL, run_client, &clients[i]) == 0);
+    }
+    for (int i = 0; i < CLIENT_COUNT; i++) pthread_join(threads[i], NULL);
+
+    int completed = 0;
+    for (int i = 0; i < CLIENT_COUNT; i++) {
+        CHECK(clients[i].status == expected_status);
+        CHECK(clients[i].body != NULL);
+        if (clients[i].body && clients[0].body && expected_status == 200) {
+            CHECK(clients[i].length == clients[0].length && memcmp(clients[i].body, clients[0].body, clients[0].length) == 0);
+        }
+        if (clients[i].status == expected_status) completed++;
+    }
+    for (int i = 0; i < CLIENT_COUNT; i++) free(clients[i].body);
+    return completed;
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+
+    // 领头请求等待其余请求加入：只计算一次，其余请求都被合并
+    CHECK(routing_engine_register(&slow_engine));
+    CHECK(routing_engine_set_override(slow_engine.name));
+    QueryService* service = slow_service = query_service_create(network, 0.0);
+    routing_engine_set_override(NULL);
+    CHECK(service != NULL);
+    if (service) {
+        CHECK(strcmp(routing_engine_get_name(query_service_get_engine(service)), slow_engine.name) == 0);
+        CHECK(run_clients(service, 200) == CLIENT_COUNT);
+        CHECK(slow_query_count == 1);
+        CHECK(coalesced_count(service) == CLIENT_COUNT - 1);
+        query_service_destroy(service);
+    }
+    slow_service = NULL;
+
+    // 默认引擎下并发请求的结果同样一致
+    service = query_service_create(network, 0.0);
+    CHECK(service != NULL);
+    if (service) {
+        CHECK(run_clients(service, 200) == CLIENT_COUNT);
+        query_service_destroy(service);
+    }
+
+    // 时限极短：领头请求和重试的等待者都超时，每个请求最终都返回504
+    service = query_service_create(network, 1e-6);
+    CHECK(service != NULL);
+    if (service) {
+        CHECK(run_clients(service, 504) == CLIENT_COUNT);
+        query_service_destroy(service);
+    }
+
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,51 @@
+/**
+ * @file test_reliability.c
+ * @brief 检查可靠性分析：结果只由种子决定，样本统计量自洽，不确定性为0时每个样本都等于基准路线。
+ */
+#include "check.h"
+#include "graph.h"
+#include "reliability.h"
+#include <string.h>
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+
+    ReliabilityOptions options;
+    reliability_default_options(&options);
+    options.sample_count = 300;
+    ReliabilityResult* first = analyze_route_reliability(network, 0, 100, &options, NULL);
+    ReliabilityResult* second = analyze_route_reliability(network, 0, 100, &options, NULL);
+    CHECK(first != NULL && second != NULL);
+    if (first && second) {
+        CHECK(first->reachable_count + first->unreachable_count == options.sample_count);
+        CHECK(first->reachable_count == second->reachable_count);
+        CHECK(memcmp(first->sample_times, second->sample_times, first->reachable_count * sizeof(double)) == 0);
+        int counted = 0;
+        for (int i = 0; i < first->route_count; i++) {
+            const ReliabilityRoute* route = &first->routes[i];
+            counted += route->optimal_count;
+            CHECK(route->node_ids[0] == 0 && route->node_ids[route->node_count - 1] == 100);
+        }
+        CHECK(counted == first->reachable_count);
+        CHECK(reliability_time_percentile(first, 5) <= reliability_time_percentile(first, 95));
+    }
+    free_reliability_result(first);
+    free_reliability_result(second);
+
+    // 去掉所有不确定性：每个样本都是同一条基准路线
+    memset(options.uncertainty, 0, sizeof(options.uncertainty));
+    options.sample_count = 50;
+    ReliabilityResult* fixed = analyze_route_reliability(network, 0, 100, &options, NULL);
+    CHECK(fixed != NULL);
+    if (fixed) {
+        CHECK(fixed->route_count == 1);
+        CHECK_NEAR(reliability_time_percentile(fixed, 0), fixed->baseline_time_hours, 1e-9);
+        CHECK_NEAR(reliability_time_percentile(fixed, 100), fixed->baseline_time_hours, 1e-9);
+        free_reliability_result(fixed);
+    }
+
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
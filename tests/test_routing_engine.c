@@ -0,0 +1,184 @@
+/**
+ * @file test_routing_engine.c
+ * @brief 检查寻路引擎：各引擎的点到点和一对多结果与隐式图上的搜索一致（不同交通方式限定和权重），
+ *        网络出现交通事件后预处理过期的引擎回退到搜索，多个线程同时查询同一个引擎，以及强制指定引擎。
+ */
+#include "check.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include "routing_engine.h"
+#include <float.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define THREAD_COUNT 4
+
+static const char* engine_names[] = { "astar", "csr_linear", "csr_heap" };
+
+static const TransportModeMask mode_masks[] = {
+    0,
+    TRANSPORT_MODE_BIT(DRIVING) | TRANSPORT_MODE_BIT(BUS),
+    TRANSPORT_MODE_BIT(FLIGHT),
+    TRANSPORT_MODE_BIT(HIGH_SPEED_RAIL) | TRANSPORT_MODE_BIT(FLIGHT),
+    TRANSPORT_MODE_ALL & ~TRANSPORT_MODE_BIT(FLIGHT),
+};
+
+static const double weights[][2] = { {1.0, 0.0}, {0.0, 1.0}, {0.5, 0.5}, {0.2, 0.8} };
+
+static double weighted_cost(const RoutePath* path, const RouteQueryOptions* options) {
+    return calculate_weighted_leg_cost(path->total_time, path->total_cost, options->time_weight, options->cost_weight);
+}
+
+/**
+ * @brief 比较各引擎与隐式图上的搜索：是否可达、加权成本（并列最优的路线可以不同），以及一对多的成本。
+ * @return int 每个引擎比较过的点到点查询数。
+ */
+static int compare_with_search(const TrafficNetwork* network, RoutingEngine* const* engines, int engine_count, const RouteQueryOptions* options,
+                               int stride) {
+    int n = traffic_network_get_node_count(network);
+    int* targets = (int*)malloc(n * sizeof(int));
+    double* costs = (double*)malloc(n * sizeof(double));
+    double* expected_costs = (double*)malloc(n * sizeof(double));
+    if (!targets || !costs || !expected_costs) {
+        free(targets);
+        free(costs);
+        free(expected_costs);
+        return 0;
+    }
+    int target_count = 0;
+    for (int t = 0; t < n; t += stride) targets[target_count++] = t;
+
+    int compared = 0;
+    for (int s = 0; s < n; s += stride) {
+        for (int k = 0; k < target_count; k++) {
+            int t = targets[k];
+            RoutePath* expected = find_shortest_path_query(network, s, t, options, NULL);
+            for (int e = 0; e < engine_count; e++) {
+                RoutePath* actual = routing_engine_query(engines[e], s, t, options, NULL);
+                CHECK((expected == NULL) == (actual == NULL));
+                if (expected && actual) CHECK_NEAR(weighted_cost(actual, options), weighted_cost(expected, options), 1e-6);
+                free_route_path(actual);
+            }
+            free_route_path(expected);
+            compared++;
+        }
+        CHECK(find_shortest_path_costs(network, s, targets, target_count, options, NULL, expected_costs));
+        for (int e = 0; e < engine_count; e++) {
+            CHECK(routing_engine_one_to_many(engines[e], s, targets, target_count, options, NULL, costs));
+            for (int k = 0; k < target_count; k++) {
+                if (expected_costs[k] == DBL_MAX) CHECK(costs[k] == DBL_MAX);
+                else CHECK_NEAR(costs[k], expected_costs[k], 1e-6);
+            }
+        }
+    }
+    free(targets);
+    free(costs);
+    free(expected_costs);
+    return compared;
+}
+
+typedef struct {
+    const TrafficNetwork* network;
+    const RoutingEngine* engine;
+    int offset;
+    int mismatches;
+} ConcurrentQueries;
+
+static void* run_concurrent_queries(void* arg) {
+    ConcurrentQueries* job = (ConcurrentQueries*)arg;
+    int n = traffic_network_get_node_count(job->network);
+    RouteQueryOptions options = { 0.5, 0.5, NULL, 0 };
+    for (int s = job->offset; s < n; s += THREAD_COUNT) {
+        for (int t = 0; t < n; t += 29) {
+            RoutePath* expected = find_shortest_path_query(job->network, s, t, &options, NULL);
+            RoutePath* actual = routing_engine_query(job->engine, s, t, &options, NULL);
+            if ((expected == NULL) != (actual == NULL) ||
+                (expected && actual && (weighted_cost(actual, &options) - weighted_cost(expected, &options) > 1e-6 ||
+                                        weighted_cost(expected, &options) - weighted_cost(actual, &options) > 1e-6))) {
+                job->mismatches++;
+            }
+            free_route_path(expected);
+            free_route_path(actual);
+        }
+    }
+    return NULL;
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+
+    // 各引擎在每种交通方式限定和权重下都与搜索一致
+    RoutingEngine* engines[3];
+    for (int e = 0; e < 3; e++) {
+        engines[e] = routing_engine_create(routing_engine_find(engine_names[e]), network);
+        CHECK(engines[e] != NULL);
+        if (!engines[e]) return CHECK_RESULT();
+        CHECK(strcmp(routing_engine_get_name(engines[e]), engine_names[e]) == 0);
+    }
+    int compared = 0;
+    for (size_t m = 0; m < sizeof(mode_masks) / sizeof(mode_masks[0]); m++) {
+        for (size_t w = 0; w < sizeof(weights) / sizeof(weights[0]); w++) {
+            RouteQueryOptions options = { weights[w][0], weights[w][1], NULL, mode_masks[m] };
+            compared += compare_with_search(network, engines, 3, &options, 13);
+        }
+    }
+    CHECK(compared > 0);
+
+    // 多个线程同时查询同一个引擎
+    for (int e = 1; e < 3; e++) {
+        ConcurrentQueries jobs[THREAD_COUNT];
+        pthread_t threads[THREAD_COUNT];
+        for (int i = 0; i < THREAD_COUNT; i++) {
+            jobs[i] = (ConcurrentQueries){ network, engines[e], i, 0 };
+            CHECK(pthread_create(&threads[i], NULL, run_concurrent_queries, &jobs[i]) == 0);
+        }
+        for (int i = 0; i < THREAD_COUNT; i++) {
+            pthread_join(threads[i], NULL);
+            CHECK(jobs[i].mismatches == 0);
+        }
+    }
+
+    // 交通事件使预处理的邻接表过期：引擎回退到搜索，结果反映事件
+    RouteQueryOptions options = { 0.5, 0.5, NULL, 0 };
+    RoutePath* before = routing_engine_query(engines[1], 0, 3, &options, NULL);
+    CHECK(before != NULL);
+    if (before) {
+        const PathSegment* first = before->segments_head;
+        CHECK(traffic_network_set_edge_enabled(network, first->from_node_id, first->to_node_id, first->mode, false));
+        for (int e = 0; e < 3; e++) {
+            RoutePath* after = routing_engine_query(engines[e], 0, 3, &options, NULL);
+            CHECK(after != NULL);
+            if (after) {
+                const PathSegment* seg = after->segments_head;
+                CHECK(!(seg->from_node_id == first->from_node_id && seg->to_node_id == first->to_node_id && seg->mode == first->mode));
+                CHECK(weighted_cost(after, &options) >= weighted_cost(before, &options) - 1e-9);
+            }
+            free_route_path(after);
+        }
+        CHECK(compare_with_search(network, engines, 3, &options, 17) > 0);
+        traffic_network_clear_incidents(network);
+        free_route_path(before);
+    }
+    for (int e = 0; e < 3; e++) routing_engine_destroy(engines[e]);
+
+    // 强制指定引擎：routing_engine_set_override() 优先于环境变量 TRAFFIC_ENGINE，未知的名称被忽略
+    RoutingWorkload batch = { ROUTING_POINT_TO_POINT, 1000, 0 };
+    setenv("TRAFFIC_ENGINE", "csr_heap", 1);
+    CHECK(routing_engine_select(network, NULL) == routing_engine_find("csr_heap"));
+    CHECK(routing_engine_select(network, &batch) == routing_engine_find("csr_heap"));
+    CHECK(routing_engine_set_override("csr_linear"));
+    CHECK(routing_engine_select(network, NULL) == routing_engine_find("csr_linear"));
+    CHECK(!routing_engine_set_override("no_such_engine"));
+    CHECK(routing_engine_set_override(NULL));
+    setenv("TRAFFIC_ENGINE", "no_such_engine", 1);
+    CHECK(routing_engine_select(network, NULL) == routing_engine_find("astar"));
+    unsetenv("TRAFFIC_ENGINE");
+    CHECK(routing_engine_select(network, NULL) == routing_engine_find("astar"));
+    CHECK(routing_engine_select(network, &batch) != routing_engine_find("astar"));
+
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
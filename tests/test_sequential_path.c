@@ -0,0 +1,137 @@
+/**
+ * @file test_sequential_path.c
+ * @brief 检查顺序路径：在多线程的默认线程池上并行计算各路段，结果与逐段串行计算后拼接完全相同。
+ */
+#include "check.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include "routing_engine.h"
+#include "solve_control.h"
+#include "thread_pool.h"
+#include <stdlib.h>
+
+#define MAX_VISITS 40
+
+/**
+ * @brief 串行参考：用同一个引擎逐段查询并拼接，任何一段没有路径时返回NULL。
+ */
+static RoutePath* serial_sequential_path(const RoutingEngine* engine, const int* visits, int count, double time_weight, double cost_weight) {
+    RouteQueryOptions options = { time_weight, cost_weight, NULL, 0 };
+    RoutePath* result = (RoutePath*)calloc(1, sizeof(RoutePath));
+    PathSegment** tail = &result->segments_head;
+    for (int i = 0; i + 1 < count; i++) {
+        RoutePath* leg = routing_engine_query(engine, visits[i], visits[i + 1], &options, NULL);
+        if (!leg || !leg->segments_head) {
+            free_route_path(leg);
+            free_route_path(result);
+            return NULL;
+        }
+        *tail = leg->segments_head;
+        while (*tail) tail = &(*tail)->next;
+        result->segment_count += leg->segment_count;
+        result->total_time += leg->total_time;
+        result->total_cost += leg->total_cost;
+        result->total_distance += leg->total_distance;
+        leg->segments_head = NULL;
+        free_route_path(leg);
+    }
+    return result;
+}
+
+/**
+ * @brief 两条路径的路段逐个相同，总计也相同。两者都为NULL时视为相同。
+ */
+static bool same_path(const RoutePath* a, const RoutePath* b) {
+    if (!a || !b) return a == b;
+    if (a->segment_count != b->segment_count || a->total_time != b->total_time || a->total_cost != b->total_cost ||
+        a->total_distance != b->total_distance) {
+        return false;
+    }
+    int count = 0;
+    const PathSegment *x = a->segments_head, *y = b->segments_head;
+    for (; x && y; x = x->next, y = y->next, count++) {
+        if (x->from_node_id != y->from_node_id || x->to_node_id != y->to_node_id || x->mode != y->mode || x->time_hours != y->time_hours ||
+            x->cost_yuan != y->cost_yuan) {
+            return false;
+        }
+    }
+    return !x && !y && count == a->segment_count;
+}
+
+static void record_progress(const char* stage, double fraction, void* user_data) {
+    (void)stage;
+    *(double*)user_data = fraction;
+}
+
+int main(void) {
+    // 即使只有一个CPU，也让默认线程池有多个工作线程，使各路段真正交错执行
+    setenv("TRAFFIC_THREADS", "4", 1);
+    CHECK(thread_pool_get_size(thread_pool_get_default()) == 4);
+
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+    int n = traffic_network_get_node_count(network);
+
+    // 跨城市的长行程，其中的路段 (a, b) 重复出现多次、方向相反的路段也会出现
+    int visits[MAX_VISITS];
+    for (int i = 0; i < MAX_VISITS; i++) visits[i] = (i % 7 == 3) ? visits[i - 2] : (i * 29 + 5) % n;
+    const double weights[][2] = { { 0.5, 0.5 }, { 1.0, 0.0 }, { 0.0, 1.0 }, { 0.8, 0.2 } };
+
+    int engines_checked = 0;
+    for (int e = 0; e < routing_engine_count(); e++) {
+        RoutingEngine* engine = routing_engine_create(routing_engine_get(e), network);
+        if (!engine) continue;
+        engines_checked++;
+        for (size_t w = 0; w < sizeof(weights) / sizeof(weights[0]); w++) {
+            for (int count = 2; count <= MAX_VISITS; count += 19) {
+                RoutePath* parallel = find_sequential_path_ex(network, visits, count, weights[w][0], weights[w][1], engine, NULL);
+                RoutePath* serial = serial_sequential_path(engine, visits, count, weights[w][0], weights[w][1]);
+                CHECK(parallel != NULL);
+                CHECK(same_path(parallel, serial));
+                free_route_path(parallel);
+                free_route_path(serial);
+            }
+        }
+        routing_engine_destroy(engine);
+    }
+    CHECK(engines_checked >= 2);
+
+    // 不指定引擎时按路段数选择，总计与逐段的最短路径之和相同；进度报告到全部完成
+    double progress = 0.0;
+    SolveControl control = { NULL, record_progress, &progress };
+    RoutePath* parallel = find_sequential_path_ex(network, visits, MAX_VISITS, 0.5, 0.5, NULL, &control);
+    CHECK(parallel != NULL);
+    CHECK(progress == 1.0);
+    double time = 0.0, cost = 0.0;
+    for (int i = 0; i + 1 < MAX_VISITS; i++) {
+        RoutePath* leg = find_shortest_path(network, visits[i], visits[i + 1], 0.5, 0.5);
+        CHECK(leg != NULL);
+        if (!leg) continue;
+        time += leg->total_time;
+        cost += leg->total_cost;
+        free_route_path(leg);
+    }
+    if (parallel) {
+        CHECK_NEAR(calculate_weighted_leg_cost(parallel->total_time, parallel->total_cost, 0.5, 0.5),
+                   calculate_weighted_leg_cost(time, cost, 0.5, 0.5), 1e-6);
+        const PathSegment* seg = parallel->segments_head;
+        CHECK(seg && seg->from_node_id == visits[0]);
+        while (seg && seg->next) {
+            CHECK(seg->to_node_id == seg->next->from_node_id);
+            seg = seg->next;
+        }
+        CHECK(seg && seg->to_node_id == visits[MAX_VISITS - 1]);
+    }
+    free_route_path(parallel);
+
+    // 有一段无法到达（起点与终点相同的路段没有路径段）时两者都失败
+    int stuck[4] = { visits[0], visits[1], visits[1], visits[2] };
+    RoutingEngine* engine = routing_engine_create(routing_engine_get(0), network);
+    CHECK(find_sequential_path_ex(network, stuck, 4, 0.5, 0.5, engine, NULL) == NULL);
+    CHECK(serial_sequential_path(engine, stuck, 4, 0.5, 0.5) == NULL);
+    routing_engine_destroy(engine);
+
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
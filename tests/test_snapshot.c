@@ -0,0 +1,227 @@
+/**
+ * @file test_snapshot.c
+ * @brief 检查二进制快照：保存后映射或读取得到的网络和同城表与原网络逐条路线相同，
+ *        映射的网络修改时复制数组、不写入映射的文件，损坏或与网络不一致的数据被拒绝。
+ */
+#include "check.h"
+#include "city_tables.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include "snapshot.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SNAPSHOT_PATH "bin/tests/test_snapshot.snapshot"
+#define TRUNCATED_PATH "bin/tests/test_snapshot_truncated.snapshot"
+
+static const double weights[][2] = { { 1.0, 0.0 }, { 0.0, 1.0 }, { 0.5, 0.5 }, { 0.2, 0.8 } };
+
+/**
+ * @brief 两条路线的总量和每个路段都相同（都为NULL也算相同）。
+ */
+static bool same_route(const RoutePath* a, const RoutePath* b) {
+    if (!a || !b) return a == b;
+    if (a->segment_count != b->segment_count || a->total_time != b->total_time || a->total_cost != b->total_cost ||
+        a->total_distance != b->total_distance) {
+        return false;
+    }
+    for (const PathSegment *x = a->segments_head, *y = b->segments_head; x || y; x = x->next, y = y->next) {
+        if (!x || !y || x->from_node_id != y->from_node_id || x->to_node_id != y->to_node_id || x->mode != y->mode) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 网络的节点和城市数组内容相同。
+ */
+static bool same_arrays(const TrafficNetwork* a, const TrafficNetwork* b) {
+    return a->node_count == b->node_count && a->city_count == b->city_count &&
+           memcmp(a->nodes, b->nodes, a->node_count * sizeof(Node)) == 0 &&
+           memcmp(a->cities, b->cities, a->city_count * sizeof(CityMeta)) == 0;
+}
+
+/**
+ * @brief 比较两个网络上的路线：全部同城节点对直接查表的结果，以及按步长抽取的同城和跨城节点对的寻路结果，各组权重。
+ *        返回不一致的数目，hits 累加查表命中的次数。
+ */
+static int count_route_mismatches(const TrafficNetwork* expected, const TrafficNetwork* actual, int* hits) {
+    int mismatches = 0;
+    int n = expected->node_count;
+    const CityTables* expected_tables = traffic_network_get_city_tables(expected);
+    const CityTables* actual_tables = traffic_network_get_city_tables(actual);
+    for (int from = 0; from < n; from++) {
+        for (int to = 0; to < n; to++) {
+            bool same_city = expected->nodes[from].city_id == expected->nodes[to].city_id;
+            bool search = (from * n + to) % (same_city ? 7 : 401) == 0;
+            if (from == to || (!same_city && !search)) continue;
+            for (size_t w = 0; w < sizeof(weights) / sizeof(weights[0]); w++) {
+                RoutePath *a, *b;
+                if (search) {
+                    a = find_shortest_path(expected, from, to, weights[w][0], weights[w][1]);
+                    b = find_shortest_path(actual, from, to, weights[w][0], weights[w][1]);
+                    if (!same_route(a, b)) mismatches++;
+                    free_route_path(a);
+                    free_route_path(b);
+                }
+                a = city_tables_find_route(expected_tables, expected, from, to, weights[w][0], weights[w][1]);
+                b = city_tables_find_route(actual_tables, actual, from, to, weights[w][0], weights[w][1]);
+                if (!same_route(a, b)) mismatches++;
+                if (a) (*hits)++;
+                free_route_path(a);
+                free_route_path(b);
+            }
+        }
+    }
+    return mismatches;
+}
+
+/**
+ * @brief 把同城表写到临时文件再读入8字节对齐的内存，模拟快照中的表。
+ */
+static void* read_tables_bytes(const CityTables* tables, size_t* out_size) {
+    FILE* fp = tmpfile();
+    if (!fp) return NULL;
+    void* data = NULL;
+    long size = -1;
+    if (city_tables_write(tables, fp) && fflush(fp) == 0) size = ftell(fp);
+    if (size > 0) data = malloc((size_t)size); // malloc 的结果满足8字节对齐
+    rewind(fp);
+    if (data && fread(data, 1, (size_t)size, fp) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(fp);
+    *out_size = data ? (size_t)size : 0;
+    return data;
+}
+
+/**
+ * @brief 把文件的前 size 个字节复制到另一个文件。
+ */
+static bool write_truncated_copy(const char* source_path, const char* target_path, long size) {
+    FILE* source = fopen(source_path, "rb");
+    FILE* target = fopen(target_path, "wb");
+    bool ok = source && target;
+    for (long i = 0; ok && i < size; i++) {
+        int c = fgetc(source);
+        ok = c != EOF && fputc(c, target) != EOF;
+    }
+    if (source) fclose(source);
+    if (target && fclose(target) != 0) ok = false;
+    return ok;
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+    CityTables* tables = city_tables_build(network, NULL, 0);
+    CHECK(tables != NULL);
+    traffic_network_set_city_tables(network, tables);
+    CHECK(snapshot_save(SNAPSHOT_PATH, network, tables));
+
+    // 映射快照：网络和同城表直接引用映射的内存
+    CityTables* mapped_tables = NULL;
+    SnapshotMapping* mapping = NULL;
+    TrafficNetwork* mapped = snapshot_map(SNAPSHOT_PATH, &mapped_tables, &mapping);
+    CHECK(mapped != NULL && mapped_tables != NULL && mapping != NULL);
+    if (!mapped) return CHECK_RESULT();
+    CHECK(same_arrays(network, mapped));
+    traffic_network_set_city_tables(mapped, mapped_tables);
+    int hits = 0;
+    CHECK(count_route_mismatches(network, mapped, &hits) == 0);
+    CHECK(hits > 0);
+
+    // 读取快照：数组和表复制到自己的内存
+    CityTables* loaded_tables = NULL;
+    TrafficNetwork* loaded = snapshot_load(SNAPSHOT_PATH, &loaded_tables);
+    CHECK(loaded != NULL && loaded_tables != NULL);
+    if (loaded) {
+        CHECK(same_arrays(network, loaded));
+        traffic_network_set_city_tables(loaded, loaded_tables);
+        hits = 0;
+        CHECK(count_route_mismatches(network, loaded, &hits) == 0);
+        CHECK(hits > 0);
+    }
+
+    // 直接引用外部数组的网络，以及引用内存中的同城表
+    TrafficNetwork* wrapped = traffic_network_wrap_arrays(network->nodes, network->node_count, network->cities, network->city_count);
+    size_t tables_size = 0;
+    void* tables_bytes = read_tables_bytes(tables, &tables_size);
+    CHECK(wrapped != NULL && tables_bytes != NULL);
+    CityTables* wrapped_tables = NULL;
+    if (wrapped && tables_bytes) {
+        CHECK(wrapped->nodes == network->nodes && wrapped->cities == network->cities);
+        wrapped_tables = city_tables_map(tables_bytes, tables_size, wrapped);
+        CHECK(wrapped_tables != NULL);
+        traffic_network_set_city_tables(wrapped, wrapped_tables);
+        hits = 0;
+        CHECK(count_route_mismatches(network, wrapped, &hits) == 0);
+        CHECK(hits > 0);
+        // 数据不完整
+        CHECK(city_tables_map(tables_bytes, tables_size - 8, wrapped) == NULL);
+    }
+
+    // 节点坐标与构建时不同的网络拒绝引用这份表
+    Node* moved_nodes = (Node*)malloc(network->node_count * sizeof(Node));
+    if (moved_nodes && tables_bytes) {
+        memcpy(moved_nodes, network->nodes, network->node_count * sizeof(Node));
+        moved_nodes[0].latitude += 0.01;
+        TrafficNetwork* moved = traffic_network_create_from_arrays(moved_nodes, network->node_count, network->cities, network->city_count);
+        CHECK(moved != NULL);
+        CHECK(city_tables_map(tables_bytes, tables_size, moved) == NULL);
+        traffic_network_destroy(moved);
+    }
+    free(moved_nodes);
+
+    // 映射的网络增加节点时复制数组（映射是只读的，直接写入会崩溃），文件内容不变
+    const Node* mapped_nodes = mapped->nodes;
+    int new_node = traffic_network_add_node(mapped, "北京", NODE_TYPE_LANDMARK, "测试新地标", 39.95, 116.40);
+    CHECK(new_node == network->node_count);
+    CHECK(mapped->nodes != mapped_nodes && mapped->node_count == network->node_count + 1);
+    RoutePath* path = find_shortest_path(mapped, new_node, 3, 0.5, 0.5);
+    CHECK(path != NULL);
+    free_route_path(path);
+    CityTables* remapped_tables = NULL;
+    SnapshotMapping* remapping = NULL;
+    TrafficNetwork* remapped = snapshot_map(SNAPSHOT_PATH, &remapped_tables, &remapping);
+    CHECK(remapped != NULL && same_arrays(network, remapped));
+    traffic_network_destroy(remapped);
+    city_tables_destroy(remapped_tables);
+    snapshot_unmap(remapping);
+
+    // 截断在同城表（位于文件末尾）中的快照仍然加载网络，只是没有表；截断在节点数组中的快照被拒绝
+    FILE* fp = fopen(SNAPSHOT_PATH, "rb");
+    long snapshot_size = fp && fseek(fp, 0, SEEK_END) == 0 ? ftell(fp) : -1;
+    if (fp) fclose(fp);
+    CityTables* bad_tables = NULL;
+    SnapshotMapping* bad_mapping = NULL;
+    CHECK(write_truncated_copy(SNAPSHOT_PATH, TRUNCATED_PATH, snapshot_size - 8));
+    TrafficNetwork* partial = snapshot_map(TRUNCATED_PATH, &bad_tables, &bad_mapping);
+    CHECK(partial != NULL && bad_tables == NULL);
+    traffic_network_destroy(partial);
+    snapshot_unmap(bad_mapping);
+    partial = snapshot_load(TRUNCATED_PATH, &bad_tables);
+    CHECK(partial != NULL && bad_tables == NULL);
+    traffic_network_destroy(partial);
+    CHECK(write_truncated_copy(SNAPSHOT_PATH, TRUNCATED_PATH, (long)(network->node_count * sizeof(Node) / 2)));
+    CHECK(snapshot_map(TRUNCATED_PATH, &bad_tables, &bad_mapping) == NULL && bad_mapping == NULL);
+    CHECK(snapshot_load(TRUNCATED_PATH, &bad_tables) == NULL);
+    CHECK(snapshot_map("bin/tests/no_such.snapshot", &bad_tables, &bad_mapping) == NULL);
+
+    remove(SNAPSHOT_PATH);
+    remove(TRUNCATED_PATH);
+    traffic_network_destroy(wrapped);
+    city_tables_destroy(wrapped_tables);
+    free(tables_bytes);
+    traffic_network_destroy(loaded);
+    city_tables_destroy(loaded_tables);
+    traffic_network_destroy(mapped);
+    city_tables_destroy(mapped_tables);
+    snapshot_unmap(mapping);
+    traffic_network_destroy(network);
+    city_tables_destroy(tables);
+    return CHECK_RESULT();
+}
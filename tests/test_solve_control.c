@@ -0,0 +1,191 @@
+/**
+ * @file test_solve_control.c
+ * @brief 检查取消令牌：已取消、截止时间已过或在求解中途取消时，TSP、多旅行者路径规划和交通分配都返回NULL；
+ *        求解函数自己的时间限制到期时则返回当前最优的可行解。
+ */
+#include "check.h"
+#include "assignment.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include "solve_control.h"
+#include "tsp_bnb.h"
+#include "tsp_matrix.h"
+#include "utils.h"
+#include "vrp.h"
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief 在指定阶段第一次报告进度时取消令牌。
+ */
+typedef struct {
+    CancelToken* token;
+    const char* stage;  // 要取消的阶段，NULL表示第一次报告时就取消
+    int reports;        // 取消后又收到的报告数
+    bool cancelled;
+} CancelAtStage;
+
+static void cancel_at_stage(const char* stage, double fraction, void* user_data) {
+    (void)fraction;
+    CancelAtStage* at = (CancelAtStage*)user_data;
+    if (at->cancelled) at->reports++;
+    if (!at->cancelled && (!at->stage || strcmp(stage, at->stage) == 0)) {
+        cancel_token_cancel(at->token);
+        at->cancelled = true;
+    }
+}
+
+static RoutePath* run_tsp(const TrafficNetwork* network, int* stops, int count, const SolveControl* control) {
+    return solve_tsp_ex(network, stops, count, 0.5, 0.5, control);
+}
+
+/**
+ * @brief 等待截止时间到期。
+ */
+static void expire_deadline(CancelToken* token) {
+    cancel_token_init(token);
+    cancel_token_set_deadline(token, 0.001);
+    double start = monotonic_time_seconds();
+    while (!cancel_token_is_cancelled(token) && monotonic_time_seconds() - start < 1.0) {
+    }
+    CHECK(cancel_token_is_cancelled(token));
+}
+
+/**
+ * @brief 依次检查：已取消、截止时间已过、在给定阶段中途取消时返回NULL，重置令牌后能正常求解。
+ */
+static void check_tsp(const TrafficNetwork* network, int* stops, int count, const char* stage) {
+    CancelToken token;
+    SolveControl control = { &token, NULL, NULL };
+    cancel_token_init(&token);
+    cancel_token_cancel(&token);
+    CHECK(run_tsp(network, stops, count, &control) == NULL);
+    expire_deadline(&token);
+    CHECK(run_tsp(network, stops, count, &control) == NULL);
+
+    cancel_token_init(&token);
+    CancelAtStage at = { &token, stage, 0, false };
+    control.on_progress = cancel_at_stage;
+    control.user_data = &at;
+    CHECK(run_tsp(network, stops, count, &control) == NULL);
+    CHECK(at.cancelled);
+
+    cancel_token_init(&token);
+    control.on_progress = NULL;
+    RoutePath* path = run_tsp(network, stops, count, &control);
+    CHECK(path != NULL);
+    free_route_path(path);
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+    int n = traffic_network_get_node_count(network);
+    int stops[TSP_BNB_MAX_NODES + 5];
+    for (int i = 0; i < TSP_BNB_MAX_NODES + 5; i++) stops[i] = (i * 31 + 2) % n;
+
+    // TSP：动态规划、分支定界、分层分解三种规模，以及成本矩阵阶段
+    check_tsp(network, stops, 8, "cost_matrix");
+    check_tsp(network, stops, 8, "dp");
+    check_tsp(network, stops, 14, NULL);
+    check_tsp(network, stops, TSP_BNB_MAX_NODES + 5, NULL);
+    CancelToken token;
+    SolveControl control = { &token, NULL, NULL };
+    bool optimal = true;
+    expire_deadline(&token);
+    CHECK(solve_tsp_exact(network, stops, 30, 0.5, 0.5, 20.0, &optimal, NULL, &control) == NULL);
+    CHECK(!optimal);
+
+    // 网络上的途经点通常在分支定界的根节点就能证明最优，搜索阶段用随机非对称矩阵检查：
+    // 自己的时间限制到期时返回当前最优的可行环路，令牌的截止时间在搜索中途到期时返回 DBL_MAX
+    int m = TSP_BNB_MAX_NODES - 5;
+    double* cost = (double*)malloc(m * m * sizeof(double));
+    int order[TSP_BNB_MAX_NODES];
+    unsigned int seed = 99u;
+    for (int i = 0; i < m * m; i++) {
+        seed = seed * 1103515245u + 12345u;
+        cost[i] = i % (m + 1) == 0 ? 0.0 : 1.0 + (seed >> 16) % 1000;
+    }
+    double best = tsp_branch_and_bound(cost, m, m, order, 20.0, NULL, &optimal);
+    CHECK(best != DBL_MAX);
+    CHECK(!optimal);
+    bool seen[TSP_BNB_MAX_NODES] = { false };
+    for (int i = 0; i < m; i++) {
+        CHECK(order[i] >= 0 && order[i] < m && !seen[order[i]]);
+        if (order[i] >= 0 && order[i] < m) seen[order[i]] = true;
+    }
+    CHECK_NEAR(best, tsp_tour_cost(cost, m, order, m), 1e-9);
+    cancel_token_init(&token);
+    cancel_token_set_deadline(&token, 20.0);
+    CHECK(tsp_branch_and_bound(cost, m, m, order, 0.0, &control, &optimal) == DBL_MAX);
+    CHECK(!optimal);
+    free(cost);
+
+    // 多旅行者路径规划：迭代次数几乎不受限，只能靠取消结束
+    VrpOptions vrp_options;
+    vrp_default_options(&vrp_options);
+    vrp_options.num_travellers = 3;
+    vrp_options.iterations = 100000000;
+    vrp_options.time_limit_ms = 0.0;
+    cancel_token_init(&token);
+    cancel_token_cancel(&token);
+    CHECK(solve_vrp(network, stops, 16, 0.5, 0.5, &vrp_options, &control) == NULL);
+    const char* vrp_stages[] = { "cost_matrix", "search" };
+    for (int s = 0; s < 2; s++) {
+        cancel_token_init(&token);
+        CancelAtStage at = { &token, vrp_stages[s], 0, false };
+        SolveControl staged = { &token, cancel_at_stage, &at };
+        CHECK(solve_vrp(network, stops, 16, 0.5, 0.5, &vrp_options, &staged) == NULL);
+        CHECK(at.cancelled);
+    }
+    cancel_token_init(&token);
+    cancel_token_set_deadline(&token, 100.0);
+    double start = monotonic_time_seconds();
+    CHECK(solve_vrp(network, stops, 16, 0.5, 0.5, &vrp_options, &control) == NULL);
+    CHECK(monotonic_time_seconds() - start < 10.0);
+    // 自己的时间限制到期时返回当前最优解
+    vrp_options.time_limit_ms = 50.0;
+    cancel_token_init(&token);
+    VrpResult* vrp = solve_vrp(network, stops, 16, 0.5, 0.5, &vrp_options, &control);
+    CHECK(vrp != NULL);
+    free_vrp_result(vrp);
+
+    // 交通分配：第一次迭代后取消，包括唯一一次迭代即结束的情形；截止时间在迭代过程中到期
+    double* demand = assignment_load_demand_csv(network, "data/od_demand.csv");
+    CHECK(demand != NULL);
+    if (demand) {
+        AssignmentOptions assignment_options;
+        assignment_default_options(&assignment_options);
+        cancel_token_init(&token);
+        cancel_token_cancel(&token);
+        CHECK(solve_traffic_assignment(network, demand, &assignment_options, &control) == NULL);
+        for (int max_iterations = 1; max_iterations <= 50; max_iterations += 49) {
+            assignment_options.max_iterations = max_iterations;
+            cancel_token_init(&token);
+            CancelAtStage at = { &token, "assignment", 0, false };
+            SolveControl staged = { &token, cancel_at_stage, &at };
+            CHECK(solve_traffic_assignment(network, demand, &assignment_options, &staged) == NULL);
+            CHECK(at.cancelled);
+            CHECK(at.reports == 0);
+        }
+        assignment_options.max_iterations = 1000000;
+        assignment_options.target_relative_gap = 0.0;
+        cancel_token_init(&token);
+        cancel_token_set_deadline(&token, 100.0);
+        start = monotonic_time_seconds();
+        CHECK(solve_traffic_assignment(network, demand, &assignment_options, &control) == NULL);
+        CHECK(monotonic_time_seconds() - start < 10.0);
+
+        assignment_default_options(&assignment_options);
+        cancel_token_init(&token);
+        AssignmentResult* result = solve_traffic_assignment(network, demand, &assignment_options, &control);
+        CHECK(result != NULL);
+        free_assignment_result(result);
+        free(demand);
+    }
+
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,164 @@
+/**
+ * @file test_speed_profile.c
+ * @brief 检查按速度曲线积分的通行时间：与手工积分的结果一致（含跨越午夜、跳过整天），且晚出发不会早到达。
+ */
+#include "check.h"
+#include "graph.h"
+#include "speed_profile.h"
+#include <math.h>
+#include <stdio.h>
+
+#define PROFILE_PATH "bin/tests/speed_profiles.csv"
+
+// 曲线的断点和斜率以单精度存储，与手工积分的精确值相差约 1e-8
+#define HAND_TOLERANCE 1e-6
+
+/**
+ * @brief 按断点线性插值求时刻 t 的速度系数（周期24小时），不使用预计算的斜率和分段索引。
+ */
+static double factor_at(const SpeedProfile* p, double t) {
+    t = fmod(t - p->hours[0], 24.0);
+    if (t < 0) t += 24.0;
+    t += p->hours[0];
+    for (int i = 0; i < p->count; i++) {
+        double h0 = p->hours[i], h1 = i + 1 < p->count ? p->hours[i + 1] : p->hours[0] + 24.0;
+        double f1 = i + 1 < p->count ? p->factors[i + 1] : p->factors[0];
+        if (t >= h0 && t < h1) return p->factors[i] + (f1 - p->factors[i]) * (t - h0) / (h1 - h0);
+    }
+    return p->factors[0];
+}
+
+/**
+ * @brief 参考实现：从出发时刻起逐段用梯形公式（对线性函数精确）累加速度系数的积分，
+ *        不跳过整天；最后一段内用二分法求走完剩余距离的时刻。
+ */
+static double reference_travel_time(const SpeedProfile* p, double free_flow_hours, double depart_hour) {
+    double t = depart_hour, remaining = free_flow_hours;
+    while (1) {
+        // 下一个断点（按周期展开到 t 之后）
+        double base = p->hours[0] + 24.0 * floor((t - p->hours[0]) / 24.0);
+        double end = base + 24.0;
+        for (int i = p->count - 1; i >= 0; i--) {
+            if (base + p->hours[i] - p->hours[0] > t) end = base + p->hours[i] - p->hours[0];
+        }
+        double f0 = factor_at(p, t);
+        double f1 = factor_at(p, end - 1e-12);
+        double covered = 0.5 * (f0 + f1) * (end - t);
+        if (covered >= remaining) {
+            double lo = 0.0, hi = end - t;
+            for (int k = 0; k < 200; k++) {
+                double mid = 0.5 * (lo + hi);
+                double fm = f0 + (f1 - f0) * mid / (end - t);
+                if (0.5 * (f0 + fm) * mid < remaining) lo = mid;
+                else hi = mid;
+            }
+            return t + 0.5 * (lo + hi) - depart_hour;
+        }
+        remaining -= covered;
+        t = end;
+    }
+}
+
+/**
+ * @brief 在若干出发时刻和自由流时间上与参考实现比较，并检查先进先出性质与出发时刻的24小时周期。
+ */
+static void check_profile(const SpeedProfile* p) {
+    const double free_flows[] = { 0.01, 0.4, 2.5, 9.0, 23.9, 30.0, 77.7 };
+    for (size_t k = 0; k < sizeof(free_flows) / sizeof(free_flows[0]); k++) {
+        double ff = free_flows[k];
+        double last_arrival = -1e300;
+        for (double depart = -3.0; depart < 45.0; depart += 0.05) {
+            double travel = speed_profile_travel_time(p, ff, depart);
+            CHECK_NEAR(travel, reference_travel_time(p, ff, depart), 1e-5 * (1.0 + travel));
+            CHECK_NEAR(travel, speed_profile_travel_time(p, ff, depart + 24.0), 1e-9 * (1.0 + travel));
+            CHECK(depart + travel >= last_arrival - 1e-9);
+            last_arrival = depart + travel;
+        }
+    }
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+    FILE* fp = fopen(PROFILE_PATH, "wb");
+    CHECK(fp != NULL);
+    if (!fp) return CHECK_RESULT();
+    fputs("city_name,mode,hour,speed_factor\n"
+          "武汉,driving,0,1\n"
+          "武汉,driving,12,2\n"
+          "武汉,bus,9,0.5\n"
+          "intercity,driving,5,0.5\n"
+          "intercity,driving,8,1.5\n"
+          "intercity,driving,20,1\n",
+          fp);
+    fclose(fp);
+    SpeedProfileSet* set = speed_profile_set_load(network, PROFILE_PATH);
+    remove(PROFILE_PATH);
+    CHECK(set != NULL);
+    if (!set) return CHECK_RESULT();
+    CHECK_NEAR(speed_profile_set_get_max_factor(set), 2.0, 1e-9);
+
+    const Node* wuhan = traffic_network_get_node_by_id(network, traffic_network_find_node_id_by_name(network, "黄鹤楼"));
+    const Node* wuhan_station = traffic_network_get_node_by_id(network, traffic_network_find_node_id_by_name(network, "武汉站"));
+    const Node* beijing = traffic_network_get_node_by_id(network, traffic_network_find_node_id_by_name(network, "故宫"));
+    CHECK(wuhan && wuhan_station && beijing);
+    if (!wuhan || !wuhan_station || !beijing) return CHECK_RESULT();
+    const SpeedProfile* rise = speed_profile_set_lookup(set, wuhan, wuhan_station, DRIVING);
+    const SpeedProfile* flat = speed_profile_set_lookup(set, wuhan, wuhan_station, BUS);
+    const SpeedProfile* wrap = speed_profile_set_lookup(set, wuhan, beijing, DRIVING);
+    CHECK(rise && flat && wrap);
+    CHECK(speed_profile_set_lookup(set, beijing, beijing, DRIVING) == NULL); // 北京没有曲线，也没有默认曲线
+    CHECK(speed_profile_set_lookup(set, wuhan, beijing, BUS) == NULL);
+    if (!rise || !flat || !wrap) return CHECK_RESULT();
+
+    // 手工积分：f(t) = 1 + t/12（0-12点），走完1小时自由流时间满足 τ + τ²/24 = 1
+    CHECK_NEAR(speed_profile_travel_time(rise, 1.0, 0.0), -12.0 + sqrt(168.0), HAND_TOLERANCE);
+    // 22点出发：f(t) = 2 - (t-12)/12 在22点为 7/6，到24点走完 (7/6 + 1)/2 × 2 = 13/6 > 1，
+    // 满足 7/6·τ - τ²/24 = 1，即 τ = 14 - sqrt(172)
+    CHECK_NEAR(speed_profile_travel_time(rise, 1.0, 22.0), 14.0 - sqrt(172.0), HAND_TOLERANCE);
+    // 一整天的积分为 36：自由流 36 小时正好 24 小时，72 + 1 小时在整两天之后按0点出发计算
+    CHECK_NEAR(speed_profile_travel_time(rise, 36.0, 5.0), 24.0, HAND_TOLERANCE);
+    CHECK_NEAR(speed_profile_travel_time(rise, 73.0, 0.0), 48.0 - 12.0 + sqrt(168.0), HAND_TOLERANCE);
+    // 单个断点即恒定系数：时间加倍，出发时刻无关
+    CHECK_NEAR(speed_profile_travel_time(flat, 3.0, 17.3), 6.0, HAND_TOLERANCE);
+    CHECK_NEAR(speed_profile_travel_time(flat, 30.0, -5.0), 60.0, HAND_TOLERANCE);
+    // 跨越午夜的最后一段（20点到次日5点，系数从1降到0.5）：23点出发时系数为 1 - 3/18 = 5/6，
+    // 满足 5/6·τ - τ²/36 = 1
+    CHECK_NEAR(speed_profile_travel_time(wrap, 1.0, 23.0), 15.0 - sqrt(189.0), HAND_TOLERANCE);
+    CHECK_NEAR(speed_profile_travel_time(wrap, 1.0, -1.0), 15.0 - sqrt(189.0), HAND_TOLERANCE);
+    CHECK_NEAR(speed_profile_travel_time(NULL, 2.5, 8.0), 2.5, 1e-12);
+    CHECK(speed_profile_travel_time(wrap, 0.0, 8.0) == 0.0);
+
+    check_profile(rise);
+    check_profile(flat);
+    check_profile(wrap);
+    speed_profile_set_destroy(set);
+
+    // 默认数据中的曲线
+    set = speed_profile_set_load(network, "data/speed_profiles.csv");
+    CHECK(set != NULL);
+    if (set) {
+        int checked = 0;
+        for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+            const SpeedProfile* p = speed_profile_set_lookup(set, beijing, beijing, (TransportMode)m);
+            if (p) checked++, check_profile(p);
+            p = speed_profile_set_lookup(set, wuhan, wuhan_station, (TransportMode)m);
+            if (p) checked++, check_profile(p);
+        }
+        CHECK(checked >= 3);
+        speed_profile_set_destroy(set);
+    }
+
+    // 断点没有严格递增
+    fp = fopen(PROFILE_PATH, "wb");
+    if (fp) {
+        fputs("city_name,mode,hour,speed_factor\n*,driving,6,1\n*,driving,6,0.5\n", fp);
+        fclose(fp);
+        CHECK(speed_profile_set_load(network, PROFILE_PATH) == NULL);
+        remove(PROFILE_PATH);
+    }
+
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
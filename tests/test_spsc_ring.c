@@ -0,0 +1,67 @@
+/**
+ * @file test_spsc_ring.c
+ * @brief 检查单生产者单消费者环形队列：满和空时的非阻塞操作，以及容量为2时大量元素按顺序完整地通过队列。
+ */
+#include "check.h"
+#include "spsc_ring.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+
+#define ITEM_COUNT 200000
+
+/**
+ * @brief 生产者：按顺序放入 1..ITEM_COUNT，前一半用阻塞版本，后一半用非阻塞版本重试。
+ */
+static void* produce(void* arg) {
+    SpscRing* ring = (SpscRing*)arg;
+    for (uintptr_t i = 1; i <= ITEM_COUNT; i++) {
+        if (i <= ITEM_COUNT / 2) {
+            spsc_ring_push(ring, (void*)i);
+        } else {
+            while (!spsc_ring_try_push(ring, (void*)i)) sched_yield();
+        }
+    }
+    return NULL;
+}
+
+int main(void) {
+    SpscRing* ring = spsc_ring_create(2);
+    CHECK(ring != NULL);
+    if (!ring) return CHECK_RESULT();
+
+    // 单线程：空时不能出队，放满后不能再入队，先进先出
+    void* item = NULL;
+    CHECK(!spsc_ring_try_pop(ring, &item));
+    CHECK(spsc_ring_try_push(ring, (void*)(uintptr_t)1));
+    CHECK(spsc_ring_try_push(ring, (void*)(uintptr_t)2));
+    CHECK(!spsc_ring_try_push(ring, (void*)(uintptr_t)3));
+    CHECK(spsc_ring_try_pop(ring, &item) && item == (void*)(uintptr_t)1);
+    CHECK(spsc_ring_try_push(ring, (void*)(uintptr_t)3));
+    CHECK(spsc_ring_pop(ring) == (void*)(uintptr_t)2);
+    CHECK(spsc_ring_pop(ring) == (void*)(uintptr_t)3);
+    CHECK(!spsc_ring_try_pop(ring, &item));
+
+    // 两个线程：消费者交替使用阻塞和非阻塞出队，检查顺序和完整性
+    pthread_t producer;
+    CHECK(pthread_create(&producer, NULL, produce, ring) == 0);
+    uintptr_t expected = 1;
+    int out_of_order = 0;
+    while (expected <= ITEM_COUNT) {
+        void* next;
+        if (expected % 2 == 0) {
+            next = spsc_ring_pop(ring);
+        } else {
+            while (!spsc_ring_try_pop(ring, &next)) sched_yield();
+        }
+        if ((uintptr_t)next != expected) out_of_order++;
+        expected++;
+    }
+    pthread_join(producer, NULL);
+    CHECK(out_of_order == 0);
+    CHECK(!spsc_ring_try_pop(ring, &item));
+
+    spsc_ring_destroy(ring);
+    spsc_ring_destroy(NULL);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,102 @@
+/**
+ * @file test_timetable.c
+ * @brief 检查连接扫描算法的最早到达查询，特别是跨越午夜运行的班次。
+ */
+#include "check.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include "timetable.h"
+#include <string.h>
+
+/**
+ * @brief 行程中的一段：起点、终点和交通方式。
+ */
+typedef struct {
+    const char* from;
+    const char* to;
+    TransportMode mode;
+} ExpectedLeg;
+
+/**
+ * @brief 检查行程的各段与期望完全相同。
+ */
+static void check_legs(const TrafficNetwork* network, const RoutePath* path, const ExpectedLeg* legs, int count) {
+    CHECK(path->segment_count == count);
+    const PathSegment* seg = path->segments_head;
+    for (int i = 0; i < count && seg; i++, seg = seg->next) {
+        CHECK(strcmp(traffic_network_get_node_by_id(network, seg->from_node_id)->name, legs[i].from) == 0);
+        CHECK(strcmp(traffic_network_get_node_by_id(network, seg->to_node_id)->name, legs[i].to) == 0);
+        CHECK(seg->mode == legs[i].mode);
+    }
+}
+
+/**
+ * @brief 检查行程首尾相接：从起点出发、在终点结束，每一段的起点是上一段的终点。
+ */
+static void check_continuous(const RoutePath* path, int start, int end) {
+    int at = start;
+    for (const PathSegment* seg = path->segments_head; seg; seg = seg->next) {
+        CHECK(seg->from_node_id == at);
+        at = seg->to_node_id;
+    }
+    CHECK(at == end);
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+    Timetable* timetable = timetable_load(network, "data/timetable.csv");
+    CHECK(timetable != NULL);
+    if (!timetable) return CHECK_RESULT();
+
+    int zhengzhou = traffic_network_find_node_id_by_name(network, "郑州东站");
+    int wuhan = traffic_network_find_node_id_by_name(network, "武汉站");
+    int changsha = traffic_network_find_node_id_by_name(network, "长沙南站");
+    int shenzhen = traffic_network_find_node_id_by_name(network, "深圳北站");
+
+    // G119 21:58 从郑州东站出发，过午夜后 25:30 到达长沙南站：留在车上不需要换乘
+    double arrival = 0.0;
+    RoutePath* path = timetable_earliest_arrival(timetable, network, zhengzhou, changsha, 21.5, &arrival);
+    CHECK(path != NULL);
+    if (path) {
+        CHECK_NEAR(arrival, 25.5, 1e-6);
+        CHECK(path->segment_count == 2);
+        check_continuous(path, zhengzhou, changsha);
+        free_route_path(path);
+    }
+
+    // 零点从武汉站出发：前一天发车的 G119 00:07 离开武汉站，赶不上（高铁站换乘需预留10分钟）；
+    // 最早的是驾车到天河国际机场，乘 CA1178（08:00-09:49）到宝安国际机场，再驾车到深圳北站，10:35 到达
+    static const ExpectedLeg via_flight[] = {
+        { "武汉站", "天河国际机场", DRIVING }, { "天河国际机场", "宝安国际机场", FLIGHT }, { "宝安国际机场", "深圳北站", DRIVING }
+    };
+    path = timetable_earliest_arrival(timetable, network, wuhan, shenzhen, 0.0, &arrival);
+    CHECK(path != NULL);
+    if (path) {
+        CHECK_NEAR(arrival, 10.0 + 35.0 / 60.0, 1e-6);
+        CHECK_NEAR(path->total_time, arrival, 1e-6);
+        check_legs(network, path, via_flight, 3);
+        if (path->segment_count == 3) {
+            CHECK_NEAR(path->segments_head->next->time_hours, 109.0 / 60.0, 1e-6);
+            CHECK_NEAR(path->segments_head->next->cost_yuan, 753.0, 1e-3);
+        }
+        free_route_path(path);
+    }
+
+    // 零点从长沙南站出发可以赶上前一天发车的 G119（01:33），留在车上经广州南站 04:37 到达深圳北站；
+    // 之后的行程不能借用同一班次当天19:00以后的区段
+    static const ExpectedLeg overnight[] = { { "长沙南站", "广州南站", HIGH_SPEED_RAIL }, { "广州南站", "深圳北站", HIGH_SPEED_RAIL } };
+    path = timetable_earliest_arrival(timetable, network, changsha, shenzhen, 0.0, &arrival);
+    CHECK(path != NULL);
+    if (path) {
+        CHECK_NEAR(arrival, 4.0 + 37.0 / 60.0, 1e-6);
+        check_legs(network, path, overnight, 2);
+        CHECK_NEAR(path->total_cost, 310.1 + 48.2, 1e-3);
+        free_route_path(path);
+    }
+
+    timetable_destroy(timetable);
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
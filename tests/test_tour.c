@@ -0,0 +1,118 @@
+/**
+ * @file test_tour.c
+ * @brief 检查可增量编辑的行程：每次增删途经点或交通事件同步后，环路成本与在当前途经点上从头求解的结果相同。
+ */
+#include "check.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include "tour.h"
+#include "tsp_matrix.h"
+#include <float.h>
+#include <stdlib.h>
+
+#define MAX_STOPS 14
+
+/**
+ * @brief 在行程当前的途经点上从头求解：按环路顺序取出途经点，重新计算成本矩阵并精确求解。
+ *        同时检查行程的环路是途经点的一个排列，且其成本与矩阵上按该顺序计算的成本相同。
+ * @return double 从头求解的最优成本；点数超出精确范围时返回行程顺序在新矩阵上的成本。
+ */
+static double solve_from_scratch(const TrafficNetwork* network, const TourPlanner* tour, bool* exact) {
+    int stops[MAX_STOPS];
+    int count = tour_planner_get_order(tour, stops, MAX_STOPS);
+    CHECK(count == tour_planner_get_stop_count(tour));
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < i; j++) CHECK(stops[i] != stops[j]);
+    }
+    double cost[MAX_STOPS * MAX_STOPS];
+    RouteQueryOptions options = { 0.5, 0.5, NULL, 0 };
+    for (int i = 0; i < count; i++) CHECK(find_shortest_path_costs(network, stops[i], stops, count, &options, NULL, cost + i * MAX_STOPS));
+
+    int identity[MAX_STOPS], order[MAX_STOPS];
+    for (int i = 0; i < count; i++) identity[i] = i;
+    double current = tsp_tour_cost(cost, MAX_STOPS, identity, count);
+    CHECK_NEAR(tour_planner_get_cost(tour), current, 1e-9);
+    *exact = false;
+    if (count > HELD_KARP_MAX_NODES) return current;
+    return tsp_solve_matrix(cost, MAX_STOPS, count, order, exact);
+}
+
+/**
+ * @brief 精确范围内增量结果必须最优，与从头求解的成本相同。
+ */
+static void check_matches_scratch(const TrafficNetwork* network, const TourPlanner* tour) {
+    bool exact = false;
+    double scratch = solve_from_scratch(network, tour, &exact);
+    if (!exact) return;
+    CHECK(tour_planner_is_optimal(tour));
+    CHECK_NEAR(tour_planner_get_cost(tour), scratch, 1e-9);
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+    int n = traffic_network_get_node_count(network);
+
+    TourPlanner* tour = tour_planner_create(network, 0.5, 0.5);
+    CHECK(tour != NULL);
+    if (!tour) return CHECK_RESULT();
+
+    // 逐个增加到超出精确范围，期间穿插删除（包括删除起点）
+    int next = 0;
+    for (int step = 0; step < 24; step++) {
+        int count = tour_planner_get_stop_count(tour);
+        if (step % 5 == 4 && count > 2) {
+            int stops[MAX_STOPS];
+            tour_planner_get_order(tour, stops, MAX_STOPS);
+            int victim = stops[step % 3 == 0 ? 0 : count / 2];
+            CHECK(tour_planner_remove_stop(tour, victim));
+            CHECK(!tour_planner_remove_stop(tour, victim));
+            CHECK(tour_planner_get_stop_count(tour) == count - 1);
+        } else if (count < MAX_STOPS) {
+            int node = (next++ * 37 + 3) % n;
+            CHECK(tour_planner_add_stop(tour, node));
+            CHECK(tour_planner_add_stop(tour, node)); // 已在行程中：不做修改
+        }
+        if (tour_planner_get_stop_count(tour) >= 2) check_matches_scratch(network, tour);
+    }
+    CHECK(tour_planner_get_stop_count(tour) > HELD_KARP_MAX_NODES);
+
+    // 删除回精确范围内：重新得到最优解
+    while (tour_planner_get_stop_count(tour) > HELD_KARP_MAX_NODES - 2) {
+        int stops[MAX_STOPS];
+        tour_planner_get_order(tour, stops, MAX_STOPS);
+        CHECK(tour_planner_remove_stop(tour, stops[1]));
+        check_matches_scratch(network, tour);
+    }
+
+    // 交通事件：同步后与在当前网络上从头求解相同
+    int stops[MAX_STOPS];
+    int count = tour_planner_get_order(tour, stops, MAX_STOPS);
+    RoutePath* route = tour_planner_build_route(tour);
+    CHECK(route != NULL);
+    if (route) {
+        const PathSegment* seg = route->segments_head;
+        CHECK(traffic_network_set_edge_time_factor(network, seg->from_node_id, seg->to_node_id, seg->mode, 5.0));
+        free_route_path(route);
+    }
+    CHECK(tour_planner_sync(tour) > 0);
+    check_matches_scratch(network, tour);
+    CHECK(tour_planner_get_order(tour, stops, MAX_STOPS) == count);
+    traffic_network_clear_incidents(network);
+    CHECK(tour_planner_sync(tour) > 0);
+    check_matches_scratch(network, tour);
+
+    // 生成的路线与环路成本一致
+    route = tour_planner_build_route(tour);
+    CHECK(route != NULL);
+    if (route) {
+        CHECK_NEAR(calculate_weighted_leg_cost(route->total_time, route->total_cost, 0.5, 0.5), tour_planner_get_cost(tour), 1e-6);
+        free_route_path(route);
+    }
+    CHECK(!tour_planner_add_stop(tour, n));
+
+    tour_planner_destroy(tour);
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,141 @@
+/**
+ * @file test_traffic_planner.c
+ * @brief 检查共享库的公共接口：参数检查、名称截断、路线的所有权、成本矩阵中的不可达标记、JSON查询，
+ *        以及关闭一个规划器不影响另一个规划器上正在进行的查询。
+ */
+#include "check.h"
+#include "traffic_planner.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <string.h>
+
+typedef struct {
+    TrafficPlanner* planner;
+    int rounds;                 // 已完成的轮数，主线程据此确认查询已经开始
+    int stop;                   // 主线程置1后，再完成一轮就退出
+    int failures;
+} QueryLoop;
+
+/**
+ * @brief 在另一个线程中反复查询相邻节点之间的路线（大多同城，会查表），直到主线程要求停止。
+ */
+static void* run_queries(void* arg) {
+    QueryLoop* loop = (QueryLoop*)arg;
+    int node_count = traffic_planner_node_count(loop->planner);
+    bool stopping = false;
+    while (!stopping) {
+        stopping = __atomic_load_n(&loop->stop, __ATOMIC_ACQUIRE);
+        for (int v = 0; v + 1 < node_count; v++) {
+            TrafficPlannerRoute* route = NULL;
+            if (traffic_planner_route(loop->planner, v, v + 1, 0.5, 0.5, 0, &route) != TRAFFIC_PLANNER_OK) loop->failures++;
+            traffic_planner_route_free(route);
+        }
+        __atomic_add_fetch(&loop->rounds, 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+int main(void) {
+    CHECK(traffic_planner_version() >> 16 == TRAFFIC_PLANNER_VERSION_MAJOR);
+
+    TrafficPlanner* planner = (TrafficPlanner*)1;
+    CHECK(traffic_planner_open("data/no_such_file.csv", &planner) == TRAFFIC_PLANNER_ERROR_LOAD_FAILED);
+    CHECK(planner == NULL);
+    CHECK(traffic_planner_open(NULL, &planner) == TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT);
+    CHECK(traffic_planner_open("data/nodes.csv", NULL) == TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT);
+
+    TrafficPlanner* first = NULL;
+    TrafficPlanner* second = NULL;
+    CHECK(traffic_planner_open("data/nodes.csv", &first) == TRAFFIC_PLANNER_OK);
+    CHECK(traffic_planner_open("data/nodes.csv", &second) == TRAFFIC_PLANNER_OK);
+    if (!first || !second) return CHECK_RESULT();
+    int node_count = traffic_planner_node_count(second);
+    CHECK(node_count > 0 && node_count == traffic_planner_node_count(first));
+
+    // 名称：与 snprintf 相同，先问长度，缓冲区不够时截断并以 '\0' 结尾
+    int wuhan = traffic_planner_find_node(second, "武汉站");
+    CHECK(wuhan >= 0);
+    CHECK(traffic_planner_find_node(second, "不存在的地标") == -1);
+    size_t length = traffic_planner_node_name(second, wuhan, NULL, 0);
+    CHECK(length == strlen("武汉站"));
+    char name[64];
+    CHECK(traffic_planner_node_name(second, wuhan, name, sizeof(name)) == length);
+    CHECK(strcmp(name, "武汉站") == 0);
+    char short_name[4];
+    memset(short_name, 'x', sizeof(short_name));
+    CHECK(traffic_planner_node_name(second, wuhan, short_name, sizeof(short_name)) == length);
+    CHECK(short_name[3] == '\0' && memcmp(short_name, "武汉站", 3) == 0);
+    CHECK(traffic_planner_node_name(second, node_count, name, sizeof(name)) == 0 && name[0] == '\0');
+
+    // 路线：路段首尾相接，总计等于各路段之和；越界的节点ID是参数错误
+    TrafficPlannerRoute* route = NULL;
+    CHECK(traffic_planner_route(second, 0, node_count, 0.5, 0.5, 0, &route) == TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT);
+    CHECK(route == NULL);
+    CHECK(traffic_planner_route(second, 0, wuhan, 0.5, 0.5, 0, &route) == TRAFFIC_PLANNER_OK);
+    double distance = 0.0, hours = 0.0, yuan = 0.0;
+    traffic_planner_route_totals(route, &distance, &hours, &yuan);
+
+    // 关闭第一个规划器时，另一个线程正在第二个规划器上查询
+    QueryLoop loop = { second, 0, 0, 0 };
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, run_queries, &loop) == 0);
+    while (__atomic_load_n(&loop.rounds, __ATOMIC_ACQUIRE) == 0) sched_yield();
+    traffic_planner_close(first);
+    __atomic_store_n(&loop.stop, 1, __ATOMIC_RELEASE);
+    pthread_join(thread, NULL);
+    CHECK(loop.failures == 0);
+
+    // 关闭规划器之后，之前返回的路线仍然有效
+    traffic_planner_close(second);
+    int count = traffic_planner_route_segment_count(route);
+    CHECK(count > 0);
+    TrafficPlannerSegment segments[64];
+    CHECK(traffic_planner_route_get_segments(route, segments, 64) == count);
+    double sum_distance = 0.0, sum_hours = 0.0, sum_yuan = 0.0;
+    for (int i = 0; i < count; i++) {
+        CHECK(segments[i].from_node_id == (i == 0 ? 0 : segments[i - 1].to_node_id));
+        sum_distance += segments[i].distance_km;
+        sum_hours += segments[i].time_hours;
+        sum_yuan += segments[i].cost_yuan;
+    }
+    CHECK(count > 0 && segments[count - 1].to_node_id == wuhan);
+    CHECK_NEAR(sum_distance, distance, 1e-6);
+    CHECK_NEAR(sum_hours, hours, 1e-6);
+    CHECK_NEAR(sum_yuan, yuan, 1e-6);
+    CHECK(traffic_planner_route_get_segments(route, segments, 1) == 1);
+    traffic_planner_route_free(route);
+
+    // 成本矩阵：只坐飞机时非机场节点不可达，输出-1；对角线为0
+    CHECK(traffic_planner_open("data/nodes.csv", &planner) == TRAFFIC_PLANNER_OK);
+    if (!planner) return CHECK_RESULT();
+    int beijing_airport = traffic_planner_find_node(planner, "首都国际机场");
+    int shanghai_airport = traffic_planner_find_node(planner, "虹桥国际机场");
+    CHECK(beijing_airport >= 0 && shanghai_airport >= 0);
+    int nodes[3] = { beijing_airport, shanghai_airport, wuhan };
+    double costs[9];
+    CHECK(traffic_planner_cost_matrix(planner, nodes, 3, 0.5, 0.5, 1u << TRAFFIC_PLANNER_MODE_FLIGHT, costs) == TRAFFIC_PLANNER_OK);
+    for (int i = 0; i < 3; i++) CHECK(costs[i * 3 + i] == 0.0);
+    CHECK(costs[0 * 3 + 1] > 0.0 && costs[1 * 3 + 0] > 0.0);
+    CHECK(costs[0 * 3 + 2] == -1.0 && costs[2 * 3 + 0] == -1.0);
+    nodes[2] = -1;
+    CHECK(traffic_planner_cost_matrix(planner, nodes, 3, 0.5, 0.5, 0, costs) == TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT);
+
+    // JSON查询：状态码与服务模式相同，错误也以JSON返回
+    char* json = NULL;
+    size_t json_length = 0;
+    int http_status = 0;
+    CHECK(traffic_planner_query_json(planner, "/health", NULL, &json, &json_length, &http_status) == TRAFFIC_PLANNER_OK);
+    CHECK(http_status == 200 && json && strstr(json, "\"status\":\"ok\"") && json_length == strlen(json));
+    traffic_planner_string_free(json);
+    CHECK(traffic_planner_query_json(planner, "/route", "from=0", &json, NULL, &http_status) == TRAFFIC_PLANNER_OK);
+    CHECK(http_status == 400 && json && strstr(json, "\"error\""));
+    traffic_planner_string_free(json);
+    CHECK(traffic_planner_query_json(planner, "/no_such_endpoint", "", &json, NULL, &http_status) == TRAFFIC_PLANNER_OK);
+    CHECK(http_status == 404);
+    traffic_planner_string_free(json);
+    CHECK(traffic_planner_query_json(planner, NULL, NULL, &json, NULL, NULL) == TRAFFIC_PLANNER_ERROR_INVALID_ARGUMENT && json == NULL);
+    traffic_planner_close(planner);
+    traffic_planner_close(NULL);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,147 @@
+/**
+ * @file test_tsp.c
+ * @brief 检查TSP求解：分支定界在8-10个点上证明最优并与穷举、Held-Karp 的成本相同；超过分支定界上限的途经点交给分层分解。
+ */
+#include "check.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include "tsp_bnb.h"
+#include "tsp_matrix.h"
+#include <float.h>
+#include <stdlib.h>
+
+#define MAX_EXACT_STOPS 10
+
+/**
+ * @brief 穷举第1..n-1个点的所有排列，返回最优环路的成本。
+ */
+static double brute_force_tour(const double* cost, int stride, int* order, int depth, int n) {
+    if (depth == n) return tsp_tour_cost(cost, stride, order, n);
+    double best = DBL_MAX;
+    for (int i = depth; i < n; i++) {
+        int t = order[depth];
+        order[depth] = order[i];
+        order[i] = t;
+        double c = brute_force_tour(cost, stride, order, depth + 1, n);
+        if (c < best) best = c;
+        order[i] = order[depth];
+        order[depth] = t;
+    }
+    return best;
+}
+
+/**
+ * @brief 访问顺序以0开头，并且恰好包含 0..n-1 各一次。
+ */
+static bool is_permutation(const int* order, int n) {
+    bool seen[MAX_EXACT_STOPS] = { false };
+    if (order[0] != 0) return false;
+    for (int i = 0; i < n; i++) {
+        if (order[i] < 0 || order[i] >= n || seen[order[i]]) return false;
+        seen[order[i]] = true;
+    }
+    return true;
+}
+
+/**
+ * @brief 在同一个成本矩阵上比较分支定界、Held-Karp 和（点数不超过 brute_force_limit 时）穷举的结果。
+ */
+static void check_exact_solvers(const double* cost, int n, int brute_force_limit) {
+    int order[MAX_EXACT_STOPS];
+    bool is_optimal = false;
+    double bnb = tsp_branch_and_bound(cost, MAX_EXACT_STOPS, n, order, 0.0, NULL, &is_optimal);
+    CHECK(is_optimal);
+    CHECK(is_permutation(order, n));
+    CHECK_NEAR(tsp_tour_cost(cost, MAX_EXACT_STOPS, order, n), bnb, 1e-9);
+
+    int dp_order[MAX_EXACT_STOPS];
+    bool dp_optimal = false;
+    double dp = tsp_solve_matrix(cost, MAX_EXACT_STOPS, n, dp_order, &dp_optimal);
+    CHECK(dp_optimal);
+    CHECK_NEAR(bnb, dp, 1e-9);
+
+    if (n <= brute_force_limit) {
+        int perm[MAX_EXACT_STOPS];
+        for (int i = 0; i < n; i++) perm[i] = i;
+        CHECK_NEAR(bnb, brute_force_tour(cost, MAX_EXACT_STOPS, perm, 1, n), 1e-9);
+    }
+}
+
+/**
+ * @brief 检查环路从起点出发、首尾相接、回到起点，并且经过每一个途经点。
+ */
+static void check_tour(const TrafficNetwork* network, const RoutePath* path, const int* stops, int count) {
+    bool* visited = (bool*)calloc(traffic_network_get_node_count(network), sizeof(bool));
+    if (!visited) return;
+    int at = stops[0];
+    for (const PathSegment* seg = path->segments_head; seg; seg = seg->next) {
+        CHECK(seg->from_node_id == at);
+        at = seg->to_node_id;
+        visited[at] = true;
+    }
+    CHECK(at == stops[0]);
+    for (int i = 0; i < count; i++) CHECK(visited[stops[i]]);
+    free(visited);
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+
+    // 网络上8-10个途经点之间的成本矩阵
+    int n = traffic_network_get_node_count(network);
+    RouteQueryOptions options = { 0.5, 0.5, NULL, 0 };
+    for (int count = 8; count <= MAX_EXACT_STOPS; count++) {
+        int ids[MAX_EXACT_STOPS];
+        for (int i = 0; i < count; i++) ids[i] = (i * 17 + count) % n;
+        double cost[MAX_EXACT_STOPS * MAX_EXACT_STOPS];
+        for (int i = 0; i < count; i++) {
+            CHECK(find_shortest_path_costs(network, ids[i], ids, count, &options, NULL, cost + i * MAX_EXACT_STOPS));
+        }
+        check_exact_solvers(cost, count, 9);
+    }
+
+    // 随机的非对称矩阵，以及一个无法到达其他点的点
+    srand(56);
+    for (int round = 0; round < 5; round++) {
+        double cost[MAX_EXACT_STOPS * MAX_EXACT_STOPS];
+        for (int i = 0; i < MAX_EXACT_STOPS * MAX_EXACT_STOPS; i++) cost[i] = 1.0 + rand() % 1000;
+        for (int i = 0; i < MAX_EXACT_STOPS; i++) cost[i * MAX_EXACT_STOPS + i] = 0.0;
+        check_exact_solvers(cost, 8 + round % 3, 9);
+    }
+    double cost[MAX_EXACT_STOPS * MAX_EXACT_STOPS];
+    for (int i = 0; i < MAX_EXACT_STOPS * MAX_EXACT_STOPS; i++) cost[i] = i % (MAX_EXACT_STOPS + 1) == 0 ? 0.0 : 10.0;
+    for (int i = 0; i < MAX_EXACT_STOPS; i++) {
+        if (i != 5) cost[5 * MAX_EXACT_STOPS + i] = DBL_MAX;
+    }
+    int order[MAX_EXACT_STOPS];
+    CHECK(tsp_branch_and_bound(cost, MAX_EXACT_STOPS, 8, order, 0.0, NULL, NULL) == DBL_MAX);
+
+    // 网络上的精确求解：9个途经点在分支定界范围内，结果被证明最优
+    int exact_stops[9];
+    for (int i = 0; i < 9; i++) exact_stops[i] = (i * 11 + 2) % n;
+    bool exact_optimal = false;
+    RoutePath* exact = solve_tsp_exact(network, exact_stops, 9, 0.5, 0.5, 0.0, &exact_optimal, NULL, NULL);
+    CHECK(exact != NULL && exact_optimal);
+    if (exact) {
+        check_tour(network, exact, exact_stops, 9);
+        free_route_path(exact);
+    }
+
+    // 超过 TSP_BNB_MAX_NODES 个途经点：分层求解，结果不声称最优
+    int stops[TSP_BNB_MAX_NODES + 20];
+    int count = TSP_BNB_MAX_NODES + 20;
+    for (int i = 0; i < count; i++) stops[i] = (i * 7) % n;
+    bool is_optimal = true;
+    RoutePath* path = solve_tsp_exact(network, stops, count, 0.5, 0.5, 1000.0, &is_optimal, NULL, NULL);
+    CHECK(path != NULL);
+    CHECK(!is_optimal);
+    if (path) {
+        check_tour(network, path, stops, count);
+        free_route_path(path);
+    }
+
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,59 @@
+/**
+ * @file test_utils.c
+ * @brief 检查交通方式名称的解析：名称列表、"all"、未知名称、空输入以及多余的逗号。
+ */
+#include "check.h"
+#include "utils.h"
+
+/**
+ * @brief 解析应当成功并得到 expected。
+ */
+static void check_valid(const char* names, TransportModeMask expected) {
+    TransportModeMask mask = 0;
+    bool ok = mode_mask_from_string(names, &mask);
+    if (!ok || mask != expected) fprintf(stderr, "解析 \"%s\" 的结果不正确\n", names);
+    CHECK(ok && mask == expected);
+}
+
+/**
+ * @brief 解析应当失败，并且不修改输出。
+ */
+static void check_invalid(const char* names) {
+    TransportModeMask mask = 0x80;
+    bool ok = mode_mask_from_string(names, &mask);
+    if (ok) fprintf(stderr, "\"%s\" 不应被接受\n", names);
+    CHECK(!ok && mask == 0x80);
+}
+
+int main(void) {
+    for (int m = 0; m < TRANSPORT_MODE_COUNT; m++) {
+        CHECK(mode_from_string(mode_to_string((TransportMode)m)) == m);
+        check_valid(mode_to_string((TransportMode)m), TRANSPORT_MODE_BIT(m));
+    }
+    CHECK(mode_from_string("walking") == -1);
+
+    check_valid("driving,high_speed_rail", TRANSPORT_MODE_BIT(DRIVING) | TRANSPORT_MODE_BIT(HIGH_SPEED_RAIL));
+    check_valid("bus,flight,bus", TRANSPORT_MODE_BIT(BUS) | TRANSPORT_MODE_BIT(FLIGHT));
+    check_valid("all", TRANSPORT_MODE_ALL);
+    check_valid("driving,all", TRANSPORT_MODE_ALL);
+
+    check_invalid("");
+    check_invalid("walking");
+    check_invalid("driving,walking");
+    check_invalid("Driving");
+    check_invalid("driving,");
+    check_invalid("driving,,bus");
+    check_invalid(",driving");
+    check_invalid(",");
+    check_invalid("driving ,bus");
+    check_invalid("a_name_that_is_much_too_long_to_be_a_mode");
+    TransportModeMask mask;
+    CHECK(!mode_mask_from_string(NULL, &mask));
+    CHECK(!mode_mask_from_string("driving", NULL));
+
+    // 空集合表示不限制
+    TransportMode modes[TRANSPORT_MODE_COUNT];
+    CHECK(mode_mask_expand(0, modes) == TRANSPORT_MODE_COUNT);
+    CHECK(mode_mask_expand(TRANSPORT_MODE_BIT(FLIGHT), modes) == 1 && modes[0] == FLIGHT);
+    return CHECK_RESULT();
+}
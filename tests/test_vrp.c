@@ -0,0 +1,143 @@
+/**
+ * @file test_vrp.c
+ * @brief 检查多旅行者路径规划：每个途经点恰好分配一次，每条路线从起点出发并返回，固定种子的结果可复现。
+ */
+#include "check.h"
+#include "graph.h"
+#include "pathfinding.h"
+#include "vrp.h"
+#include <float.h>
+#include <stdlib.h>
+
+#define STOP_COUNT 13
+
+/**
+ * @brief 检查结果的结构：途经点的分配、人均上限、路线的首尾与途经顺序以及成本汇总。
+ */
+static void check_result(const VrpResult* result, const int* stops, int stop_count, const VrpOptions* options) {
+    CHECK(result->num_routes == options->num_travellers);
+    int depot = stops[0];
+    int seen[STOP_COUNT] = { 0 };
+    double total = 0.0, longest = 0.0;
+    for (int r = 0; r < result->num_routes; r++) {
+        CHECK(result->stop_counts[r] >= 0);
+        if (options->max_stops_per_route > 0) CHECK(result->stop_counts[r] <= options->max_stops_per_route);
+        for (int k = 0; k < result->stop_counts[r]; k++) {
+            int index = -1;
+            for (int i = 0; i < stop_count; i++) {
+                if (stops[i] == result->stop_ids[r][k]) index = i;
+            }
+            CHECK(index > 0); // 起点不会作为途经点出现
+            if (index > 0) seen[index]++;
+        }
+        if (result->stop_counts[r] == 0) {
+            CHECK(result->routes[r] == NULL);
+            CHECK(result->route_costs[r] == 0.0);
+            continue;
+        }
+
+        // 路线从起点出发、依次经过分配的途经点并回到起点
+        const RoutePath* route = result->routes[r];
+        CHECK(route != NULL);
+        if (!route) continue;
+        CHECK(route->segments_head->from_node_id == depot);
+        int next = 0, last = depot;
+        for (const PathSegment* seg = route->segments_head; seg; seg = seg->next) {
+            CHECK(seg->from_node_id == last);
+            last = seg->to_node_id;
+            if (next < result->stop_counts[r] && last == result->stop_ids[r][next]) next++;
+        }
+        CHECK(last == depot);
+        CHECK(next == result->stop_counts[r]);
+        CHECK_NEAR(calculate_weighted_leg_cost(route->total_time, route->total_cost, 0.5, 0.5), result->route_costs[r], 1e-6);
+        total += result->route_costs[r];
+        if (result->route_costs[r] > longest) longest = result->route_costs[r];
+    }
+    for (int i = 1; i < stop_count; i++) CHECK(seen[i] == 1);
+    CHECK_NEAR(result->total_cost, total, 1e-6);
+    CHECK_NEAR(result->max_route_cost, longest, 1e-9);
+}
+
+/**
+ * @brief 两次求解的分配与访问顺序完全相同。
+ */
+static bool same_result(const VrpResult* a, const VrpResult* b) {
+    if (a->num_routes != b->num_routes || a->total_cost != b->total_cost) return false;
+    for (int r = 0; r < a->num_routes; r++) {
+        if (a->stop_counts[r] != b->stop_counts[r]) return false;
+        for (int k = 0; k < a->stop_counts[r]; k++) {
+            if (a->stop_ids[r][k] != b->stop_ids[r][k]) return false;
+        }
+    }
+    return true;
+}
+
+int main(void) {
+    TrafficNetwork* network = traffic_network_create("data/nodes.csv");
+    CHECK(network != NULL);
+    if (!network) return CHECK_RESULT();
+    int n = traffic_network_get_node_count(network);
+
+    int stops[STOP_COUNT];
+    for (int i = 0; i < STOP_COUNT; i++) stops[i] = (i * 11) % n;
+
+    for (int objective = VRP_MINIMIZE_TOTAL; objective <= VRP_MINIMIZE_MAX_ROUTE; objective++) {
+        VrpOptions options;
+        vrp_default_options(&options);
+        options.num_travellers = 3;
+        options.max_stops_per_route = 5;
+        options.objective = (VrpObjective)objective;
+        options.num_threads = 1;
+        options.iterations = 300;
+        options.time_limit_ms = 0.0;
+        options.seed = 2024u;
+
+        VrpResult* first = solve_vrp(network, stops, STOP_COUNT, 0.5, 0.5, &options, NULL);
+        VrpResult* second = solve_vrp(network, stops, STOP_COUNT, 0.5, 0.5, &options, NULL);
+        CHECK(first != NULL && second != NULL);
+        if (first && second) {
+            check_result(first, stops, STOP_COUNT, &options);
+            CHECK(same_result(first, second));
+        }
+        free_vrp_result(first);
+        free_vrp_result(second);
+
+        // 多个搜索线程的结果不保证可复现，但结构同样合法
+        options.num_threads = 3;
+        options.seed = 7u;
+        VrpResult* parallel = solve_vrp(network, stops, STOP_COUNT, 0.5, 0.5, &options, NULL);
+        CHECK(parallel != NULL);
+        if (parallel) check_result(parallel, stops, STOP_COUNT, &options);
+        free_vrp_result(parallel);
+    }
+
+    // 重复的途经点（包括起点）只访问一次
+    int duplicated[STOP_COUNT + 3];
+    for (int i = 0; i < STOP_COUNT; i++) duplicated[i] = stops[i];
+    duplicated[STOP_COUNT] = stops[0];
+    duplicated[STOP_COUNT + 1] = stops[4];
+    duplicated[STOP_COUNT + 2] = stops[4];
+    VrpOptions options;
+    vrp_default_options(&options);
+    options.num_travellers = 4;
+    options.num_threads = 1;
+    options.iterations = 100;
+    VrpResult* result = solve_vrp(network, duplicated, STOP_COUNT + 3, 0.5, 0.5, &options, NULL);
+    CHECK(result != NULL);
+    if (result) check_result(result, stops, STOP_COUNT, &options);
+    free_vrp_result(result);
+
+    // 人均上限不足以覆盖全部途经点、旅行者数量无效、节点无效
+    options.max_stops_per_route = 2;
+    options.num_travellers = 5;
+    CHECK(solve_vrp(network, stops, STOP_COUNT, 0.5, 0.5, &options, NULL) == NULL);
+    options.max_stops_per_route = 0;
+    options.num_travellers = 0;
+    CHECK(solve_vrp(network, stops, STOP_COUNT, 0.5, 0.5, &options, NULL) == NULL);
+    options.num_travellers = 2;
+    int invalid[2] = { 0, n };
+    CHECK(solve_vrp(network, invalid, 2, 0.5, 0.5, &options, NULL) == NULL);
+
+    traffic_network_destroy(network);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,108 @@
+/**
+ * @file embed_network.c
+ * @brief 把节点CSV转换为可以编译进程序的 `static const` 数据表（见 include/embedded_network.h）。
+ * @details 用法：embed_network <nodes.csv> <输出文件>
+ *          使用与程序相同的加载函数解析CSV，因此内置数据与运行时加载的网络完全一致。
+ *          名称中的非ASCII字符以八进制转义输出，生成的文件与源文件编码无关。
+ */
+#include "graph.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const Node* sort_nodes; // 仅供 compare_by_name 使用，本工具是单线程的
+
+static int compare_by_name(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    int order = strcmp(sort_nodes[x].name, sort_nodes[y].name);
+    return order != 0 ? order : (x > y) - (x < y);
+}
+
+/**
+ * @brief 输出C字符串字面量。
+ */
+static void write_string(FILE* fp, const char* s) {
+    fputc('"', fp);
+    for (const unsigned char* p = (const unsigned char*)s; *p; p++) {
+        if (*p == '"' || *p == '\\') fprintf(fp, "\\%c", *p);
+        else if (*p < 0x20 || *p >= 0x7F) fprintf(fp, "\\%03o", *p);
+        else fputc(*p, fp);
+    }
+    fputc('"', fp);
+}
+
+static const char* node_type_name(NodeType type) {
+    switch (type) {
+        case NODE_TYPE_AIRPORT: return "NODE_TYPE_AIRPORT";
+        case NODE_TYPE_HSR_STATION: return "NODE_TYPE_HSR_STATION";
+        default: return "NODE_TYPE_LANDMARK";
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "用法: %s <nodes.csv> <输出文件>\n", argv[0]);
+        return 1;
+    }
+    TrafficNetwork* network = traffic_network_create(argv[1]);
+    if (!network || network->node_count == 0) {
+        traffic_network_destroy(network);
+        return 1;
+    }
+
+    int* name_index = (int*)malloc(network->node_count * sizeof(int));
+    if (!name_index) {
+        traffic_network_destroy(network);
+        return 1;
+    }
+    for (int i = 0; i < network->node_count; i++) name_index[i] = i;
+    sort_nodes = network->nodes;
+    qsort(name_index, network->node_count, sizeof(int), compare_by_name);
+
+    FILE* fp = fopen(argv[2], "w");
+    if (!fp) {
+        fprintf(stderr, "错误: 无法写入 %s\n", argv[2]);
+        free(name_index);
+        traffic_network_destroy(network);
+        return 1;
+    }
+    fprintf(fp, "/* 由 tools/embed_network 根据 %s 自动生成，请勿手工修改。 */\n\n", argv[1]);
+
+    fprintf(fp, "static const Node embedded_nodes[%d] = {\n", network->node_count);
+    for (int i = 0; i < network->node_count; i++) {
+        const Node* node = &network->nodes[i];
+        fprintf(fp, "    {%d, %d, %s, ", node->id, node->city_id, node_type_name(node->type));
+        write_string(fp, node->name);
+        fprintf(fp, ", %.17g, %.17g},\n", node->latitude, node->longitude);
+    }
+    fprintf(fp, "};\n\n");
+
+    fprintf(fp, "static const CityMeta embedded_cities[%d] = {\n", network->city_count);
+    for (int c = 0; c < network->city_count; c++) {
+        const CityMeta* city = &network->cities[c];
+        fprintf(fp, "    {%d, ", city->city_id);
+        write_string(fp, city->city_name);
+        fprintf(fp, ", %d, %d, %d},\n", city->landmark_node_id, city->airport_node_id, city->hsr_node_id);
+    }
+    fprintf(fp, "};\n\n");
+
+    fprintf(fp, "static const int embedded_name_index[%d] = {", network->node_count);
+    for (int i = 0; i < network->node_count; i++) fprintf(fp, "%s%d,", i % 16 == 0 ? "\n    " : " ", name_index[i]);
+    fprintf(fp, "\n};\n\n");
+
+    fprintf(fp, "static const EmbeddedNetwork embedded_network = {\n    ");
+    write_string(fp, argv[1]);
+    fprintf(fp, ",\n    embedded_nodes, %d,\n    embedded_cities, %d,\n    embedded_name_index,\n};\n", network->node_count,
+            network->city_count);
+
+    bool ok = !ferror(fp);
+    if (fclose(fp) != 0) ok = false;
+    free(name_index);
+    traffic_network_destroy(network);
+    if (!ok) {
+        fprintf(stderr, "错误: 写入 %s 失败\n", argv[2]);
+        remove(argv[2]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,227 @@
+/**
+ * @file loadgen.c
+ * @brief 服务模式的本地压测工具：多个 keep-alive 连接并发发送请求，统计吞吐量和延迟分位数。
+ * @details 用法：loadgen [-a 地址] [-p 端口] [-c 连接数] [-d 秒数] [-e 状态码] [-m 子串] [-s] [-v] [请求路径...]
+ *          每个连接一个线程，发送请求后等待完整响应再发送下一个；多个请求路径按顺序轮流使用。
+ *          默认请求路径是 /route?from=0&to=3（节点可以用ID表示）。
+ *          状态码不是期望值（默认200）或响应体不含 -m 指定的子串的请求计为失败；
+ *          -s 时每个请求使用新连接，以 HTTP/1.0 发送后立即半关闭写方向（shutdown(SHUT_WR)），检查服务仍然回复；
+ *          -v 为校验模式：有任何失败时以非0状态退出，供 make check 使用。
+ */
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief 一个连接（线程）的参数和统计结果。
+ */
+typedef struct {
+    int index;
+    double* latencies;          // 每个成功请求的延迟（毫秒）
+    int count;
+    int capacity;
+    int errors;                 // 状态码或响应体不符合期望、连接失败和读写错误
+} ClientStats;
+
+static struct sockaddr_in server_address;
+static char** paths;
+static int path_count;
+static double end_time;
+static int expected_status = 200;
+static const char* expected_substring;
+static bool half_close;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int connect_server(void) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(fd, (struct sockaddr*)&server_address, sizeof(server_address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief 读取一个完整的响应。
+ * @param body 输出以 '\0' 结尾的响应体；响应比缓冲区大时为NULL。
+ * @return int HTTP状态码，连接出错时返回-1。
+ */
+static int read_response(int fd, char* buffer, size_t size, const char** body) {
+    size_t length = 0;
+    char* header_end = NULL;
+    while (!header_end) {
+        if (length + 1 >= size) return -1;
+        ssize_t n = recv(fd, buffer + length, size - length - 1, 0);
+        if (n <= 0) return -1;
+        length += n;
+        buffer[length] = '\0';
+        header_end = strstr(buffer, "\r\n\r\n");
+    }
+    int status = atoi(buffer + 9); // "HTTP/1.1 200 OK"
+    const char* field = strstr(buffer, "Content-Length:");
+    size_t body_length = field && field < header_end ? strtoul(field + 15, NULL, 10) : 0;
+    size_t total = (header_end + 4 - buffer) + body_length;
+    if (total < size) {
+        while (length < total) {
+            ssize_t n = recv(fd, buffer + length, total - length, 0);
+            if (n <= 0) return -1;
+            length += n;
+        }
+        buffer[total] = '\0';
+        *body = header_end + 4;
+        return status;
+    }
+    *body = NULL;
+    while (length < total) { // 响应体比缓冲区大，只需读完，不必保存
+        ssize_t n = recv(fd, buffer, total - length < size ? total - length : size, 0);
+        if (n <= 0) return -1;
+        length += n;
+    }
+    return status;
+}
+
+static void* client_main(void* arg) {
+    ClientStats* stats = (ClientStats*)arg;
+    static __thread char buffer[1 << 16];
+    char request[4096];
+    int fd = -1;
+    for (int i = stats->index; now_seconds() < end_time; i++) {
+        if (fd < 0 && (fd = connect_server()) < 0) {
+            stats->errors++;
+            nanosleep(&(struct timespec){0, 10000000}, NULL);
+            continue;
+        }
+        int length = snprintf(request, sizeof(request), "GET %s HTTP/1.%d\r\nHost: localhost\r\n\r\n", paths[i % path_count],
+                              half_close ? 0 : 1);
+        double start = now_seconds();
+        const char* body = NULL;
+        bool sent = send(fd, request, length, MSG_NOSIGNAL) == length && (!half_close || shutdown(fd, SHUT_WR) == 0);
+        int status = sent ? read_response(fd, buffer, sizeof(buffer), &body) : -1;
+        double elapsed_ms = (now_seconds() - start) * 1000.0;
+        if (half_close && fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+        if (status < 0) {
+            stats->errors++;
+            if (fd >= 0) close(fd);
+            fd = -1;
+            continue;
+        }
+        if (status != expected_status || (expected_substring && (!body || !strstr(body, expected_substring)))) {
+            if (stats->errors++ == 0) {
+                fprintf(stderr, "不符合期望的响应: %s -> %d %.200s\n", paths[i % path_count], status, body ? body : "(响应过大)");
+            }
+            continue;
+        }
+        if (stats->count == stats->capacity) {
+            int capacity = stats->capacity ? stats->capacity * 2 : 4096;
+            double* latencies = (double*)realloc(stats->latencies, capacity * sizeof(double));
+            if (!latencies) break;
+            stats->latencies = latencies;
+            stats->capacity = capacity;
+        }
+        stats->latencies[stats->count++] = elapsed_ms;
+    }
+    if (fd >= 0) close(fd);
+    return NULL;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double* sorted, int count, double p) {
+    if (count == 0) return 0.0;
+    int index = (int)(p * (count - 1) + 0.5);
+    return sorted[index];
+}
+
+int main(int argc, char** argv) {
+    const char* address = "127.0.0.1";
+    int port = 8080, connections = 16;
+    double duration = 10.0;
+    bool verify = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "a:p:c:d:e:m:sv")) != -1) {
+        switch (opt) {
+            case 'a': address = optarg; break;
+            case 'p': port = atoi(optarg); break;
+            case 'c': connections = atoi(optarg); break;
+            case 'd': duration = atof(optarg); break;
+            case 'e': expected_status = atoi(optarg); break;
+            case 'm': expected_substring = optarg; break;
+            case 's': half_close = true; break;
+            case 'v': verify = true; break;
+            default:
+                fprintf(stderr, "用法: %s [-a 地址] [-p 端口] [-c 连接数] [-d 秒数] [-e 状态码] [-m 子串] [-s] [-v] [请求路径...]\n", argv[0]);
+                return 1;
+        }
+    }
+    static char* default_path = "/route?from=0&to=3";
+    paths = optind < argc ? argv + optind : &default_path;
+    path_count = optind < argc ? argc - optind : 1;
+    if (connections <= 0 || duration <= 0) return 1;
+
+    memset(&server_address, 0, sizeof(server_address));
+    server_address.sin_family = AF_INET;
+    server_address.sin_port = htons((unsigned short)port);
+    if (inet_pton(AF_INET, address, &server_address.sin_addr) != 1) {
+        fprintf(stderr, "错误: 无效的地址 %s\n", address);
+        return 1;
+    }
+
+    ClientStats* stats = (ClientStats*)calloc(connections, sizeof(ClientStats));
+    pthread_t* threads = (pthread_t*)malloc(connections * sizeof(pthread_t));
+    if (!stats || !threads) return 1;
+    double start = now_seconds();
+    end_time = start + duration;
+    for (int i = 0; i < connections; i++) {
+        stats[i].index = i;
+        pthread_create(&threads[i], NULL, client_main, &stats[i]);
+    }
+    int total = 0, errors = 0;
+    for (int i = 0; i < connections; i++) {
+        pthread_join(threads[i], NULL);
+        total += stats[i].count;
+        errors += stats[i].errors;
+    }
+    double elapsed = now_seconds() - start;
+
+    double* all = (double*)malloc((total > 0 ? total : 1) * sizeof(double));
+    if (!all) return 1;
+    int k = 0;
+    for (int i = 0; i < connections; i++) {
+        memcpy(all + k, stats[i].latencies, stats[i].count * sizeof(double));
+        k += stats[i].count;
+        free(stats[i].latencies);
+    }
+    qsort(all, total, sizeof(double), compare_double);
+
+    printf("连接数 %d，持续 %.1f 秒，成功 %d 个请求，失败 %d 个\n", connections, elapsed, total, errors);
+    printf("吞吐量: %.0f 请求/秒\n", total / elapsed);
+    printf("延迟(ms): p50 %.3f  p90 %.3f  p99 %.3f  最大 %.3f\n", percentile(all, total, 0.50), percentile(all, total, 0.90),
+           percentile(all, total, 0.99), total > 0 ? all[total - 1] : 0.0);
+    free(all);
+    free(stats);
+    free(threads);
+    if (verify) return errors > 0 || total == 0 ? 1 : 0;
+    return errors > 0 && total == 0 ? 1 : 0;
+}